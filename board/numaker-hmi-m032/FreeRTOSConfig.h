@@ -37,13 +37,23 @@ extern uint32_t SystemCoreClock;
 #define configUSE_16_BIT_TICKS          0
 #define configIDLE_SHOULD_YIELD         1
 #define configUSE_MUTEXES               1
+#define configTASK_NOTIFICATION_ARRAY_ENTRIES 2
 #define configQUEUE_REGISTRY_SIZE       8
 #define configCHECK_FOR_STACK_OVERFLOW  0
 #define configUSE_RECURSIVE_MUTEXES     1
 #define configUSE_MALLOC_FAILED_HOOK    0
 #define configUSE_APPLICATION_TASK_TAG  0
 #define configUSE_COUNTING_SEMAPHORES   1
+#if defined(CONFIG_NU_SYSSTAT) && !defined(__IASMARM__)
+/* Run time stats of nu_sysstat.c on SysTick. */
+extern void nu_sysstat_timer_init(void);
+extern uint32_t nu_sysstat_timer_get(void);
+#define configGENERATE_RUN_TIME_STATS   1
+#define portCONFIGURE_TIMER_FOR_RUN_TIME_STATS()    nu_sysstat_timer_init()
+#define portGET_RUN_TIME_COUNTER_VALUE()            nu_sysstat_timer_get()
+#else
 #define configGENERATE_RUN_TIME_STATS   0
+#endif
 #define configUSE_QUEUE_SETS            1
 
 /* Co-routine definitions. */
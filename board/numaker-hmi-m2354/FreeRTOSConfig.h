@@ -45,7 +45,7 @@
 /* Stack and heap */
 #define configMINIMAL_STACK_SIZE                        (uint16_t)128
 #define configMINIMAL_SECURE_STACK_SIZE                 1024
-#define configTOTAL_HEAP_SIZE                           (size_t)(24 * 1024)
+#define configTOTAL_HEAP_SIZE                           (size_t)(40 * 1024)
 #define configMAX_TASK_NAME_LEN                         12
 /* OS features */
 #define configUSE_MUTEXES                               1
@@ -57,6 +57,7 @@
 #define configUSE_RECURSIVE_MUTEXES                     1
 #define configUSE_QUEUE_SETS                            0
 #define configUSE_TASK_NOTIFICATIONS                    1
+#define configTASK_NOTIFICATION_ARRAY_ENTRIES           2
 #define configUSE_TRACE_FACILITY                        1
 /* Hooks */
 #define configUSE_IDLE_HOOK                             0
@@ -100,9 +101,18 @@
 #define configKERNEL_INTERRUPT_PRIORITY                 (configLIBRARY_LOWEST_INTERRUPT_PRIORITY << (8 - configPRIO_BITS))
 #define configMAX_SYSCALL_INTERRUPT_PRIORITY            (configLIBRARY_MAX_SYSCALL_INTERRUPT_PRIORITY << (8 - configPRIO_BITS))
 #ifndef __IASMARM__
+#if defined(CONFIG_NU_SYSSTAT)
+    /* Run time stats of nu_sysstat.c */
+    extern void nu_sysstat_timer_init(void);
+    extern uint32_t nu_sysstat_timer_get(void);
+    #define configGENERATE_RUN_TIME_STATS               1
+    #define portCONFIGURE_TIMER_FOR_RUN_TIME_STATS()    nu_sysstat_timer_init()
+    #define portGET_RUN_TIME_COUNTER_VALUE()            nu_sysstat_timer_get()
+#else
     #define configGENERATE_RUN_TIME_STATS               0
     #define portCONFIGURE_TIMER_FOR_RUN_TIME_STATS()
     #define portGET_RUN_TIME_COUNTER_VALUE()            0
+#endif
     #define configTICK_RATE_HZ                          (TickType_t)1000
 #endif /* __IASMARM__ */
 #if defined(CPU_CORTEX_M3) || defined(CPU_CORTEX_M4) || defined(CPU_CORTEX_M7)
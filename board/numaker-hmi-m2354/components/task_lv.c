@@ -7,10 +7,19 @@
  ******************************************************************************/
 
 #include "lv_glue.h"
+#include "nu_memtag.h"
+#include "nu_sysstat.h"
+#include "nu_image_decoder.h"
+#include "nu_asset_loader.h"
 
 #define CONFIG_LV_TASK_STACKSIZE     4096
 #define CONFIG_LV_TASK_PRIORITY      (configMAX_PRIORITIES-1)
 
+/* Time raw read against read-plus-decompress of the same image on the SPI-NOR drive. */
+//#define CONFIG_IMAGE_DECODER_BENCHMARK
+#define CONFIG_IMAGE_BENCHMARK_RAW      "0:bg.bin"
+#define CONFIG_IMAGE_BENCHMARK_STREAM   "0:bg.nz"
+
 #if LV_USE_LOG
 static void lv_nuvoton_log(lv_log_level_t level, const char *buf)
 {
@@ -18,12 +27,55 @@ static void lv_nuvoton_log(lv_log_level_t level, const char *buf)
 }
 #endif /* LV_USE_LOG */
 
-void lv_tick_task(void *pdata)
+/* Nothing in projects without sls_files, as ui_init() of common/lv_demo.c. */
+#if defined (__GNUC__)
+    __attribute__((weak)) void ui_font_caption_init(void)
+#else
+    __weak void ui_font_caption_init(void)
+#endif
 {
-    while (1)
+}
+
+static TaskHandle_t s_hLvTask = NULL;
+
+void nu_lv_task_wakeup(uint32_t u32Events)
+{
+    if (s_hLvTask != NULL)
+        xTaskNotifyIndexed(s_hLvTask, NU_LV_WAKEUP_NOTIFY_INDEX, u32Events, eSetBits);
+}
+
+void nu_lv_task_wakeup_from_isr(uint32_t u32Events)
+{
+    if (s_hLvTask != NULL)
     {
-        lv_tick_inc(1);
-        vTaskDelay((TickType_t) 1 / portTICK_PERIOD_MS);
+        BaseType_t xHigherPriorityTaskWoken = pdFALSE;
+
+        xTaskNotifyIndexedFromISR(s_hLvTask, NU_LV_WAKEUP_NOTIFY_INDEX, u32Events, eSetBits, &xHigherPriorityTaskWoken);
+
+        portYIELD_FROM_ISR(xHigherPriorityTaskWoken);
+    }
+}
+
+static void lv_nuvoton_invalidate_cb(lv_event_t *e)
+{
+    /* Invalidation inside lv_timer_handler() is covered by its returned deadline. */
+    if (xTaskGetCurrentTaskHandle() != s_hLvTask)
+        nu_lv_task_wakeup(NU_LV_WAKEUP_REFRESH);
+}
+
+static void lv_nuvoton_indev_ready(void)
+{
+    lv_indev_t *indev = lv_indev_get_next(NULL);
+
+    /* Don't wait for next read period, make all read timers ready. */
+    while (indev != NULL)
+    {
+        lv_timer_t *timer = lv_indev_get_read_timer(indev);
+
+        if (timer != NULL)
+            lv_timer_ready(timer);
+
+        indev = lv_indev_get_next(indev);
     }
 }
 
@@ -38,26 +90,60 @@ void lv_nuvoton_task(void *pdata)
     lv_tick_set_cb(xTaskGetTickCount);    /*Expression evaluating to current system time in ms*/
     lv_delay_set_cb(vTaskDelay);
 
+    /* LZ4/RLE band-compressed images. */
+    nu_image_decoder_init();
+
+    /* Tag draw buffers, it is nothing without CONFIG_NU_MEMTAG. */
+    nu_memtag_lv_init();
+
     extern void lv_port_disp_init(void);
     lv_port_disp_init();
 
     extern void lv_port_indev_init(void);
     lv_port_indev_init();
 
+#if defined(CONFIG_IMAGE_DECODER_BENCHMARK)
+    nu_image_decoder_benchmark(CONFIG_IMAGE_BENCHMARK_RAW, CONFIG_IMAGE_BENCHMARK_STREAM);
+#endif
+
+    /* Screens load their images in background, see sls_files/ui_img_manager.c. */
+    LV_ASSERT(nu_asset_loader_init() == 0);
+
     extern void ui_init(void);
     ui_init();
 
+    /* Caption in a font of the SPI-NOR drive, see sls_files/ui_font_manager.c. */
+    ui_font_caption_init();
+
+    /* CPU load overlay, it is nothing without CONFIG_NU_SYSSTAT. */
+    nu_sysstat_lv_init();
+
+    lv_display_add_event_cb(lv_display_get_default(), lv_nuvoton_invalidate_cb, LV_EVENT_INVALIDATE_AREA, NULL);
+
     while (1)
     {
-        lv_task_handler();
-        vTaskDelay((TickType_t) 1 / portTICK_PERIOD_MS);
+        uint32_t u32Events = 0;
+        uint32_t u32TimeTillNext = lv_timer_handler();
+        TickType_t xTicksToWait = (u32TimeTillNext == LV_NO_TIMER_READY) ? portMAX_DELAY : pdMS_TO_TICKS(u32TimeTillNext);
+
+        /* Overdue timers: still yield one tick to lower-priority tasks. */
+        if (xTicksToWait == 0)
+            xTicksToWait = 1;
+
+        /* Sleep until next timer deadline or a wakeup event from touch IRQ, invalidation or asset loader. */
+        xTaskNotifyWaitIndexed(NU_LV_WAKEUP_NOTIFY_INDEX, 0, 0xFFFFFFFFUL, &u32Events, xTicksToWait);
+
+        if (u32Events & NU_LV_WAKEUP_INPUT)
+            lv_nuvoton_indev_ready();
+
+        if (u32Events & NU_LV_WAKEUP_ASSET)
+            nu_asset_loader_dispatch();
     }
 }
 
 
 int task_lv_init(void)
 {
-    xTaskCreate(lv_tick_task, "lv_tick", configMINIMAL_STACK_SIZE, NULL, CONFIG_LV_TASK_PRIORITY - 1, NULL);
-    xTaskCreate(lv_nuvoton_task, "lv_hdler", CONFIG_LV_TASK_STACKSIZE, NULL, CONFIG_LV_TASK_PRIORITY, NULL);
+    xTaskCreate(lv_nuvoton_task, "lv_hdler", CONFIG_LV_TASK_STACKSIZE, NULL, CONFIG_LV_TASK_PRIORITY, &s_hLvTask);
     return 0;
 }
@@ -16,7 +16,8 @@
 #define LV_COLOR_DEPTH                  16
 
 #define LV_FONT_MONTSERRAT_12           1
-#define LV_FONT_MONTSERRAT_16           1
+/* 16 px text is streamed from 0:lato16.fnt on the SPI-NOR drive, see sls_files/README.md. */
+//#define LV_FONT_MONTSERRAT_16           1
 
 /* Please comment LV_USE_DEMO_MUSIC declaration before un-comment below */
 #define LV_USE_DEMO_WIDGETS             1
@@ -8,13 +8,18 @@
 /*-----------------------------------------------------------------------*/
 
 #include <stdio.h>
-#include "sfud.h"
-#include "sfud_cfg.h"
+#include "ftl_sfud.h"
 
 #include "ff.h"         /* Obtains integer types */
 #include "diskio.h"     /* Declarations of disk functions */
 
-#define DEF_SECTOR_SIZE     512
+/* Sectors of the flash translation layer, not erase blocks of the flash. */
+#define DEF_SECTOR_SIZE     NU_FTL_SECTOR_SIZE
+
+/* FF_MAX_SS=512 is set in the project settings of this board, ffconf.h is shared. */
+#if (FF_MAX_SS != DEF_SECTOR_SIZE)
+    #error "FF_MAX_SS must match NU_FTL_SECTOR_SIZE"
+#endif
 
 /*-----------------------------------------------------------------------*/
 /* Get Drive Status                                                      */
@@ -46,50 +51,13 @@ DSTATUS disk_initialize(
 
     if (stat != RES_OK)
     {
-        //sfud_flash *flash = sfud_get_device(SFUD_W25_DEVICE_INDEX);
-        if (sfud_init() == SFUD_SUCCESS)
+        if (ftl_sfud_init() == 0)
             stat = RES_OK;
-        /* Enable qspi fast read mode, set four data lines width */
-        //sfud_qspi_fast_read_enable(flash, 4);
     }
 
     return stat;
 }
 
-typedef enum
-{
-    SFUD_READ,
-    SFUD_ERASE_WRITE,
-    SFUD_WRITE,
-} E_MODE;
-
-static sfud_err sfud_transfer(E_MODE mode, uint8_t *pu8Buf, uint32_t sector, uint32_t count)
-{
-    sfud_err result;
-    sfud_flash *flash = sfud_get_device(SFUD_W25_DEVICE_INDEX);
-    uint32_t u32SecSize = flash->chip.erase_gran;
-    uint32_t u32Addr, u32Size;
-
-    u32Addr = sector * u32SecSize;
-    u32Size = count * u32SecSize;
-
-    // printf("%s Mode: %d, StartSecAddr: %d, Size: %d\n", __func__, mode, u32Addr, u32Size);
-    if (mode == SFUD_READ)
-    {
-        result = sfud_read(flash, u32Addr, u32Size, (uint8_t *)pu8Buf);
-    }
-    else if (mode == SFUD_ERASE_WRITE)
-    {
-        result = sfud_erase_write(flash, u32Addr, u32Size, (uint8_t *)pu8Buf);
-    }
-    else if (mode == SFUD_WRITE)
-    {
-        result = sfud_write(flash, u32Addr, u32Size, (uint8_t *)pu8Buf);
-    }
-
-    return result;
-}
-
 /*-----------------------------------------------------------------------*/
 /* Read Sector(s)                                                        */
 /*-----------------------------------------------------------------------*/
@@ -101,12 +69,12 @@ DRESULT disk_read(
     UINT count      /* Number of sectors to read */
 )
 {
-    if (pdrv || (count == 0 || count >= 2))
+    if (pdrv || (count == 0))
     {
         return RES_ERROR;
     }
 
-    return (sfud_transfer(SFUD_READ, buff, sector, count) == SFUD_SUCCESS) ? RES_OK : RES_ERROR;
+    return (ftl_sfud_read(sector, buff, count) == 0) ? RES_OK : RES_ERROR;
 }
 
 
@@ -124,12 +92,12 @@ DRESULT disk_write(
     UINT count          /* Number of sectors to write */
 )
 {
-    if (pdrv || (count == 0 || count >= 2))
+    if (pdrv || (count == 0))
     {
         return RES_ERROR;
     }
 
-    return (sfud_transfer(SFUD_ERASE_WRITE, (BYTE *)buff, sector, count) == SFUD_SUCCESS) ? RES_OK : RES_ERROR;
+    return (ftl_sfud_write(sector, buff, count) == 0) ? RES_OK : RES_ERROR;
 }
 
 #endif
@@ -153,17 +121,19 @@ DRESULT disk_ioctl(
     switch (cmd)
     {
     case CTRL_SYNC :        /* Make sure that no pending write process */
+        /* Sectors are on flash when disk_write returns. */
         break;
 
     case GET_SECTOR_COUNT : /* Get number of sectors on the disk (DWORD) */
-        *(DWORD *)buff = sfud_get_device(SFUD_W25_DEVICE_INDEX)->chip.capacity / sfud_get_device(SFUD_W25_DEVICE_INDEX)->chip.erase_gran;
+        *(DWORD *)buff = ftl_sfud_sector_count();
         break;
 
     case GET_SECTOR_SIZE :  /* Get R/W sector size (WORD) */
-        *(DWORD *)buff = sfud_get_device(SFUD_W25_DEVICE_INDEX)->chip.erase_gran;
+        *(WORD *)buff = DEF_SECTOR_SIZE;
         break;
 
     case GET_BLOCK_SIZE :   /* Get erase block size in unit of sector (DWORD) */
+        /* Erase is hidden by the flash translation layer. */
         *(DWORD *)buff = 1;
         break;
 
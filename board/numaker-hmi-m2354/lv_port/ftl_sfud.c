@@ -0,0 +1,138 @@
+/**************************************************************************//**
+ * @file     ftl_sfud.c
+ * @brief    Flash translation layer on SFUD, shared by FatFs and USB MSC
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ * @copyright (C) 2024 Nuvoton Technology Corp. All rights reserved.
+ *****************************************************************************/
+#include "lv_glue.h"
+#include "sfud.h"
+#include "sfud_cfg.h"
+#include "ftl_sfud.h"
+
+static S_NU_FTL s_sFtl;
+static SemaphoreHandle_t s_xFtlLock = NULL;
+static int s_bFtlReady = 0;
+
+static int ftl_sfud_flash_read(void *pvUserData, uint32_t u32Addr, void *pvBuf, uint32_t u32Len)
+{
+    return (sfud_read((sfud_flash *)pvUserData, u32Addr, u32Len, (uint8_t *)pvBuf) == SFUD_SUCCESS) ? 0 : -1;
+}
+
+static int ftl_sfud_flash_prog(void *pvUserData, uint32_t u32Addr, const void *pvBuf, uint32_t u32Len)
+{
+    return (sfud_write((sfud_flash *)pvUserData, u32Addr, u32Len, (const uint8_t *)pvBuf) == SFUD_SUCCESS) ? 0 : -1;
+}
+
+static int ftl_sfud_flash_erase(void *pvUserData, uint32_t u32Addr)
+{
+    sfud_flash *flash = (sfud_flash *)pvUserData;
+
+    return (sfud_erase(flash, u32Addr, flash->chip.erase_gran) == SFUD_SUCCESS) ? 0 : -1;
+}
+
+/* FatFs mounts before the scheduler runs, no one to contend with then. */
+static void ftl_sfud_lock(void)
+{
+    if (xTaskGetSchedulerState() != taskSCHEDULER_NOT_STARTED)
+        while (xSemaphoreTake(s_xFtlLock, portMAX_DELAY) != pdTRUE);
+}
+
+static void ftl_sfud_unlock(void)
+{
+    if (xTaskGetSchedulerState() != taskSCHEDULER_NOT_STARTED)
+        xSemaphoreGive(s_xFtlLock);
+}
+
+static void ftl_sfud_gc_worker(void *pvParameters)
+{
+    int ret;
+
+    for (;;)
+    {
+        ftl_sfud_lock();
+        ret = nu_ftl_gc_step(&s_sFtl, CONFIG_FTL_SFUD_GC_FREE_TARGET);
+        ftl_sfud_unlock();
+
+        if (ret <= 0)
+            vTaskDelay(pdMS_TO_TICKS(CONFIG_FTL_SFUD_GC_PERIOD_MS));
+    }
+}
+
+int ftl_sfud_init(void)
+{
+    S_NU_FTL_FLASH sFlash;
+    sfud_flash *flash;
+
+    if (s_bFtlReady)
+        return 0;
+
+    if (sfud_init() != SFUD_SUCCESS)
+        return -1;
+
+    flash = sfud_get_device(SFUD_W25_DEVICE_INDEX);
+
+#ifdef SFUD_USING_QSPI
+    {
+        extern sfud_err nu_sfud_qspi_fast_read_enable(sfud_flash * flash, uint8_t data_line_width);
+
+        /* Enable qspi fast read mode from SFDP, up to four data lines width */
+        nu_sfud_qspi_fast_read_enable(flash, 4);
+    }
+#endif
+
+    sFlash.pfnRead = ftl_sfud_flash_read;
+    sFlash.pfnProg = ftl_sfud_flash_prog;
+    sFlash.pfnErase = ftl_sfud_flash_erase;
+    sFlash.pvUserData = flash;
+    sFlash.u32BlockSize = flash->chip.erase_gran;
+    sFlash.u32BlockCount = flash->chip.capacity / flash->chip.erase_gran;
+
+    if (nu_ftl_mount(&s_sFtl, &sFlash) != 0)
+    {
+        printf("[ftl] mount failed\n");
+        return -1;
+    }
+
+    printf("[ftl] %d sectors, %d free blocks, %d to erase, max erase count %d\n",
+           s_sFtl.u32SectorCount,
+           s_sFtl.u32FreeBlocks,
+           s_sFtl.u32DirtyBlocks,
+           s_sFtl.sStat.u32MaxEraseCnt);
+
+    s_xFtlLock = xSemaphoreCreateMutex();
+    LV_ASSERT(s_xFtlLock != NULL);
+
+    LV_ASSERT(xTaskCreate(ftl_sfud_gc_worker, "ftl_gc", CONFIG_FTL_SFUD_GC_STACKSIZE, NULL, tskIDLE_PRIORITY, NULL) == pdPASS);
+
+    s_bFtlReady = 1;
+
+    return 0;
+}
+
+int ftl_sfud_read(uint32_t u32Sector, void *pvBuf, uint32_t u32Count)
+{
+    int ret;
+
+    ftl_sfud_lock();
+    ret = nu_ftl_read(&s_sFtl, u32Sector, pvBuf, u32Count);
+    ftl_sfud_unlock();
+
+    return ret;
+}
+
+int ftl_sfud_write(uint32_t u32Sector, const void *pvBuf, uint32_t u32Count)
+{
+    int ret;
+
+    ftl_sfud_lock();
+    ret = nu_ftl_write(&s_sFtl, u32Sector, pvBuf, u32Count);
+    ftl_sfud_unlock();
+
+    return ret;
+}
+
+uint32_t ftl_sfud_sector_count(void)
+{
+    return s_sFtl.u32SectorCount;
+}
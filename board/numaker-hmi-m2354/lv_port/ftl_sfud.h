@@ -0,0 +1,31 @@
+/**************************************************************************//**
+ * @file     ftl_sfud.h
+ * @brief    Flash translation layer on SFUD, shared by FatFs and USB MSC
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ * @copyright (C) 2024 Nuvoton Technology Corp. All rights reserved.
+ *****************************************************************************/
+#ifndef __FTL_SFUD_H__
+#define __FTL_SFUD_H__
+
+#include <stdint.h>
+#include "nu_ftl.h"
+
+/* Background collection keeps this many blocks free, so writers rarely collect in foreground. */
+#if !defined(CONFIG_FTL_SFUD_GC_FREE_TARGET)
+    #define CONFIG_FTL_SFUD_GC_FREE_TARGET  (CONFIG_NU_FTL_GC_MIN_FREE + 2)
+#endif
+
+/* Sleep of the collector task when nothing is left to do. */
+#if !defined(CONFIG_FTL_SFUD_GC_PERIOD_MS)
+    #define CONFIG_FTL_SFUD_GC_PERIOD_MS    500
+#endif
+
+#define CONFIG_FTL_SFUD_GC_STACKSIZE        384
+
+int ftl_sfud_init(void);
+int ftl_sfud_read(uint32_t u32Sector, void *pvBuf, uint32_t u32Count);
+int ftl_sfud_write(uint32_t u32Sector, const void *pvBuf, uint32_t u32Count);
+uint32_t ftl_sfud_sector_count(void);
+
+#endif /* __FTL_SFUD_H__ */
@@ -1,7 +1,9 @@
+#include <string.h>
+#include "lv_glue.h"
+#include "queue.h"
 #include "usbd_core.h"
 #include "usbd_msc.h"
-#include "sfud.h"
-#include "sfud_cfg.h"
+#include "ftl_sfud.h"
 
 #define MSC_IN_EP  0x81
 #define MSC_OUT_EP 0x02
@@ -124,64 +126,364 @@ static void usbd_event_handler(uint8_t busid, uint8_t event)
     }
 }
 
+/*
+ * All flash access runs in one worker task, in job order. The MSC thread
+ * only copies between USB buffers and RAM, so it overlaps flash time:
+ *  - Sequential reads: the next request is read ahead into a spare buffer
+ *    while the current one is sent to host.
+ *  - Writes: collected in a RAM cache block of several sectors. Its dirty
+ *    sectors are committed to the flash translation layer in one go when
+ *    writing moves to another block, while the other cache buffer takes new
+ *    data. A dirty block is also committed after CONFIG_MSC_CACHE_IDLE_MS
+ *    without traffic.
+ * Sectors are the 512-byte ones of ftl_sfud.c, like diskio_sfud.c, so host
+ * and FatFs see one volume layout.
+ */
+#define CONFIG_MSC_WORKER_STACKSIZE    512
+#define CONFIG_MSC_WORKER_PRIORITY     CONFIG_USBDEV_MSC_PRIO
+#define CONFIG_MSC_CACHE_IDLE_MS       200
+
+/* Size of a cache block, also upper bound of one read-ahead request. */
+#define CONFIG_MSC_CACHE_BLOCK_SIZE    4096
+
+#define MSC_SECTOR_SIZE                NU_FTL_SECTOR_SIZE
+#define MSC_CACHE_SECTORS              (CONFIG_MSC_CACHE_BLOCK_SIZE / MSC_SECTOR_SIZE)
+#define MSC_CACHE_NUM                  2
+#define MSC_CACHE_NONE                 0xFFFFFFFF
+
 typedef enum
 {
-    SFUD_READ,
-    SFUD_ERASE_WRITE,
-    SFUD_WRITE,
-} E_MODE;
+    evMSC_JOB_READ,
+    evMSC_JOB_COMMIT,
+} E_MSC_JOB;
+
+typedef struct
+{
+    E_MSC_JOB eJob;
+    uint32_t u32Addr;
+    uint32_t u32Len;
+    uint32_t u32Idx;
+} S_MSC_JOB;
+
+typedef struct
+{
+    uint8_t *pu8Buf;
+    uint32_t u32Block;      // Cache block index, MSC_CACHE_NONE if empty
+    uint32_t u32DirtyMask;  // One bit per sector
+    SemaphoreHandle_t xIdle; // Held by MSC thread or by a pending commit
+} S_MSC_WCACHE;
+
+typedef struct
+{
+    uint8_t *pu8Buf;
+    uint32_t u32Addr;
+    uint32_t u32Len;
+    int bValid;
+    int bPending;
+    int bStale;             // Overlaps a block committed by worker since it was queued
+    int iResult;
+    SemaphoreHandle_t xDone;
+} S_MSC_RCACHE;
+
+static uint8_t s_au8CacheBuf[MSC_CACHE_NUM + 1][CONFIG_MSC_CACHE_BLOCK_SIZE] __attribute__((aligned(4)));
+
+static S_MSC_WCACHE s_asWCache[MSC_CACHE_NUM];
+static S_MSC_RCACHE s_sRCache;
+static uint32_t s_u32WActive = 0;
+static volatile int s_iWriteResult = 0;
+
+static QueueHandle_t s_xJobQueue = NULL;
+static SemaphoreHandle_t s_xLock = NULL;
 
 static uint32_t s_u32BlkCnt = 0;
 static uint32_t s_u32BlkSize = 0;
 
-static sfud_err sfud_transfer(E_MODE mode, uint8_t *pu8Buf, uint32_t sector, uint32_t u32Size)
+static int msc_range_overlap(uint32_t u32Addr1, uint32_t u32Len1, uint32_t u32Addr2, uint32_t u32Len2)
 {
-    sfud_err result;
-    sfud_flash *flash = sfud_get_device(SFUD_W25_DEVICE_INDEX);
-    uint32_t u32Addr = sector * s_u32BlkSize;
+    return (u32Addr1 < (u32Addr2 + u32Len2)) && (u32Addr2 < (u32Addr1 + u32Len1));
+}
+
+static void msc_rcache_wait(void)
+{
+    if (s_sRCache.bPending)
+    {
+        while (xSemaphoreTake(s_sRCache.xDone, portMAX_DELAY) != pdTRUE);
+        s_sRCache.bPending = 0;
+        s_sRCache.bValid = (s_sRCache.iResult == 0) && !s_sRCache.bStale;
+    }
+}
+
+/* Read-ahead data fetched before a block is committed is stale. */
+static void msc_rcache_drop(uint32_t u32Block)
+{
+    msc_rcache_wait();
+
+    if (s_sRCache.bValid && msc_range_overlap(s_sRCache.u32Addr, s_sRCache.u32Len, u32Block * CONFIG_MSC_CACHE_BLOCK_SIZE, CONFIG_MSC_CACHE_BLOCK_SIZE))
+        s_sRCache.bValid = 0;
+}
+
+/*
+ * Worker side of msc_rcache_drop(). A read-ahead may be queued behind the
+ * worker itself, so it is not waited for. Whether it runs before or after
+ * the commit, it is marked stale and the MSC thread fetches it again.
+ */
+static void msc_rcache_mark_stale(uint32_t u32Block)
+{
+    if ((s_sRCache.bPending || s_sRCache.bValid) && msc_range_overlap(s_sRCache.u32Addr, s_sRCache.u32Len, u32Block * CONFIG_MSC_CACHE_BLOCK_SIZE, CONFIG_MSC_CACHE_BLOCK_SIZE))
+    {
+        s_sRCache.bStale = 1;
+        s_sRCache.bValid = 0;
+    }
+}
 
-    // printf("%s Mode: %d, StartSecAddr: %d, Size: %d\n", __func__, mode, u32Addr, u32Size);
-    if (mode == SFUD_READ)
+static void msc_cache_commit_now(S_MSC_WCACHE *psCache)
+{
+    uint32_t i, j;
+
+    /* Runs of dirty sectors only, the rest of the block is untouched on flash. */
+    for (i = 0; i < MSC_CACHE_SECTORS; i = j)
     {
-        result = sfud_read(flash, u32Addr, u32Size, (uint8_t *)pu8Buf);
+        if (!(psCache->u32DirtyMask & (1u << i)))
+        {
+            j = i + 1;
+            continue;
+        }
+
+        for (j = i + 1; (j < MSC_CACHE_SECTORS) && (psCache->u32DirtyMask & (1u << j)); j++);
+
+        if (ftl_sfud_write(psCache->u32Block * MSC_CACHE_SECTORS + i, psCache->pu8Buf + i * MSC_SECTOR_SIZE, j - i) != 0)
+        {
+            printf("[msc] commit sector %d+%d failed\n", psCache->u32Block * MSC_CACHE_SECTORS + i, j - i);
+            s_iWriteResult = -1;
+        }
     }
-    else if (mode == SFUD_ERASE_WRITE)
+
+    psCache->u32DirtyMask = 0;
+}
+
+static void msc_worker(void *pvParameters)
+{
+    S_MSC_JOB sJob;
+
+    for (;;)
     {
-        result = sfud_erase_write(flash, u32Addr, u32Size, (uint8_t *)pu8Buf);
+        if (xQueueReceive(s_xJobQueue, &sJob, pdMS_TO_TICKS(CONFIG_MSC_CACHE_IDLE_MS)) != pdTRUE)
+        {
+            /* Host is quiet, commit the block being collected if MSC thread is not in the middle of a request. */
+            if (xSemaphoreTake(s_xLock, 0) == pdTRUE)
+            {
+                if (s_asWCache[s_u32WActive].u32DirtyMask)
+                {
+                    msc_rcache_mark_stale(s_asWCache[s_u32WActive].u32Block);
+                    msc_cache_commit_now(&s_asWCache[s_u32WActive]);
+                }
+
+                xSemaphoreGive(s_xLock);
+            }
+            continue;
+        }
+
+        if (sJob.eJob == evMSC_JOB_READ)
+        {
+            s_sRCache.iResult = ftl_sfud_read(sJob.u32Addr / MSC_SECTOR_SIZE, s_sRCache.pu8Buf, sJob.u32Len / MSC_SECTOR_SIZE);
+            xSemaphoreGive(s_sRCache.xDone);
+        }
+        else
+        {
+            msc_cache_commit_now(&s_asWCache[sJob.u32Idx]);
+            xSemaphoreGive(s_asWCache[sJob.u32Idx].xIdle);
+        }
     }
-    else if (mode == SFUD_WRITE)
+}
+
+static void msc_job_submit(E_MSC_JOB eJob, uint32_t u32Addr, uint32_t u32Len, uint32_t u32Idx)
+{
+    S_MSC_JOB sJob = { eJob, u32Addr, u32Len, u32Idx };
+
+    while (xQueueSend(s_xJobQueue, &sJob, portMAX_DELAY) != pdTRUE);
+}
+
+static void msc_rcache_fetch(uint32_t u32Addr, uint32_t u32Len)
+{
+    msc_rcache_wait();
+
+    s_sRCache.u32Addr = u32Addr;
+    s_sRCache.u32Len = u32Len;
+    s_sRCache.bValid = 0;
+    s_sRCache.bStale = 0;
+    s_sRCache.bPending = 1;
+
+    msc_job_submit(evMSC_JOB_READ, u32Addr, u32Len, 0);
+}
+
+/* Hand the active write cache to worker and take the other one. */
+static void msc_cache_rotate(void)
+{
+    S_MSC_WCACHE *psCache = &s_asWCache[s_u32WActive];
+
+    if (psCache->u32DirtyMask)
     {
-        result = sfud_write(flash, u32Addr, u32Size, (uint8_t *)pu8Buf);
+        msc_rcache_drop(psCache->u32Block);
+        msc_job_submit(evMSC_JOB_COMMIT, 0, 0, s_u32WActive);
+        s_u32WActive = (s_u32WActive + 1) % MSC_CACHE_NUM;
+
+        /* Wait for the previous commit of this buffer. */
+        while (xSemaphoreTake(s_asWCache[s_u32WActive].xIdle, portMAX_DELAY) != pdTRUE);
     }
 
-    return result;
+    s_asWCache[s_u32WActive].u32Block = MSC_CACHE_NONE;
 }
 
 void usbd_msc_get_cap(uint8_t busid, uint8_t lun, uint32_t *block_num, uint32_t *block_size)
 {
-    *block_num = (s_u32BlkCnt < 1000) ? 1000 : s_u32BlkCnt; //Pretend having so many buffer,not has actually.
+    *block_num = s_u32BlkCnt;
     *block_size = s_u32BlkSize;
 }
 
 int usbd_msc_sector_read(uint8_t busid, uint8_t lun, uint32_t sector, uint8_t *buffer, uint32_t length)
 {
-    if (sector < s_u32BlkCnt)
-        sfud_transfer(SFUD_READ, buffer, sector, length);
-    return 0;
+    uint32_t u32Addr = sector * s_u32BlkSize;
+    uint32_t u32Capacity = s_u32BlkCnt * s_u32BlkSize;
+    S_MSC_WCACHE *psCache = &s_asWCache[s_u32WActive];
+    int ret = -1;
+
+    if ((sector >= s_u32BlkCnt) || ((u32Addr + length) > u32Capacity) || (length > CONFIG_MSC_CACHE_BLOCK_SIZE))
+        return -1;
+
+    xSemaphoreTake(s_xLock, portMAX_DELAY);
+
+    /* Reads are queued behind commits, so a dirty block only needs to be handed over. */
+    if (psCache->u32DirtyMask && msc_range_overlap(u32Addr, length, psCache->u32Block * CONFIG_MSC_CACHE_BLOCK_SIZE, CONFIG_MSC_CACHE_BLOCK_SIZE))
+        msc_cache_rotate();
+
+    if (!(s_sRCache.bPending || s_sRCache.bValid) || (s_sRCache.u32Addr != u32Addr) || (s_sRCache.u32Len != length))
+    {
+        /* Missed, not sequential. */
+        msc_rcache_fetch(u32Addr, length);
+    }
+
+    msc_rcache_wait();
+
+    /* Committed by worker while in flight, fetch again behind the commit. */
+    if (s_sRCache.bStale)
+    {
+        msc_rcache_fetch(u32Addr, length);
+        msc_rcache_wait();
+    }
+
+    if (s_sRCache.bValid)
+    {
+        memcpy(buffer, s_sRCache.pu8Buf, length);
+        ret = 0;
+
+        /* Read ahead the next request while this one goes to host. */
+        if ((u32Addr + (2 * length)) <= u32Capacity)
+            msc_rcache_fetch(u32Addr + length, length);
+    }
+
+    xSemaphoreGive(s_xLock);
+
+    return ret;
 }
 
 int usbd_msc_sector_write(uint8_t busid, uint8_t lun, uint32_t sector, uint8_t *buffer, uint32_t length)
 {
-    if (sector < s_u32BlkCnt)
-        sfud_transfer(SFUD_ERASE_WRITE, buffer, sector, length);
-    return 0;
+    uint32_t u32Addr = sector * s_u32BlkSize;
+    uint32_t u32Capacity = s_u32BlkCnt * s_u32BlkSize;
+    int ret = 0;
+
+    if ((sector >= s_u32BlkCnt) || ((u32Addr + length) > u32Capacity) || (length % s_u32BlkSize))
+        return -1;
+
+    xSemaphoreTake(s_xLock, portMAX_DELAY);
+
+    /* Drop read-ahead data going stale. */
+    msc_rcache_wait();
+    if (s_sRCache.bValid && msc_range_overlap(u32Addr, length, s_sRCache.u32Addr, s_sRCache.u32Len))
+        s_sRCache.bValid = 0;
+
+    while (length > 0)
+    {
+        uint32_t u32Block = u32Addr / CONFIG_MSC_CACHE_BLOCK_SIZE;
+        uint32_t u32Offset = u32Addr % CONFIG_MSC_CACHE_BLOCK_SIZE;
+        uint32_t u32Len = CONFIG_MSC_CACHE_BLOCK_SIZE - u32Offset;
+        S_MSC_WCACHE *psCache;
+
+        if (u32Len > length)
+            u32Len = length;
+
+        /* No merge with flash contents, only written sectors are committed. */
+        if (s_asWCache[s_u32WActive].u32Block != u32Block)
+        {
+            msc_cache_rotate();
+            s_asWCache[s_u32WActive].u32Block = u32Block;
+        }
+
+        psCache = &s_asWCache[s_u32WActive];
+        memcpy(psCache->pu8Buf + u32Offset, buffer, u32Len);
+        psCache->u32DirtyMask |= ((1u << (u32Len / MSC_SECTOR_SIZE)) - 1) << (u32Offset / MSC_SECTOR_SIZE);
+
+        buffer += u32Len;
+        u32Addr += u32Len;
+        length -= u32Len;
+    }
+
+    /* Report a failed commit of earlier data once. */
+    if (s_iWriteResult != 0)
+    {
+        s_iWriteResult = 0;
+        ret = -1;
+    }
+
+    xSemaphoreGive(s_xLock);
+
+    return ret;
+}
+
+static void msc_cache_init(void)
+{
+    int i;
+
+    for (i = 0; i < MSC_CACHE_NUM; i++)
+    {
+        s_asWCache[i].pu8Buf = &s_au8CacheBuf[i][0];
+        s_asWCache[i].u32Block = MSC_CACHE_NONE;
+        s_asWCache[i].u32DirtyMask = 0;
+        s_asWCache[i].xIdle = xSemaphoreCreateBinary();
+        LV_ASSERT(s_asWCache[i].xIdle != NULL);
+        xSemaphoreGive(s_asWCache[i].xIdle);
+    }
+
+    /* MSC thread owns the active buffer. */
+    s_u32WActive = 0;
+    xSemaphoreTake(s_asWCache[s_u32WActive].xIdle, portMAX_DELAY);
+
+    s_sRCache.pu8Buf = &s_au8CacheBuf[MSC_CACHE_NUM][0];
+    s_sRCache.xDone = xSemaphoreCreateBinary();
+    LV_ASSERT(s_sRCache.xDone != NULL);
+
+    s_xLock = xSemaphoreCreateMutex();
+    LV_ASSERT(s_xLock != NULL);
+
+    s_xJobQueue = xQueueCreate(MSC_CACHE_NUM + 1, sizeof(S_MSC_JOB));
+    LV_ASSERT(s_xJobQueue != NULL);
+
+    LV_ASSERT(xTaskCreate(msc_worker, "msc_flash", CONFIG_MSC_WORKER_STACKSIZE, NULL, CONFIG_MSC_WORKER_PRIORITY, NULL) == pdPASS);
 }
 
 static struct usbd_interface intf0;
 void msc_sfud_init(uint8_t busid, uint32_t reg_base)
 {
-    s_u32BlkSize = sfud_get_device(SFUD_W25_DEVICE_INDEX)->chip.erase_gran;
-    s_u32BlkCnt = sfud_get_device(SFUD_W25_DEVICE_INDEX)->chip.capacity / s_u32BlkSize;
+    /* Mounted by FatFs already in most cases. */
+    LV_ASSERT(ftl_sfud_init() == 0);
+
+    s_u32BlkSize = MSC_SECTOR_SIZE;
+    s_u32BlkCnt = ftl_sfud_sector_count();
+
+    LV_ASSERT(MSC_CACHE_SECTORS <= 32);
+    LV_ASSERT(CONFIG_USBDEV_MSC_MAX_BUFSIZE <= CONFIG_MSC_CACHE_BLOCK_SIZE);
+
+    msc_cache_init();
 
     usbd_desc_register(busid, msc_ram_descriptor);
     usbd_add_interface(busid, usbd_msc_init_intf(busid, &intf0, MSC_OUT_EP, MSC_IN_EP));
@@ -28,12 +28,46 @@
 
 #include <sfud.h>
 #include <stdarg.h>
+#include <string.h>
 #include "drv_spi.h"
 #include "sfud_cfg.h"
 
 static char log_buf[256];
 
+#if defined(CONFIG_SPI_USE_PDMA)
+struct nu_sfud_spi_pdma
+{
+    SPI_T   *base;
+    int16_t  pdma_perp_tx;
+    int16_t  pdma_perp_rx;
+};
+
+static const struct nu_sfud_spi_pdma s_asSfudSpiPdma[] =
+{
+    { (SPI_T *)QSPI0, PDMA_QSPI0_TX, PDMA_QSPI0_RX },
+    { SPI0,           PDMA_SPI0_TX,  PDMA_SPI0_RX  },
+    { SPI1,           PDMA_SPI1_TX,  PDMA_SPI1_RX  },
+    { SPI2,           PDMA_SPI2_TX,  PDMA_SPI2_RX  },
+    { SPI3,           PDMA_SPI3_TX,  PDMA_SPI3_RX  },
+};
+#endif
+
+static struct nu_spi s_NuSPI_Flash =
+{
+    .base           = NULL,
+    .ss_pin         = -1,
+#if defined(CONFIG_SPI_USE_PDMA)
+    .pdma_perp_tx   = -1,
+    .pdma_chanid_tx = -1,
+    .pdma_perp_rx   = -1,
+    .pdma_chanid_rx = -1,
+    .m_psSemBus     = 0,
+    .m_psSemDone    = NULL,
+#endif
+};
+
 void sfud_log_debug(const char *file, const long line, const char *format, ...);
+void sfud_log_info(const char *format, ...);
 
 static void spi_lock(const sfud_spi *spi)
 {
@@ -126,8 +160,22 @@ static sfud_err spi_write_read(const sfud_spi *spi, const uint8_t *write_buf, si
     SPI_T *nu_spi = (SPI_T *)spi->user_data;
 
     //printf("[%s] %x tx:%x,%d rx:%x,%d \n", __func__, nu_spi, write_buf, write_size, read_buf, read_size);
-    if (nu_spi_send_then_recv(nu_spi, (const void *)write_buf, write_size, read_buf, read_size, 1) != 0)
-        result = SFUD_ERR_WRITE;
+#if defined(CONFIG_SPI_USE_PDMA)
+    /* PDMA completion is interrupt-driven, and the kernel keeps interrupts masked
+       after its first critical section until the scheduler is started. */
+    if ((s_NuSPI_Flash.base == nu_spi) &&
+            (xTaskGetSchedulerState() != taskSCHEDULER_NOT_STARTED))
+    {
+        if (s_NuSPI_Flash.m_psSemDone == NULL)
+            s_NuSPI_Flash.m_psSemDone = xSemaphoreCreateBinary();
+
+        if (nu_spi_send_then_recv_pdma(&s_NuSPI_Flash, write_buf, write_size, read_buf, read_size) != 0)
+            result = SFUD_ERR_WRITE;
+    }
+    else
+#endif
+        if (nu_spi_send_then_recv(nu_spi, (const void *)write_buf, write_size, read_buf, read_size, 1) != 0)
+            result = SFUD_ERR_WRITE;
 
     return result;
 }
@@ -140,6 +188,51 @@ static void retry_delay_100us(void)
 }
 
 #ifdef SFUD_USING_QSPI
+
+#define SFUD_SFDP_CMD_READ              0x5A
+#define SFUD_SFDP_SIGNATURE             0x50444653UL    /* "SFDP" */
+#define SFUD_SFDP_BFPT_MAX_DWORDS       15
+
+/* JESD216 Basic Flash Parameter Table, 1st DWORD. */
+#define SFUD_BFPT_DW1_FAST_READ_112     (1UL << 16)
+#define SFUD_BFPT_DW1_FAST_READ_122     (1UL << 20)
+#define SFUD_BFPT_DW1_FAST_READ_144     (1UL << 21)
+#define SFUD_BFPT_DW1_FAST_READ_114     (1UL << 22)
+
+/* A fast-read field in DWORD3/DWORD4 is: dummy[4:0], mode[7:5], instruction[15:8]. */
+#define SFUD_BFPT_FR_INS(field)         (((field) >> 8) & 0xFF)
+#define SFUD_BFPT_FR_CYCLES(field)      (((field) & 0x1F) + (((field) >> 5) & 0x7))
+
+#define SFUD_CMD_READ_STATUS_REGISTER2  0x35
+#define SFUD_CMD_WRITE_STATUS_REGISTER2 0x31
+
+static void nu_qspi_lines_set(QSPI_T *qspi, uint8_t u8Lines, int bIsOutput)
+{
+    switch (u8Lines)
+    {
+    case 2:
+        QSPI_DISABLE_QUAD_MODE(qspi);
+        if (bIsOutput)
+            QSPI_ENABLE_DUAL_OUTPUT_MODE(qspi);
+        else
+            QSPI_ENABLE_DUAL_INPUT_MODE(qspi);
+        break;
+
+    case 4:
+        QSPI_DISABLE_DUAL_MODE(qspi);
+        if (bIsOutput)
+            QSPI_ENABLE_QUAD_OUTPUT_MODE(qspi);
+        else
+            QSPI_ENABLE_QUAD_INPUT_MODE(qspi);
+        break;
+
+    default:
+        QSPI_DISABLE_DUAL_MODE(qspi);
+        QSPI_DISABLE_QUAD_MODE(qspi);
+        break;
+    }
+}
+
 /**
  * read flash data by QSPI
  */
@@ -147,10 +240,263 @@ static sfud_err qspi_read(const struct __sfud_spi *spi, uint32_t addr, sfud_qspi
                           uint8_t *read_buf, size_t read_size)
 {
     sfud_err result = SFUD_SUCCESS;
+    QSPI_T *qspi = (QSPI_T *)spi->user_data;
+    struct nu_spi *psNuSPI = &s_NuSPI_Flash;
+    uint8_t au8Frame[4 + 8];
+    int i32AddrBytes = qspi_read_cmd_format->address_size / 8;
+    int i32DummyBytes = (qspi_read_cmd_format->dummy_cycles * qspi_read_cmd_format->address_lines) / 8;
+    int i;
 
-    /**
-     * add your qspi read flash data code
-     */
+    if ((psNuSPI->base != (SPI_T *)qspi) || (i32AddrBytes > 4) || (i32DummyBytes > 8))
+    {
+        result = SFUD_ERR_READ;
+        goto exit_qspi_read;
+    }
+
+    for (i = 0; i < i32AddrBytes; i++)
+    {
+        au8Frame[i] = (uint8_t)(addr >> ((i32AddrBytes - 1 - i) * 8));
+    }
+
+    /* Dummy cycles run on the address lines. 0xFF keeps the flash out of continuous read mode. */
+    memset(&au8Frame[i32AddrBytes], 0xFF, i32DummyBytes);
+
+    nu_spi_ss_set(psNuSPI, 0);
+
+    nu_qspi_lines_set(qspi, qspi_read_cmd_format->instruction_lines, 1);
+    nu_spi_xfer(psNuSPI, &qspi_read_cmd_format->instruction, NULL, 1);
+
+    nu_qspi_lines_set(qspi, qspi_read_cmd_format->address_lines, 1);
+    nu_spi_xfer(psNuSPI, au8Frame, NULL, i32AddrBytes + i32DummyBytes);
+
+    nu_qspi_lines_set(qspi, qspi_read_cmd_format->data_lines, 0);
+#if defined(CONFIG_SPI_USE_PDMA)
+    if (xTaskGetSchedulerState() != taskSCHEDULER_NOT_STARTED)
+    {
+        if (psNuSPI->m_psSemDone == NULL)
+            psNuSPI->m_psSemDone = xSemaphoreCreateBinary();
+
+        /* Data phase, PDMA receive once it is over the threshold. */
+        nu_spi_xfer(psNuSPI, NULL, read_buf, read_size);
+    }
+    else
+    {
+        /* No PDMA completion interrupt yet, keep every piece under the threshold. */
+        while (read_size > 0)
+        {
+            size_t len = (read_size < (CONFIG_SPI_USE_PDMA_MIN_THRESHOLD - 1)) ? read_size : (CONFIG_SPI_USE_PDMA_MIN_THRESHOLD - 1);
+
+            nu_spi_xfer(psNuSPI, NULL, read_buf, len);
+            read_buf += len;
+            read_size -= len;
+        }
+    }
+#else
+    nu_spi_xfer(psNuSPI, NULL, read_buf, read_size);
+#endif
+
+    nu_qspi_lines_set(qspi, 1, 1);
+
+    nu_spi_ss_set(psNuSPI, 1);
+
+exit_qspi_read:
+
+    return result;
+}
+
+static sfud_err nu_sfud_sfdp_read(const sfud_flash *flash, uint32_t addr, uint8_t *buf, size_t len)
+{
+    uint8_t au8Cmd[5] = { SFUD_SFDP_CMD_READ, (uint8_t)(addr >> 16), (uint8_t)(addr >> 8), (uint8_t)addr, 0xFF };
+
+    return flash->spi.wr(&flash->spi, au8Cmd, sizeof(au8Cmd), buf, len);
+}
+
+static sfud_err nu_sfud_reg_read(const sfud_flash *flash, uint8_t u8Cmd, uint8_t *pu8Value)
+{
+    return flash->spi.wr(&flash->spi, &u8Cmd, 1, pu8Value, 1);
+}
+
+static sfud_err nu_sfud_reg_write(const sfud_flash *flash, const uint8_t *pu8Cmd, size_t len)
+{
+    sfud_err result;
+    uint8_t u8Cmd = SFUD_CMD_WRITE_ENABLE;
+    uint8_t u8Status;
+    size_t retry = flash->retry.times;
+
+    if ((result = flash->spi.wr(&flash->spi, &u8Cmd, 1, NULL, 0)) != SFUD_SUCCESS)
+        return result;
+
+    if ((result = flash->spi.wr(&flash->spi, pu8Cmd, len, NULL, 0)) != SFUD_SUCCESS)
+        return result;
+
+    /* Wait for the non-volatile status write. */
+    do
+    {
+        if ((result = nu_sfud_reg_read(flash, SFUD_CMD_READ_STATUS_REGISTER, &u8Status)) != SFUD_SUCCESS)
+            return result;
+
+        if (!(u8Status & SFUD_STATUS_REGISTER_BUSY))
+            return SFUD_SUCCESS;
+
+        if (flash->retry.delay)
+            flash->retry.delay();
+    }
+    while (retry--);
+
+    return SFUD_ERR_TIMEOUT;
+}
+
+/* Set the Quad Enable bit as described by BFPT DWORD15[22:20]. */
+static sfud_err nu_sfud_quad_enable(const sfud_flash *flash, uint32_t u32QER)
+{
+    sfud_err result = SFUD_SUCCESS;
+    uint8_t u8Sr1 = 0, u8Sr2 = 0;
+    uint8_t au8Cmd[3];
+
+    switch (u32QER)
+    {
+    case 0: /* No QE bit, IO2/IO3 are always data lines. */
+        break;
+
+    case 1:
+    case 4:
+    case 5: /* QE is SR2[1], written together with SR1 by 01h. */
+        if (((result = nu_sfud_reg_read(flash, SFUD_CMD_READ_STATUS_REGISTER, &u8Sr1)) != SFUD_SUCCESS) ||
+                ((result = nu_sfud_reg_read(flash, SFUD_CMD_READ_STATUS_REGISTER2, &u8Sr2)) != SFUD_SUCCESS))
+            break;
+        if (u8Sr2 & 0x02)
+            break;
+        au8Cmd[0] = SFUD_CMD_WRITE_STATUS_REGISTER;
+        au8Cmd[1] = u8Sr1;
+        au8Cmd[2] = u8Sr2 | 0x02;
+        if ((result = nu_sfud_reg_write(flash, au8Cmd, 3)) == SFUD_SUCCESS)
+            result = nu_sfud_reg_read(flash, SFUD_CMD_READ_STATUS_REGISTER2, &u8Sr2);
+        if ((result == SFUD_SUCCESS) && !(u8Sr2 & 0x02))
+            result = SFUD_ERR_WRITE;
+        break;
+
+    case 6: /* QE is SR2[1], written alone by 31h. */
+        if ((result = nu_sfud_reg_read(flash, SFUD_CMD_READ_STATUS_REGISTER2, &u8Sr2)) != SFUD_SUCCESS)
+            break;
+        if (u8Sr2 & 0x02)
+            break;
+        au8Cmd[0] = SFUD_CMD_WRITE_STATUS_REGISTER2;
+        au8Cmd[1] = u8Sr2 | 0x02;
+        if ((result = nu_sfud_reg_write(flash, au8Cmd, 2)) == SFUD_SUCCESS)
+            result = nu_sfud_reg_read(flash, SFUD_CMD_READ_STATUS_REGISTER2, &u8Sr2);
+        if ((result == SFUD_SUCCESS) && !(u8Sr2 & 0x02))
+            result = SFUD_ERR_WRITE;
+        break;
+
+    case 2: /* QE is SR1[6]. */
+        if ((result = nu_sfud_reg_read(flash, SFUD_CMD_READ_STATUS_REGISTER, &u8Sr1)) != SFUD_SUCCESS)
+            break;
+        if (u8Sr1 & 0x40)
+            break;
+        au8Cmd[0] = SFUD_CMD_WRITE_STATUS_REGISTER;
+        au8Cmd[1] = u8Sr1 | 0x40;
+        if ((result = nu_sfud_reg_write(flash, au8Cmd, 2)) == SFUD_SUCCESS)
+            result = nu_sfud_reg_read(flash, SFUD_CMD_READ_STATUS_REGISTER, &u8Sr1);
+        if ((result == SFUD_SUCCESS) && !(u8Sr1 & 0x40))
+            result = SFUD_ERR_WRITE;
+        break;
+
+    default:
+        result = SFUD_ERR_NOT_FOUND;
+        break;
+    }
+
+    return result;
+}
+
+/**
+ * Select the widest fast read command the flash advertises in its SFDP Basic
+ * Flash Parameter Table, up to data_line_width lines, and route sfud_read()
+ * through qspi_read(). Single-line read is kept if nothing better is found.
+ */
+sfud_err nu_sfud_qspi_fast_read_enable(sfud_flash *flash, uint8_t data_line_width)
+{
+    sfud_err result;
+    uint8_t au8Buf[SFUD_SFDP_BFPT_MAX_DWORDS * 4];
+    uint32_t au32Bfpt[SFUD_SFDP_BFPT_MAX_DWORDS] = { 0 };
+    uint32_t u32Ptr, u32Dwords, i;
+    sfud_qspi_read_cmd_format sFmt = { 0 };
+
+    /* SFDP header and the first (mandatory BFPT) parameter header. */
+    if ((result = nu_sfud_sfdp_read(flash, 0, au8Buf, 16)) != SFUD_SUCCESS)
+        goto exit_nu_sfud_qspi_fast_read_enable;
+
+    if (nu_get32_le(&au8Buf[0]) != SFUD_SFDP_SIGNATURE)
+    {
+        result = SFUD_ERR_NOT_FOUND;
+        goto exit_nu_sfud_qspi_fast_read_enable;
+    }
+
+    u32Dwords = au8Buf[11];
+    u32Ptr    = nu_get24_le(&au8Buf[12]);
+    if (u32Dwords > SFUD_SFDP_BFPT_MAX_DWORDS)
+        u32Dwords = SFUD_SFDP_BFPT_MAX_DWORDS;
+
+    if ((u32Dwords < 4) ||
+            ((result = nu_sfud_sfdp_read(flash, u32Ptr, au8Buf, u32Dwords * 4)) != SFUD_SUCCESS))
+    {
+        result = (result == SFUD_SUCCESS) ? SFUD_ERR_NOT_FOUND : result;
+        goto exit_nu_sfud_qspi_fast_read_enable;
+    }
+
+    for (i = 0; i < u32Dwords; i++)
+    {
+        au32Bfpt[i] = nu_get32_le(&au8Buf[i * 4]);
+    }
+
+    sFmt.instruction = SFUD_CMD_READ_DATA;
+    sFmt.instruction_lines = 1;
+    sFmt.address_size = flash->addr_in_4_byte ? 32 : 24;
+    sFmt.address_lines = 1;
+    sFmt.data_lines = 1;
+
+    /* Quad modes need a known Quad Enable method, JESD216A and later. */
+    if ((data_line_width >= 4) &&
+            (au32Bfpt[0] & (SFUD_BFPT_DW1_FAST_READ_144 | SFUD_BFPT_DW1_FAST_READ_114)) &&
+            (u32Dwords >= 15) &&
+            (nu_sfud_quad_enable(flash, (au32Bfpt[14] >> 20) & 0x7) == SFUD_SUCCESS))
+    {
+        if (au32Bfpt[0] & SFUD_BFPT_DW1_FAST_READ_144)
+        {
+            sFmt.instruction   = SFUD_BFPT_FR_INS(au32Bfpt[2]);
+            sFmt.dummy_cycles  = SFUD_BFPT_FR_CYCLES(au32Bfpt[2]);
+            sFmt.address_lines = 4;
+        }
+        else
+        {
+            sFmt.instruction   = SFUD_BFPT_FR_INS(au32Bfpt[2] >> 16);
+            sFmt.dummy_cycles  = SFUD_BFPT_FR_CYCLES(au32Bfpt[2] >> 16);
+        }
+        sFmt.data_lines = 4;
+    }
+    else if (data_line_width >= 2)
+    {
+        if (au32Bfpt[0] & SFUD_BFPT_DW1_FAST_READ_122)
+        {
+            sFmt.instruction   = SFUD_BFPT_FR_INS(au32Bfpt[3] >> 16);
+            sFmt.dummy_cycles  = SFUD_BFPT_FR_CYCLES(au32Bfpt[3] >> 16);
+            sFmt.address_lines = 2;
+            sFmt.data_lines    = 2;
+        }
+        else if (au32Bfpt[0] & SFUD_BFPT_DW1_FAST_READ_112)
+        {
+            sFmt.instruction   = SFUD_BFPT_FR_INS(au32Bfpt[3]);
+            sFmt.dummy_cycles  = SFUD_BFPT_FR_CYCLES(au32Bfpt[3]);
+            sFmt.data_lines    = 2;
+        }
+    }
+
+    flash->read_cmd_format = sFmt;
+
+    sfud_log_info("Fast read: %02Xh %d-%d-%d, %d dummy cycles.", sFmt.instruction,
+                  sFmt.instruction_lines, sFmt.address_lines, sFmt.data_lines, sFmt.dummy_cycles);
+
+exit_nu_sfud_qspi_fast_read_enable:
 
     return result;
 }
@@ -197,6 +543,25 @@ sfud_err sfud_spi_port_init(sfud_flash *flash)
     /* Set sequence to MSB first */
     SPI_SET_MSB_FIRST(spi);
 
+    s_NuSPI_Flash.base = spi;
+
+#if defined(CONFIG_SPI_USE_PDMA)
+    {
+        int i;
+
+        for (i = 0; i < sizeof(s_asSfudSpiPdma) / sizeof(s_asSfudSpiPdma[0]); i++)
+        {
+            if (s_asSfudSpiPdma[i].base == spi)
+            {
+                /* Reads above CONFIG_SPI_USE_PDMA_MIN_THRESHOLD go through PDMA. */
+                s_NuSPI_Flash.pdma_perp_tx = s_asSfudSpiPdma[i].pdma_perp_tx;
+                s_NuSPI_Flash.pdma_perp_rx = s_asSfudSpiPdma[i].pdma_perp_rx;
+                break;
+            }
+        }
+    }
+#endif
+
     /* set the interfaces and data */
     flash->spi.wr = spi_write_read;
 #ifdef SFUD_USING_QSPI
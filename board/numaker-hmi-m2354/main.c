@@ -9,6 +9,7 @@
 #include "lv_glue.h"
 #include "ff.h"
 #include "diskio.h"
+#include "sfud_cfg.h"
 
 static void sys_init(void)
 {
@@ -57,6 +58,16 @@ static void sys_init(void)
     /* Enable digital path on these EADC pins */
     GPIO_ENABLE_DIGITAL_PATH(PB, BIT6 | BIT7 | BIT8 | BIT9 | BIT10 | BIT11);
 
+#if defined(SFUD_USING_QSPI)
+    /* Enable QSPI0 module clock */
+    CLK_EnableModuleClock(QSPI0_MODULE);
+    CLK_SetModuleClock(QSPI0_MODULE, CLK_CLKSEL2_QSPI0SEL_PCLK0, MODULE_NoMsk);
+    SYS_ResetModule(QSPI0_RST);
+    SYS->GPA_MFPL &= ~(SYS_GPA_MFPL_PA0MFP_Msk | SYS_GPA_MFPL_PA1MFP_Msk | SYS_GPA_MFPL_PA2MFP_Msk | SYS_GPA_MFPL_PA3MFP_Msk | SYS_GPA_MFPL_PA4MFP_Msk | SYS_GPA_MFPL_PA5MFP_Msk);
+    SYS->GPA_MFPL |= (SYS_GPA_MFPL_PA0MFP_QSPI0_MOSI0 | SYS_GPA_MFPL_PA1MFP_QSPI0_MISO0 | SYS_GPA_MFPL_PA2MFP_QSPI0_CLK | SYS_GPA_MFPL_PA3MFP_QSPI0_SS |
+                      SYS_GPA_MFPL_PA4MFP_QSPI0_MOSI1 | SYS_GPA_MFPL_PA5MFP_QSPI0_MISO1);
+    GPIO_SetSlewCtl(PA, BIT0 | BIT1 | BIT3 | BIT4 | BIT5, GPIO_SLEWCTL_HIGH);
+#else
     /* Enable SPI0 module clock */
     CLK_EnableModuleClock(SPI0_MODULE);
     CLK_SetModuleClock(SPI0_MODULE, CLK_CLKSEL2_SPI0SEL_PCLK1, MODULE_NoMsk);
@@ -64,6 +75,7 @@ static void sys_init(void)
     SYS->GPA_MFPL &= ~(SYS_GPA_MFPL_PA0MFP_Msk | SYS_GPA_MFPL_PA1MFP_Msk | SYS_GPA_MFPL_PA2MFP_Msk | SYS_GPA_MFPL_PA3MFP_Msk);
     SYS->GPA_MFPL |= (SYS_GPA_MFPL_PA0MFP_SPI0_MOSI | SYS_GPA_MFPL_PA1MFP_SPI0_MISO | SYS_GPA_MFPL_PA2MFP_SPI0_CLK | SYS_GPA_MFPL_PA3MFP_SPI0_SS);
     GPIO_SetSlewCtl(PA, BIT0 | BIT1 | BIT3, GPIO_SLEWCTL_HIGH);
+#endif
 
     /* Pull-up MISO1 & MOSI1 pins */
     SYS->GPC_MFPH &= ~(SYS_GPC_MFPH_PC9MFP_Msk | SYS_GPC_MFPH_PC10MFP_Msk);
@@ -34,6 +34,8 @@
 //#define SFUD_DEBUG_MODE
 #define SFUD_USING_SFDP
 
+/* Dual/quad fast read on QSPI0(PA0~PA5). The command is chosen from the SFDP
+   table of the flash. It needs IO2/IO3 of the flash wired to PA4/PA5. */
 //#define SFUD_USING_QSPI
 
 
@@ -42,9 +44,15 @@ enum
     SFUD_W25_DEVICE_INDEX = 0,
 };
 
+#if defined(SFUD_USING_QSPI)
+    #define SFUD_FLASH_SPI_PORT     QSPI0
+#else
+    #define SFUD_FLASH_SPI_PORT     SPI0
+#endif
+
 #define SFUD_FLASH_DEVICE_TABLE                                                \
 {                                                                              \
-    [SFUD_W25_DEVICE_INDEX] = {.name = "W25X16AV", .spi.user_data = (void *)SPI0 },       \
+    [SFUD_W25_DEVICE_INDEX] = {.name = "W25X16AV", .spi.user_data = (void *)SFUD_FLASH_SPI_PORT },       \
 }
 
 #endif /* _SFUD_CFG_H_ */
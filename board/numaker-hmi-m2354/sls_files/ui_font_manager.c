@@ -0,0 +1,92 @@
+#include <string.h>
+#include "ui.h"
+#include "ui_font_manager.h"
+#include "nu_asset_pack.h"
+#include "nu_font_stream.h"
+
+/* The same pack as ui_img_manager.c, drive '0' is FatFs volume 0. */
+#define UI_ASSET_PACK_PATH  "0:assets.pak"
+
+#define UI_FONT_MAX     4
+
+static struct
+{
+    const char *fname;
+    const lv_font_t *font;
+} s_asUiFont[UI_FONT_MAX];
+
+/*
+ * Fonts read their glyphs through the pack for as long as they live, so
+ * unlike the images, the file of the pack is kept open.
+ */
+static S_NU_ASSET_PACK *_ui_font_pack(void)
+{
+    static S_NU_ASSET_PACK s_sPack;
+    static int s_i32PackState = 0;   // 0: not opened, 1: opened, -1: no pack
+
+    if (s_i32PackState == 0)
+        s_i32PackState = (nu_asset_pack_open(&s_sPack, UI_ASSET_PACK_PATH) == 0) ? 1 : -1;
+
+    return (s_i32PackState > 0) ? &s_sPack : NULL;
+}
+
+/*
+ * Open a binary font on the SPI-NOR drive in place of a Montserrat size
+ * left out of lv_conf.h. "0:lato16.fnt" is resolved by the ID of
+ * "lato16.fnt" in the asset pack, or read as a loose file if the pack lacks
+ * it. It is opened once and kept for later screens, glyphs are read on
+ * demand through the cache of nu_font_stream. Letters the font lacks come
+ * from fallback, which is also used whole if the font is absent or refused,
+ * e.g. built with kerning or compression.
+ */
+const lv_font_t *_ui_load_font(const char *fname, const lv_font_t *fallback)
+{
+    S_NU_ASSET_PACK *psPack = _ui_font_pack();
+    const char *name = strchr(fname, ':');
+    lv_font_t *font = NULL;
+    int i;
+
+    for (i = 0; (i < UI_FONT_MAX) && (s_asUiFont[i].fname != NULL); i++)
+    {
+        if (strcmp(s_asUiFont[i].fname, fname) == 0)
+            return s_asUiFont[i].font;
+    }
+
+    if (psPack != NULL)
+        font = nu_font_stream_create_packed(psPack, nu_asset_id(name ? name + 1 : fname));
+
+    if (font == NULL)
+        font = nu_font_stream_create(fname);
+
+    if (font != NULL)
+        font->fallback = fallback;
+    else
+        LV_LOG_WARN("%s not loaded, use the fallback font", fname);
+
+    /* A failed one too, so it is not tried again on every screen. */
+    if (i < UI_FONT_MAX)
+    {
+        s_asUiFont[i].fname = fname;
+        s_asUiFont[i].font = font ? font : fallback;
+    }
+
+    return font ? font : fallback;
+}
+
+/*
+ * Caption of ui_Screen1 in the streamed Lato 16. SquareLine Studio does not
+ * know fonts on the drive, so it is added here after ui_init() and is not
+ * lost when the screens are exported again.
+ */
+void ui_font_caption_init(void)
+{
+    lv_obj_t *label = lv_label_create(ui_Screen1);
+
+    lv_obj_set_width(label, LV_SIZE_CONTENT);
+    lv_obj_set_height(label, LV_SIZE_CONTENT);
+    lv_obj_set_x(label, 0);
+    lv_obj_set_y(label, 96);
+    lv_obj_set_align(label, LV_ALIGN_CENTER);
+    lv_label_set_text(label, "Touch to switch screens");
+    lv_obj_set_style_text_font(label, UI_LOAD_FONT("0:lato16.fnt", LV_FONT_DEFAULT), LV_PART_MAIN | LV_STATE_DEFAULT);
+}
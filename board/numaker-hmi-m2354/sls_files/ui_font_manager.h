@@ -0,0 +1,9 @@
+#ifndef _UI_FONT_MANAGER_H
+#define _UI_FONT_MANAGER_H
+
+const lv_font_t *_ui_load_font(const char *fname, const lv_font_t *fallback);
+void ui_font_caption_init(void);
+
+#define UI_LOAD_FONT _ui_load_font
+
+#endif
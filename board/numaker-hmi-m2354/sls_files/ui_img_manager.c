@@ -1,20 +1,139 @@
+#include <string.h>
 #include "ui.h"
+#include "nu_memtag.h"
+#include "nu_asset_pack.h"
+#include "nu_asset_loader.h"
 
-uint8_t *_ui_load_binary(char *fname, const uint32_t size)
+/* LVGL drive '0' is FatFs volume 0, so a path works for lv_fs and the asset loader. */
+#define UI_ASSET_PACK_PATH  "0:assets.pak"
+
+static int _ui_load_file(const char *fname, const uint32_t offset, uint8_t *buf, const uint32_t size)
 {
     lv_fs_file_t f;
     lv_fs_res_t res;
     res = lv_fs_open(&f, fname, LV_FS_MODE_RD);
-    if (res != LV_FS_RES_OK) return NULL; // file not found
-    uint32_t read_num;
-    uint8_t *buf = lv_malloc(sizeof(uint8_t) * size);
-    res = lv_fs_read(&f, buf, size, &read_num);
+    if (res != LV_FS_RES_OK) return -1; // file not found
+    uint32_t read_num = 0;
+    res = lv_fs_seek(&f, offset, LV_FS_SEEK_SET);
+    if (res == LV_FS_RES_OK)
+        res = lv_fs_read(&f, buf, size, &read_num);
+    lv_fs_close(&f);
     if (res != LV_FS_RES_OK || read_num != size)
+        return -1;
+    return 0;
+}
+
+/*
+ * Resolve "0:1.bin" by the ID of "1.bin" in the asset pack, one seek per asset.
+ * The index is read once and kept for later screens, the file is closed
+ * right away as payloads are read by the asset loader with its own handle.
+ */
+static const S_NU_ASSET_ENTRY *_ui_find_packed(char *fname, const uint32_t size)
+{
+    static S_NU_ASSET_PACK s_sPack;
+    static int s_i32PackState = 0;   // 0: not opened, 1: index loaded, -1: no pack
+    const S_NU_ASSET_ENTRY *psEntry;
+    char *name = strchr(fname, ':');
+
+    if (s_i32PackState == 0)
     {
-        lv_free(buf);
+        s_i32PackState = (nu_asset_pack_open(&s_sPack, UI_ASSET_PACK_PATH) == 0) ? 1 : -1;
+        nu_asset_pack_release_file(&s_sPack);
+    }
+
+    if (s_i32PackState < 0)
+        return NULL;
+
+    /* Pixels are read in place, a compressed payload is not of this size anyway. */
+    psEntry = nu_asset_pack_find(&s_sPack, nu_asset_id(name ? name + 1 : fname));
+    if (!psEntry || (psEntry->u8Codec != evNU_ASSET_CODEC_STORED) || (psEntry->u32Size != size))
         return NULL;
+
+    return psEntry;
+}
+
+/* In the loader task, user_data is the pack entry, which stays with the index. */
+static int _ui_load_check(void *buf, uint32_t size, void *user_data)
+{
+    const S_NU_ASSET_ENTRY *psEntry = (const S_NU_ASSET_ENTRY *)user_data;
+
+    return (nu_asset_crc32(0, buf, size) == psEntry->u32Crc) ? 0 : -1;
+}
+
+static void _ui_image_refresh(lv_obj_t *obj, const void *buf)
+{
+    const lv_image_dsc_t *dsc;
+
+    if (!lv_obj_check_type(obj, &lv_image_class))
+        return;
+
+    dsc = lv_image_get_src(obj);
+    if ((lv_image_src_get_type(dsc) == LV_IMAGE_SRC_VARIABLE) && (dsc->data == buf))
+    {
+        lv_image_cache_drop(dsc);
+        lv_obj_invalidate(obj);
     }
-    lv_fs_close(&f);
-    return buf;
 }
 
+static lv_obj_tree_walk_res_t _ui_image_refresh_cb(lv_obj_t *obj, void *user_data)
+{
+    _ui_image_refresh(obj, user_data);
+    return LV_OBJ_TREE_WALK_NEXT;
+}
+
+/* Pixels are in place, redraw every image showing the placeholder on all screens. */
+static void _ui_load_done(int result, void *buf, uint32_t size, void *user_data)
+{
+    LV_UNUSED(user_data);
+
+    if (result != 0)
+    {
+        /* Read error or CRC mismatch, drop what came in and show the blank placeholder again. */
+        LV_LOG_WARN("image of %p failed to load, keep placeholder", buf);
+        lv_memzero(buf, size);
+    }
+
+    lv_obj_tree_walk(NULL, _ui_image_refresh_cb, buf);
+}
+
+/*
+ * The pixel buffer is returned at once, cleared as a blank placeholder
+ * (transparent in alpha formats). The asset loader task fills it in
+ * background, so screens come up without waiting for the SPI-NOR drive.
+ * The buffer stays owned by the image descriptor.
+ */
+uint8_t *_ui_load_binary(char *fname, const uint32_t size)
+{
+    const S_NU_ASSET_ENTRY *psEntry = _ui_find_packed(fname, size);
+    const char *path = psEntry ? UI_ASSET_PACK_PATH : fname;
+    uint32_t offset = psEntry ? psEntry->u32Offset : 0;
+    S_NU_ASSET_REQ sReq;
+    uint8_t *buf;
+
+    buf = NU_MEMTAG_MALLOC(lv_malloc, evNU_MEMTAG_IMAGE, size);
+    if (buf == NULL)
+        return NULL;
+
+    lv_memzero(buf, size);
+
+    lv_memzero(&sReq, sizeof(sReq));
+    sReq.szPath = path;
+    sReq.u32Offset = offset;
+    sReq.u32Size = size;
+    sReq.pvBuf = buf;
+    sReq.ePrio = evNU_ASSET_PRIO_NORMAL;
+    sReq.pfnProcess = psEntry ? _ui_load_check : NULL;
+    sReq.pfnDone = _ui_load_done;
+    sReq.pvUserData = (void *)psEntry;
+
+    if (nu_asset_loader_request(&sReq) != NU_ASSET_REQ_INVALID)
+        return buf;
+
+    /* Queue is full, fall back to a blocking read. */
+    if ((_ui_load_file(path, offset, buf, size) == 0) &&
+            (!psEntry || (_ui_load_check(buf, size, (void *)psEntry) == 0)))
+        return buf;
+
+    NU_MEMTAG_FREE(lv_free, buf);
+    return NULL;
+}
@@ -13,8 +13,9 @@
 
 #define CONFIG_USB_PRINTF     printf
 
-#define usb_malloc(size)      malloc(size)
-#define usb_free(ptr)         free(ptr)
+#include "nu_memtag.h"
+#define usb_malloc(size)      NU_MEMTAG_MALLOC(malloc, evNU_MEMTAG_USB, size)
+#define usb_free(ptr)         NU_MEMTAG_FREE(free, ptr)
 
 
 #ifndef CONFIG_USB_DBG_LEVEL
@@ -26,11 +26,17 @@ struct nu_spi
     int16_t pdma_perp_rx;
     int8_t  pdma_chanid_rx;
     volatile uint32_t m_psSemBus;
+    SemaphoreHandle_t m_psSemDone;    /* Optional, block on it instead of polling m_psSemBus. */
 #endif
 };
 typedef struct nu_spi *nu_spi_t;
 
 int nu_spi_transfer(struct nu_spi *psNuSPI, const void *tx, void *rx, int length);
+int nu_spi_xfer(struct nu_spi *psNuSPI, const void *tx, void *rx, int length);
+void nu_spi_ss_set(struct nu_spi *psNuSPI, int level);
 int nu_spi_send_then_recv(SPI_T *spi, const uint8_t *tx, int tx_len, uint8_t *rx, int rx_len, int dw);
+#if defined(CONFIG_SPI_USE_PDMA)
+int nu_spi_send_then_recv_pdma(struct nu_spi *psNuSPI, const uint8_t *tx, int tx_len, uint8_t *rx, int rx_len);
+#endif
 
 #endif //__DRV_SPI_H__
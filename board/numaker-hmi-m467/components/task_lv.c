@@ -7,9 +7,11 @@
  ******************************************************************************/
 
 #include "lv_glue.h"
+#include "nu_memtag.h"
+#include "nu_sysstat.h"
 
 #define CONFIG_LV_TASK_STACKSIZE     4096
-#define CONFIG_LV_TASK_PRIORITY      (configMAX_PRIORITIES-1)
+#define CONFIG_LV_TASK_PRIORITY      (tskIDLE_PRIORITY + LV_THREAD_PRIO_HIGH)
 
 #if LV_USE_LOG
 static void lv_nuvoton_log(lv_log_level_t level, const char *buf)
@@ -18,12 +20,46 @@ static void lv_nuvoton_log(lv_log_level_t level, const char *buf)
 }
 #endif /* LV_USE_LOG */
 
-void lv_tick_task(void *pdata)
+static TaskHandle_t s_hLvTask = NULL;
+
+void nu_lv_task_wakeup(uint32_t u32Events)
 {
-    while (1)
+    if (s_hLvTask != NULL)
+        xTaskNotifyIndexed(s_hLvTask, NU_LV_WAKEUP_NOTIFY_INDEX, u32Events, eSetBits);
+}
+
+void nu_lv_task_wakeup_from_isr(uint32_t u32Events)
+{
+    if (s_hLvTask != NULL)
+    {
+        BaseType_t xHigherPriorityTaskWoken = pdFALSE;
+
+        xTaskNotifyIndexedFromISR(s_hLvTask, NU_LV_WAKEUP_NOTIFY_INDEX, u32Events, eSetBits, &xHigherPriorityTaskWoken);
+
+        portYIELD_FROM_ISR(xHigherPriorityTaskWoken);
+    }
+}
+
+static void lv_nuvoton_invalidate_cb(lv_event_t *e)
+{
+    /* Invalidation inside lv_timer_handler() is covered by its returned deadline. */
+    if (xTaskGetCurrentTaskHandle() != s_hLvTask)
+        nu_lv_task_wakeup(NU_LV_WAKEUP_REFRESH);
+}
+
+static void lv_nuvoton_indev_ready(void)
+{
+    lv_indev_t *indev = lv_indev_get_next(NULL);
+
+    /* Don't wait for next read period, make all read timers ready. */
+    while (indev != NULL)
     {
-        lv_tick_inc(1);
-        vTaskDelay((TickType_t) 1 / portTICK_PERIOD_MS);
+        lv_timer_t *timer = lv_indev_get_read_timer(indev);
+
+        if (timer != NULL)
+            lv_timer_ready(timer);
+
+        indev = lv_indev_get_next(indev);
     }
 }
 
@@ -38,6 +74,9 @@ void lv_nuvoton_task(void *pdata)
     lv_tick_set_cb(xTaskGetTickCount);    /*Expression evaluating to current system time in ms*/
     lv_delay_set_cb(vTaskDelay);
 
+    /* Tag draw buffers, it is nothing without CONFIG_NU_MEMTAG. */
+    nu_memtag_lv_init();
+
     extern void lv_port_disp_init(void);
     lv_port_disp_init();
 
@@ -47,17 +86,32 @@ void lv_nuvoton_task(void *pdata)
     extern void ui_init(void);
     ui_init();
 
+    /* CPU load overlay, it is nothing without CONFIG_NU_SYSSTAT. */
+    nu_sysstat_lv_init();
+
+    lv_display_add_event_cb(lv_display_get_default(), lv_nuvoton_invalidate_cb, LV_EVENT_INVALIDATE_AREA, NULL);
+
     while (1)
     {
-        lv_task_handler();
-        vTaskDelay((TickType_t) 1 / portTICK_PERIOD_MS);
+        uint32_t u32Events = 0;
+        uint32_t u32TimeTillNext = lv_timer_handler();
+        TickType_t xTicksToWait = (u32TimeTillNext == LV_NO_TIMER_READY) ? portMAX_DELAY : pdMS_TO_TICKS(u32TimeTillNext);
+
+        /* Overdue timers: still yield one tick to lower-priority tasks. */
+        if (xTicksToWait == 0)
+            xTicksToWait = 1;
+
+        /* Sleep until next timer deadline or a wakeup event from touch IRQ or invalidation. */
+        xTaskNotifyWaitIndexed(NU_LV_WAKEUP_NOTIFY_INDEX, 0, 0xFFFFFFFFUL, &u32Events, xTicksToWait);
+
+        if (u32Events & NU_LV_WAKEUP_INPUT)
+            lv_nuvoton_indev_ready();
     }
 }
 
 
 int task_lv_init(void)
 {
-    xTaskCreate(lv_tick_task, "lv_tick", configMINIMAL_STACK_SIZE, NULL, CONFIG_LV_TASK_PRIORITY - 1, NULL);
-    xTaskCreate(lv_nuvoton_task, "lv_hdler", CONFIG_LV_TASK_STACKSIZE, NULL, CONFIG_LV_TASK_PRIORITY, NULL);
+    xTaskCreate(lv_nuvoton_task, "lv_hdler", CONFIG_LV_TASK_STACKSIZE, NULL, CONFIG_LV_TASK_PRIORITY, &s_hLvTask);
     return 0;
 }
@@ -9,7 +9,12 @@
 #ifndef LV_CONF_H
 #define LV_CONF_H
 
-#define LV_USE_OS   LV_OS_NONE
+#define LV_USE_OS   LV_OS_FREERTOS
+
+/* Draw units are threads at LV_THREAD_PRIO_HIGH, rendering overlaps the flush task. FreeRTOS */
+/* runs on one core here, so more units only add switching; raise it with more cores to run on. */
+#define LV_DRAW_SW_DRAW_UNIT_CNT        1
+#define LV_DRAW_THREAD_STACK_SIZE       (6*1024)
 
 #if defined(__320x240__)
     #define LV_HOR_RES_MAX                  320
@@ -28,6 +33,7 @@
 
 /* Please comment LV_USE_DEMO_MUSIC declaration before un-comment below */
 #define LV_USE_DEMO_WIDGETS             1
+//#define LV_USE_DEMO_BENCHMARK           1
 //#define LV_USE_DEMO_MUSIC             1
 #if LV_USE_DEMO_MUSIC
     #define LV_DEMO_MUSIC_AUTO_PLAY     1
@@ -6,6 +6,8 @@
  * @copyright (C) 2020 Nuvoton Technology Corp. All rights reserved.
  *****************************************************************************/
 #include "drv_spi.h"
+#include "nu_sysstat.h"
+#include "nu_section.h"
 
 #define SPI_GET_DATA_WIDTH(spi)  (((spi)->CTL & SPI_CTL_DWIDTH_Msk) >> SPI_CTL_DWIDTH_Pos)
 
@@ -81,7 +83,7 @@ __STATIC_INLINE void nu_spi_drain_rxfifo(SPI_T *spi)
     }
 }
 
-static int nu_spi_transmit_poll(struct nu_spi *psNuSPI, const uint8_t *tx, uint8_t *rx, int length, int dw)
+NU_FAST_CODE static int nu_spi_transmit_poll(struct nu_spi *psNuSPI, const uint8_t *tx, uint8_t *rx, int length, int dw)
 {
     SPI_T *base = psNuSPI->base;
     // Write-only
@@ -187,9 +189,21 @@ static void nu_pdma_spi_rx_cb_event(void *pvUserData, uint32_t u32EventFilter)
 {
     struct nu_spi *psNuSPI = (struct nu_spi *)pvUserData;
 
+    nu_sysstat_isr_enter();
+
     LV_ASSERT(psNuSPI);
 
     psNuSPI->m_psSemBus = 1;
+
+    if (psNuSPI->m_psSemDone != NULL)
+    {
+        BaseType_t xHigherPriorityTaskWoken = pdFALSE;
+
+        xSemaphoreGiveFromISR(psNuSPI->m_psSemDone, &xHigherPriorityTaskWoken);
+        portYIELD_FROM_ISR(xHigherPriorityTaskWoken);
+    }
+
+    nu_sysstat_isr_exit(evNU_SYSSTAT_ISR_SPI);
 }
 
 static void nu_pdma_spi_tx_cb_trigger(void *pvUserData, uint32_t u32UserData)
@@ -342,58 +356,112 @@ static int nu_spi_transmit_pdma(struct nu_spi *psNuSPI, const void *tx, void *rx
     LV_ASSERT(result == 0);
 
     /* Wait RX-PDMA transfer done */
-    while (psNuSPI->m_psSemBus == 0)
+    if (psNuSPI->m_psSemDone != NULL)
+    {
+        while (xSemaphoreTake(psNuSPI->m_psSemDone, portMAX_DELAY) != pdTRUE);
+    }
+    else
     {
+        while (psNuSPI->m_psSemBus == 0)
+        {
+        }
     }
 
     return length;
 }
-#endif
 
-int nu_spi_transfer(struct nu_spi *psNuSPI, const void *tx, void *rx, int length)
+static void nu_spi_pdma_channel_prepare(struct nu_spi *psNuSPI)
 {
-    int ret, dw;
-
-#if defined(CONFIG_SPI_USE_PDMA)
     if ((psNuSPI->pdma_perp_tx > 0) && (psNuSPI->pdma_chanid_tx < 0))
         psNuSPI->pdma_chanid_tx = nu_pdma_channel_allocate(psNuSPI->pdma_perp_tx);
 
     if ((psNuSPI->pdma_perp_rx > 0) && (psNuSPI->pdma_chanid_rx < 0))
         psNuSPI->pdma_chanid_rx = nu_pdma_channel_allocate(psNuSPI->pdma_perp_rx);
-#endif
+}
 
-    dw = SPI_GET_DATA_WIDTH(psNuSPI->base) / 8;
+static int nu_spi_pdma_eligible(struct nu_spi *psNuSPI, const void *tx, void *rx, int length, int dw)
+{
+    /* DMA transfer constrains */
+    return (psNuSPI->pdma_chanid_tx != -1) &&
+           (psNuSPI->pdma_chanid_rx != -1) &&
+           !((uint32_t)tx % dw) &&
+           !((uint32_t)rx % dw) &&
+           (dw != 3) &&
+           (length >= CONFIG_SPI_USE_PDMA_MIN_THRESHOLD);
+}
+#endif
 
+void nu_spi_ss_set(struct nu_spi *psNuSPI, int level)
+{
     if (psNuSPI->ss_pin > 0)
     {
-        GPIO_PIN_DATA(NU_GET_PORT(psNuSPI->ss_pin), NU_GET_PIN(psNuSPI->ss_pin)) = 0;
+        GPIO_PIN_DATA(NU_GET_PORT(psNuSPI->ss_pin), NU_GET_PIN(psNuSPI->ss_pin)) = level;
+    }
+    else if (level)
+    {
+        SPI_SET_SS_HIGH(psNuSPI->base);
     }
     else
     {
         SPI_SET_SS_LOW(psNuSPI->base);
     }
+}
+
+/**
+ * One transfer phase without touching SS, for callers framing multi-phase
+ * commands themselves. PDMA is used when the phase is eligible.
+ */
+int nu_spi_xfer(struct nu_spi *psNuSPI, const void *tx, void *rx, int length)
+{
+    int dw;
 
 #if defined(CONFIG_SPI_USE_PDMA)
-    /* DMA transfer constrains */
-    if ((psNuSPI->pdma_chanid_tx != -1) &&
-            (psNuSPI->pdma_chanid_rx != -1) &&
-            !((uint32_t)tx % dw) &&
-            !((uint32_t)rx % dw) &&
-            (dw != 3) &&
-            (length >= CONFIG_SPI_USE_PDMA_MIN_THRESHOLD))
-        ret = nu_spi_transmit_pdma(psNuSPI, tx, rx, length, dw);
-    else
+    nu_spi_pdma_channel_prepare(psNuSPI);
 #endif
-        ret = nu_spi_transmit_poll(psNuSPI, tx, rx, length, dw);
 
-    if (psNuSPI->ss_pin > 0)
-    {
-        GPIO_PIN_DATA(NU_GET_PORT(psNuSPI->ss_pin), NU_GET_PIN(psNuSPI->ss_pin)) = 1;
-    }
-    else
-    {
-        SPI_SET_SS_HIGH(psNuSPI->base);
-    }
+    dw = SPI_GET_DATA_WIDTH(psNuSPI->base) / 8;
+
+#if defined(CONFIG_SPI_USE_PDMA)
+    if (nu_spi_pdma_eligible(psNuSPI, tx, rx, length, dw))
+        return nu_spi_transmit_pdma(psNuSPI, tx, rx, length, dw);
+#endif
+
+    return nu_spi_transmit_poll(psNuSPI, tx, rx, length, dw);
+}
+
+#if defined(CONFIG_SPI_USE_PDMA)
+/**
+ * Send a command phase by polling, then receive the data phase by PDMA.
+ * The RX channel writes into rx (SrcFix/DstInc) while the TX channel
+ * clocks out a fixed dummy word, so a long read costs one PDMA round trip
+ * instead of one FIFO round trip per word.
+ */
+int nu_spi_send_then_recv_pdma(struct nu_spi *psNuSPI, const uint8_t *tx, int tx_len, uint8_t *rx, int rx_len)
+{
+    nu_spi_ss_set(psNuSPI, 0);
+
+    /* Command, address and dummy cycles are under the PDMA threshold. */
+    if (tx && (tx_len > 0))
+        nu_spi_xfer(psNuSPI, tx, NULL, tx_len);
+
+    if (rx && (rx_len > 0))
+        nu_spi_xfer(psNuSPI, NULL, rx, rx_len);
+
+    nu_spi_ss_set(psNuSPI, 1);
+
+    return 0;
+}
+#endif
+
+int nu_spi_transfer(struct nu_spi *psNuSPI, const void *tx, void *rx, int length)
+{
+    int ret;
+
+    nu_spi_ss_set(psNuSPI, 0);
+
+    ret = nu_spi_xfer(psNuSPI, tx, rx, length);
+
+    nu_spi_ss_set(psNuSPI, 1);
 
     return ret;
 }
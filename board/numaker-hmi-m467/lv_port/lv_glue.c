@@ -10,14 +10,67 @@
 #include "lv_glue.h"
 #include "disp.h"
 #include "indev_touch.h"
+#include "nu_latprobe.h"
+#include "nu_sysstat.h"
+#include "nu_section.h"
+
+#if defined(CONFIG_INDEV_TOUCH_I2C_IRQ)
+    #include "touch_i2c_async.h"
+#endif
 
 #if defined(CONFIG_AD)
     #include "touch_adc.h"
 #endif
 
+#if defined(CONFIG_DISP_TILE_LINES)
+#include "queue.h"
+
+#define CONFIG_DISP_TILE_TASK_STACKSIZE     512
+#define CONFIG_DISP_TILE_TASK_PRIORITY      (tskIDLE_PRIORITY + LV_THREAD_PRIO_HIGHEST)
+
+typedef struct
+{
+    lv_area_t sArea;
+    void *pvPixels;
+} S_DISP_TILE_JOB;
+
+NU_DMA_DATA static uint8_t s_au8TileBuf[2][CONFIG_DISP_TILE_SIZE];
+static QueueHandle_t s_xTileQueue = NULL;
+static SemaphoreHandle_t s_xTileDone = NULL;
+
+static void disp_tile_task(void *pvParameters)
+{
+    S_DISP_TILE_JOB sJob;
+
+    for (;;)
+    {
+        while (xQueueReceive(s_xTileQueue, &sJob, portMAX_DELAY) != pdTRUE);
+
+        /* PDMA feeds EBI or SPI, this task sleeps on its completion and LVGL renders the other tile meanwhile. */
+        disp_fillrect((uint16_t *)sJob.pvPixels, &sJob.sArea);
+
+        xSemaphoreGive(s_xTileDone);
+    }
+}
+
+static void disp_tile_init(void)
+{
+    s_xTileQueue = xQueueCreate(1, sizeof(S_DISP_TILE_JOB));
+    LV_ASSERT(s_xTileQueue != NULL);
+
+    s_xTileDone = xSemaphoreCreateBinary();
+    LV_ASSERT(s_xTileDone != NULL);
+
+    LV_ASSERT(xTaskCreate(disp_tile_task, "disp_tile", CONFIG_DISP_TILE_TASK_STACKSIZE, NULL, CONFIG_DISP_TILE_TASK_PRIORITY, NULL) == pdPASS);
+}
+
+#else
+
 #define CONFIG_VRAM_TOTAL_ALLOCATED_SIZE    NVT_ALIGN((LV_HOR_RES_MAX * CONFIG_DISP_LINE_BUFFER_NUMBER * (LV_COLOR_DEPTH/8)), 4)
 
-static uint8_t s_au8FrameBuf[CONFIG_VRAM_TOTAL_ALLOCATED_SIZE] __attribute__((aligned(4)));
+NU_DMA_DATA static uint8_t s_au8FrameBuf[CONFIG_VRAM_TOTAL_ALLOCATED_SIZE];
+
+#endif
 
 #if defined(USE_ILI9341_SPI) && defined(__320x240__)
 S_CALIBRATION_MATRIX g_sCalMat = { -105, 6354, -3362552, 5086, -24, -2489744, 65536 };
@@ -71,6 +124,10 @@ int lcd_device_initialize(void)
 
     disp_init();
 
+#if defined(CONFIG_DISP_TILE_LINES)
+    disp_tile_init();
+#endif
+
     return 0;
 }
 
@@ -89,8 +146,14 @@ int lcd_device_control(int cmd, void *argv)
 
         LV_ASSERT(argv != NULL);
 
+#if defined(CONFIG_DISP_TILE_LINES)
+        /* Two tiles back to back. */
+        psLCDInfo->pvVramStartAddr = (void *)&s_au8TileBuf[0][0];
+        psLCDInfo->u32VramSize = sizeof(s_au8TileBuf);
+#else
         psLCDInfo->pvVramStartAddr = (void *)s_au8FrameBuf;
         psLCDInfo->u32VramSize = CONFIG_VRAM_TOTAL_ALLOCATED_SIZE;
+#endif
         psLCDInfo->u32ResWidth = LV_HOR_RES_MAX;
         psLCDInfo->u32ResHeight = LV_VER_RES_MAX;
         psLCDInfo->u32BytePerPixel = (LV_COLOR_DEPTH / 8);
@@ -98,11 +161,33 @@ int lcd_device_control(int cmd, void *argv)
     }
     break;
 
+#if defined(CONFIG_DISP_TILE_LINES)
+    case evLCD_CTRL_TILE_UPDATE:
+    {
+        S_LCD_TILE *psTile = (S_LCD_TILE *)argv;
+        S_DISP_TILE_JOB sJob;
+
+        LV_ASSERT(argv != NULL);
+
+        lv_area_copy(&sJob.sArea, (const lv_area_t *)psTile->pvArea);
+        sJob.pvPixels = psTile->pvPixels;
+
+        while (xQueueSend(s_xTileQueue, &sJob, portMAX_DELAY) != pdTRUE);
+    }
+    break;
+
+    case evLCD_CTRL_TILE_WAIT:
+    {
+        while (xSemaphoreTake(s_xTileDone, portMAX_DELAY) != pdTRUE);
+    }
+    break;
+#else
     case evLCD_CTRL_RECT_UPDATE:
     {
         disp_fillrect((uint16_t *)s_au8FrameBuf, (const lv_area_t *)argv);
     }
     break;
+#endif
 
     default:
         LV_ASSERT(0);
@@ -144,11 +229,23 @@ void GPG_IRQHandler(void)
 {
     GPIO_T *PORT = (GPIO_T *)(GPIOA_BASE + (NU_GET_PORT(CONFIG_INDEV_TOUCH_PIN_IRQ) * PORT_OFFSET));
 
+    nu_sysstat_isr_enter();
+
     /* To check if PC.5 interrupt occurred */
     if (GPIO_GET_INT_FLAG(PORT, NU_GET_PIN_MASK(NU_GET_PIN(CONFIG_INDEV_TOUCH_PIN_IRQ))))
     {
         GPIO_CLR_INT_FLAG(PORT, NU_GET_PIN_MASK(NU_GET_PIN(CONFIG_INDEV_TOUCH_PIN_IRQ)));
+        nu_latprobe_irq();
+
+#if defined(CONFIG_INDEV_TOUCH_I2C_IRQ)
+        /* Touch data is ready, read it in I2C interrupts. LVGL task is woken when it is in. */
+        touch_i2c_async_kick_from_isr();
+#else
         s_u32LastIRQ = xTaskGetTickCount();
+
+        /* Touch data is ready, read it without waiting for next polling period. */
+        nu_lv_task_wakeup_from_isr(NU_LV_WAKEUP_INPUT);
+#endif
     }
     else
     {
@@ -156,6 +253,17 @@ void GPG_IRQHandler(void)
         volatile uint32_t u32temp = PORT->INTSRC;
         PORT->INTSRC = u32temp;
     }
+
+    nu_sysstat_isr_exit(evNU_SYSSTAT_ISR_TOUCH);
+}
+#endif
+
+#if defined(CONFIG_INDEV_TOUCH_I2C_IRQ)
+void I2C1_IRQHandler(void)
+{
+    nu_sysstat_isr_enter();
+    touch_i2c_async_irq_handler();
+    nu_sysstat_isr_exit(evNU_SYSSTAT_ISR_I2C);
 }
 #endif
 
@@ -193,6 +301,8 @@ int touchpad_device_initialize(void)
     GPIO_SetMode(PORT, NU_GET_PIN_MASK(NU_GET_PIN(CONFIG_INDEV_TOUCH_PIN_IRQ)), GPIO_MODE_INPUT);
     GPIO_SetPullCtl(PORT, NU_GET_PIN_MASK(NU_GET_PIN(CONFIG_INDEV_TOUCH_PIN_IRQ)), GPIO_PUSEL_PULL_UP);
     GPIO_EnableInt(PORT, NU_GET_PIN(CONFIG_INDEV_TOUCH_PIN_IRQ), GPIO_INT_FALLING);
+    /* The ISR calls FreeRTOS FromISR APIs. */
+    NVIC_SetPriority(au32GPIRQ[NU_GET_PORT(CONFIG_INDEV_TOUCH_PIN_IRQ)], configLIBRARY_MAX_SYSCALL_INTERRUPT_PRIORITY + 1);
     NVIC_EnableIRQ(au32GPIRQ[NU_GET_PORT(CONFIG_INDEV_TOUCH_PIN_IRQ)]);
 #endif
 
@@ -223,7 +333,14 @@ int touchpad_device_read(lv_indev_data_t *psInDevData)
 {
 #if defined(CONFIG_INDEV_TOUCH_I2C)
 
-#if defined(CONFIG_INDEV_TOUCH_PIN_IRQ)
+#if defined(CONFIG_INDEV_TOUCH_PIN_IRQ) && defined(CONFIG_INDEV_TOUCH_I2C_IRQ)
+    /* Non-blocking, it only picks up the snapshot read in background. */
+    indev_touch_get_data((lv_indev_data_t *)&s_sInDevData);
+
+    psInDevData->point.x = s_sInDevData.point.x;
+    psInDevData->point.y = s_sInDevData.point.y;
+    psInDevData->state = s_sInDevData.state;
+#elif defined(CONFIG_INDEV_TOUCH_PIN_IRQ)
     static uint32_t u32LastIRQ = 0;
 
     if (u32LastIRQ != s_u32LastIRQ)
@@ -319,7 +436,19 @@ exit_touchpad_device_read:
 
 int touchpad_device_control(int cmd, void *argv)
 {
-    return 0;
+    switch (cmd)
+    {
+#if defined(CONFIG_INDEV_TOUCH_I2C)
+    case evTOUCH_CTRL_GET_POINTS:
+        LV_ASSERT(argv != NULL);
+        return indev_touch_get_points((S_TOUCH_POINTS *)argv);
+#endif
+
+    default:
+        break;
+    }
+
+    return -1;
 }
 
 void touchpad_device_close(void)
@@ -25,6 +25,15 @@
     #error "Wrong CONFIG_DISP_LINE_BUFFER_NUMBER definition"
 #endif
 
+/* Tiled rendering, LVGL renders into two tiles of these lines by turns. A finished tile is sent */
+/* to panel by PDMA in a flush task, while the other one is rendered by LVGL draw units. */
+/* Comment it out to render into one screen-size buffer directly. */
+#define CONFIG_DISP_TILE_LINES          48
+
+#if defined(CONFIG_DISP_TILE_LINES)
+    #define CONFIG_DISP_TILE_SIZE       NVT_ALIGN((LV_HOR_RES_MAX * CONFIG_DISP_TILE_LINES * (LV_COLOR_DEPTH/8)), 4)
+#endif
+
 #if defined(USE_ILI9341_SPI)
 
     /* ILI9341 SPI */
@@ -73,6 +82,7 @@
     /* ST1663I I2C */
     #define CONFIG_INDEV_TOUCH_I2C        I2C1
     #define CONFIG_INDEV_TOUCH_PIN_IRQ    NU_GET_PININDEX(evGG, 6)
+    #define CONFIG_INDEV_TOUCH_I2C_IRQ    I2C1_IRQn      /* Comment it out for blocking reads on LVGL thread. */
     #define CONFIG_INDEV_TOUCH_PIN_RESET  NU_GET_PININDEX(evGD, 10)
     #define INDEV_TOUCH_SET_RST           GPIO_PIN_DATA(NU_GET_PORT(CONFIG_INDEV_TOUCH_PIN_RESET), NU_GET_PIN(CONFIG_INDEV_TOUCH_PIN_RESET)) = 0
     #define INDEV_TOUCH_CLR_RST           GPIO_PIN_DATA(NU_GET_PORT(CONFIG_INDEV_TOUCH_PIN_RESET), NU_GET_PIN(CONFIG_INDEV_TOUCH_PIN_RESET)) = 1
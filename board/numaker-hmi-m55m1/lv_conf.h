@@ -12,6 +12,17 @@
 #define LV_USE_OS   LV_OS_FREERTOS
 
 #define LV_USE_DRAW_GDMA                1
+#define LV_DRAW_BUF_STRIDE_ALIGN        4
+
+/* Layer buffers in SRAM, 224 KB beside the fast heap and VRAM, see common/nu_layer_pool.h. */
+#define CONFIG_NU_LAYER_POOL            1
+#define CONFIG_NU_LAYER_POOL_SMALL_SIZE     (8 * 1024)
+#define CONFIG_NU_LAYER_POOL_SMALL_NUM      4
+#define CONFIG_NU_LAYER_POOL_MEDIUM_SIZE    (32 * 1024)
+#define CONFIG_NU_LAYER_POOL_MEDIUM_NUM     2
+#define CONFIG_NU_LAYER_POOL_LARGE_SIZE     (128 * 1024)
+#define CONFIG_NU_LAYER_POOL_LARGE_NUM      1
+
 #define LV_USE_NATIVE_HELIUM_ASM        1
 
 #if defined(__480x272__)
@@ -42,6 +53,8 @@
 #define LV_USE_PERF_MONITOR             1
 #define LV_USE_LOG                      0
 
+/* lv_malloc() is served by common/nu_heap.c, this size joins the internal SRAM region. */
+#define LV_USE_STDLIB_MALLOC            LV_STDLIB_CUSTOM
 #define CONFIG_LV_MEM_SIZE              (128*1024U)
 
 #if LV_USE_LOG == 1
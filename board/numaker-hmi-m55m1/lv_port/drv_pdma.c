@@ -7,6 +7,9 @@
  *****************************************************************************/
 
 #include "drv_pdma.h"
+#include "nu_memtag.h"
+#include "nu_sysstat.h"
+#include "nu_section.h"
 
 #ifndef NU_PDMA_MEMFUN_ACTOR_MAX
     #define NU_PDMA_MEMFUN_ACTOR_MAX (4)
@@ -49,6 +52,11 @@ struct nu_pdma_chn
     nu_pdma_desc_t        *m_ppsSgtbl;
     uint32_t               m_u32WantedSGTblNum;
 
+    /* Shape of chain built in m_ppsSgtbl, reused by _nu_pdma_transfer_chain. */
+    uint32_t               m_u32ChainNodes;
+    uint32_t               m_u32ChainDataWidth;
+    nu_pdma_memctrl_t      m_eChainMemCtl;
+
     uint32_t               m_u32EventFilter;
     uint32_t               m_u32IdleTimeout_us;
     nu_pdma_periph_ctl_t   m_spPeripCtl;
@@ -80,6 +88,7 @@ static void nu_pdma_memfun_cb(void *pvUserData, uint32_t u32Events);
 static void nu_pdma_memfun_actor_init(void);
 static int nu_pdma_memfun_employ(void);
 static int nu_pdma_non_transfer_count_get(int32_t i32ChannID);
+static void _nu_pdma_free_sgtbls(nu_pdma_chn_t *psPdmaChann);
 
 /* Public functions -------------------------------------------------------------*/
 
@@ -119,6 +128,8 @@ static struct nu_pdma_memfun_actor nu_pdma_memfun_actor_arr[NU_PDMA_MEMFUN_ACTOR
 /* SG table pool */
 static DSCT_T nu_pdma_sgtbl_arr[NU_PDMA_SGTBL_POOL_SIZE] = { 0 };
 static uint32_t nu_pdma_sgtbl_token[NVT_ALIGN(NU_PDMA_SGTBL_POOL_SIZE, 32) / 32];
+static int nu_pdma_sgtbl_inuse = 0;
+static int nu_pdma_sgtbl_peak = 0;
 
 static int nu_pdma_check_is_nonallocated(uint32_t u32ChnId)
 {
@@ -337,6 +348,9 @@ int nu_pdma_channel_free(int i32ChannID)
     {
         nu_pdma_chn_mask_arr[NU_PDMA_GET_MOD_IDX(i32ChannID)] &= ~(1 << NU_PDMA_GET_MOD_CHIDX(i32ChannID));
         nu_pdma_channel_disable(i32ChannID);
+
+        /* Give cached chain back to sgtbl pool. */
+        _nu_pdma_free_sgtbls(&nu_pdma_chn_arr[i32ChannID - NU_PDMA_CH_Pos]);
         ret =  0;
     }
 
@@ -621,6 +635,14 @@ static int nu_pdma_sgtbls_token_allocate(void)
         {
             nu_pdma_sgtbl_token[i] &= ~(1 << idx);
             idx += i * 32;
+
+            /* Record demand, it is the hint of NU_PDMA_SGTBL_POOL_SIZE. */
+            if (++nu_pdma_sgtbl_inuse > nu_pdma_sgtbl_peak)
+            {
+                nu_pdma_sgtbl_peak = nu_pdma_sgtbl_inuse;
+                LV_LOG_INFO("sgtbl peak: %d/%d", nu_pdma_sgtbl_peak, NU_PDMA_SGTBL_POOL_SIZE);
+            }
+
             return idx;
         }
     }
@@ -635,6 +657,16 @@ static void nu_pdma_sgtbls_token_free(nu_pdma_desc_t psSgtbls)
     LV_ASSERT(idx >= 0);
     LV_ASSERT((idx + 1) <= NU_PDMA_SGTBL_POOL_SIZE);
     nu_pdma_sgtbl_token[idx / 32] |= (1 << (idx % 32));
+    nu_pdma_sgtbl_inuse--;
+}
+
+void nu_pdma_sgtbls_usage(int *pi32InUse, int *pi32Peak)
+{
+    if (pi32InUse)
+        *pi32InUse = nu_pdma_sgtbl_inuse;
+
+    if (pi32Peak)
+        *pi32Peak = nu_pdma_sgtbl_peak;
 }
 
 void nu_pdma_sgtbls_free(nu_pdma_desc_t *ppsSgtbls, int num)
@@ -667,7 +699,7 @@ int nu_pdma_sgtbls_allocate(nu_pdma_desc_t *ppsSgtbls, int num)
         /* Get token. */
         if ((idx = nu_pdma_sgtbls_token_allocate()) < 0)
         {
-            printf("No available sgtbl.\n");
+            printf("No available sgtbl, enlarge NU_PDMA_SGTBL_POOL_SIZE(%d).\n", NU_PDMA_SGTBL_POOL_SIZE);
             goto fail_nu_pdma_sgtbls_allocate;
         }
 
@@ -768,71 +800,113 @@ static void _nu_pdma_free_sgtbls(nu_pdma_chn_t *psPdmaChann)
     if (psPdmaChann->m_ppsSgtbl)
     {
         nu_pdma_sgtbls_free(psPdmaChann->m_ppsSgtbl, psPdmaChann->m_u32WantedSGTblNum);
+        nvt_free_align(psPdmaChann->m_ppsSgtbl);
         psPdmaChann->m_ppsSgtbl = NULL;
-        psPdmaChann->m_u32WantedSGTblNum = 0;
     }
+
+    psPdmaChann->m_u32WantedSGTblNum = 0;
+    psPdmaChann->m_u32ChainNodes = 0;
+}
+
+/* Descriptors cached by channel only grow, a shorter chain reuses the head of them. */
+static int _nu_pdma_grow_sgtbls(nu_pdma_chn_t *psPdmaChann, uint32_t u32Num)
+{
+    nu_pdma_desc_t *ppsSgtbl;
+
+    if (u32Num <= psPdmaChann->m_u32WantedSGTblNum)
+        return 0;
+
+    ppsSgtbl = (nu_pdma_desc_t *)nvt_malloc_align_tag(sizeof(nu_pdma_desc_t) * u32Num, 4, evNU_MEMTAG_PDMA);
+    if (!ppsSgtbl)
+        return -1;
+
+    if (nu_pdma_sgtbls_allocate(&ppsSgtbl[psPdmaChann->m_u32WantedSGTblNum], u32Num - psPdmaChann->m_u32WantedSGTblNum) != 0)
+    {
+        nvt_free_align(ppsSgtbl);
+        return -1;
+    }
+
+    if (psPdmaChann->m_ppsSgtbl)
+    {
+        memcpy(ppsSgtbl, psPdmaChann->m_ppsSgtbl, sizeof(nu_pdma_desc_t) * psPdmaChann->m_u32WantedSGTblNum);
+        nvt_free_align(psPdmaChann->m_ppsSgtbl);
+    }
+
+    psPdmaChann->m_ppsSgtbl = ppsSgtbl;
+    psPdmaChann->m_u32WantedSGTblNum = u32Num;
+
+    /* Links are changed, rebuild it. */
+    psPdmaChann->m_u32ChainNodes = 0;
+
+    return 0;
 }
 
 static int _nu_pdma_transfer_chain(int i32ChannID, uint32_t u32DataWidth, uint32_t u32AddrSrc, uint32_t u32AddrDst, uint32_t u32TransferCnt, uint32_t u32IdleTimeout_us)
 {
-    int i = 0;
     int ret = 1;
+    uint32_t i;
     nu_pdma_periph_ctl_t *psPeriphCtl = NULL;
     nu_pdma_chn_t *psPdmaChann = &nu_pdma_chn_arr[i32ChannID - NU_PDMA_CH_Pos];
 
     nu_pdma_memctrl_t eMemCtl = nu_pdma_channel_memctrl_get(i32ChannID);
 
-    uint32_t u32Offset = 0;
-    uint32_t u32TxCnt = 0;
+    uint32_t u32Nodes = (u32TransferCnt + NU_PDMA_MAX_TXCNT - 1) / NU_PDMA_MAX_TXCNT;
+    uint32_t u32LastCnt = u32TransferCnt - ((u32Nodes - 1) * NU_PDMA_MAX_TXCNT);
+    uint32_t u32Stride = NU_PDMA_MAX_TXCNT * u32DataWidth / 8;
 
     psPeriphCtl = &psPdmaChann->m_spPeripCtl;
 
-    if (psPdmaChann->m_u32WantedSGTblNum != (u32TransferCnt / NU_PDMA_MAX_TXCNT + 1))
-    {
-        if (psPdmaChann->m_u32WantedSGTblNum > 0)
-            _nu_pdma_free_sgtbls(psPdmaChann);
+    if (_nu_pdma_grow_sgtbls(psPdmaChann, u32Nodes) != 0)
+        goto exit__nu_pdma_transfer_chain;
 
-        psPdmaChann->m_u32WantedSGTblNum = u32TransferCnt / NU_PDMA_MAX_TXCNT + 1;
+    if ((psPdmaChann->m_u32ChainNodes == u32Nodes) &&
+            (psPdmaChann->m_u32ChainDataWidth == u32DataWidth) &&
+            (psPdmaChann->m_eChainMemCtl == eMemCtl))
+    {
+        nu_pdma_desc_t psLast = psPdmaChann->m_ppsSgtbl[u32Nodes - 1];
 
-        psPdmaChann->m_ppsSgtbl = (nu_pdma_desc_t *)nvt_malloc_align(sizeof(nu_pdma_desc_t) * psPdmaChann->m_u32WantedSGTblNum, 4);
-        if (!psPdmaChann->m_ppsSgtbl)
+        if ((u32AddrSrc % (u32DataWidth / 8)) || (u32AddrDst % (u32DataWidth / 8)))
             goto exit__nu_pdma_transfer_chain;
 
-        ret = nu_pdma_sgtbls_allocate(psPdmaChann->m_ppsSgtbl, psPdmaChann->m_u32WantedSGTblNum);
-        if (ret != 0)
-            goto exit__nu_pdma_transfer_chain;
-    }
+        /* Same shape, patch addresses and count of last node only. */
+        for (i = 0; i < u32Nodes; i++)
+        {
+            psPdmaChann->m_ppsSgtbl[i]->SA = (eMemCtl & 0x2ul) ? u32AddrSrc + (i * u32Stride) : u32AddrSrc; /* Src address is Inc or not. */
+            psPdmaChann->m_ppsSgtbl[i]->DA = (eMemCtl & 0x1ul) ? u32AddrDst + (i * u32Stride) : u32AddrDst; /* Dst address is Inc or not. */
+        }
 
-    for (i = 0; i < psPdmaChann->m_u32WantedSGTblNum; i++)
+        psLast->CTL = (psLast->CTL & ~PDMA_DSCT_CTL_TXCNT_Msk) | ((u32LastCnt - 1) << PDMA_DSCT_CTL_TXCNT_Pos);
+    }
+    else
     {
-        u32TxCnt = (u32TransferCnt > NU_PDMA_MAX_TXCNT) ? NU_PDMA_MAX_TXCNT : u32TransferCnt;
-
-        ret = nu_pdma_desc_setup(i32ChannID,
-                                 psPdmaChann->m_ppsSgtbl[i],
-                                 u32DataWidth,
-                                 (eMemCtl & 0x2ul) ? u32AddrSrc + u32Offset : u32AddrSrc, /* Src address is Inc or not. */
-                                 (eMemCtl & 0x1ul) ? u32AddrDst + u32Offset : u32AddrDst, /* Dst address is Inc or not. */
-                                 u32TxCnt,
-                                 ((i + 1) == psPdmaChann->m_u32WantedSGTblNum) ? NULL : psPdmaChann->m_ppsSgtbl[i + 1],
-                                 ((i + 1) == psPdmaChann->m_u32WantedSGTblNum) ? 0 : 1); // Silent, w/o TD interrupt
-
-        if (ret != 0)
-            goto exit__nu_pdma_transfer_chain;
+        psPdmaChann->m_u32ChainNodes = 0;
 
-        u32TransferCnt -= u32TxCnt;
-        u32Offset += (u32TxCnt * u32DataWidth / 8);
+        for (i = 0; i < u32Nodes; i++)
+        {
+            ret = nu_pdma_desc_setup(i32ChannID,
+                                     psPdmaChann->m_ppsSgtbl[i],
+                                     u32DataWidth,
+                                     (eMemCtl & 0x2ul) ? u32AddrSrc + (i * u32Stride) : u32AddrSrc, /* Src address is Inc or not. */
+                                     (eMemCtl & 0x1ul) ? u32AddrDst + (i * u32Stride) : u32AddrDst, /* Dst address is Inc or not. */
+                                     ((i + 1) == u32Nodes) ? u32LastCnt : NU_PDMA_MAX_TXCNT,
+                                     ((i + 1) == u32Nodes) ? NULL : psPdmaChann->m_ppsSgtbl[i + 1],
+                                     ((i + 1) == u32Nodes) ? 0 : 1); // Silent, w/o TD interrupt
+
+            if (ret != 0)
+                goto exit__nu_pdma_transfer_chain;
+        }
+
+        psPdmaChann->m_u32ChainNodes = u32Nodes;
+        psPdmaChann->m_u32ChainDataWidth = u32DataWidth;
+        psPdmaChann->m_eChainMemCtl = eMemCtl;
     }
 
     _nu_pdma_transfer(i32ChannID, psPeriphCtl->m_u32Peripheral, psPdmaChann->m_ppsSgtbl[0], u32IdleTimeout_us);
 
     ret = 0;
 
-    return ret;
-
 exit__nu_pdma_transfer_chain:
 
-    _nu_pdma_free_sgtbls(psPdmaChann);
-
     return -(ret);
 }
 
@@ -995,12 +1069,16 @@ void PDMA_IRQHandler(PDMA_T *PDMA)
 
 void PDMA0_IRQHandler(void)
 {
+    nu_sysstat_isr_enter();
     PDMA_IRQHandler(PDMA0);
+    nu_sysstat_isr_exit(evNU_SYSSTAT_ISR_PDMA);
 }
 
 void PDMA1_IRQHandler(void)
 {
+    nu_sysstat_isr_enter();
     PDMA_IRQHandler(PDMA1);
+    nu_sysstat_isr_exit(evNU_SYSSTAT_ISR_PDMA);
 }
 
 static void nu_pdma_memfun_actor_init(void)
@@ -1065,7 +1143,7 @@ static int nu_pdma_memfun_employ(void)
     return idx;
 }
 
-static int nu_pdma_memfun(void *dest, void *src, uint32_t u32DataWidth, unsigned int u32TransferCnt, nu_pdma_memctrl_t eMemCtl)
+NU_FAST_CODE static int nu_pdma_memfun(void *dest, void *src, uint32_t u32DataWidth, unsigned int u32TransferCnt, nu_pdma_memctrl_t eMemCtl)
 {
     static int i32memActorInited = 0;
 
@@ -25,6 +25,20 @@
     #error "Wrong CONFIG_DISP_LINE_BUFFER_NUMBER definition"
 #endif
 
+#define CONFIG_VRAM_TOTAL_ALLOCATED_SIZE    NVT_ALIGN((LV_HOR_RES_MAX * CONFIG_DISP_LINE_BUFFER_NUMBER * (LV_COLOR_DEPTH/8)), DCACHE_LINE_SIZE)
+
+/* Tiled rendering, LVGL renders into two SRAM tiles of these lines by turns. A finished tile is */
+/* sent to panel while the other one is rendered. */
+/* Comment it out to render into one screen-size buffer directly. */
+#define CONFIG_DISP_TILE_LINES              48
+
+#if defined(CONFIG_DISP_TILE_LINES)
+    #define CONFIG_DISP_TILE_SIZE           NVT_ALIGN((LV_HOR_RES_MAX * CONFIG_DISP_TILE_LINES * (LV_COLOR_DEPTH/8)), DCACHE_LINE_SIZE)
+#endif
+
+/* HyperRAM on SPIM1, what follows the frame buffer is heap of NU_MEM_BULK. */
+#define CONFIG_HYPERRAM_SIZE                (8*1024*1024)
+
 #define GPIO_PIN_DATA              GPIO_PIN_DATA_S
 
 /* FSA506/LT7381 EBI */
@@ -43,6 +57,7 @@
 /* ST1663I/FT5316 I2C */
 #define CONFIG_INDEV_TOUCH_I2C        I2C1
 #define CONFIG_INDEV_TOUCH_PIN_IRQ    NU_GET_PININDEX(evGF, 6)
+#define CONFIG_INDEV_TOUCH_I2C_IRQ    I2C1_IRQn      /* Comment it out for blocking reads on LVGL thread. */
 #define CONFIG_INDEV_TOUCH_PIN_RESET  NU_GET_PININDEX(evGD, 10)
 #define INDEV_TOUCH_SET_RST           GPIO_PIN_DATA(NU_GET_PORT(CONFIG_INDEV_TOUCH_PIN_RESET), NU_GET_PIN(CONFIG_INDEV_TOUCH_PIN_RESET)) = 0
 #define INDEV_TOUCH_CLR_RST           GPIO_PIN_DATA(NU_GET_PORT(CONFIG_INDEV_TOUCH_PIN_RESET), NU_GET_PIN(CONFIG_INDEV_TOUCH_PIN_RESET)) = 1
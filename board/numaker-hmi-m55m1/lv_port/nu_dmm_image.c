@@ -0,0 +1,115 @@
+/**************************************************************************//**
+ * @file     nu_dmm_image.c
+ * @brief    Images drawn in place from SPIM direct-map windows
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ * @copyright (C) 2024 Nuvoton Technology Corp. All rights reserved.
+ *****************************************************************************/
+
+#include "lv_glue.h"
+#include "nu_dmm_image.h"
+
+#define SPIM_FLASH_DIV          1
+
+/* Winbond Fast Read Quad I/O, 1-4-4 with 2 mode clocks and 4 dummy clocks. */
+static SPIM_PHASE_T s_sQuadReadCmd =
+{
+    CMD_DMA_FAST_QUAD_READ,                                                     // Command Code
+    PHASE_NORMAL_MODE, PHASE_WIDTH_8,  PHASE_DISABLE_DTR,                       // Command Phase
+    PHASE_QUAD_MODE,   PHASE_WIDTH_24, PHASE_DISABLE_DTR,                       // Address Phase
+    PHASE_QUAD_MODE,   PHASE_ORDER_MODE0, PHASE_DISABLE_DTR, SPIM_OP_DISABLE,   // Data Phase
+    4,                                                                          // Dummy Cycle Phase
+    PHASE_DISABLE_CONT_READM, PHASE_QUAD_MODE, PHASE_WIDTH_8, PHASE_DISABLE_DTR // Read Mode Phase
+};
+
+static int nu_dmm_addr_is_mapped(uint32_t u32Addr, uint32_t u32Size)
+{
+    /* Base and backed size, SPI-NOR on SPIM0 and HyperRAM on SPIM1. */
+    const uint32_t au32Windows[][2] =
+    {
+        { SPIM_DMM0_SADDR,  NU_SPIM_FLASH_DMM_SIZE },
+        { SPIM_DMM0_NSADDR, NU_SPIM_FLASH_DMM_SIZE },
+        { SPIM_DMM1_SADDR,  CONFIG_HYPERRAM_SIZE },
+        { SPIM_DMM1_NSADDR, CONFIG_HYPERRAM_SIZE },
+    };
+    int i;
+
+    for (i = 0; i < sizeof(au32Windows) / sizeof(au32Windows[0]); i++)
+    {
+        if ((u32Addr >= au32Windows[i][0]) &&
+                (u32Size <= au32Windows[i][1]) &&
+                ((u32Addr - au32Windows[i][0]) <= (au32Windows[i][1] - u32Size)))
+            return 1;
+    }
+
+    return 0;
+}
+
+/**
+ * Bring an SPI-NOR flash on the SPIM port into quad direct-map mode.
+ * Multi-function pins and SPIM/OTFC clocks are set by the caller.
+ */
+int nu_spim_flash_dmm_init(SPIM_T *spim)
+{
+    SPIM_SET_CLOCK_DIVIDER(spim, SPIM_FLASH_DIV);
+    SPIM_SET_RXCLKDLY_RDDLYSEL(spim, 0);
+    SPIM_DISABLE_CIPHER(spim);
+
+    if (SPIM_InitFlash(spim, 1) != SPIM_OK)
+    {
+        LV_LOG_ERROR("SPIM flash initialize failed");
+        return -1;
+    }
+
+    /* 3-byte addresses, see NU_SPIM_FLASH_DMM_SIZE. */
+    SPIM_Enable_4Bytes_Mode(spim, 0, 1);
+    SPIM_SetQuadEnable(spim, 1, 1);
+
+    SPIM_DMADMM_InitPhase(spim, &s_sQuadReadCmd, SPIM_CTL0_OPMODE_DIRECTMAP);
+    SPIM_EnterDirectMapMode(spim, 0, s_sQuadReadCmd.u32CMDCode, 1);
+
+    return 0;
+}
+
+/**
+ * Describe an LVGL binary image (lv_image_header_t followed by pixel data)
+ * that already sits in a SPIM direct-map window. data points straight into
+ * the window, so draw units read it in place without a load step or heap.
+ *
+ * Compressed images are rejected, they have to be decoded into RAM.
+ */
+int nu_dmm_image_dsc_init(lv_image_dsc_t *psImgDsc, const void *pvMapped, uint32_t u32Size)
+{
+    const lv_image_header_t *psHeader = (const lv_image_header_t *)pvMapped;
+    uint32_t u32Stride;
+
+    LV_ASSERT_NULL(psImgDsc);
+
+    if (!pvMapped ||
+            (u32Size <= sizeof(lv_image_header_t)) ||
+            !nu_dmm_addr_is_mapped((uint32_t)pvMapped, u32Size) ||
+            ((uint32_t)pvMapped % 4))
+        goto exit_nu_dmm_image_dsc_init;
+
+    if ((psHeader->magic != LV_IMAGE_HEADER_MAGIC) ||
+            (psHeader->flags & LV_IMAGE_FLAGS_COMPRESSED))
+        goto exit_nu_dmm_image_dsc_init;
+
+    u32Stride = psHeader->stride ? psHeader->stride : lv_draw_buf_width_to_stride(psHeader->w, psHeader->cf);
+    if ((u32Stride * psHeader->h) > (u32Size - sizeof(lv_image_header_t)))
+        goto exit_nu_dmm_image_dsc_init;
+
+    lv_memzero(psImgDsc, sizeof(lv_image_dsc_t));
+    psImgDsc->header        = *psHeader;
+    psImgDsc->header.stride = u32Stride;
+    psImgDsc->data_size     = u32Size - sizeof(lv_image_header_t);
+    psImgDsc->data          = (const uint8_t *)pvMapped + sizeof(lv_image_header_t);
+
+    return 0;
+
+exit_nu_dmm_image_dsc_init:
+
+    LV_LOG_WARN("Not an in-place image at %p", pvMapped);
+
+    return -1;
+}
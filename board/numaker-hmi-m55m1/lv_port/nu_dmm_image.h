@@ -0,0 +1,41 @@
+/**************************************************************************//**
+ * @file     nu_dmm_image.h
+ * @brief    Images drawn in place from SPIM direct-map windows
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ * @copyright (C) 2024 Nuvoton Technology Corp. All rights reserved.
+ *****************************************************************************/
+#ifndef __NU_DMM_IMAGE_H__
+#define __NU_DMM_IMAGE_H__
+
+#include "NuMicro.h"
+#include "lvgl.h"
+
+/*
+ * Const assets tagged with NU_DMM_ASSET are linked into the .nu_dmm_assets
+ * section, which the scatter/linker files locate at the SPIM0 direct-map
+ * window. The programming tool writes them to the external SPI-NOR flash and
+ * LVGL reads pixels through DMM, so nothing is copied to SRAM.
+ *
+ * Define USE_SPIM_FLASH_AS_ASSETS in the project to map SPIM0 at start-up.
+ * Without it, the section stays empty and the assets are linked into internal
+ * flash as usual.
+ */
+#if defined(USE_SPIM_FLASH_AS_ASSETS)
+    #if defined(__ICCARM__)
+        #define NU_DMM_ASSET        _Pragma("location=\".nu_dmm_assets\"") _Pragma("data_alignment=4")
+    #else
+        #define NU_DMM_ASSET        __attribute__((section(".nu_dmm_assets"), aligned(4)))
+    #endif
+#else
+    #define NU_DMM_ASSET
+#endif
+
+/* The SPI-NOR is read with 3-byte addresses, so only the first 16 MB of the
+   SPIM0 window are backed. The SPIM0_DMM region of the linker files matches it. */
+#define NU_SPIM_FLASH_DMM_SIZE      (16 * 1024 * 1024)
+
+int nu_spim_flash_dmm_init(SPIM_T *spim);
+int nu_dmm_image_dsc_init(lv_image_dsc_t *psImgDsc, const void *pvMapped, uint32_t u32Size);
+
+#endif /* __NU_DMM_IMAGE_H__ */
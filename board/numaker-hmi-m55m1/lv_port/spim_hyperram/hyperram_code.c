@@ -16,6 +16,15 @@
 #define DMM_MODE_TRIM
 #define DLL_TRIM_SIZE               32
 
+/* Burst length of DMA clear and verify. */
+#define HYPERRAM_BURST_SIZE         4096
+
+/* One flash page keeps the trimmed DLL delay step number.
+   The last APROM page is left out of FLASH in the GCC, VSCode, IAR and Keil linker files. */
+#if !defined(CONFIG_HYPERRAM_DLL_RECORD_ADDR)
+    #define CONFIG_HYPERRAM_DLL_RECORD_ADDR     (FMC_APROM_END - FMC_FLASH_PAGE_SIZE)
+#endif
+
 #define SPIM_HYPER_DIV              1
 
 #define HYPERRAM_CSM_TIME           4000 /* ns */
@@ -70,23 +79,55 @@ void SPIM_Hyper_DefaultConfig(SPIM_T *spim, uint32_t u32CSM, uint32_t u32AcctRD,
  * @param spim
  * @param u32StartAddr  erase start address
  * @param u32EraseSize  erase size
+ * @note  SPIM is left in I/O mode, enter direct map mode again before DMM access.
  */
 void HyperRAM_Erase(SPIM_T *spim, uint32_t u32StartAddr, uint32_t u32EraseSize)
 {
-    uint16_t u16Data;
-    uint32_t u32i = 0;
+    static uint32_t s_au32Zero[HYPERRAM_BURST_SIZE / 4] __attribute__((aligned(DCACHE_LINE_SIZE))) = {0};
+    static uint32_t s_au32Check[HYPERRAM_BURST_SIZE / 4] __attribute__((aligned(DCACHE_LINE_SIZE)));
+    uint32_t u32Offset, u32Len, u32i;
     uint32_t u32RemainSize = (u32EraseSize % 2);
+    uint16_t u16Data;
 
-    for (u32i = 0; u32i <= (u32EraseSize - u32RemainSize); u32i += 2)
+#ifdef NVT_DCACHE_ON
+    SCB_CleanDCache_by_Addr((volatile void *)s_au32Zero, (int32_t)sizeof(s_au32Zero));
+#endif
+
+    /* Clear in DMA bursts, then read back in DMA bursts. */
+    for (u32Offset = 0; u32Offset < (u32EraseSize - u32RemainSize); u32Offset += u32Len)
     {
-        SPIM_HYPER_Write2Byte(spim, (u32StartAddr + u32i), 0x0000);
-        u16Data = SPIM_HYPER_Read1Word(spim, (u32StartAddr + u32i));
+        u32Len = u32EraseSize - u32RemainSize - u32Offset;
+        if (u32Len > HYPERRAM_BURST_SIZE)
+            u32Len = HYPERRAM_BURST_SIZE;
+
+        if (SPIM_HYPER_DMAWrite(spim, u32StartAddr + u32Offset, (uint8_t *)s_au32Zero, u32Len) != SPIM_HYPER_OK)
+            goto exit_HyperRAM_Erase;
+    }
 
-        if (u16Data != 0x0000)
+    for (u32Offset = 0; u32Offset < (u32EraseSize - u32RemainSize); u32Offset += u32Len)
+    {
+        u32Len = u32EraseSize - u32RemainSize - u32Offset;
+        if (u32Len > HYPERRAM_BURST_SIZE)
+            u32Len = HYPERRAM_BURST_SIZE;
+
+#ifdef NVT_DCACHE_ON
+        SCB_InvalidateDCache_by_Addr((volatile void *)s_au32Check, (int32_t)sizeof(s_au32Check));
+#endif
+
+        if (SPIM_HYPER_DMARead(spim, u32StartAddr + u32Offset, (uint8_t *)s_au32Check, u32Len) != SPIM_HYPER_OK)
+            goto exit_HyperRAM_Erase;
+
+#ifdef NVT_DCACHE_ON
+        SCB_InvalidateDCache_by_Addr((volatile void *)s_au32Check, (int32_t)sizeof(s_au32Check));
+#endif
+
+        if (memcmp(s_au32Check, s_au32Zero, u32Len))
         {
+            for (u32i = 0; (u32i < u32Len / 4) && (s_au32Check[u32i] == 0); u32i++);
+
             printf("Erase Hyper RAM fail!! Read address:0x%08x, data::0x%08x  expect: 0\n",
-                   u32StartAddr + u32i,
-                   u16Data);
+                   u32StartAddr + u32Offset + (u32i * 4),
+                   s_au32Check[u32i]);
 
             while (1);
         }
@@ -95,7 +136,7 @@ void HyperRAM_Erase(SPIM_T *spim, uint32_t u32StartAddr, uint32_t u32EraseSize)
     if (u32RemainSize != 0)
     {
         SPIM_HYPER_Write1Byte(spim, (u32StartAddr + (u32EraseSize - 1)), 0x00);
-        u16Data = SPIM_HYPER_Read1Word(spim, (u32StartAddr + u32EraseSize));
+        u16Data = SPIM_HYPER_Read1Word(spim, (u32StartAddr + (u32EraseSize - 1)));
 
         if ((u16Data & 0xFF) != 0)
         {
@@ -106,83 +147,183 @@ void HyperRAM_Erase(SPIM_T *spim, uint32_t u32StartAddr, uint32_t u32EraseSize)
             while (1);
         }
     }
+
+    return;
+
+exit_HyperRAM_Erase:
+
+    printf("Erase Hyper RAM fail!! DMA timeout at address:0x%08x\n", u32StartAddr + u32Offset);
+
+    while (1);
 }
 
+static const uint8_t s_au8TrimPatten[DLL_TRIM_SIZE] =
+{
+    0xFF, 0x0F, 0xFF, 0x00, 0xFF, 0xCC, 0xC3, 0xCC, 0xC3, 0x3C, 0xCC, 0xFF, 0xFE, 0xFF, 0xFE, 0xEF,
+    0xFF, 0xDF, 0xFF, 0xDD, 0xFF, 0xFB, 0xFF, 0xFB, 0xBF, 0xFF, 0x7F, 0xFF, 0x77, 0xF7, 0xBD, 0xEF,
+};
+
 /**
- * @brief Trim DLL component delay stop number
+ * @brief Check the trim pattern at HyperRAM address 0 with a DLL delay step number
  *
  * @param spim
+ * @param u8RdDelay  delay step number
+ * @return 0 on pass, -1 on fail.
  */
-void HyperRAM_TrimDLLDelayNumber(SPIM_T *spim)
+static int HyperRAM_CheckDLLDelayNumber(SPIM_T *spim, uint8_t u8RdDelay)
 {
-    uint8_t u8RdDelay = 0;
-    uint8_t u8RdDelayIdx = 0;
-    uint8_t u8RdDelayRes[SPIM_MAX_DLL_LATENCY] = {0};
-    uint32_t u32i = 0;
-    uint32_t u32SrcAddr = 0;
-    uint8_t au8TrimPatten[128] =
-    {
-        0xFF, 0x0F, 0xFF, 0x00, 0xFF, 0xCC, 0xC3, 0xCC, 0xC3, 0x3C, 0xCC, 0xFF, 0xFE, 0xFF, 0xFE, 0xEF,
-        0xFF, 0xDF, 0xFF, 0xDD, 0xFF, 0xFB, 0xFF, 0xFB, 0xBF, 0xFF, 0x7F, 0xFF, 0x77, 0xF7, 0xBD, 0xEF,
-        0xFF, 0xF0, 0xFF, 0xF0, 0x0F, 0xFC, 0xCC, 0x3C, 0xCC, 0x33, 0xCC, 0xCF, 0xFE, 0xFF, 0xFF, 0xEE,
-        0xFF, 0xFD, 0xFF, 0xFD, 0xDF, 0xFF, 0xBF, 0xFF, 0xBB, 0xFF, 0xF7, 0xFF, 0xF7, 0x7F, 0x7B, 0xDE,
-        0xFF, 0x0F, 0xFF, 0x00, 0xFF, 0xCC, 0xC3, 0xCC, 0xC3, 0x3C, 0xCC, 0xFF, 0xFE, 0xFF, 0xFE, 0xEF,
-        0xFF, 0xDF, 0xFF, 0xDD, 0xFF, 0xFB, 0xFF, 0xFB, 0xBF, 0xFF, 0x7F, 0xFF, 0x77, 0xF7, 0xBD, 0xEF,
-        0xFF, 0xF0, 0xFF, 0xF0, 0x0F, 0xFC, 0xCC, 0x3C, 0xCC, 0x33, 0xCC, 0xCF, 0xFE, 0xFF, 0xFF, 0xEE,
-        0xFF, 0xFD, 0xFF, 0xFD, 0xDF, 0xFF, 0xBF, 0xFF, 0xBB, 0xFF, 0xF7, 0xFF, 0xF7, 0x7F, 0x7B, 0xDE,
-    };
-    uint8_t au8DestArray[DLL_TRIM_SIZE] = {0};
+    uint8_t au8DestArray[DLL_TRIM_SIZE] __attribute__((aligned(4))) = {0};
 #ifdef DMM_MODE_TRIM
     uint32_t u32DMMAddr = SPIM_HYPER_GetDMMAddress(spim);
-    uint32_t *pu32RdBuf = NULL;
+    uint32_t *pu32RdBuf = (uint32_t *)&au8DestArray[0];
     uint32_t u32RdDataCnt = 0;
+    uint32_t u32i;
 #endif
 
-    SPIM_HYPER_EnableDLL(spim);
+    /* Set DLL calibration to select the valid delay step number */
+    if (SPIM_HYPER_SetDLLDelayNum(spim, u8RdDelay) != SPIM_HYPER_OK)
+    {
+        printf("DLL Config Failed\r\n");
+    }
 
-    /* Write Data to HyperRAM */
-    for (u32i = u32SrcAddr; u32i < DLL_TRIM_SIZE; u32i++)
+#ifndef DMM_MODE_TRIM
+    /* Read Data from HyperRAM */
+    SPIM_HYPER_DMARead(spim, 0, au8DestArray, DLL_TRIM_SIZE);
+#else
+
+#ifdef NVT_DCACHE_ON
+    SCB_InvalidateDCache_by_Addr((volatile void *)u32DMMAddr, (int32_t)DLL_TRIM_SIZE);
+#endif
+
+    for (u32i = 0; u32i < DLL_TRIM_SIZE; u32i += 4)
     {
-        SPIM_HYPER_Write1Byte(spim, u32i, au8TrimPatten[u32i]);
+        pu32RdBuf[u32RdDataCnt++] = inpw(u32DMMAddr + u32i);
     }
 
-#ifdef DMM_MODE_TRIM
-    SPIM_HYPER_EnterDirectMapMode(spim);
 #endif
 
-    for (u8RdDelay = 0; u8RdDelay < SPIM_HYPER_MAX_LATENCY; u8RdDelay++)
+    return memcmp(s_au8TrimPatten, au8DestArray, DLL_TRIM_SIZE) ? -1 : 0;
+}
+
+/*
+ * The trimmed delay step number is kept in one flash page. It is valid
+ * only for the same SPIM and the same SCLK frequency.
+ */
+typedef struct
+{
+    uint32_t u32Magic;
+    uint32_t u32SpimBase;
+    uint32_t u32SclkFreq;
+    uint32_t u32DelayNum;
+    uint32_t u32Check;
+} S_DLL_TRIM_RECORD;
+
+#define DLL_TRIM_RECORD_MAGIC       0x544C4C44  /* "DLLT" */
+#define DLL_TRIM_RECORD_WORDS       (sizeof(S_DLL_TRIM_RECORD) / 4)
+
+static uint32_t HyperRAM_DLLRecordCheck(const S_DLL_TRIM_RECORD *psRecord)
+{
+    return ~(psRecord->u32Magic ^ psRecord->u32SpimBase ^ psRecord->u32SclkFreq ^ psRecord->u32DelayNum);
+}
+
+static int HyperRAM_LoadDLLRecord(SPIM_T *spim, uint8_t *pu8DelayNum)
+{
+    S_DLL_TRIM_RECORD sRecord;
+    uint32_t *pu32Record = (uint32_t *)&sRecord;
+    uint32_t u32i;
+
+    SYS_UnlockReg();
+    FMC_Open();
+
+    for (u32i = 0; u32i < DLL_TRIM_RECORD_WORDS; u32i++)
+        pu32Record[u32i] = FMC_Read(CONFIG_HYPERRAM_DLL_RECORD_ADDR + (u32i * 4));
+
+    FMC_Close();
+    SYS_LockReg();
+
+    if ((sRecord.u32Magic != DLL_TRIM_RECORD_MAGIC) ||
+            (sRecord.u32Check != HyperRAM_DLLRecordCheck(&sRecord)) ||
+            (sRecord.u32SpimBase != (uint32_t)spim) ||
+            (sRecord.u32SclkFreq != CLK_GetSCLKFreq()) ||
+            (sRecord.u32DelayNum >= SPIM_HYPER_MAX_LATENCY))
     {
-        /* Set DLL calibration to select the valid delay step number */
-        if (SPIM_HYPER_SetDLLDelayNum(spim, u8RdDelay) != SPIM_HYPER_OK)
-        {
-            printf("DLL Config Failed\r\n");
-        }
+        return -1;
+    }
 
-        memset(au8DestArray, 0, DLL_TRIM_SIZE);
+    *pu8DelayNum = (uint8_t)sRecord.u32DelayNum;
 
-        pu32RdBuf = (uint32_t *)&au8DestArray[0];
-        u32RdDataCnt = 0;
+    return 0;
+}
 
-#ifndef DMM_MODE_TRIM
-        /* Read Data from HyperRAM */
-        SPIM_HYPER_DMARead(spim, u32SrcAddr, au8DestArray, u32TestSize);
-#else
+static void HyperRAM_SaveDLLRecord(SPIM_T *spim, uint8_t u8DelayNum)
+{
+    S_DLL_TRIM_RECORD sRecord;
+    uint32_t *pu32Record = (uint32_t *)&sRecord;
+    uint32_t u32i;
 
-#ifdef NVT_DCACHE_ON
-        SCB_InvalidateDCache_by_Addr((volatile void *)u32DMMAddr, (int32_t)DLL_TRIM_SIZE);
-#endif
+    sRecord.u32Magic = DLL_TRIM_RECORD_MAGIC;
+    sRecord.u32SpimBase = (uint32_t)spim;
+    sRecord.u32SclkFreq = CLK_GetSCLKFreq();
+    sRecord.u32DelayNum = u8DelayNum;
+    sRecord.u32Check = HyperRAM_DLLRecordCheck(&sRecord);
 
-        for (u32i = u32SrcAddr; u32i < (u32SrcAddr + DLL_TRIM_SIZE); u32i += 4)
-        {
-            pu32RdBuf[u32RdDataCnt++] = inpw(u32DMMAddr + u32i);
-        }
+    SYS_UnlockReg();
+    FMC_Open();
+    FMC_ENABLE_AP_UPDATE();
+
+    if (FMC_Erase(CONFIG_HYPERRAM_DLL_RECORD_ADDR) != 0)
+        goto exit_HyperRAM_SaveDLLRecord;
+
+    for (u32i = 0; u32i < DLL_TRIM_RECORD_WORDS; u32i++)
+    {
+        if (FMC_Write(CONFIG_HYPERRAM_DLL_RECORD_ADDR + (u32i * 4), pu32Record[u32i]) != 0)
+            goto exit_HyperRAM_SaveDLLRecord;
+    }
+
+exit_HyperRAM_SaveDLLRecord:
 
+    FMC_DISABLE_AP_UPDATE();
+    FMC_Close();
+    SYS_LockReg();
+}
+
+/**
+ * @brief Trim DLL component delay stop number
+ *
+ * @param spim
+ */
+void HyperRAM_TrimDLLDelayNumber(SPIM_T *spim)
+{
+    uint8_t u8RdDelay = 0;
+    uint8_t u8RdDelayIdx = 0;
+    uint8_t u8RdDelayRes[SPIM_MAX_DLL_LATENCY] = {0};
+    uint32_t u32i = 0;
+
+    SPIM_HYPER_EnableDLL(spim);
+
+    /* Write Data to HyperRAM */
+    for (u32i = 0; u32i < DLL_TRIM_SIZE; u32i++)
+    {
+        SPIM_HYPER_Write1Byte(spim, u32i, s_au8TrimPatten[u32i]);
+    }
+
+#ifdef DMM_MODE_TRIM
+    SPIM_HYPER_EnterDirectMapMode(spim);
 #endif
 
+    /* Re-validate the stored step number, sweep all steps only on mismatch. */
+    if ((HyperRAM_LoadDLLRecord(spim, &u8RdDelay) == 0) &&
+            (HyperRAM_CheckDLLDelayNumber(spim, u8RdDelay) == 0))
+    {
+        printf("Set DLL Delay Num : %d (stored)\r\n", u8RdDelay);
+        return;
+    }
+
+    for (u8RdDelay = 0; u8RdDelay < SPIM_HYPER_MAX_LATENCY; u8RdDelay++)
+    {
         /* Verify the data and save the number of successful delay steps */
-        if (memcmp(au8TrimPatten, au8DestArray, DLL_TRIM_SIZE))
+        if (HyperRAM_CheckDLLDelayNumber(spim, u8RdDelay) != 0)
         {
-            //printf("!!!\tData compare failed at block 0x%x\n", u32SrcAddr);
             printf("Delay Step Num : %d = Fail\r\n", u8RdDelay);
         }
         else
@@ -197,20 +338,19 @@ void HyperRAM_TrimDLLDelayNumber(SPIM_T *spim)
         }
     }
 
-    if (u8RdDelayIdx <= 1)
-    {
-        u8RdDelayIdx = 0;
-    }
-    else
+    /* Nothing passed, keep flash record untouched. */
+    if (u8RdDelayIdx > 0)
     {
-        if (u8RdDelayIdx >= 2)
+        if (u8RdDelayIdx <= 1)
         {
-            u8RdDelayIdx = (u8RdDelayIdx / 2) - 1;
+            u8RdDelayIdx = 0;
         }
         else
         {
-            u8RdDelayIdx = 1;
+            u8RdDelayIdx = (u8RdDelayIdx / 2) - 1;
         }
+
+        HyperRAM_SaveDLLRecord(spim, u8RdDelayRes[u8RdDelayIdx]);
     }
 
     /* Set the number of intermediate delay steps */
@@ -18,6 +18,10 @@
 //------------------------------------------------------------------------------
 void HyperRAM_Init(SPIM_T *spim);
 
+/* Zero and verify a range by DMA. Not called at boot, LVGL draws the whole
+   frame buffer on its first refresh and the heap makes no zero promise. */
+void HyperRAM_Erase(SPIM_T *spim, uint32_t u32StartAddr, uint32_t u32EraseSize);
+
 #endif  /* __HYPER_RAM_CODE_H__ */
 
 /*** (C) COPYRIGHT 2023 Nuvoton Technology Corp. ***/
\ No newline at end of file
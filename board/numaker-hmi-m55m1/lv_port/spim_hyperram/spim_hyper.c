@@ -508,7 +508,6 @@ int32_t SPIM_HYPER_DMAWrite(SPIM_T *spim, uint32_t u32Addr, uint8_t *pu8WrBuf, u
     return SPIM_HYPER_OK;
 }
 
-#if 0 //(TESTCHIP_ONLY)
 /**
   * @brief  Read data from HyperBus Module.
   * @param  spim
@@ -534,7 +533,6 @@ int32_t SPIM_HYPER_DMARead(SPIM_T *spim, uint32_t u32Addr, uint8_t *pu8RdBuf, ui
 
     return SPIM_HYPER_OK;
 }
-#endif
 
 /**
   * @brief  SPIM Hyper Mode Enter DMM Mode
@@ -7,6 +7,14 @@
  ******************************************************************************/
 
 #include "lv_glue.h"
+#include "nu_heap.h"
+#include "nu_dmm_image.h"
+#include "lv_port/spim_hyperram/hyperram_code.h"
+
+/* Internal SRAM heap, shared by FreeRTOS and small LVGL objects. */
+#define CONFIG_HEAP_FAST_SIZE   (configTOTAL_HEAP_SIZE + CONFIG_LV_MEM_SIZE)
+
+static uint8_t s_au8HeapFast[CONFIG_HEAP_FAST_SIZE] __attribute__((aligned(DCACHE_LINE_SIZE)));
 
 #if defined(NVT_DCACHE_ON)
 enum { DEVICE_IDX, CODE_IDX, DATA_IDX, DEVICE_MEMORY_IDX };
@@ -169,11 +177,53 @@ static void sys_init(void)
     GPIO_SetSlewCtl(PH, (BIT12 | BIT13 | BIT14 | BIT15), GPIO_SLEWCTL_FAST1);
     GPIO_SetSlewCtl(PJ, (BIT2 | BIT3 | BIT4 | BIT5 | BIT6 | BIT7), GPIO_SLEWCTL_FAST1);
 
-    extern void HyperRAM_Init(SPIM_T * spim);
     HyperRAM_Init(SPIM1);
 
     SPIM_HYPER_EnterDirectMapMode(SPIM1);
 #endif
+
+#if defined(USE_SPIM_FLASH_AS_ASSETS)
+    /* Enable SPIM module clock */
+    CLK_EnableModuleClock(SPIM0_MODULE);
+
+    /* Enable SPIM module clock */
+    CLK_EnableModuleClock(OTFC0_MODULE);
+
+    /* Init SPIM multi-function pins, PC0~PC5 are taken by EBI on NuMaker-HMI-M55M1. */
+    SET_SPIM0_MOSI_PA0();
+    SET_SPIM0_MISO_PA1();
+    SET_SPIM0_CLK_PA2();
+    SET_SPIM0_SS_PA3();
+    SET_SPIM0_D3_PA4();
+    SET_SPIM0_D2_PA5();
+
+    PA->SMTEN |= (GPIO_SMTEN_SMTEN0_Msk |
+                  GPIO_SMTEN_SMTEN1_Msk |
+                  GPIO_SMTEN_SMTEN2_Msk |
+                  GPIO_SMTEN_SMTEN3_Msk |
+                  GPIO_SMTEN_SMTEN4_Msk |
+                  GPIO_SMTEN_SMTEN5_Msk);
+
+    /* Set SPIM I/O pins as high slew rate. */
+    GPIO_SetSlewCtl(PA, (BIT0 | BIT1 | BIT2 | BIT3 | BIT4 | BIT5), GPIO_SLEWCTL_FAST1);
+
+    nu_spim_flash_dmm_init(SPIM0);
+#endif
+}
+
+static void heap_init(void)
+{
+    nu_heap_add_region(s_au8HeapFast, sizeof(s_au8HeapFast), NU_MEM_FAST | NU_MEM_DMA);
+
+#if defined(USE_HYPERRAM_AS_FRAMEBUFFER) && defined(CONFIG_DISP_TILE_LINES)
+    /* Tiles are in SRAM and the panel keeps its own GRAM, all of HyperRAM is for large buffers. */
+    nu_heap_add_region((void *)SPIM_DMM1_SADDR, CONFIG_HYPERRAM_SIZE, NU_MEM_BULK | NU_MEM_DMA);
+#elif defined(USE_HYPERRAM_AS_FRAMEBUFFER)
+    /* Large draw and layer buffers go behind the frame buffer. */
+    nu_heap_add_region((void *)(SPIM_DMM1_SADDR + CONFIG_VRAM_TOTAL_ALLOCATED_SIZE),
+                       CONFIG_HYPERRAM_SIZE - CONFIG_VRAM_TOTAL_ALLOCATED_SIZE,
+                       NU_MEM_BULK | NU_MEM_DMA);
+#endif
 }
 
 int main(void)
@@ -182,6 +232,8 @@ int main(void)
 
     sys_init();
 
+    heap_init();
+
     task_lv_init();
 
     /* Start scheduling. */
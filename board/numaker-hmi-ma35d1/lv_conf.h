@@ -12,7 +12,26 @@
 #define LV_NUVOTON_INCLUDE     "MA35D1.h"
 #include LV_NUVOTON_INCLUDE
 
-#define LV_USE_OS   LV_OS_NONE
+#define LV_USE_OS   LV_OS_FREERTOS
+
+/* Draw units are threads at LV_THREAD_PRIO_HIGH, rendering overlaps the flush task. FreeRTOS */
+/* runs on one core here, so more units only add switching; raise it with more cores to run on. */
+#define LV_DRAW_SW_DRAW_UNIT_CNT        1
+#define LV_DRAW_THREAD_STACK_SIZE       (16*1024)
+
+/* Core 1 draws plain fills and layer blends beside the software unit, see common/drv_draw/core1. */
+//#define LV_USE_DRAW_CORE1               1
+
+#define LV_DRAW_BUF_STRIDE_ALIGN        4
+
+/* Layer buffers in DDR, 1.375 MB sized for 32-bit color, see common/nu_layer_pool.h. */
+#define CONFIG_NU_LAYER_POOL            1
+#define CONFIG_NU_LAYER_POOL_SMALL_SIZE     (32 * 1024)
+#define CONFIG_NU_LAYER_POOL_SMALL_NUM      4
+#define CONFIG_NU_LAYER_POOL_MEDIUM_SIZE    (128 * 1024)
+#define CONFIG_NU_LAYER_POOL_MEDIUM_NUM     2
+#define CONFIG_NU_LAYER_POOL_LARGE_SIZE     (512 * 1024)
+#define CONFIG_NU_LAYER_POOL_LARGE_NUM      1
 
 #if defined(__1024x600__)
     #define LV_HOR_RES_MAX              1024
@@ -54,6 +73,7 @@
 
 /* Please comment LV_USE_DEMO_MUSIC declaration before un-comment below */
 #define LV_USE_DEMO_WIDGETS             1
+//#define LV_USE_DEMO_BENCHMARK           1
 //#define LV_USE_DEMO_MUSIC             1
 #if LV_USE_DEMO_MUSIC
     #define LV_DEMO_MUSIC_AUTO_PLAY     1
@@ -8,10 +8,18 @@
 
 #include "lvgl.h"
 #include "lv_glue.h"
+#include "nu_sysstat.h"
+#include "nu_dcache.h"
+
+#if (CONFIG_LV_DISP_FULL_REFRESH==0)
+    #include "queue.h"
+    #include "drv_pdma.h"
+#endif
 
 #define CONFIG_VRAM_TOTAL_ALLOCATED_SIZE    NVT_ALIGN((LV_HOR_RES_MAX * LV_VER_RES_MAX * (LV_COLOR_DEPTH/8) * CONFIG_LCD_FB_NUM), 128)
 
 static uint8_t s_au8FrameBuf[CONFIG_VRAM_TOTAL_ALLOCATED_SIZE] __attribute__((aligned(128)));
+static S_NU_DCACHE_DIRTY s_sFrameDirty;
 
 #if defined(__1024x600__)
 S_CALIBRATION_MATRIX g_sCalMat = { -17558, 1, 69298832, -10, 11142, -2549195, 65536 };
@@ -68,8 +76,78 @@ static void lcd_disp_handler(void)
 }
 #endif
 
+#if (CONFIG_LV_DISP_FULL_REFRESH==0)
+
+#define CONFIG_DISP_FLUSH_TASK_STACKSIZE    1024
+#define CONFIG_DISP_FLUSH_TASK_PRIORITY     (tskIDLE_PRIORITY + LV_THREAD_PRIO_HIGHEST)
+
+typedef struct
+{
+    lv_area_t sArea;
+    void *pvPixels;
+} S_DISP_FLUSH_JOB;
+
+static QueueHandle_t s_xFlushQueue = NULL;
+static SemaphoreHandle_t s_xFlushDone = NULL;
+
+/* Copy a rendered area into the frame buffer by PDMA, the task sleeps on its completion. */
+static void disp_flush_copy(const S_DISP_FLUSH_JOB *psJob)
+{
+    const uint32_t u32BytePerPixel = LV_COLOR_DEPTH / 8;
+    const uint32_t u32FrameStride = LV_HOR_RES_MAX * u32BytePerPixel;
+    int32_t w = lv_area_get_width(&psJob->sArea);
+    int32_t h = lv_area_get_height(&psJob->sArea);
+    uint32_t u32LineSize = w * u32BytePerPixel;
+    uint8_t *pu8Dst = s_au8FrameBuf + (psJob->sArea.y1 * u32FrameStride) + (psJob->sArea.x1 * u32BytePerPixel);
+    uint8_t *pu8Src = (uint8_t *)psJob->pvPixels;
+    int32_t y;
+
+    /* Full-width lines are contiguous on both sides, one transfer. */
+    if (u32LineSize == u32FrameStride)
+    {
+        nu_pdma_memcpy(pu8Dst, pu8Src, u32LineSize * h);
+        return;
+    }
+
+    for (y = 0; y < h; y++)
+    {
+        nu_pdma_memcpy(pu8Dst, pu8Src, u32LineSize);
+        pu8Dst += u32FrameStride;
+        pu8Src += u32LineSize;
+    }
+}
+
+static void disp_flush_task(void *pvParameters)
+{
+    S_DISP_FLUSH_JOB sJob;
+
+    for (;;)
+    {
+        while (xQueueReceive(s_xFlushQueue, &sJob, portMAX_DELAY) != pdTRUE);
+
+        /* LVGL renders into the other shadow buffer meanwhile. */
+        disp_flush_copy(&sJob);
+
+        xSemaphoreGive(s_xFlushDone);
+    }
+}
+
+static void disp_flush_init(void)
+{
+    s_xFlushQueue = xQueueCreate(1, sizeof(S_DISP_FLUSH_JOB));
+    LV_ASSERT(s_xFlushQueue != NULL);
+
+    s_xFlushDone = xSemaphoreCreateBinary();
+    LV_ASSERT(s_xFlushDone != NULL);
+
+    LV_ASSERT(xTaskCreate(disp_flush_task, "disp_flush", CONFIG_DISP_FLUSH_TASK_STACKSIZE, NULL, CONFIG_DISP_FLUSH_TASK_PRIORITY, NULL) == pdPASS);
+}
+#endif
+
 int lcd_device_initialize(void)
 {
+    nu_dcache_dirty_init(&s_sFrameDirty, s_au8FrameBuf, LV_HOR_RES_MAX, LV_VER_RES_MAX * CONFIG_LCD_FB_NUM, LV_COLOR_DEPTH / 8);
+
     /* Unlock protected registers */
     SYS_UnlockReg();
 
@@ -94,6 +172,8 @@ int lcd_device_initialize(void)
     IRQ_SetHandler((IRQn_ID_t)DISP_IRQn, lcd_disp_handler);
     IRQ_Enable((IRQn_ID_t)DISP_IRQn);
     DISP_ENABLE_INT();
+#else
+    disp_flush_init();
 #endif
 
     return 0;
@@ -147,10 +227,40 @@ int lcd_device_control(int cmd, void *argv)
 
     case evLCD_CTRL_RECT_UPDATE:
     {
-        dcache_clean_by_mva(s_au8FrameBuf, CONFIG_VRAM_TOTAL_ALLOCATED_SIZE);
+        const lv_area_t *psArea = (const lv_area_t *)argv;
+
+        /* Clean the lines of the updated area only, all frame buffers without one. */
+        if (psArea != NULL)
+            nu_dcache_dirty_mark(&s_sFrameDirty, psArea->x1, psArea->y1, psArea->x2, psArea->y2);
+        else
+            nu_dcache_dirty_mark_all(&s_sFrameDirty);
+
+        nu_dcache_dirty_flush(&s_sFrameDirty, evNU_DCACHE_CLEAN);
     }
     break;
 
+#if (CONFIG_LV_DISP_FULL_REFRESH==0)
+    case evLCD_CTRL_TILE_UPDATE:
+    {
+        S_LCD_TILE *psTile = (S_LCD_TILE *)argv;
+        S_DISP_FLUSH_JOB sJob;
+
+        LV_ASSERT(argv != NULL);
+
+        lv_area_copy(&sJob.sArea, (const lv_area_t *)psTile->pvArea);
+        sJob.pvPixels = psTile->pvPixels;
+
+        while (xQueueSend(s_xFlushQueue, &sJob, portMAX_DELAY) != pdTRUE);
+    }
+    break;
+
+    case evLCD_CTRL_TILE_WAIT:
+    {
+        while (xSemaphoreTake(s_xFlushDone, portMAX_DELAY) != pdTRUE);
+    }
+    break;
+#endif
+
     default:
         LV_ASSERT(0);
     }
@@ -191,7 +301,11 @@ static volatile E_ADT_Mode s_evADTMode = evADT_Idle;
 
 static void ADC0_IRQHandler(void)
 {
-    uint32_t u32ISR = ADC0->ISR;
+    uint32_t u32ISR;
+
+    nu_sysstat_isr_enter();
+
+    u32ISR = ADC0->ISR;
     if ((u32ISR & ADC_ISR_PEDEF_Msk) == ADC_ISR_PEDEF_Msk)
     {
         // Clear interrupt flag
@@ -199,6 +313,9 @@ static void ADC0_IRQHandler(void)
         ADC_DisableInt(ADC0, ADC_IER_PEDEIEN_Msk);
 
         s_evADTMode = evADT_PD_GOTO_XY;
+
+        /* Pen down, start conversion without waiting for next polling period. */
+        nu_lv_task_wakeup_from_isr(NU_LV_WAKEUP_INPUT);
     }
     else if ((u32ISR & ADC_ISR_MF_Msk) == ADC_ISR_MF_Msk)
     {
@@ -206,6 +323,8 @@ static void ADC0_IRQHandler(void)
         ADC_CLR_INT_FLAG(ADC0, ADC_ISR_MF_Msk);
         s_evADTMode = evADT_XYConvert_Done;
     }
+
+    nu_sysstat_isr_exit(evNU_SYSSTAT_ISR_TOUCH);
 }
 
 
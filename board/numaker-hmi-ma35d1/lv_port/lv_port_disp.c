@@ -28,28 +28,19 @@ static void lv_port_disp_full(lv_display_t *disp, const lv_area_t *area, uint8_t
 static void *buf3_next = NULL;
 static void lv_port_disp_partial(lv_display_t *disp, const lv_area_t *area, uint8_t *px_map)
 {
+    S_LCD_TILE sTile;
 
-    S_LCD_INFO *psLCDInfo = (S_LCD_INFO *)lv_display_get_driver_data(disp);
-
-    /* Update dirty region. */
-    int32_t x, y;
-    int32_t w = lv_area_get_width(area);
-    int32_t h = lv_area_get_height(area);
-    uint32_t *pDisp = (uint32_t *)nc_ptr(psLCDInfo->pvVramStartAddr + (LV_HOR_RES_MAX * area->y1 + area->x1) * sizeof(uint32_t));
-    uint32_t *pSrc = (uint32_t *)px_map;
-
-    for (y = 0; y < h; y++)
-    {
-        for (x = 0; x < w; x++)
-        {
-            pDisp[x] = pSrc[x];
-        }
-        pDisp += LV_HOR_RES_MAX;
-        pSrc += w;
-    }
+    sTile.pvArea = area;
+    sTile.pvPixels = px_map;
 
-    lv_display_flush_ready(disp);
+    /* Hand over to the flush task and return, LVGL renders into the other shadow buffer meanwhile. */
+    LV_ASSERT(lcd_device_control(evLCD_CTRL_TILE_UPDATE, (void *)&sTile) == 0);
+}
 
+static void lv_port_disp_partial_wait(lv_display_t *disp)
+{
+    /* Called by LVGL before reusing a buffer, the flushing flag is cleared by LVGL after. */
+    LV_ASSERT(lcd_device_control(evLCD_CTRL_TILE_WAIT, NULL) == 0);
 }
 
 #endif
@@ -88,6 +79,7 @@ void lv_port_disp_init(void)
     LV_LOG_INFO("Use two screen-size shadow buffer, 0x%08x, 0x%08x.", buf2, buf3_next);
 
     lv_display_set_flush_cb(disp, lv_port_disp_partial);               /*Set a flush callback to draw to the display*/
+    lv_display_set_flush_wait_cb(disp, lv_port_disp_partial_wait);     /*Set a wait callback to block until it is copied*/
     lv_display_set_buffers(disp, buf2, buf3_next, u32FBSize, LV_DISPLAY_RENDER_MODE_PARTIAL); /*Set an initialized buffer*/
 #endif
 }
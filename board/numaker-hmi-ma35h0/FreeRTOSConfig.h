@@ -84,6 +84,7 @@ extern uint32_t SystemCoreClock;
 #define configUSE_16_BIT_TICKS          0
 #define configIDLE_SHOULD_YIELD         1
 #define configUSE_MUTEXES               1
+#define configTASK_NOTIFICATION_ARRAY_ENTRIES 2
 #define configQUEUE_REGISTRY_SIZE       8
 
 #define configCHECK_FOR_STACK_OVERFLOW  2
@@ -131,9 +132,18 @@ FreeRTOS/Source/tasks.c for limitations. */
 /* Run time stats are not generated.  portCONFIGURE_TIMER_FOR_RUN_TIME_STATS and
 portGET_RUN_TIME_COUNTER_VALUE must be defined if configGENERATE_RUN_TIME_STATS
 is set to 1. */
+#if defined(CONFIG_NU_SYSSTAT)
+/* Run time stats of nu_sysstat.c on the generic timer. */
+extern void nu_sysstat_timer_init(void);
+extern uint32_t nu_sysstat_timer_get(void);
+#define configGENERATE_RUN_TIME_STATS 1
+#define portCONFIGURE_TIMER_FOR_RUN_TIME_STATS() nu_sysstat_timer_init()
+#define portGET_RUN_TIME_COUNTER_VALUE() nu_sysstat_timer_get()
+#else
 #define configGENERATE_RUN_TIME_STATS 0
 #define portCONFIGURE_TIMER_FOR_RUN_TIME_STATS()
 #define portGET_RUN_TIME_COUNTER_VALUE()
+#endif
 
 /* The size of the global output buffer that is available for use when there
 are multiple command interpreters running at once (for example, one on a UART
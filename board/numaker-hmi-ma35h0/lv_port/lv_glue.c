@@ -8,10 +8,13 @@
 
 #include "lvgl.h"
 #include "lv_glue.h"
+#include "nu_sysstat.h"
+#include "nu_dcache.h"
 
 #define CONFIG_VRAM_TOTAL_ALLOCATED_SIZE    NVT_ALIGN((LV_HOR_RES_MAX * LV_VER_RES_MAX * (LV_COLOR_DEPTH/8) * CONFIG_LCD_FB_NUM), 128)
 
 static uint8_t s_au8FrameBuf[CONFIG_VRAM_TOTAL_ALLOCATED_SIZE] __attribute__((aligned(128)));
+static S_NU_DCACHE_DIRTY s_sFrameDirty;
 
 #if defined(__1024x600__)
 S_CALIBRATION_MATRIX g_sCalMat = { -17558, 1, 69298832, -10, 11142, -2549195, 65536 };
@@ -70,6 +73,8 @@ static void lcd_disp_handler(void)
 
 int lcd_device_initialize(void)
 {
+    nu_dcache_dirty_init(&s_sFrameDirty, s_au8FrameBuf, LV_HOR_RES_MAX, LV_VER_RES_MAX * CONFIG_LCD_FB_NUM, LV_COLOR_DEPTH / 8);
+
     /* Unlock protected registers */
     SYS_UnlockReg();
 
@@ -147,7 +152,15 @@ int lcd_device_control(int cmd, void *argv)
 
     case evLCD_CTRL_RECT_UPDATE:
     {
-        dcache_clean_by_mva(s_au8FrameBuf, CONFIG_VRAM_TOTAL_ALLOCATED_SIZE);
+        const lv_area_t *psArea = (const lv_area_t *)argv;
+
+        /* Clean the lines of the updated area only, all frame buffers without one. */
+        if (psArea != NULL)
+            nu_dcache_dirty_mark(&s_sFrameDirty, psArea->x1, psArea->y1, psArea->x2, psArea->y2);
+        else
+            nu_dcache_dirty_mark_all(&s_sFrameDirty);
+
+        nu_dcache_dirty_flush(&s_sFrameDirty, evNU_DCACHE_CLEAN);
     }
     break;
 
@@ -191,7 +204,11 @@ static volatile E_ADT_Mode s_evADTMode = evADT_Idle;
 
 static void ADC0_IRQHandler(void)
 {
-    uint32_t u32ISR = ADC0->ISR;
+    uint32_t u32ISR;
+
+    nu_sysstat_isr_enter();
+
+    u32ISR = ADC0->ISR;
     if ((u32ISR & ADC_ISR_PEDEF_Msk) == ADC_ISR_PEDEF_Msk)
     {
         // Clear interrupt flag
@@ -199,6 +216,9 @@ static void ADC0_IRQHandler(void)
         ADC_DisableInt(ADC0, ADC_IER_PEDEIEN_Msk);
 
         s_evADTMode = evADT_PD_GOTO_XY;
+
+        /* Pen down, start conversion without waiting for next polling period. */
+        nu_lv_task_wakeup_from_isr(NU_LV_WAKEUP_INPUT);
     }
     else if ((u32ISR & ADC_ISR_MF_Msk) == ADC_ISR_MF_Msk)
     {
@@ -206,6 +226,8 @@ static void ADC0_IRQHandler(void)
         ADC_CLR_INT_FLAG(ADC0, ADC_ISR_MF_Msk);
         s_evADTMode = evADT_XYConvert_Done;
     }
+
+    nu_sysstat_isr_exit(evNU_SYSSTAT_ISR_TOUCH);
 }
 
 
@@ -13,10 +13,12 @@
 #include LV_NUVOTON_INCLUDE
 
 #define LV_USE_DRAW_BITBLT                     1
+#define CONFIG_NU_LAYER_POOL                   1
 #define LV_USE_PARALLEL_DRAW_DEBUG             0
 #define CONFIG_LV_ATTRIBUTE_MEM_ALIGN_SIZE     32
 #define CONFIG_LV_ATTRIBUTE_MEM_ALIGN          __attribute__((aligned(32)))
 #define CONFIG_LV_DRAW_BUF_ALIGN               32
+#define LV_DRAW_BUF_STRIDE_ALIGN               4
 
 #define LV_USE_OS   LV_OS_FREERTOS
 
@@ -55,6 +55,7 @@
 #define configIDLE_SHOULD_YIELD         1
 
 #define configUSE_MUTEXES               1
+#define configTASK_NOTIFICATION_ARRAY_ENTRIES 2
 #define configCHECK_FOR_STACK_OVERFLOW  0
 #define configUSE_RECURSIVE_MUTEXES     1
 #define configQUEUE_REGISTRY_SIZE       10
@@ -78,4 +79,13 @@ to exclude the API function. */
 #define INCLUDE_pcTaskGetTaskName               1
 #define INCLUDE_xTaskGetSchedulerState          1
 
+/* Run time stats of nu_sysstat.c, counted in ticks. */
+#if defined(CONFIG_NU_SYSSTAT)
+extern void nu_sysstat_timer_init(void);
+extern uint32_t nu_sysstat_timer_get(void);
+#define configGENERATE_RUN_TIME_STATS           1
+#define portCONFIGURE_TIMER_FOR_RUN_TIME_STATS() nu_sysstat_timer_init()
+#define portGET_RUN_TIME_COUNTER_VALUE()        nu_sysstat_timer_get()
+#endif
+
 #endif /* FREERTOS_CONFIG_H */
@@ -8,10 +8,12 @@
 
 #include "lvgl.h"
 #include "lv_glue.h"
+#include "nu_dcache.h"
 
 #define CONFIG_VRAM_TOTAL_ALLOCATED_SIZE    NVT_ALIGN((LV_HOR_RES_MAX * LV_VER_RES_MAX * (LV_COLOR_DEPTH/8) * CONFIG_LCD_FB_NUM), DEF_CACHE_LINE_SIZE)
 
 static uint8_t s_au8FrameBuf[CONFIG_VRAM_TOTAL_ALLOCATED_SIZE] __attribute__((aligned(DEF_CACHE_LINE_SIZE)));
+static S_NU_DCACHE_DIRTY s_sFrameDirty;
 
 extern S_CALIBRATION_MATRIX g_sCalMat;
 #if defined(__800x480__)
@@ -161,6 +163,8 @@ int lcd_device_initialize(void)
 {
     int i32DisplayPanel;
 
+    nu_dcache_dirty_init(&s_sFrameDirty, s_au8FrameBuf, LV_HOR_RES_MAX, LV_VER_RES_MAX * CONFIG_LCD_FB_NUM, LV_COLOR_DEPTH / 8);
+
     /* GDMA engine clock */
     outpw(REG_CLK_HCLKEN, inpw(REG_CLK_HCLKEN) | 0x00001000);
 
@@ -273,7 +277,15 @@ int lcd_device_control(int cmd, void *argv)
 
     case evLCD_CTRL_RECT_UPDATE:
     {
-        sysCleanDcache((UINT32)s_au8FrameBuf, (UINT32)CONFIG_VRAM_TOTAL_ALLOCATED_SIZE);
+        const lv_area_t *psArea = (const lv_area_t *)argv;
+
+        /* Clean the lines of the updated area only, all frame buffers without one. */
+        if (psArea != NULL)
+            nu_dcache_dirty_mark(&s_sFrameDirty, psArea->x1, psArea->y1, psArea->x2, psArea->y2);
+        else
+            nu_dcache_dirty_mark_all(&s_sFrameDirty);
+
+        nu_dcache_dirty_flush(&s_sFrameDirty, evNU_DCACHE_CLEAN);
     }
     break;
 
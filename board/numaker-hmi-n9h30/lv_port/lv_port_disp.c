@@ -9,6 +9,7 @@
 #include "lvgl.h"
 #include "lv_glue.h"
 #include "2d.h"
+#include "nu_dcache.h"
 
 #if CONFIG_LV_DISP_FULL_REFRESH
 
@@ -83,10 +84,10 @@ static void lv_port_disp_partial(lv_display_t *disp, const lv_area_t *area, uint
         const uint8_t *dest_start_buf = psLCDInfo->pvVramStartAddr + (area->y1 * dest_stride);
 
         /* Clean. then invalidate cache line of dest buffer to memory */
-        sysCleanInvalidatedDcache((UINT32)dest_start_buf, dest_stride * dest_h);
+        nu_dcache_range(evNU_DCACHE_CLEAN_INVALIDATE, dest_start_buf, dest_stride * dest_h);
 
         /* Flush cache line of src buffer to memory */
-        sysCleanDcache((uint32_t)px_map, dest_w * dest_h * px_size);
+        nu_dcache_range(evNU_DCACHE_CLEAN, px_map, dest_w * dest_h * px_size);
 
         ge2dSpriteBlt_Screen(area->x1, area->y1, dest_w, dest_h, (void *)px_map);
     }
@@ -98,10 +99,12 @@ static void lv_port_disp_partial(lv_display_t *disp, const lv_area_t *area, uint
         int32_t h = lv_area_get_height(area);
 
 #if (LV_COLOR_DEPTH==32)
-        uint32_t *pDisp = (uint32_t *)((uint32_t)psLCDInfo->pvVramStartAddr) + (psLCDInfo->u32ResWidth * area->y1 + area->x1);
+        uint32_t *pDispStart = (uint32_t *)((uint32_t)psLCDInfo->pvVramStartAddr) + (psLCDInfo->u32ResWidth * area->y1 + area->x1);
+        uint32_t *pDisp = pDispStart;
         uint32_t *pSrc = (uint32_t *)px_map;
 #elif (LV_COLOR_DEPTH==16)
-        uint16_t *pDisp = (uint16_t *)(uint32_t)psLCDInfo->pvVramStartAddr + (psLCDInfo->u32ResWidth * area->y1 + area->x1);
+        uint16_t *pDispStart = (uint16_t *)(uint32_t)psLCDInfo->pvVramStartAddr + (psLCDInfo->u32ResWidth * area->y1 + area->x1);
+        uint16_t *pDisp = pDispStart;
         uint16_t *pSrc = (uint16_t *)px_map;
 #endif
 
@@ -110,11 +113,12 @@ static void lv_port_disp_partial(lv_display_t *disp, const lv_area_t *area, uint
             for (x = 0; x < w; x++)
                 pDisp[x] = pSrc[x];
 
-            sysCleanInvalidatedDcache((UINT32)pDisp, w * (LV_COLOR_DEPTH / 8));
-
             pDisp += psLCDInfo->u32ResWidth;
             pSrc += w;
         }
+
+        /* Once for all rows after copying. */
+        nu_dcache_rect(evNU_DCACHE_CLEAN_INVALIDATE, pDispStart, w * (LV_COLOR_DEPTH / 8), h, psLCDInfo->u32ResWidth * (LV_COLOR_DEPTH / 8));
     }
 }
 
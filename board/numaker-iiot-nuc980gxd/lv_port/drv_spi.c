@@ -6,6 +6,8 @@
  * @copyright (C) 2020 Nuvoton Technology Corp. All rights reserved.
  *****************************************************************************/
 #include "drv_spi.h"
+#include "nu_sysstat.h"
+#include "nu_section.h"
 
 #define SPI_GET_DATA_WIDTH(spi)       (((spi)->CTL & SPI_CTL_DWIDTH_Msk) >> SPI_CTL_DWIDTH_Pos)
 #define SPI_TRIGGER_TX_RX_PDMA(spi)   ((spi)->PDMACTL |= (SPI_PDMACTL_TXPDMAEN_Msk | SPI_PDMACTL_RXPDMAEN_Msk))
@@ -83,7 +85,7 @@ __STATIC_INLINE void nu_spi_drain_rxfifo(SPI_T *spi)
     }
 }
 
-static int nu_spi_transmit_poll(struct nu_spi *psNuSPI, const uint8_t *tx, uint8_t *rx, int length, int dw)
+NU_FAST_CODE static int nu_spi_transmit_poll(struct nu_spi *psNuSPI, const uint8_t *tx, uint8_t *rx, int length, int dw)
 {
     SPI_T *base = psNuSPI->base;
     // Write-only
@@ -189,9 +191,13 @@ static void nu_pdma_spi_rx_cb_event(void *pvUserData, uint32_t u32EventFilter)
 {
     struct nu_spi *psNuSPI = (struct nu_spi *)pvUserData;
 
+    nu_sysstat_isr_enter();
+
     LV_ASSERT(psNuSPI);
 
     psNuSPI->m_psSemBus = 1;
+
+    nu_sysstat_isr_exit(evNU_SYSSTAT_ISR_SPI);
 }
 
 static void nu_pdma_spi_tx_cb_trigger(void *pvUserData, uint32_t u32UserData)
@@ -76,6 +76,7 @@ int nu_pdma_desc_setup(int i32ChannID, nu_pdma_desc_t dma_desc, uint32_t u32Data
 int nu_pdma_sg_transfer(int i32ChannID, nu_pdma_desc_t head, uint32_t u32IdleTimeout_us);
 int nu_pdma_sgtbls_allocate(nu_pdma_desc_t *ppsSgtbls, int num);
 void nu_pdma_sgtbls_free(nu_pdma_desc_t *ppsSgtbls, int num);
+void nu_pdma_sgtbls_usage(int *pi32InUse, int *pi32Peak);
 
 // For memory actor
 void *nu_pdma_memcpy(void *dest, void *src, unsigned int count);
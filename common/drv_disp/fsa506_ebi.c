@@ -7,6 +7,7 @@
  *****************************************************************************/
 
 #include "disp.h"
+#include "nu_section.h"
 
 void disp_write_reg(uint16_t reg, uint16_t data)
 {
@@ -36,7 +37,7 @@ void disp_set_page(uint16_t StartPage, uint16_t EndPage)
     disp_write_reg(0x7, EndPage & 0xFF);
 }
 
-void disp_send_pixels(uint16_t *pixels, int byte_len)
+NU_FAST_CODE void disp_send_pixels(uint16_t *pixels, int byte_len)
 {
     int count = byte_len / sizeof(uint16_t);
 
@@ -7,6 +7,7 @@
  *****************************************************************************/
 
 #include "disp.h"
+#include "nu_section.h"
 
 void disp_set_column(uint16_t StartCol, uint16_t EndCol)
 {
@@ -28,7 +29,7 @@ void disp_set_page(uint16_t StartPage, uint16_t EndPage)
     DISP_WRITE_DATA(EndPage & 0xFF);
 }
 
-void disp_send_pixels(uint16_t *pixels, int byte_len)
+NU_FAST_CODE void disp_send_pixels(uint16_t *pixels, int byte_len)
 {
     int count = byte_len / sizeof(uint16_t);
 #if defined(CONFIG_DISP_USE_PDMA)
@@ -45,6 +45,15 @@ static void DISP_WRITE_DATA_2B(uint16_t u16Dat)
 
 void disp_send_pixels(uint16_t *pixels, int byte_len)
 {
+#if defined(CONFIG_DISP_USE_PDMA) && defined(CONFIG_DISP_TILE_LINES)
+    /* Sent from the flush task, it sleeps on PDMA completion instead of polling so LVGL renders meanwhile. */
+    if (s_NuSPI.m_psSemDone == NULL)
+    {
+        s_NuSPI.m_psSemDone = xSemaphoreCreateBinary();
+        LV_ASSERT(s_NuSPI.m_psSemDone != NULL);
+    }
+#endif
+
     SPI_SET_DATA_WIDTH(CONFIG_DISP_SPI, 16);
     nu_spi_transfer(&s_NuSPI, (const void *)pixels, NULL, byte_len);
 }
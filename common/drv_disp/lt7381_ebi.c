@@ -7,6 +7,7 @@
  *****************************************************************************/
 
 #include "disp.h"
+#include "nu_section.h"
 
 void disp_write_reg(uint16_t reg, uint16_t data)
 {
@@ -55,7 +56,7 @@ static uint32_t lt7381_vram_fifo_isempty(void)
     return ((DISP_READ_STATUS() & 0x40) != 0) ? 1 : 0;
 }
 
-void disp_send_pixels(uint16_t *pixels, int byte_len)
+NU_FAST_CODE void disp_send_pixels(uint16_t *pixels, int byte_len)
 {
     int count = byte_len / sizeof(uint16_t);
 
@@ -3,6 +3,7 @@
 #include <string.h>
 
 #include "lv_glue.h"
+#include "nu_sysstat.h"
 
 #if (LV_USE_OS==LV_OS_FREERTOS)
     static SemaphoreHandle_t s_xGE2DSem = NULL;
@@ -22,12 +23,16 @@ void ge2dISR(void)
 {
     BaseType_t xHigherPriorityTaskWoken = pdFALSE;
 
+    nu_sysstat_isr_enter();
+
     /* Clear interrupt status. */
     outpw(REG_GE2D_INTSTS, 1);
 
     xSemaphoreGiveFromISR(s_xGE2DSem, &xHigherPriorityTaskWoken);
 
     portYIELD_FROM_ISR(xHigherPriorityTaskWoken);
+
+    nu_sysstat_isr_exit(evNU_SYSSTAT_ISR_DRAW);
 }
 #endif
 
@@ -14,6 +14,7 @@
  *********************/
 
 #include "lv_draw_2dge.h"
+#include "nu_dcache.h"
 
 #if LV_USE_DRAW_2DGE
 
@@ -461,7 +462,6 @@ static void _2dge_invalidate_cache(const lv_draw_buf_t *draw_buf, const lv_area_
     lv_color_format_t cf = header->cf;
 
     uint8_t *address = draw_buf->data;
-    int32_t i = 0;
     uint32_t bytes_per_pixel = lv_color_format_get_size(cf);
     int32_t width = lv_area_get_width(area);
     int32_t lines = lv_area_get_height(area);
@@ -470,11 +470,8 @@ static void _2dge_invalidate_cache(const lv_draw_buf_t *draw_buf, const lv_area_
     /* Stride is in bytes, not pixels */
     address = address + (area->x1 * (int32_t)bytes_per_pixel) + (stride * (uint32_t)area->y1);
 
-    for (i = 0; i < lines; i++)
-    {
-        sysCleanInvalidatedDcache((UINT32)address, bytes_to_flush_per_line);
-        address += stride;
-    }
+    /* Rows are merged into one range unless far apart. */
+    nu_dcache_rect(evNU_DCACHE_CLEAN_INVALIDATE, address, (uint32_t)bytes_to_flush_per_line, (uint32_t)lines, stride);
 }
 
 #endif /*LV_USE_DRAW_PXP*/
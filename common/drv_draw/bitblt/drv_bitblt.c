@@ -3,6 +3,7 @@
 #include <string.h>
 
 #include "lv_glue.h"
+#include "nu_sysstat.h"
 
 #if (LV_USE_OS==LV_OS_FREERTOS)
     static SemaphoreHandle_t s_xBITBLTSem = NULL;
@@ -18,7 +19,11 @@ void bitbltWaitForCompletion(void)
 #if (LV_USE_OS==LV_OS_FREERTOS)
 void bitbltISR(void)
 {
-    UINT32 bltIntStat = inp32(REG_BLTINTCR);
+    UINT32 bltIntStat;
+
+    nu_sysstat_isr_enter();
+
+    bltIntStat = inp32(REG_BLTINTCR);
 
     /* BLT complete */
     if (bltIntStat & BLT_INTS)
@@ -32,6 +37,8 @@ void bitbltISR(void)
 
         portYIELD_FROM_ISR(xHigherPriorityTaskWoken);
     }
+
+    nu_sysstat_isr_exit(evNU_SYSSTAT_ISR_DRAW);
 }
 #endif
 
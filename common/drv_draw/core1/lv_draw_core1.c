@@ -0,0 +1,411 @@
+/**
+ * @file lv_draw_core1.c
+ *
+ */
+
+/**
+ * Copyright 2024 Nuvoton
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+/*********************
+ *      INCLUDES
+ *********************/
+
+#include "lv_draw_core1.h"
+
+#if LV_USE_DRAW_CORE1
+
+#include "MA35D1.h"
+#include "FreeRTOS.h"
+#include "semphr.h"
+#include "nu_sysstat.h"
+
+/*
+ * Core 0 runs FreeRTOS and LVGL, core 1 runs no OS, only the loop in main1().
+ * This unit takes plain fills and layer blends on XRGB8888 targets, builds a
+ * job for each and hands it to core 1 through nu_amp_draw queues, while the
+ * software units keep drawing everything else on core 0 in parallel.
+ *
+ * The startup code sets CPUECTLR.SMPEN on both cores and both run with the
+ * same translation tables, so their data caches are kept coherent by the
+ * cluster and no maintenance is needed between the cores. Explicit cleaning
+ * could not work anyway: tasks of both cores share cache lines at their edges.
+ */
+
+/*********************
+ *      DEFINES
+ *********************/
+
+#define DRAW_UNIT_ID_CORE1     253
+
+/**********************
+ *      TYPEDEFS
+ **********************/
+
+/**********************
+ *  STATIC PROTOTYPES
+ **********************/
+
+/*
+ * Evaluate a task and set the score and preferred core 1 unit.
+ * Return 1 if task is preferred, 0 otherwise (task is not supported).
+ */
+static int32_t _core1_evaluate(lv_draw_unit_t *draw_unit, lv_draw_task_t *task);
+
+/*
+ * Dispatch a task to the core 1 unit.
+ * Return 1 if task was dispatched, 0 otherwise (task not supported).
+ */
+static int32_t _core1_dispatch(lv_draw_unit_t *draw_unit, lv_layer_t *layer);
+
+/*
+ * Delete the core 1 draw unit.
+ */
+static int32_t _core1_delete(lv_draw_unit_t *draw_unit);
+
+static void _core1_render_thread_cb(void *ptr);
+
+static void _core1_execute_drawing(lv_draw_core1_unit_t *u);
+
+static void _core1_done_handler(void);
+
+/**********************
+ *  STATIC VARIABLES
+ **********************/
+
+/* Requests from core 0 and completions from core 1. */
+static S_NU_AMP_QUEUE s_sReqQueue __attribute__((aligned(CONFIG_NU_AMP_CACHE_LINE)));
+static S_NU_AMP_QUEUE s_sDoneQueue __attribute__((aligned(CONFIG_NU_AMP_CACHE_LINE)));
+
+static SemaphoreHandle_t s_hDoneSem = NULL;
+
+/**********************
+ *      MACROS
+ **********************/
+
+/**********************
+ *   GLOBAL FUNCTIONS
+ **********************/
+
+void lv_draw_core1_init(void)
+{
+    nu_amp_queue_init(&s_sReqQueue);
+    nu_amp_queue_init(&s_sDoneQueue);
+
+    s_hDoneSem = xSemaphoreCreateBinary();
+    LV_ASSERT(s_hDoneSem != NULL);
+
+    IRQ_SetHandler((IRQn_ID_t)CONFIG_LV_DRAW_CORE1_SGI, _core1_done_handler);
+    IRQ_Enable((IRQn_ID_t)CONFIG_LV_DRAW_CORE1_SGI);
+
+    nu_core1_boot();
+
+    lv_draw_core1_unit_t *draw_core1_unit = lv_draw_create_unit(sizeof(lv_draw_core1_unit_t));
+    draw_core1_unit->base_unit.evaluate_cb = _core1_evaluate;
+    draw_core1_unit->base_unit.dispatch_cb = _core1_dispatch;
+    draw_core1_unit->base_unit.delete_cb = _core1_delete;
+
+    lv_thread_init(&draw_core1_unit->thread, LV_THREAD_PRIO_HIGH, _core1_render_thread_cb, 2 * 1024, draw_core1_unit);
+}
+
+void lv_draw_core1_deinit(void)
+{
+    IRQ_Disable((IRQn_ID_t)CONFIG_LV_DRAW_CORE1_SGI);
+}
+
+__attribute__((weak)) void nu_core1_boot(void)
+{
+    extern void start64(void);
+
+    /* The boot ROM holds core 1 in WFE until a warm-boot address is given. */
+    SYS->CA35WRBADR1 = (uint32_t)(uintptr_t)start64;
+    SYS->CA35WRBPAR1 = 1;
+
+    __asm volatile("dsb sy");
+    __asm volatile("sev");
+}
+
+/* Entry of core 1 from the SecondaryCore path of startup.S, after SystemInit1(). */
+void main1(void)
+{
+    S_NU_AMP_DRAW_JOB sJob;
+
+    while (1)
+    {
+        /* SEV of core 0 after a push wakes it, also if it comes before the WFE. */
+        while (!nu_amp_queue_pop(&s_sReqQueue, &sJob))
+            __asm volatile("wfe");
+
+        nu_amp_draw_run(&sJob);
+
+        /* One job per unit is in flight, so it is never full. */
+        while (!nu_amp_queue_push(&s_sDoneQueue, &sJob))
+            __asm volatile("wfe");
+
+        __asm volatile("dsb sy");
+        GIC_SendSGI((IRQn_Type)CONFIG_LV_DRAW_CORE1_SGI, 1 << 0, 0);
+    }
+}
+
+/**********************
+ *   STATIC FUNCTIONS
+ **********************/
+
+static void _core1_done_handler(void)
+{
+    BaseType_t xHigherPriorityTaskWoken = pdFALSE;
+
+    nu_sysstat_isr_enter();
+
+    xSemaphoreGiveFromISR(s_hDoneSem, &xHigherPriorityTaskWoken);
+    portYIELD_FROM_ISR(xHigherPriorityTaskWoken);
+
+    nu_sysstat_isr_exit(evNU_SYSSTAT_ISR_DRAW);
+}
+
+static bool _core1_buf_aligned(const void *buf, uint32_t stride)
+{
+    /* Test for pointer alignment */
+    if ((uintptr_t)buf % 4)
+        return false;
+
+    /* Test for invalid stride */
+    if (stride % 4)
+        return false;
+
+    return true;
+}
+
+static bool _core1_draw_layer_supported(const lv_draw_image_dsc_t *draw_dsc)
+{
+    const lv_layer_t *layer_to_draw = (const lv_layer_t *)draw_dsc->src;
+
+    if ((layer_to_draw->color_format != LV_COLOR_FORMAT_ARGB8888) &&
+            (layer_to_draw->color_format != LV_COLOR_FORMAT_XRGB8888))
+        return false;
+
+    if (layer_to_draw->draw_buf &&
+            !_core1_buf_aligned(layer_to_draw->draw_buf->data, layer_to_draw->draw_buf->header.stride))
+        return false;
+
+    /* Only a straight copy with opacity, no transform, recolor or mask. */
+    if ((draw_dsc->rotation != 0) || (draw_dsc->scale_x != LV_SCALE_NONE) || (draw_dsc->scale_y != LV_SCALE_NONE) ||
+            (draw_dsc->recolor_opa > LV_OPA_MIN) || (draw_dsc->blend_mode != LV_BLEND_MODE_NORMAL) ||
+            (draw_dsc->clip_radius != 0) || (draw_dsc->bitmap_mask_src != NULL))
+        return false;
+
+    return true;
+}
+
+static int32_t _core1_evaluate(lv_draw_unit_t *u, lv_draw_task_t *task)
+{
+    LV_UNUSED(u);
+
+    const lv_draw_dsc_base_t *draw_dsc_base = (lv_draw_dsc_base_t *) task->draw_dsc;
+
+    /* Jobs write opaque pixels, a target with alpha is left to the software units. */
+    if (draw_dsc_base->layer->color_format != LV_COLOR_FORMAT_XRGB8888)
+        return 0;
+
+    switch (task->type)
+    {
+    case LV_DRAW_TASK_TYPE_FILL:
+    {
+        const lv_draw_fill_dsc_t *draw_dsc = (lv_draw_fill_dsc_t *) task->draw_dsc;
+
+        if (!((draw_dsc->radius == 0) && (draw_dsc->grad.dir == LV_GRAD_DIR_NONE)))
+            return 0;
+    }
+    break;
+
+    case LV_DRAW_TASK_TYPE_LAYER:
+        if (!_core1_draw_layer_supported((lv_draw_image_dsc_t *) task->draw_dsc))
+            return 0;
+        break;
+
+    default:
+        return 0;
+    }
+
+    /* Lower is preferred, the software unit scores 100. */
+    if (task->preference_score > 70)
+    {
+        task->preference_score = 70;
+        task->preferred_draw_unit_id = DRAW_UNIT_ID_CORE1;
+    }
+
+    return 1;
+}
+
+static int32_t _core1_dispatch(lv_draw_unit_t *draw_unit, lv_layer_t *layer)
+{
+    lv_draw_core1_unit_t *draw_core1_unit = (lv_draw_core1_unit_t *) draw_unit;
+
+    /* Return immediately if it's busy with draw task. */
+    if (draw_core1_unit->task_act)
+        return 0;
+
+    /* Try to get an ready to draw. */
+    lv_draw_task_t *t = lv_draw_get_next_available_task(layer, NULL, DRAW_UNIT_ID_CORE1);
+
+    if (t == NULL || t->preferred_draw_unit_id != DRAW_UNIT_ID_CORE1)
+        return -1;
+
+    void *buf = lv_draw_layer_alloc_buf(layer);
+    if (buf == NULL)
+        return -1;
+
+    t->state = LV_DRAW_TASK_STATE_IN_PROGRESS;
+    draw_core1_unit->base_unit.target_layer = layer;
+    draw_core1_unit->base_unit.clip_area = &t->clip_area;
+    draw_core1_unit->task_act = t;
+
+    /* Let the render thread work. */
+    if (draw_core1_unit->inited)
+        lv_thread_sync_signal(&draw_core1_unit->sync);
+
+    return 1;
+}
+
+static int32_t _core1_delete(lv_draw_unit_t *draw_unit)
+{
+    lv_draw_core1_unit_t *draw_core1_unit = (lv_draw_core1_unit_t *) draw_unit;
+
+    LV_LOG_INFO("Cancel core 1 draw thread.");
+    draw_core1_unit->exit_status = true;
+
+    if (draw_core1_unit->inited)
+        lv_thread_sync_signal(&draw_core1_unit->sync);
+
+    lv_result_t res = lv_thread_delete(&draw_core1_unit->thread);
+
+    return res;
+}
+
+static bool _core1_job_fill(S_NU_AMP_DRAW_JOB *psJob, const lv_draw_fill_dsc_t *dsc)
+{
+    psJob->u32Op = eNU_AMP_DRAW_FILL;
+    psJob->u32Color = ((uint32_t)dsc->color.red << 16) | ((uint32_t)dsc->color.green << 8) | dsc->color.blue;
+    psJob->u8Opa = dsc->opa;
+
+    return true;
+}
+
+static bool _core1_job_layer(S_NU_AMP_DRAW_JOB *psJob, const lv_draw_image_dsc_t *dsc,
+                             const lv_area_t *coords, lv_area_t *blend_area)
+{
+    lv_layer_t *layer_to_draw = (lv_layer_t *)dsc->src;
+    const lv_draw_buf_t *src_buf = layer_to_draw->draw_buf;
+
+    /* Nothing was drawn on the layer, its buffer is not allocated. */
+    if (src_buf == NULL)
+        return false;
+
+    /* The layer is drawn 1:1 at coords, clip to what its buffer holds. */
+    const lv_area_t src_area =
+    {
+        .x1 = coords->x1,
+        .y1 = coords->y1,
+        .x2 = coords->x1 + src_buf->header.w - 1,
+        .y2 = coords->y1 + src_buf->header.h - 1
+    };
+
+    if (!_lv_area_intersect(blend_area, blend_area, &src_area))
+        return false;
+
+    psJob->u32Op = (src_buf->header.cf == LV_COLOR_FORMAT_ARGB8888) ? eNU_AMP_DRAW_BLEND_ARGB : eNU_AMP_DRAW_BLEND_XRGB;
+    psJob->pu8Src = lv_draw_buf_goto_xy(src_buf, blend_area->x1 - coords->x1, blend_area->y1 - coords->y1);
+    psJob->u32SrcStride = src_buf->header.stride;
+    psJob->u8Opa = dsc->opa;
+
+    return true;
+}
+
+static void _core1_execute_drawing(lv_draw_core1_unit_t *u)
+{
+    lv_draw_task_t *task = u->task_act;
+    lv_draw_unit_t *draw_unit = (lv_draw_unit_t *)u;
+    lv_layer_t *layer = draw_unit->target_layer;
+    S_NU_AMP_DRAW_JOB sJob = { 0 };
+    bool bQueued = false;
+
+    lv_area_t blend_area;
+    if (!_lv_area_intersect(&blend_area, &task->area, draw_unit->clip_area))
+        return; /*Fully clipped, nothing to do*/
+
+    switch (task->type)
+    {
+    case LV_DRAW_TASK_TYPE_FILL:
+        bQueued = _core1_job_fill(&sJob, task->draw_dsc);
+        break;
+    case LV_DRAW_TASK_TYPE_LAYER:
+        bQueued = _core1_job_layer(&sJob, task->draw_dsc, &task->area, &blend_area);
+        break;
+    default:
+        break;
+    }
+
+    if (!bQueued)
+        return;
+
+    sJob.u32Width = lv_area_get_width(&blend_area);
+    sJob.u32Height = lv_area_get_height(&blend_area);
+    sJob.pu8Dst = lv_draw_buf_goto_xy(layer->draw_buf, blend_area.x1 - layer->buf_area.x1, blend_area.y1 - layer->buf_area.y1);
+    sJob.u32DstStride = layer->draw_buf->header.stride;
+    sJob.pvUserData = task;
+
+    LV_ASSERT(nu_amp_queue_push(&s_sReqQueue, &sJob));
+
+    /* Wake core 1 from WFE, and sleep until its SGI. */
+    __asm volatile("dsb sy");
+    __asm volatile("sev");
+
+    xSemaphoreTake(s_hDoneSem, portMAX_DELAY);
+
+    LV_ASSERT(nu_amp_queue_pop(&s_sDoneQueue, &sJob) && (sJob.pvUserData == task));
+}
+
+static void _core1_render_thread_cb(void *ptr)
+{
+    lv_draw_core1_unit_t *u = ptr;
+
+    lv_thread_sync_init(&u->sync);
+    u->inited = true;
+
+    while (1)
+    {
+        /* Wait for sync if there is no task set. */
+        while (u->task_act == NULL)
+        {
+            if (u->exit_status)
+                break;
+
+            lv_thread_sync_wait(&u->sync);
+        }
+
+        if (u->exit_status)
+        {
+            LV_LOG_INFO("Ready to exit core 1 draw thread.");
+            break;
+        }
+
+        _core1_execute_drawing(u);
+
+        /* Signal the ready state to dispatcher. */
+        u->task_act->state = LV_DRAW_TASK_STATE_READY;
+
+        /* Cleanup. */
+        u->task_act = NULL;
+
+        /* The draw unit is free now. Request a new dispatching as it can get a new task. */
+        lv_draw_dispatch_request();
+    }
+
+    u->inited = false;
+    lv_thread_sync_delete(&u->sync);
+    LV_LOG_INFO("Exit core 1 draw thread.");
+}
+
+#endif /*LV_USE_DRAW_CORE1*/
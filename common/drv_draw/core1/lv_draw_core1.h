@@ -0,0 +1,84 @@
+/**
+ * @file lv_draw_core1.h
+ *
+ */
+
+#ifndef LV_DRAW_CORE1_H
+#define LV_DRAW_CORE1_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*********************
+ *      INCLUDES
+ *********************/
+#include "../lv_draw.h"
+
+#if LV_USE_DRAW_CORE1
+
+#include "../../misc/lv_area.h"
+#include "../../misc/lv_color.h"
+#include "../../display/lv_display.h"
+#include "../../osal/lv_os.h"
+
+#include "nu_amp_draw.h"
+
+#if !LV_USE_OS
+    #error "LV_USE_DRAW_CORE1 needs LV_USE_OS, the render thread sleeps while core 1 draws."
+#endif
+
+/*********************
+ *      DEFINES
+ *********************/
+
+/* SGI raised by core 1 on core 0 when a job is completed. */
+#if !defined(CONFIG_LV_DRAW_CORE1_SGI)
+    #define CONFIG_LV_DRAW_CORE1_SGI        8
+#endif
+
+/**********************
+ *      TYPEDEFS
+ **********************/
+
+typedef struct
+{
+    lv_draw_unit_t base_unit;
+    lv_draw_task_t *task_act;
+    lv_thread_sync_t sync;
+    lv_thread_t thread;
+    volatile bool inited;
+    volatile bool exit_status;
+} lv_draw_core1_unit_t;
+
+/**********************
+ * GLOBAL PROTOTYPES
+ **********************/
+
+/**
+ * Start core 1 and register it as a draw unit. Called in lv_nuvoton_task.
+ */
+void lv_draw_core1_init(void);
+
+/**
+ * Deinitialize the core 1 draw unit. Core 1 keeps waiting for jobs.
+ */
+void lv_draw_core1_deinit(void);
+
+/**
+ * Release core 1 from reset into start64 of the startup code, which continues in main1().
+ * Weak, replace it on a boot flow where core 1 is started another way.
+ */
+void nu_core1_boot(void);
+
+/**********************
+ *      MACROS
+ **********************/
+
+#endif /*LV_USE_DRAW_CORE1*/
+
+#ifdef __cplusplus
+} /*extern "C"*/
+#endif
+
+#endif /*LV_DRAW_CORE1_H*/
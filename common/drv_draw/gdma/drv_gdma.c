@@ -3,6 +3,7 @@
 #include <string.h>
 
 #include "lv_glue.h"
+#include "nu_sysstat.h"
 #include "dma350_ch_drv.h"
 #include "dma350_lib.h"
 
@@ -90,8 +91,12 @@ void gdmaWaitForCompletion(struct dma350_ch_dev_t *dev, enum dma350_lib_exec_typ
 #if (LV_USE_OS==LV_OS_FREERTOS)
 void GDMACH0_IRQHandler(void)
 {
+    union dma350_ch_status_t status;
+
+    nu_sysstat_isr_enter();
+
     /* Clear interrupt status. */
-    union dma350_ch_status_t status = dma350_ch_get_status(GDMA_CH_DEV_S[0]);
+    status = dma350_ch_get_status(GDMA_CH_DEV_S[0]);
 
     if (status.b.STAT_DONE)
     {
@@ -102,6 +107,8 @@ void GDMACH0_IRQHandler(void)
         xSemaphoreGiveFromISR(s_xGDMASem, &xHigherPriorityTaskWoken);
         portYIELD_FROM_ISR(xHigherPriorityTaskWoken);
     }
+
+    nu_sysstat_isr_exit(evNU_SYSSTAT_ISR_DRAW);
 }
 #endif
 
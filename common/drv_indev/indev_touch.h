@@ -15,4 +15,7 @@
 int indev_touch_get_data(lv_indev_data_t *psInDevData);
 int indev_touch_init(void);
 
+/* Capacitive controllers only. */
+int indev_touch_get_points(S_TOUCH_POINTS *psPoints);
+
 #endif /* __INPUT_TOUCH_H__*/
@@ -205,6 +205,14 @@ static void _cleanscreen(void)
 #endif
             plvColorStart++;
         }
+
+        area.x1 = 0;
+        area.y1 = 0;
+        area.x2 = LV_HOR_RES_MAX - 1;
+        area.y2 = LV_VER_RES_MAX - 1;
+
+        /* Update dirty region. */
+        LV_ASSERT(lcd_device_control(evLCD_CTRL_RECT_UPDATE, (void *)&area) == 0);
     }
     break;
 
@@ -284,6 +292,11 @@ static void _draw_bots(int x, int y)
             }
             plvColorStart += (LV_HOR_RES_MAX - DEF_DOT_NUMBER);
         }
+
+        area.x1 = start_x;
+        area.y1 = start_y;
+        area.x2 = start_x + DEF_DOT_NUMBER - 1;
+        area.y2 = start_y + DEF_DOT_NUMBER - 1;
     }
     break;
 
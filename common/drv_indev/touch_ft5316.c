@@ -7,13 +7,24 @@
  *****************************************************************************/
 
 #include <string.h>
+#include <stddef.h>
 #include "indev_touch.h"
 
+#if defined(CONFIG_INDEV_TOUCH_I2C_IRQ)
+    #include "touch_i2c_async.h"
+#endif
+
 #define FT5316_REGITER_LEN   1
 #define FT5316_MAX_TOUCH     5
 #define FT5316_ADDRESS       0x38
 
-#define CONFIG_MAX_TOUCH     1
+#if !defined(CONFIG_MAX_TOUCH)
+    #define CONFIG_MAX_TOUCH     FT5316_MAX_TOUCH
+#endif
+
+#if (CONFIG_MAX_TOUCH > FT5316_MAX_TOUCH) || (CONFIG_MAX_TOUCH > TOUCH_POINT_MAX)
+    #error "Wrong CONFIG_MAX_TOUCH definition"
+#endif
 
 typedef struct
 {
@@ -121,12 +132,10 @@ typedef struct
 
 } S_FT_REGMAP;
 
-static int16_t pre_x[CONFIG_MAX_TOUCH];
-static int16_t pre_y[CONFIG_MAX_TOUCH];
-static int16_t pre_w[CONFIG_MAX_TOUCH];
-static int16_t s_tp_dowm[CONFIG_MAX_TOUCH];
-static int16_t pre_id[CONFIG_MAX_TOUCH];
-static uint8_t pre_touch = 0;
+static S_TOUCH_POINTS s_sPoints;            /* Contacts of the last report */
+static int16_t s_i16PrimaryId = -1;         /* Contact reported as LVGL pointer, -1 if none */
+static lv_point_t s_sPrimary;
+static uint8_t s_u8LastGesture = FT_GESTURE_ID_MOVE_NONE;
 
 static S_FT_REGMAP sFtRegMap;
 
@@ -135,89 +144,150 @@ static int ft5316_write_reg(I2C_T *i2c, uint8_t reg, uint8_t value)
     return -I2C_WriteByteOneReg(i2c, FT5316_ADDRESS, reg, value);
 }
 
+#if !defined(CONFIG_INDEV_TOUCH_I2C_IRQ)
 static int ft5316_read_reg(I2C_T *i2c, uint8_t reg, uint8_t *data, uint32_t len)
 {
     return (I2C_ReadMultiBytesOneReg(i2c, FT5316_ADDRESS, reg, data, len) == len) ? 0 : -1;
 }
+#endif
 
-static void ft5316_touch_up(lv_indev_data_t *buf, int16_t id)
+#if defined(CONFIG_INDEV_TOUCH_I2C_IRQ)
+/* Called in I2C ISR with the head registers of the snapshot. */
+static uint32_t ft5316_point_count(const uint8_t *pu8Head)
 {
-    s_tp_dowm[id] = 0;
-
-    buf[id].state = LV_INDEV_STATE_RELEASED;
-    buf[id].point.x = pre_x[id];
-    buf[id].point.y = pre_y[id];
+    return ((const S_FT_REGMAP *)pu8Head)->u8TDStatus;
+}
 
-    pre_x[id] = -1;  /* last point is none */
-    pre_y[id] = -1;
-    pre_w[id] = -1;
+static const S_TOUCH_I2C_ASYNC_CFG s_sFtAsyncCfg =
+{
+    .psI2C = CONFIG_INDEV_TOUCH_I2C,
+    .u8Addr = FT5316_ADDRESS,
+    .u8BaseReg = 0,
+    .u8HeadLen = offsetof(S_FT_REGMAP, m_sTP),
+    .u8PointSize = sizeof(S_FT_TP),
+    .u8PointMax = FT5316_MAX_TOUCH,
+    .pfnPointCount = ft5316_point_count,
+};
+#endif
+
+static E_TOUCH_GESTURE ft5316_gesture(uint8_t u8GestureId)
+{
+    switch (u8GestureId)
+    {
+    case FT_GESTURE_ID_MOVE_UP:
+        return evTOUCH_GESTURE_MOVE_UP;
+    case FT_GESTURE_ID_MOVE_RIGHT:
+        return evTOUCH_GESTURE_MOVE_RIGHT;
+    case FT_GESTURE_ID_MOVE_DOWN:
+        return evTOUCH_GESTURE_MOVE_DOWN;
+    case FT_GESTURE_ID_MOVE_LEFT:
+        return evTOUCH_GESTURE_MOVE_LEFT;
+    case FT_GESTURE_ID_MOVE_IN:
+        return evTOUCH_GESTURE_ZOOM_IN;
+    case FT_GESTURE_ID_MOVE_OUT:
+        return evTOUCH_GESTURE_ZOOM_OUT;
+    default:
+        return evTOUCH_GESTURE_NONE;
+    }
 }
 
-static void ft5316_touch_down(lv_indev_data_t *buf, int8_t id, int16_t x, int16_t y, int16_t w)
+/*
+ * Contacts are matched by controller ID between reports, one missing in the
+ * new report is lifted. The LVGL pointer follows one contact. When it is
+ * lifted the pointer is released once, then follows the first contact down.
+ */
+static void ft5316_track(const S_TOUCH_POINTS *psNow)
 {
-    s_tp_dowm[id] = 1;
+    uint32_t i;
+    int16_t i16Primary = -1;
 
-    buf[id].point.x = x;
-    buf[id].point.y = y;
-    buf[id].state = LV_INDEV_STATE_PRESSED;
+    for (i = 0; i < psNow->u32Count; i++)
+    {
+        if (psNow->asPoint[i].i16Id == s_i16PrimaryId)
+        {
+            i16Primary = s_i16PrimaryId;
+            break;
+        }
+    }
 
-    pre_x[id] = x; /* save last point */
-    pre_y[id] = y;
-    pre_w[id] = w;
+    if ((s_i16PrimaryId < 0) && (psNow->u32Count > 0))
+    {
+        i = 0;
+        i16Primary = psNow->asPoint[0].i16Id;
+    }
+
+    if (i16Primary >= 0)
+    {
+        s_sPrimary.x = psNow->asPoint[i].i16X;
+        s_sPrimary.y = psNow->asPoint[i].i16Y;
+    }
+
+    s_i16PrimaryId = i16Primary;
+    s_sPoints.u32Count = psNow->u32Count;
+    memcpy(s_sPoints.asPoint, psNow->asPoint, psNow->u32Count * sizeof(S_TOUCH_POINT));
+}
+
+static void ft5316_add_point(S_TOUCH_POINTS *psNow, int16_t id, uint16_t x, uint16_t y, uint16_t w)
+{
+    S_TOUCH_POINT *psPoint = &psNow->asPoint[psNow->u32Count++];
+
+    psPoint->i16Id = id;
+    psPoint->i16X = x;
+    psPoint->i16Y = y;
+    psPoint->i16W = w;
 }
 
 int indev_touch_get_data(lv_indev_data_t *psInDevData)
 {
-    int i, error = 0;
+    S_TOUCH_POINTS sNow;
+    int i, points, error = 0;
     int32_t   touch_event, touchid;
 
+#if defined(CONFIG_INDEV_TOUCH_I2C_IRQ)
+
+#if !defined(CONFIG_INDEV_TOUCH_PIN_IRQ)
+    /* No touch IRQ, read for the next poll. */
+    touch_i2c_async_kick();
+#endif
+
+    /* Nothing new read in background, keep the last report. */
+    error = touch_i2c_async_fetch(&sFtRegMap, sizeof(sFtRegMap)) ? 0 : -1;
+    if (error)
+        goto exit_indev_touch_get_data;
+
+#else
     memset(&sFtRegMap, 0, sizeof(S_FT_REGMAP));
 
     error = ft5316_read_reg(CONFIG_INDEV_TOUCH_I2C, 0, (uint8_t *)&sFtRegMap, sizeof(sFtRegMap));
     if (error)
     {
         LV_LOG_ERROR("Get touch data failed, err:");
-        goto exit_indev_touch_get_data;
-    }
 
-    if (sFtRegMap.u8TDStatus > CONFIG_MAX_TOUCH)
-    {
-        LV_LOG_ERROR("FW report max point:%d > panel info. max:%d", sFtRegMap.u8TDStatus, CONFIG_MAX_TOUCH);
+        /* Report all lifted. */
+        s_sPoints.u32Count = 0;
+        s_i16PrimaryId = -1;
         goto exit_indev_touch_get_data;
     }
+#endif
 
-    if (pre_touch > sFtRegMap.u8TDStatus)               /* point up */
+    points = sFtRegMap.u8TDStatus;
+    if (points > CONFIG_MAX_TOUCH)
     {
-        for (i = 0; i < CONFIG_MAX_TOUCH; i++)
-        {
-            uint8_t j;
-            for (j = 0; j < sFtRegMap.u8TDStatus; j++)  /* this time touch num */
-            {
-                if (pre_id[i] == i)                /* this id is not free */
-                    break;
-            }
-
-            if ((j == sFtRegMap.u8TDStatus) && (pre_id[i] != -1))         /* free this node */
-            {
-                // LV_LOG_INFO("free %d tid=%d\n", i, pre_id[i]);
-                ft5316_touch_up(psInDevData, pre_id[i]);
-                pre_id[i] = -1;
-            }
-        }
+        LV_LOG_WARN("FW report max point:%d > panel info. max:%d", points, CONFIG_MAX_TOUCH);
+        points = CONFIG_MAX_TOUCH;
     }
 
-    for (i = 0; i < sFtRegMap.u8TDStatus; i++)
+    sNow.u32Count = 0;
+    for (i = 0; i < points; i++)
     {
         touch_event = sFtRegMap.m_sTP[i].u8EvtFlag;
         touchid = sFtRegMap.m_sTP[i].u8TouchID;
 
-        LV_LOG_INFO("(%d/%d) %d %d", i, sFtRegMap.u8TDStatus, touchid, touch_event);
+        LV_LOG_INFO("(%d/%d) %d %d", i, points, touchid, touch_event);
 
         if (touchid >= 0x0f)
             continue;
 
-        pre_id[i] = touchid;
-
         if ((touch_event == FT_EVENTFLAG_PRESS_DOWN) || (touch_event == FT_EVENTFLAG_CONTACT))
         {
             uint16_t  x, y, w;
@@ -235,36 +305,48 @@ int indev_touch_get_data(lv_indev_data_t *psInDevData)
                 continue;
             }
 
-            ft5316_touch_down(psInDevData, touchid, x, y, w);
-        }
-        else
-        {
-            // Up
-            ft5316_touch_up(psInDevData, touchid);
+            ft5316_add_point(&sNow, touchid, x, y, w);
         }
+        // Lift-up, it is not in sNow.
+
+    } // for (i = 0; i < points; i++)
+
+    ft5316_track(&sNow);
+
+    /* Gesture ID stays for some reports, take it on change only. */
+    if (sFtRegMap.m_u8Guesture != s_u8LastGesture)
+    {
+        s_u8LastGesture = sFtRegMap.m_u8Guesture;
+        if (ft5316_gesture(s_u8LastGesture) != evTOUCH_GESTURE_NONE)
+            s_sPoints.eGesture = ft5316_gesture(s_u8LastGesture);
+    }
 
-    } // for (i = 0; i < sFtRegMap.u8TDStatus; i++)
+exit_indev_touch_get_data:
 
-    pre_touch = sFtRegMap.u8TDStatus;
+    psInDevData->point.x = s_sPrimary.x;
+    psInDevData->point.y = s_sPrimary.y;
+    psInDevData->state = (s_i16PrimaryId >= 0) ? LV_INDEV_STATE_PRESSED : LV_INDEV_STATE_RELEASED;
 
     LV_LOG_INFO("%s (%d, %d)", psInDevData->state ? "Press" : "Release", psInDevData->point.x, psInDevData->point.y);
 
     return (psInDevData->state == LV_INDEV_STATE_PRESSED) ? 1 : 0;
+}
 
-exit_indev_touch_get_data:
+/* All contacts of the last report. A hardware gesture is returned once. */
+int indev_touch_get_points(S_TOUCH_POINTS *psPoints)
+{
+    LV_ASSERT(psPoints != NULL);
 
-    pre_touch = 0;
+    memcpy(psPoints, &s_sPoints, sizeof(S_TOUCH_POINTS));
+    s_sPoints.eGesture = evTOUCH_GESTURE_NONE;
 
     return 0;
 }
 
 int indev_touch_init(void)
 {
-    memset(&pre_x[0], 0xff,   CONFIG_MAX_TOUCH * sizeof(int16_t));
-    memset(&pre_y[0], 0xff,   CONFIG_MAX_TOUCH * sizeof(int16_t));
-    memset(&pre_w[0], 0xff,   CONFIG_MAX_TOUCH * sizeof(int16_t));
-    memset(&s_tp_dowm[0], 0,  CONFIG_MAX_TOUCH * sizeof(int16_t));
-    memset(&pre_id[0], 0xff,  CONFIG_MAX_TOUCH * sizeof(int16_t));
+    memset(&s_sPoints, 0, sizeof(S_TOUCH_POINTS));
+    s_i16PrimaryId = -1;
 
     /* Hardware reset */
     INDEV_TOUCH_SET_RST;
@@ -276,5 +358,11 @@ int indev_touch_init(void)
 
     ft5316_write_reg(CONFIG_INDEV_TOUCH_I2C, 0x0, 0);
 
+#if defined(CONFIG_INDEV_TOUCH_I2C_IRQ)
+    /* Register setup above is blocking, reads from now on are in I2C interrupts. */
+    touch_i2c_async_init(&s_sFtAsyncCfg, CONFIG_INDEV_TOUCH_I2C_IRQ);
+    touch_i2c_async_kick();
+#endif
+
     return 0;
 }
@@ -0,0 +1,238 @@
+/**************************************************************************//**
+ * @file     touch_i2c_async.c
+ * @brief    Interrupt-driven register read of I2C touch controllers
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ * @copyright (C) 2024 Nuvoton Technology Corp. All rights reserved.
+ *****************************************************************************/
+
+#include <string.h>
+#include "touch_i2c_async.h"
+
+#if defined(CONFIG_INDEV_TOUCH_I2C_IRQ)
+
+/* I2C status codes of master mode. */
+#define I2C_STATUS_START            0x08
+#define I2C_STATUS_REPEAT_START     0x10
+#define I2C_STATUS_SLAW_ACK         0x18
+#define I2C_STATUS_TXDATA_ACK       0x28
+#define I2C_STATUS_SLAR_ACK         0x40
+#define I2C_STATUS_RXDATA_ACK       0x50
+#define I2C_STATUS_RXDATA_NACK      0x58
+
+typedef enum
+{
+    evTOUCH_I2C_IDLE,
+    evTOUCH_I2C_HEAD,           // Head registers with the point count
+    evTOUCH_I2C_POINTS,         // Active points only
+} E_TOUCH_I2C_PHASE;
+
+static S_TOUCH_I2C_ASYNC_CFG s_sCfg;
+static S_TOUCH_I2C_ASYNC_STAT s_sStat;
+
+/* Filled by turns, s_u32Front is the newest complete one. */
+static uint8_t s_au8Snap[2][TOUCH_I2C_ASYNC_SNAP_MAX];
+static volatile uint32_t s_u32Front = 0;
+static volatile uint32_t s_u32Seq = 0;
+static uint32_t s_u32Fetched = 0;
+
+/* Transfer state, owned by the ISRs. Tasks touch it in critical sections only. */
+static volatile E_TOUCH_I2C_PHASE s_ePhase = evTOUCH_I2C_IDLE;
+static volatile bool s_bPending = false;
+static TickType_t s_xStartTick;
+static uint8_t *s_pu8Dst;
+static uint32_t s_u32Len;
+static uint32_t s_u32Idx;
+static uint8_t s_u8Reg;
+static bool s_bReadStage;
+
+static void touch_i2c_start(void)
+{
+    s_ePhase = evTOUCH_I2C_HEAD;
+    s_bPending = false;
+    s_bReadStage = false;
+    s_u8Reg = s_sCfg.u8BaseReg;
+    s_pu8Dst = s_au8Snap[s_u32Front ^ 1];
+    s_u32Len = s_sCfg.u8HeadLen;
+    s_u32Idx = 0;
+    s_xStartTick = xTaskGetTickCountFromISR();
+
+    I2C_START(s_sCfg.psI2C);
+}
+
+static void touch_i2c_kick_locked(void)
+{
+    s_sStat.u32Kicks++;
+
+    if (s_ePhase != evTOUCH_I2C_IDLE)
+    {
+        /* Merge into one more read after the current one. */
+        if ((xTaskGetTickCountFromISR() - s_xStartTick) < pdMS_TO_TICKS(CONFIG_TOUCH_I2C_ASYNC_TIMEOUT_MS))
+        {
+            s_bPending = true;
+            return;
+        }
+
+        s_sStat.u32Timeouts++;
+        I2C_SET_CONTROL_REG(s_sCfg.psI2C, I2C_CTL_STO_SI);
+    }
+
+    touch_i2c_start();
+}
+
+void touch_i2c_async_kick_from_isr(void)
+{
+    UBaseType_t uxSaved = taskENTER_CRITICAL_FROM_ISR();
+
+    touch_i2c_kick_locked();
+
+    taskEXIT_CRITICAL_FROM_ISR(uxSaved);
+}
+
+void touch_i2c_async_kick(void)
+{
+    taskENTER_CRITICAL();
+
+    touch_i2c_kick_locked();
+
+    taskEXIT_CRITICAL();
+}
+
+/* Last byte of a phase is in. Go on with the points, or publish the snapshot. */
+static uint32_t touch_i2c_phase_done(void)
+{
+    if (s_ePhase == evTOUCH_I2C_HEAD)
+    {
+        uint32_t u32Points = s_sCfg.pfnPointCount(s_pu8Dst);
+
+        if (u32Points > s_sCfg.u8PointMax)
+            u32Points = s_sCfg.u8PointMax;
+
+        if (u32Points)
+        {
+            s_ePhase = evTOUCH_I2C_POINTS;
+            s_bReadStage = false;
+            s_u8Reg = s_sCfg.u8BaseReg + s_sCfg.u8HeadLen;
+            s_pu8Dst += s_sCfg.u8HeadLen;
+            s_u32Len = u32Points * s_sCfg.u8PointSize;
+            s_u32Idx = 0;
+
+            /* Repeated START, the bus is kept. */
+            return I2C_CTL_STA_SI;
+        }
+    }
+
+    s_u32Front ^= 1;
+    s_u32Seq++;
+    s_sStat.u32Reads++;
+    s_ePhase = evTOUCH_I2C_IDLE;
+
+    return I2C_CTL_STO_SI;
+}
+
+void touch_i2c_async_irq_handler(void)
+{
+    I2C_T *i2c = s_sCfg.psI2C;
+    uint32_t u32Seq = s_u32Seq;
+    uint32_t u32Ctrl;
+
+    switch (I2C_GET_STATUS(i2c))
+    {
+    case I2C_STATUS_START:
+    case I2C_STATUS_REPEAT_START:
+        I2C_SET_DATA(i2c, (uint8_t)((s_sCfg.u8Addr << 1) | (s_bReadStage ? 1 : 0)));
+        u32Ctrl = I2C_CTL_SI;
+        break;
+
+    case I2C_STATUS_SLAW_ACK:
+        I2C_SET_DATA(i2c, s_u8Reg);
+        u32Ctrl = I2C_CTL_SI;
+        break;
+
+    case I2C_STATUS_TXDATA_ACK:
+        /* Register address is sent, turn around to read. */
+        s_bReadStage = true;
+        u32Ctrl = I2C_CTL_STA_SI;
+        break;
+
+    case I2C_STATUS_SLAR_ACK:
+        u32Ctrl = (s_u32Len > 1) ? I2C_CTL_SI_AA : I2C_CTL_SI;
+        break;
+
+    case I2C_STATUS_RXDATA_ACK:
+        s_pu8Dst[s_u32Idx++] = I2C_GET_DATA(i2c);
+        u32Ctrl = (s_u32Idx < (s_u32Len - 1)) ? I2C_CTL_SI_AA : I2C_CTL_SI;
+        break;
+
+    case I2C_STATUS_RXDATA_NACK:
+        s_pu8Dst[s_u32Idx++] = I2C_GET_DATA(i2c);
+        u32Ctrl = touch_i2c_phase_done();
+        break;
+
+    default:
+        /* NACK of address or register, arbitration lost, bus error. */
+        s_sStat.u32Errors++;
+        s_ePhase = evTOUCH_I2C_IDLE;
+        u32Ctrl = I2C_CTL_STO_SI;
+        break;
+    }
+
+    I2C_SET_CONTROL_REG(i2c, u32Ctrl);
+
+    if (s_ePhase == evTOUCH_I2C_IDLE)
+    {
+        /* The controller raised its IRQ again while reading. */
+        if (s_bPending)
+            touch_i2c_start();
+
+        if (u32Seq != s_u32Seq)
+            nu_lv_task_wakeup_from_isr(NU_LV_WAKEUP_INPUT);
+    }
+}
+
+int touch_i2c_async_fetch(void *pvSnap, uint32_t u32Len)
+{
+    int ret = 0;
+
+    if (u32Len > TOUCH_I2C_ASYNC_SNAP_MAX)
+        u32Len = TOUCH_I2C_ASYNC_SNAP_MAX;
+
+    /* Snapshot is small, the copy holds off the I2C interrupt only briefly. */
+    taskENTER_CRITICAL();
+
+    if (s_u32Fetched != s_u32Seq)
+    {
+        memcpy(pvSnap, s_au8Snap[s_u32Front], u32Len);
+        s_u32Fetched = s_u32Seq;
+        ret = 1;
+    }
+
+    taskEXIT_CRITICAL();
+
+    return ret;
+}
+
+void touch_i2c_async_stat(S_TOUCH_I2C_ASYNC_STAT *psStat)
+{
+    taskENTER_CRITICAL();
+    *psStat = s_sStat;
+    taskEXIT_CRITICAL();
+}
+
+/* Call it after I2C_Open() and any blocking register setup of the controller. */
+int touch_i2c_async_init(const S_TOUCH_I2C_ASYNC_CFG *psCfg, IRQn_Type eIRQn)
+{
+    LV_ASSERT((psCfg->u8HeadLen + psCfg->u8PointSize * psCfg->u8PointMax) <= TOUCH_I2C_ASYNC_SNAP_MAX);
+    LV_ASSERT(psCfg->pfnPointCount != NULL);
+
+    s_sCfg = *psCfg;
+
+    /* Same priority as the touch GPIO IRQ, so neither preempts the other. */
+    NVIC_SetPriority(eIRQn, configLIBRARY_MAX_SYSCALL_INTERRUPT_PRIORITY + 1);
+    I2C_EnableInt(s_sCfg.psI2C);
+    NVIC_EnableIRQ(eIRQn);
+
+    return 0;
+}
+
+#endif /* CONFIG_INDEV_TOUCH_I2C_IRQ */
@@ -0,0 +1,67 @@
+/**************************************************************************//**
+ * @file     touch_i2c_async.h
+ * @brief    Interrupt-driven register read of I2C touch controllers
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ * @copyright (C) 2024 Nuvoton Technology Corp. All rights reserved.
+ *****************************************************************************/
+
+#ifndef __TOUCH_I2C_ASYNC_H__
+#define __TOUCH_I2C_ASYNC_H__
+
+#include <stdint.h>
+#include "lv_glue.h"
+
+/*
+ * A read runs in I2C interrupts and has two phases in one bus transaction:
+ * the head registers from u8BaseReg, which hold the number of touch points,
+ * then only the active points after them. The result is a snapshot of the
+ * register map from u8BaseReg, published into one of two buffers. The LVGL
+ * thread copies the newest one without touching the bus.
+ *
+ * A board enables it by defining CONFIG_INDEV_TOUCH_I2C_IRQ as the IRQn of
+ * CONFIG_INDEV_TOUCH_I2C in lv_glue.h, and calling
+ * touch_i2c_async_irq_handler() from that I2C IRQ handler. Reads start from
+ * the touch GPIO ISR, or from each poll without CONFIG_INDEV_TOUCH_PIN_IRQ.
+ */
+
+#define TOUCH_I2C_ASYNC_SNAP_MAX    64
+
+/* A transfer stuck longer than this, e.g. by a bus error without interrupt, is aborted. */
+#if !defined(CONFIG_TOUCH_I2C_ASYNC_TIMEOUT_MS)
+    #define CONFIG_TOUCH_I2C_ASYNC_TIMEOUT_MS   20
+#endif
+
+typedef struct
+{
+    I2C_T *psI2C;
+    uint8_t u8Addr;             // 7-bit address
+    uint8_t u8BaseReg;          // First register of the snapshot
+    uint8_t u8HeadLen;          // Registers read in the first phase
+    uint8_t u8PointSize;        // Registers per touch point, following the head
+    uint8_t u8PointMax;
+    uint32_t (*pfnPointCount)(const uint8_t *pu8Head);  // Active points by the head, called in ISR
+} S_TOUCH_I2C_ASYNC_CFG;
+
+typedef struct
+{
+    uint32_t u32Reads;          // Published snapshots
+    uint32_t u32Errors;         // NACK, arbitration loss or bus error
+    uint32_t u32Timeouts;
+    uint32_t u32Kicks;          // Start requests, merged while busy
+} S_TOUCH_I2C_ASYNC_STAT;
+
+int touch_i2c_async_init(const S_TOUCH_I2C_ASYNC_CFG *psCfg, IRQn_Type eIRQn);
+
+/* Request a read, from the touch GPIO ISR or from a task. */
+void touch_i2c_async_kick_from_isr(void);
+void touch_i2c_async_kick(void);
+
+void touch_i2c_async_irq_handler(void);
+
+/* Copy the newest snapshot if there is one since the last call. Returns 1 if copied, 0 if none. */
+int touch_i2c_async_fetch(void *pvSnap, uint32_t u32Len);
+
+void touch_i2c_async_stat(S_TOUCH_I2C_ASYNC_STAT *psStat);
+
+#endif /* __TOUCH_I2C_ASYNC_H__ */
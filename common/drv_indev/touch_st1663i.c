@@ -7,13 +7,24 @@
  *****************************************************************************/
 
 #include <string.h>
+#include <stddef.h>
 #include "indev_touch.h"
 
+#if defined(CONFIG_INDEV_TOUCH_I2C_IRQ)
+    #include "touch_i2c_async.h"
+#endif
+
 #define ST1663I_REGITER_LEN  1
 #define ST1663I_MAX_TOUCH    5
 #define ST1663I_ADDRESS      0x55
 
-#define CONFIG_MAX_TOUCH     1
+#if !defined(CONFIG_MAX_TOUCH)
+    #define CONFIG_MAX_TOUCH     ST1663I_MAX_TOUCH
+#endif
+
+#if (CONFIG_MAX_TOUCH > ST1663I_MAX_TOUCH) || (CONFIG_MAX_TOUCH > TOUCH_POINT_MAX)
+    #error "Wrong CONFIG_MAX_TOUCH definition"
+#endif
 
 typedef struct
 {
@@ -59,12 +70,9 @@ typedef struct
 
 } S_ST_REGMAP;
 
-static int16_t pre_x[CONFIG_MAX_TOUCH];
-static int16_t pre_y[CONFIG_MAX_TOUCH];
-static int16_t pre_w[CONFIG_MAX_TOUCH];
-static int16_t s_tp_dowm[CONFIG_MAX_TOUCH];
-static int16_t pre_id[CONFIG_MAX_TOUCH];
-static uint8_t pre_touch = 0;
+static S_TOUCH_POINTS s_sPoints;            /* Contacts of the last report */
+static int16_t s_i16PrimaryId = -1;         /* Contact reported as LVGL pointer, -1 if none */
+static lv_point_t s_sPrimary;
 
 static S_ST_REGMAP sStRegMap;
 
@@ -73,80 +81,121 @@ static int st1663i_write_reg(I2C_T *i2c, uint8_t reg, uint8_t value)
     return -I2C_WriteByteOneReg(i2c, ST1663I_ADDRESS, reg, value);
 }
 
+#if !defined(CONFIG_INDEV_TOUCH_I2C_IRQ)
 static int st1663i_read_reg(I2C_T *i2c, uint8_t reg, uint8_t *data, uint32_t len)
 {
     return (I2C_ReadMultiBytesOneReg(i2c, ST1663I_ADDRESS, reg, data, len) == len) ? 0 : -1;
 }
+#endif
 
-static void st1663i_touch_up(lv_indev_data_t *buf, int16_t id)
+#if defined(CONFIG_INDEV_TOUCH_I2C_IRQ)
+/* Called in I2C ISR with the head registers of the snapshot. */
+static uint32_t st1663i_point_count(const uint8_t *pu8Head)
 {
-    s_tp_dowm[id] = 0;
+    return ((const S_ST_REGMAP *)pu8Head)->u8Fingers;
+}
 
-    buf[id].state = LV_INDEV_STATE_RELEASED;
-    buf[id].point.x = pre_x[id];
-    buf[id].point.y = pre_y[id];
+static const S_TOUCH_I2C_ASYNC_CFG s_sStAsyncCfg =
+{
+    .psI2C = CONFIG_INDEV_TOUCH_I2C,
+    .u8Addr = ST1663I_ADDRESS,
+    .u8BaseReg = 0x10,
+    .u8HeadLen = offsetof(S_ST_REGMAP, m_sTP),
+    .u8PointSize = sizeof(S_ST_TP),
+    .u8PointMax = ST1663I_MAX_TOUCH,
+    .pfnPointCount = st1663i_point_count,
+};
+#endif
+
+/*
+ * Contacts are matched by controller ID between reports, one missing in the
+ * new report is lifted. The LVGL pointer follows one contact. When it is
+ * lifted the pointer is released once, then follows the first contact down.
+ */
+static void st1663i_track(const S_TOUCH_POINTS *psNow)
+{
+    uint32_t i;
+    int16_t i16Primary = -1;
 
-    pre_x[id] = -1;  /* last point is none */
-    pre_y[id] = -1;
-    pre_w[id] = -1;
+    for (i = 0; i < psNow->u32Count; i++)
+    {
+        if (psNow->asPoint[i].i16Id == s_i16PrimaryId)
+        {
+            i16Primary = s_i16PrimaryId;
+            break;
+        }
+    }
+
+    if ((s_i16PrimaryId < 0) && (psNow->u32Count > 0))
+    {
+        i = 0;
+        i16Primary = psNow->asPoint[0].i16Id;
+    }
+
+    if (i16Primary >= 0)
+    {
+        s_sPrimary.x = psNow->asPoint[i].i16X;
+        s_sPrimary.y = psNow->asPoint[i].i16Y;
+    }
+
+    s_i16PrimaryId = i16Primary;
+    s_sPoints.u32Count = psNow->u32Count;
+    memcpy(s_sPoints.asPoint, psNow->asPoint, psNow->u32Count * sizeof(S_TOUCH_POINT));
 }
 
-static void st1663i_touch_down(lv_indev_data_t *buf, int8_t id, int16_t x, int16_t y, int16_t w)
+static void st1663i_add_point(S_TOUCH_POINTS *psNow, int16_t id, uint16_t x, uint16_t y, uint16_t w)
 {
-    s_tp_dowm[id] = 1;
+    S_TOUCH_POINT *psPoint = &psNow->asPoint[psNow->u32Count++];
 
-    buf[id].point.x = x;
-    buf[id].point.y = y;
-    buf[id].state = LV_INDEV_STATE_PRESSED;
-
-    pre_x[id] = x; /* save last point */
-    pre_y[id] = y;
-    pre_w[id] = w;
+    psPoint->i16Id = id;
+    psPoint->i16X = x;
+    psPoint->i16Y = y;
+    psPoint->i16W = w;
 }
 
 int indev_touch_get_data(lv_indev_data_t *psInDevData)
 {
-    int i, error = 0;
+    S_TOUCH_POINTS sNow;
+    int i, points, error = 0;
+
+#if defined(CONFIG_INDEV_TOUCH_I2C_IRQ)
+
+#if !defined(CONFIG_INDEV_TOUCH_PIN_IRQ)
+    /* No touch IRQ, read for the next poll. */
+    touch_i2c_async_kick();
+#endif
+
+    /* Nothing new read in background, keep the last report. */
+    error = touch_i2c_async_fetch(&sStRegMap, sizeof(sStRegMap)) ? 0 : -1;
+    if (error)
+        goto exit_indev_touch_get_data;
 
+#else
     memset(&sStRegMap, 0, sizeof(S_ST_REGMAP));
 
     error = st1663i_read_reg(CONFIG_INDEV_TOUCH_I2C, 0x10, (uint8_t *)&sStRegMap, sizeof(sStRegMap));
     if (error)
     {
         LV_LOG_ERROR("Get touch data failed, err:");
-        goto exit_indev_touch_get_data;
-    }
 
-    if (sStRegMap.u8Fingers > CONFIG_MAX_TOUCH)
-    {
-        LV_LOG_ERROR("FW report max point:%d > panel info. max:%d", sStRegMap.u8Fingers, CONFIG_MAX_TOUCH);
+        /* Report all lifted. */
+        s_sPoints.u32Count = 0;
+        s_i16PrimaryId = -1;
         goto exit_indev_touch_get_data;
     }
+#endif
 
-    if (pre_touch > sStRegMap.u8Fingers)               /* point up */
+    points = sStRegMap.u8Fingers;
+    if (points > CONFIG_MAX_TOUCH)
     {
-        for (i = 0; i < CONFIG_MAX_TOUCH; i++)
-        {
-            uint8_t j;
-            for (j = 0; j < sStRegMap.u8Fingers; j++)  /* this time touch num */
-            {
-                if (pre_id[i] == i)                /* this id is not free */
-                    break;
-            }
-
-            if ((j == sStRegMap.u8Fingers) && (pre_id[i] != -1))         /* free this node */
-            {
-                // LV_LOG_INFO("free %d tid=%d\n", i, pre_id[i]);
-                st1663i_touch_up(psInDevData, pre_id[i]);
-                pre_id[i] = -1;
-            }
-        }
+        LV_LOG_WARN("FW report max point:%d > panel info. max:%d", points, CONFIG_MAX_TOUCH);
+        points = CONFIG_MAX_TOUCH;
     }
 
-    for (i = 0; i < sStRegMap.u8Fingers; i++)
+    /* Contacts stay in their slot while down, the slot is the ID. */
+    sNow.u32Count = 0;
+    for (i = 0; i < points; i++)
     {
-        pre_id[i] = i;
-
         if (sStRegMap.m_sTP[i].u8Valid)
         {
             uint16_t  x, y, w;
@@ -164,36 +213,41 @@ int indev_touch_get_data(lv_indev_data_t *psInDevData)
                 continue;
             }
 
-            st1663i_touch_down(psInDevData, i, x, y, w);
-        }
-        else
-        {
-            // Up
-            st1663i_touch_up(psInDevData, i);
+            st1663i_add_point(&sNow, i, x, y, w);
         }
+        // Up, it is not in sNow.
+
+    } // for (i = 0; i < points; i++)
+
+    /* No gesture ID in this register map. */
+    st1663i_track(&sNow);
 
-    } // for (i = 0; i < sStRegMap.u8TDStatus; i++)
+exit_indev_touch_get_data:
 
-    pre_touch = sStRegMap.u8Fingers;
+    psInDevData->point.x = s_sPrimary.x;
+    psInDevData->point.y = s_sPrimary.y;
+    psInDevData->state = (s_i16PrimaryId >= 0) ? LV_INDEV_STATE_PRESSED : LV_INDEV_STATE_RELEASED;
 
     LV_LOG_INFO("%s (%d, %d)", psInDevData->state ? "Press" : "Release", psInDevData->point.x, psInDevData->point.y);
 
     return (psInDevData->state == LV_INDEV_STATE_PRESSED) ? 1 : 0;
+}
 
-exit_indev_touch_get_data:
+/* All contacts of the last report. A hardware gesture is returned once. */
+int indev_touch_get_points(S_TOUCH_POINTS *psPoints)
+{
+    LV_ASSERT(psPoints != NULL);
 
-    pre_touch = 0;
+    memcpy(psPoints, &s_sPoints, sizeof(S_TOUCH_POINTS));
+    s_sPoints.eGesture = evTOUCH_GESTURE_NONE;
 
     return 0;
 }
 
 int indev_touch_init(void)
 {
-    memset(&pre_x[0], 0xff,   CONFIG_MAX_TOUCH * sizeof(int16_t));
-    memset(&pre_y[0], 0xff,   CONFIG_MAX_TOUCH * sizeof(int16_t));
-    memset(&pre_w[0], 0xff,   CONFIG_MAX_TOUCH * sizeof(int16_t));
-    memset(&s_tp_dowm[0], 0,  CONFIG_MAX_TOUCH * sizeof(int16_t));
-    memset(&pre_id[0], 0xff,  CONFIG_MAX_TOUCH * sizeof(int16_t));
+    memset(&s_sPoints, 0, sizeof(S_TOUCH_POINTS));
+    s_i16PrimaryId = -1;
 
     /* Hardware reset */
     INDEV_TOUCH_SET_RST;
@@ -205,5 +259,11 @@ int indev_touch_init(void)
 
     st1663i_write_reg(CONFIG_INDEV_TOUCH_I2C, 0x0, 0);
 
+#if defined(CONFIG_INDEV_TOUCH_I2C_IRQ)
+    /* Register setup above is blocking, reads from now on are in I2C interrupts. */
+    touch_i2c_async_init(&s_sStAsyncCfg, CONFIG_INDEV_TOUCH_I2C_IRQ);
+    touch_i2c_async_kick();
+#endif
+
     return 0;
 }
@@ -8,15 +8,44 @@
 
 #include "lvgl.h"
 #include "lv_glue.h"
+#include "nu_latprobe.h"
 
 static void lv_port_disp_partial(lv_display_t *disp, const lv_area_t *area, uint8_t *px_map)
 {
+    nu_latprobe_flush_begin(area);
+
     /* Update dirty region. */
     LV_ASSERT(lcd_device_control(evLCD_CTRL_RECT_UPDATE, (void *)area) == 0);
 
+    nu_latprobe_flush_end();
+
     lv_disp_flush_ready(disp);
 }
 
+#if defined(CONFIG_DISP_TILE_LINES)
+static void lv_port_disp_tile(lv_display_t *disp, const lv_area_t *area, uint8_t *px_map)
+{
+    S_LCD_TILE sTile;
+
+    sTile.pvArea = area;
+    sTile.pvPixels = px_map;
+
+    nu_latprobe_flush_begin(area);
+
+    /* Hand over the finished tile and return, LVGL renders the other tile meanwhile. */
+    LV_ASSERT(lcd_device_control(evLCD_CTRL_TILE_UPDATE, (void *)&sTile) == 0);
+}
+
+static void lv_port_disp_tile_wait(lv_display_t *disp)
+{
+    /* Called by LVGL before reusing a tile, the flushing flag is cleared by LVGL after. */
+    LV_ASSERT(lcd_device_control(evLCD_CTRL_TILE_WAIT, NULL) == 0);
+
+    /* Late by rendering of the other tile at most. */
+    nu_latprobe_flush_end();
+}
+#endif
+
 void lv_port_disp_init(void)
 {
     lv_display_t *disp;
@@ -27,7 +56,11 @@ void lv_port_disp_init(void)
     LV_ASSERT(lcd_device_open() == 0);
     LV_ASSERT(lcd_device_control(evLCD_CTRL_GET_INFO, (void *)&sLcdInfo) == 0);
 
+#if defined(CONFIG_DISP_TILE_LINES)
+    LV_LOG_INFO("Use two tiles of %d lines: 0x%08x", CONFIG_DISP_TILE_LINES, sLcdInfo.pvVramStartAddr);
+#else
     LV_LOG_INFO("Use one screen-size shadow buffer: 0x%08x", sLcdInfo.pvVramStartAddr);
+#endif
 
     disp = lv_display_create(sLcdInfo.u32ResWidth, sLcdInfo.u32ResHeight);
     LV_ASSERT(disp != NULL);
@@ -35,9 +68,22 @@ void lv_port_disp_init(void)
     /*Set user-data*/
     lv_display_set_driver_data(disp, &sLcdInfo);
 
+#if defined(CONFIG_DISP_TILE_LINES)
+    /*Set a flush callback to send a tile, and a wait callback to block until it is sent*/
+    lv_display_set_flush_cb(disp, lv_port_disp_tile);
+    lv_display_set_flush_wait_cb(disp, lv_port_disp_tile_wait);
+
+    /*Set two tiles, rendering and transferring go by turns*/
+    lv_display_set_buffers(disp,
+                           sLcdInfo.pvVramStartAddr,
+                           (uint8_t *)sLcdInfo.pvVramStartAddr + (sLcdInfo.u32VramSize / 2),
+                           sLcdInfo.u32VramSize / 2,
+                           LV_DISPLAY_RENDER_MODE_PARTIAL);
+#else
     /*Set a flush callback to draw to the display*/
     lv_display_set_flush_cb(disp, lv_port_disp_partial);
 
     /*Set an initialized buffer*/
     lv_display_set_buffers(disp, sLcdInfo.pvVramStartAddr, NULL, sLcdInfo.u32VramSize, LV_DISPLAY_RENDER_MODE_PARTIAL);
+#endif
 }
@@ -7,10 +7,176 @@
 *****************************************************************************/
 #include "lvgl.h"
 #include "lv_glue.h"
+#include "src/indev/lv_indev_private.h"
+#include "nu_latprobe.h"
+#include "nu_predict.h"
+
+/*
+ * With CONFIG_NU_INDEV_PREDICT, a dragged pointer is reported where it is
+ * expected to be when the frame reaches the panel, to hide the render and
+ * flush time. The lookahead is CONFIG_NU_INDEV_PREDICT_LOOKAHEAD_MS, tuned by
+ * lv_port_indev_set_lookahead(). With CONFIG_NU_LATPROBE it follows the
+ * measured read-flush and flush time on each press instead.
+ *
+ * CONFIG_NU_INDEV_PREDICT_TRACE prints the raw samples as "[indev] ms x y state"
+ * lines, replay them by tools/nu_predict_replay.c to tune the filter.
+ */
+#if !defined(CONFIG_NU_INDEV_PREDICT_LOOKAHEAD_MS)
+    #define CONFIG_NU_INDEV_PREDICT_LOOKAHEAD_MS    20
+#endif
+
+#if defined(CONFIG_NU_INDEV_PREDICT_TRACE)
+    #include <stdio.h>
+#endif
+
+#if defined(CONFIG_NU_INDEV_PREDICT)
+    static S_NU_PREDICT s_sPredict;
+    static lv_indev_state_t s_eLastState = LV_INDEV_STATE_RELEASED;
+#endif
+
+/* Contacts of the last read, for capacitive panels reporting more than one. */
+static S_TOUCH_POINTS s_sTouchPoints;
+static uint32_t s_u32ZoomEvent;
+
+/*
+ * A swipe recognized by the touch controller is sent as LV_EVENT_GESTURE,
+ * the same way LVGL does for its own recognition, so lv_indev_get_gesture_dir()
+ * works in handlers. Zoom is sent as the event of lv_port_indev_get_zoom_event()
+ * with a pointer to the E_TOUCH_GESTURE as parameter.
+ */
+static void input_gesture(lv_indev_t *indev, E_TOUCH_GESTURE eGesture)
+{
+    lv_obj_t *gesture_obj = indev->pointer.act_obj;
+    lv_dir_t dir;
+
+    while (gesture_obj && lv_obj_has_flag(gesture_obj, LV_OBJ_FLAG_GESTURE_BUBBLE))
+        gesture_obj = lv_obj_get_parent(gesture_obj);
+
+    if (gesture_obj == NULL)
+        gesture_obj = lv_screen_active();
+
+    switch (eGesture)
+    {
+    case evTOUCH_GESTURE_MOVE_UP:
+        dir = LV_DIR_TOP;
+        break;
+    case evTOUCH_GESTURE_MOVE_DOWN:
+        dir = LV_DIR_BOTTOM;
+        break;
+    case evTOUCH_GESTURE_MOVE_LEFT:
+        dir = LV_DIR_LEFT;
+        break;
+    case evTOUCH_GESTURE_MOVE_RIGHT:
+        dir = LV_DIR_RIGHT;
+        break;
+
+    case evTOUCH_GESTURE_ZOOM_IN:
+    case evTOUCH_GESTURE_ZOOM_OUT:
+        lv_obj_send_event(gesture_obj, s_u32ZoomEvent, &eGesture);
+        return;
+
+    default:
+        return;
+    }
+
+    /* LVGL recognized it from the pointer already. */
+    if (indev->pointer.gesture_sent)
+        return;
+
+    indev->pointer.gesture_sent = 1;
+    indev->pointer.gesture_dir = dir;
+
+    lv_obj_send_event(gesture_obj, LV_EVENT_GESTURE, indev);
+}
+
+#if defined(CONFIG_NU_INDEV_PREDICT)
+static void input_predict(lv_indev_data_t *data)
+{
+    int32_t i32X = data->point.x;
+    int32_t i32Y = data->point.y;
+    uint32_t u32Now = lv_tick_get();
+
+#if defined(CONFIG_NU_INDEV_PREDICT_TRACE)
+    printf("[indev] %u %d %d %d\n", u32Now, (int)i32X, (int)i32Y, data->state == LV_INDEV_STATE_PRESSED);
+#endif
+
+    /* Report the release point as is, and start again on the next press. */
+    if (data->state != LV_INDEV_STATE_PRESSED)
+    {
+        nu_predict_reset(&s_sPredict);
+        s_eLastState = data->state;
+        return;
+    }
+
+#if defined(CONFIG_NU_LATPROBE)
+    if (s_eLastState != LV_INDEV_STATE_PRESSED)
+    {
+        S_NU_LATPROBE_STAT sStat;
+
+        nu_latprobe_stat(&sStat);
+        if (sStat.u32Samples)
+            s_sPredict.u32LookaheadMs = (sStat.u32AvgReadFlushUs + sStat.u32AvgFlushUs + 500) / 1000;
+    }
+#endif
+    s_eLastState = data->state;
+
+    if (nu_predict_update(&s_sPredict, u32Now, &i32X, &i32Y))
+    {
+        lv_display_t *disp = lv_display_get_default();
+
+        /* Keep it on the screen. */
+        data->point.x = LV_CLAMP(0, i32X, lv_display_get_horizontal_resolution(disp) - 1);
+        data->point.y = LV_CLAMP(0, i32Y, lv_display_get_vertical_resolution(disp) - 1);
+    }
+}
+#endif
 
 static void input_read(lv_indev_t *indev, lv_indev_data_t *data)
 {
+    S_TOUCH_POINTS sPoints;
+
     touchpad_device_read(data);
+
+    /* Nothing without CONFIG_NU_LATPROBE. */
+    nu_latprobe_read(data);
+
+#if defined(CONFIG_NU_INDEV_PREDICT)
+    input_predict(data);
+#endif
+
+    lv_memzero(&sPoints, sizeof(sPoints));
+    if (touchpad_device_control(evTOUCH_CTRL_GET_POINTS, &sPoints) != 0)
+        return;
+
+    s_sTouchPoints = sPoints;
+
+    if (sPoints.eGesture != evTOUCH_GESTURE_NONE)
+        input_gesture(indev, sPoints.eGesture);
+}
+
+/* All contacts of the last read. The pointer indev follows one of them. */
+int lv_port_indev_get_points(S_TOUCH_POINTS *psPoints)
+{
+    LV_ASSERT(psPoints != NULL);
+
+    *psPoints = s_sTouchPoints;
+
+    return (int)s_sTouchPoints.u32Count;
+}
+
+uint32_t lv_port_indev_get_zoom_event(void)
+{
+    return s_u32ZoomEvent;
+}
+
+/* Time from the read to pixels on the panel in ms, 0 to turn off prediction. */
+void lv_port_indev_set_lookahead(uint32_t u32Ms)
+{
+#if defined(CONFIG_NU_INDEV_PREDICT)
+    s_sPredict.u32LookaheadMs = u32Ms;
+#else
+    LV_UNUSED(u32Ms);
+#endif
 }
 
 void lv_port_indev_init(void)
@@ -20,6 +186,14 @@ void lv_port_indev_init(void)
     LV_ASSERT(touchpad_device_initialize() == 0);
     LV_ASSERT(touchpad_device_open() == 0);
 
+    s_u32ZoomEvent = lv_event_register_id();
+
+    nu_latprobe_init();
+
+#if defined(CONFIG_NU_INDEV_PREDICT)
+    nu_predict_init(&s_sPredict, CONFIG_NU_INDEV_PREDICT_LOOKAHEAD_MS);
+#endif
+
     lv_indev_touch = lv_indev_create();
     lv_indev_set_type(lv_indev_touch, LV_INDEV_TYPE_POINTER);
     lv_indev_set_read_cb(lv_indev_touch,  input_read);
@@ -0,0 +1,152 @@
+/**************************************************************************//**
+ * @file     nu_amp_draw.c
+ * @brief    Draw job queue between two cores
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ * @copyright (C) 2024 Nuvoton Technology Corp. All rights reserved.
+ *****************************************************************************/
+
+#include <string.h>
+#include "nu_amp_draw.h"
+
+#define NU_AMP_QUEUE_MASK       (CONFIG_NU_AMP_QUEUE_DEPTH - 1)
+
+/* Alpha above/below these is taken as opaque/transparent, as LV_OPA_MAX/LV_OPA_MIN. */
+#define NU_AMP_OPA_MAX          253
+#define NU_AMP_OPA_MIN          2
+
+void nu_amp_queue_init(S_NU_AMP_QUEUE *psQueue)
+{
+    memset(psQueue, 0, sizeof(S_NU_AMP_QUEUE));
+}
+
+bool nu_amp_queue_push(S_NU_AMP_QUEUE *psQueue, const S_NU_AMP_DRAW_JOB *psJob)
+{
+    uint32_t u32Head = psQueue->u32Head;
+
+    /* Acquire: the consumer is done reading the slot before it is reused. */
+    if ((u32Head - __atomic_load_n(&psQueue->u32Tail, __ATOMIC_ACQUIRE)) >= CONFIG_NU_AMP_QUEUE_DEPTH)
+        return false;
+
+    psQueue->asJobs[u32Head & NU_AMP_QUEUE_MASK] = *psJob;
+
+    /* Release: the slot is visible before the new head. */
+    __atomic_store_n(&psQueue->u32Head, u32Head + 1, __ATOMIC_RELEASE);
+
+    return true;
+}
+
+bool nu_amp_queue_pop(S_NU_AMP_QUEUE *psQueue, S_NU_AMP_DRAW_JOB *psJob)
+{
+    uint32_t u32Tail = psQueue->u32Tail;
+
+    if (__atomic_load_n(&psQueue->u32Head, __ATOMIC_ACQUIRE) == u32Tail)
+        return false;
+
+    *psJob = psQueue->asJobs[u32Tail & NU_AMP_QUEUE_MASK];
+
+    __atomic_store_n(&psQueue->u32Tail, u32Tail + 1, __ATOMIC_RELEASE);
+
+    return true;
+}
+
+bool nu_amp_queue_empty(const S_NU_AMP_QUEUE *psQueue)
+{
+    return __atomic_load_n(&psQueue->u32Head, __ATOMIC_ACQUIRE) == __atomic_load_n(&psQueue->u32Tail, __ATOMIC_ACQUIRE);
+}
+
+/* Rounded x / 255 for x up to 255 * 255. */
+static inline uint32_t nu_amp_div255(uint32_t x)
+{
+    x += 128;
+    return (x + (x >> 8)) >> 8;
+}
+
+static inline uint32_t nu_amp_mix(uint32_t u32Src, uint32_t u32Dst, uint32_t u32Alpha)
+{
+    uint32_t u32Inv = 255 - u32Alpha;
+    uint32_t r = nu_amp_div255(((u32Src >> 16) & 0xFF) * u32Alpha + ((u32Dst >> 16) & 0xFF) * u32Inv);
+    uint32_t g = nu_amp_div255(((u32Src >> 8) & 0xFF) * u32Alpha + ((u32Dst >> 8) & 0xFF) * u32Inv);
+    uint32_t b = nu_amp_div255((u32Src & 0xFF) * u32Alpha + (u32Dst & 0xFF) * u32Inv);
+
+    return 0xFF000000UL | (r << 16) | (g << 8) | b;
+}
+
+static void nu_amp_draw_fill(const S_NU_AMP_DRAW_JOB *psJob)
+{
+    uint32_t u32Color = psJob->u32Color | 0xFF000000UL;
+    uint32_t x, y;
+
+    if (psJob->u8Opa <= NU_AMP_OPA_MIN)
+        return;
+
+    for (y = 0; y < psJob->u32Height; y++)
+    {
+        uint32_t *pu32Dst = (uint32_t *)(psJob->pu8Dst + y * psJob->u32DstStride);
+
+        if (psJob->u8Opa >= NU_AMP_OPA_MAX)
+        {
+            for (x = 0; x < psJob->u32Width; x++)
+                pu32Dst[x] = u32Color;
+        }
+        else
+        {
+            for (x = 0; x < psJob->u32Width; x++)
+                pu32Dst[x] = nu_amp_mix(u32Color, pu32Dst[x], psJob->u8Opa);
+        }
+    }
+}
+
+static void nu_amp_draw_blend(const S_NU_AMP_DRAW_JOB *psJob, bool bSrcAlpha)
+{
+    uint32_t x, y;
+
+    if (psJob->u8Opa <= NU_AMP_OPA_MIN)
+        return;
+
+    for (y = 0; y < psJob->u32Height; y++)
+    {
+        const uint32_t *pu32Src = (const uint32_t *)(psJob->pu8Src + y * psJob->u32SrcStride);
+        uint32_t *pu32Dst = (uint32_t *)(psJob->pu8Dst + y * psJob->u32DstStride);
+
+        if (!bSrcAlpha && (psJob->u8Opa >= NU_AMP_OPA_MAX))
+        {
+            memcpy(pu32Dst, pu32Src, psJob->u32Width * sizeof(uint32_t));
+            continue;
+        }
+
+        for (x = 0; x < psJob->u32Width; x++)
+        {
+            uint32_t u32Alpha = bSrcAlpha ? (pu32Src[x] >> 24) : 0xFF;
+
+            if (psJob->u8Opa < NU_AMP_OPA_MAX)
+                u32Alpha = nu_amp_div255(u32Alpha * psJob->u8Opa);
+
+            if (u32Alpha >= NU_AMP_OPA_MAX)
+                pu32Dst[x] = pu32Src[x] | 0xFF000000UL;
+            else if (u32Alpha > NU_AMP_OPA_MIN)
+                pu32Dst[x] = nu_amp_mix(pu32Src[x], pu32Dst[x], u32Alpha);
+        }
+    }
+}
+
+void nu_amp_draw_run(const S_NU_AMP_DRAW_JOB *psJob)
+{
+    switch (psJob->u32Op)
+    {
+    case eNU_AMP_DRAW_FILL:
+        nu_amp_draw_fill(psJob);
+        break;
+
+    case eNU_AMP_DRAW_BLEND_XRGB:
+        nu_amp_draw_blend(psJob, false);
+        break;
+
+    case eNU_AMP_DRAW_BLEND_ARGB:
+        nu_amp_draw_blend(psJob, true);
+        break;
+
+    default:
+        break;
+    }
+}
@@ -0,0 +1,84 @@
+/**************************************************************************//**
+ * @file     nu_amp_draw.h
+ * @brief    Draw job queue between two cores
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ * @copyright (C) 2024 Nuvoton Technology Corp. All rights reserved.
+ *****************************************************************************/
+#ifndef __NU_AMP_DRAW_H__
+#define __NU_AMP_DRAW_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/*
+ * A core hands software draw jobs to another core through a pair of
+ * single-producer single-consumer rings in shared memory, one for requests
+ * and one for completions. Indexes are free-running and published with
+ * release stores, so no lock and no interrupt masking is needed, only
+ * coherent memory between the cores. How the consumer is woken and how the
+ * completion is signalled is left to the platform (SEV/SGI on MA35D1).
+ *
+ * Jobs are plain fills and blends on 32-bit pixels, already clipped and
+ * addressed by the producer. It has no LVGL or RTOS dependency, so
+ * tools/nu_amp_draw_test.c runs the protocol with two threads on host.
+ */
+
+/* Number of slots in a ring, a power of 2. */
+#if !defined(CONFIG_NU_AMP_QUEUE_DEPTH)
+    #define CONFIG_NU_AMP_QUEUE_DEPTH       8
+#endif
+
+/* Producer and consumer indexes are kept on separate lines. */
+#if !defined(CONFIG_NU_AMP_CACHE_LINE)
+    #define CONFIG_NU_AMP_CACHE_LINE        64
+#endif
+
+#if (CONFIG_NU_AMP_QUEUE_DEPTH & (CONFIG_NU_AMP_QUEUE_DEPTH - 1))
+    #error "CONFIG_NU_AMP_QUEUE_DEPTH must be a power of 2"
+#endif
+
+typedef enum
+{
+    eNU_AMP_DRAW_FILL,          // u32Color onto XRGB8888 destination
+    eNU_AMP_DRAW_BLEND_XRGB,    // XRGB8888 source, alpha is u8Opa
+    eNU_AMP_DRAW_BLEND_ARGB,    // ARGB8888 source, alpha is scaled by u8Opa
+} E_NU_AMP_DRAW_OP;
+
+typedef struct
+{
+    uint32_t u32Op;             // E_NU_AMP_DRAW_OP
+    uint32_t u32Width;          // Pixels
+    uint32_t u32Height;
+    uint8_t *pu8Dst;            // First pixel of the area
+    uint32_t u32DstStride;      // Bytes
+    const uint8_t *pu8Src;      // First pixel of the area, blends only
+    uint32_t u32SrcStride;
+    uint32_t u32Color;          // XRGB8888, fills only
+    uint8_t u8Opa;              // 0..255
+    void *pvUserData;           // Passed back as is
+} S_NU_AMP_DRAW_JOB;
+
+typedef struct
+{
+    volatile uint32_t u32Head;  // Written by the producer only
+    uint8_t au8Pad0[CONFIG_NU_AMP_CACHE_LINE - sizeof(uint32_t)];
+    volatile uint32_t u32Tail;  // Written by the consumer only
+    uint8_t au8Pad1[CONFIG_NU_AMP_CACHE_LINE - sizeof(uint32_t)];
+    S_NU_AMP_DRAW_JOB asJobs[CONFIG_NU_AMP_QUEUE_DEPTH];
+} S_NU_AMP_QUEUE;
+
+void nu_amp_queue_init(S_NU_AMP_QUEUE *psQueue);
+
+/* Producer side. Returns false if it is full. */
+bool nu_amp_queue_push(S_NU_AMP_QUEUE *psQueue, const S_NU_AMP_DRAW_JOB *psJob);
+
+/* Consumer side. Returns false if it is empty. */
+bool nu_amp_queue_pop(S_NU_AMP_QUEUE *psQueue, S_NU_AMP_DRAW_JOB *psJob);
+
+bool nu_amp_queue_empty(const S_NU_AMP_QUEUE *psQueue);
+
+/* Execute a job on the calling core. */
+void nu_amp_draw_run(const S_NU_AMP_DRAW_JOB *psJob);
+
+#endif /* __NU_AMP_DRAW_H__ */
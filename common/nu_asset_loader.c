@@ -0,0 +1,312 @@
+/**************************************************************************//**
+ * @file     nu_asset_loader.c
+ * @brief    Background asset loader on FatFs
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ * @copyright (C) 2024 Nuvoton Technology Corp. All rights reserved.
+ *****************************************************************************/
+#include <string.h>
+#include "FreeRTOS.h"
+#include "task.h"
+#include "ff.h"
+#include "nu_misc.h"
+#include "nu_memtag.h"
+#include "nu_asset_loader.h"
+
+/*
+ * FatFs is shared with lv_fs of the LVGL thread, so it must be built with
+ * FF_FS_REENTRANT.
+ */
+#if !FF_FS_REENTRANT
+    #error "nu_asset_loader needs FF_FS_REENTRANT in ffconf.h"
+#endif
+
+typedef enum
+{
+    evASSET_REQ_FREE,
+    evASSET_REQ_QUEUED,
+    evASSET_REQ_LOADING,
+    evASSET_REQ_DONE,
+    evASSET_REQ_CANCELLED,      // While loading
+    evASSET_REQ_DROPPED,        // Cancelled and loaded, freed at dispatch
+} E_ASSET_REQ_STATE;
+
+typedef struct
+{
+    volatile E_ASSET_REQ_STATE eState;
+    uint32_t u32Id;             // Also the order of arrival
+    int i32Result;
+    char szPath[CONFIG_NU_ASSET_LOADER_PATH_MAX];
+    uint32_t u32Offset;
+    uint32_t u32Size;
+    void *pvBuf;
+    E_NU_ASSET_PRIO ePrio;
+    nu_asset_process_t pfnProcess;
+    nu_asset_done_t pfnDone;
+    void *pvUserData;
+} S_ASSET_REQ;
+
+static S_ASSET_REQ s_asAssetReq[CONFIG_NU_ASSET_LOADER_REQ_NUM];
+static uint32_t s_u32NextId = 1;
+static TaskHandle_t s_hLoaderTask = NULL;
+
+/* The loader task keeps the last file open, a pack is opened once for all its assets. */
+static FIL s_sFile;
+static char s_szOpenPath[CONFIG_NU_ASSET_LOADER_PATH_MAX];
+
+/* Oldest queued request of the highest priority, marked as loading. */
+static S_ASSET_REQ *asset_req_take(void)
+{
+    S_ASSET_REQ *psPick = NULL;
+    int i;
+
+    taskENTER_CRITICAL();
+
+    for (i = 0; i < CONFIG_NU_ASSET_LOADER_REQ_NUM; i++)
+    {
+        S_ASSET_REQ *psReq = &s_asAssetReq[i];
+
+        if (psReq->eState != evASSET_REQ_QUEUED)
+            continue;
+
+        if ((psPick == NULL) ||
+                (psReq->ePrio < psPick->ePrio) ||
+                ((psReq->ePrio == psPick->ePrio) && ((int32_t)(psReq->u32Id - psPick->u32Id) < 0)))
+            psPick = psReq;
+    }
+
+    if (psPick != NULL)
+        psPick->eState = evASSET_REQ_LOADING;
+
+    taskEXIT_CRITICAL();
+
+    return psPick;
+}
+
+static int asset_req_read(S_ASSET_REQ *psReq)
+{
+    UINT uiRead;
+
+    if (strcmp(s_szOpenPath, psReq->szPath) != 0)
+    {
+        if (s_szOpenPath[0] != '\0')
+        {
+            f_close(&s_sFile);
+            s_szOpenPath[0] = '\0';
+        }
+
+        if (f_open(&s_sFile, psReq->szPath, FA_READ) != FR_OK)
+            return -1;
+
+        strcpy(s_szOpenPath, psReq->szPath);
+    }
+
+    if (f_lseek(&s_sFile, psReq->u32Offset) != FR_OK)
+        return -1;
+
+    if ((f_read(&s_sFile, psReq->pvBuf, psReq->u32Size, &uiRead) != FR_OK) || (uiRead != psReq->u32Size))
+        return -1;
+
+    return 0;
+}
+
+static void nu_asset_loader_task(void *pvParameters)
+{
+    S_ASSET_REQ *psReq;
+    int i32Result;
+
+    LV_UNUSED(pvParameters);
+
+    while (1)
+    {
+        psReq = asset_req_take();
+
+        if (psReq == NULL)
+        {
+            /* Nothing queued, don't hold the file while idle. */
+            if (s_szOpenPath[0] != '\0')
+            {
+                f_close(&s_sFile);
+                s_szOpenPath[0] = '\0';
+            }
+
+            ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+            continue;
+        }
+
+        i32Result = asset_req_read(psReq);
+
+        if ((i32Result == 0) && (psReq->pfnProcess != NULL))
+            i32Result = psReq->pfnProcess(psReq->pvBuf, psReq->u32Size, psReq->pvUserData);
+
+        taskENTER_CRITICAL();
+        psReq->i32Result = i32Result;
+        psReq->eState = (psReq->eState == evASSET_REQ_LOADING) ? evASSET_REQ_DONE : evASSET_REQ_DROPPED;
+        taskEXIT_CRITICAL();
+
+        /* Callbacks and frees of cancelled requests run in the LVGL thread. */
+        nu_lv_task_wakeup(NU_LV_WAKEUP_ASSET);
+    }
+}
+
+int nu_asset_loader_init(void)
+{
+    if (s_hLoaderTask != NULL)
+        return 0;
+
+    if (xTaskCreate(nu_asset_loader_task, "asset", CONFIG_NU_ASSET_LOADER_STACKSIZE, NULL,
+                    CONFIG_NU_ASSET_LOADER_PRIORITY, &s_hLoaderTask) != pdPASS)
+        return -1;
+
+    return 0;
+}
+
+uint32_t nu_asset_loader_request(const S_NU_ASSET_REQ *psReq)
+{
+    S_ASSET_REQ *psSlot = NULL;
+    uint32_t u32Size = psReq->u32Size;
+    void *pvBuf = psReq->pvBuf;
+    int i;
+
+    LV_ASSERT_NULL(s_hLoaderTask);
+    LV_ASSERT(psReq->ePrio < evNU_ASSET_PRIO_CNT);
+
+    if (strlen(psReq->szPath) >= CONFIG_NU_ASSET_LOADER_PATH_MAX)
+        return NU_ASSET_REQ_INVALID;
+
+    for (i = 0; i < CONFIG_NU_ASSET_LOADER_REQ_NUM; i++)
+    {
+        if (s_asAssetReq[i].eState == evASSET_REQ_FREE)
+        {
+            psSlot = &s_asAssetReq[i];
+            break;
+        }
+    }
+
+    if (psSlot == NULL)
+        return NU_ASSET_REQ_INVALID;
+
+    if (u32Size == 0)
+    {
+        FILINFO sInfo;
+
+        /* Whole file, FatFs is reentrant so a stat here is safe. */
+        if ((f_stat(psReq->szPath, &sInfo) != FR_OK) || (sInfo.fsize <= psReq->u32Offset))
+            return NU_ASSET_REQ_INVALID;
+
+        u32Size = (uint32_t)sInfo.fsize - psReq->u32Offset;
+    }
+
+    if (pvBuf == NULL)
+    {
+        pvBuf = NU_MEMTAG_MALLOC(lv_malloc, evNU_MEMTAG_IMAGE, u32Size);
+        if (pvBuf == NULL)
+            return NU_ASSET_REQ_INVALID;
+    }
+
+    strcpy(psSlot->szPath, psReq->szPath);
+    psSlot->u32Offset = psReq->u32Offset;
+    psSlot->u32Size = u32Size;
+    psSlot->pvBuf = pvBuf;
+    psSlot->ePrio = psReq->ePrio;
+    psSlot->pfnProcess = psReq->pfnProcess;
+    psSlot->pfnDone = psReq->pfnDone;
+    psSlot->pvUserData = psReq->pvUserData;
+    psSlot->i32Result = -1;
+
+    psSlot->u32Id = s_u32NextId++;
+    if (s_u32NextId == NU_ASSET_REQ_INVALID)
+        s_u32NextId++;
+
+    taskENTER_CRITICAL();
+    psSlot->eState = evASSET_REQ_QUEUED;
+    taskEXIT_CRITICAL();
+
+    xTaskNotifyGive(s_hLoaderTask);
+
+    return psSlot->u32Id;
+}
+
+int nu_asset_loader_cancel(uint32_t u32ReqId)
+{
+    S_ASSET_REQ *psReq = NULL;
+    E_ASSET_REQ_STATE eState = evASSET_REQ_FREE;
+    int i;
+
+    if (u32ReqId == NU_ASSET_REQ_INVALID)
+        return -1;
+
+    taskENTER_CRITICAL();
+
+    for (i = 0; i < CONFIG_NU_ASSET_LOADER_REQ_NUM; i++)
+    {
+        if ((s_asAssetReq[i].eState != evASSET_REQ_FREE) && (s_asAssetReq[i].u32Id == u32ReqId))
+        {
+            psReq = &s_asAssetReq[i];
+            eState = psReq->eState;
+
+            /* The loader task owns a loading buffer, let dispatch free it. */
+            if (eState == evASSET_REQ_LOADING)
+                psReq->eState = evASSET_REQ_CANCELLED;
+            else if ((eState == evASSET_REQ_QUEUED) || (eState == evASSET_REQ_DONE))
+                psReq->eState = evASSET_REQ_FREE;
+            break;
+        }
+    }
+
+    taskEXIT_CRITICAL();
+
+    if ((psReq == NULL) || (eState == evASSET_REQ_CANCELLED) || (eState == evASSET_REQ_DROPPED))
+        return -1;
+
+    if (eState != evASSET_REQ_LOADING)
+    {
+        NU_MEMTAG_FREE(lv_free, psReq->pvBuf);
+        psReq->pvBuf = NULL;
+    }
+
+    return 0;
+}
+
+uint32_t nu_asset_loader_pending(void)
+{
+    uint32_t u32Count = 0;
+    int i;
+
+    for (i = 0; i < CONFIG_NU_ASSET_LOADER_REQ_NUM; i++)
+    {
+        E_ASSET_REQ_STATE eState = s_asAssetReq[i].eState;
+
+        if ((eState == evASSET_REQ_QUEUED) || (eState == evASSET_REQ_LOADING) || (eState == evASSET_REQ_DONE))
+            u32Count++;
+    }
+
+    return u32Count;
+}
+
+void nu_asset_loader_dispatch(void)
+{
+    int i;
+
+    for (i = 0; i < CONFIG_NU_ASSET_LOADER_REQ_NUM; i++)
+    {
+        S_ASSET_REQ *psReq = &s_asAssetReq[i];
+
+        E_ASSET_REQ_STATE eState = psReq->eState;
+        nu_asset_done_t pfnDone = psReq->pfnDone;
+        void *pvBuf = psReq->pvBuf;
+
+        /* Only the loader task moves a request out of loading, to done or dropped. */
+        if ((eState != evASSET_REQ_DONE) && (eState != evASSET_REQ_DROPPED))
+            continue;
+
+        psReq->pvBuf = NULL;
+        psReq->eState = evASSET_REQ_FREE;
+
+        /* The slot is free already, so the callback may queue a new request. */
+        if ((eState == evASSET_REQ_DONE) && (pfnDone != NULL))
+            pfnDone(psReq->i32Result, pvBuf, psReq->u32Size, psReq->pvUserData);
+        else
+            NU_MEMTAG_FREE(lv_free, pvBuf);
+    }
+}
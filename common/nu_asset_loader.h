@@ -0,0 +1,95 @@
+/**************************************************************************//**
+ * @file     nu_asset_loader.h
+ * @brief    Background asset loader on FatFs
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ * @copyright (C) 2024 Nuvoton Technology Corp. All rights reserved.
+ *****************************************************************************/
+#ifndef __NU_ASSET_LOADER_H__
+#define __NU_ASSET_LOADER_H__
+
+#include <stdint.h>
+#include "lvgl.h"
+
+/*
+ * A low-priority task reads assets from FatFs into buffers, so the LVGL
+ * thread never blocks on storage. Requests are served by priority, then
+ * in order of arrival.
+ *
+ * LVGL runs without OS support (LV_OS_NONE), so the loader task touches
+ * neither lv_malloc nor lv_fs. Buffers are allocated by the request call,
+ * and completion is signalled by NU_LV_WAKEUP_ASSET to the LVGL task which
+ * runs nu_asset_loader_dispatch() to invoke the callbacks. All functions
+ * below are for the LVGL thread only.
+ */
+
+/* Concurrent requests, queued and in flight. */
+#if !defined(CONFIG_NU_ASSET_LOADER_REQ_NUM)
+    #define CONFIG_NU_ASSET_LOADER_REQ_NUM      8
+#endif
+
+/* Longest FatFs path of a request, including the terminator. */
+#if !defined(CONFIG_NU_ASSET_LOADER_PATH_MAX)
+    #define CONFIG_NU_ASSET_LOADER_PATH_MAX     32
+#endif
+
+#if !defined(CONFIG_NU_ASSET_LOADER_STACKSIZE)
+    #define CONFIG_NU_ASSET_LOADER_STACKSIZE    512
+#endif
+
+#if !defined(CONFIG_NU_ASSET_LOADER_PRIORITY)
+    #define CONFIG_NU_ASSET_LOADER_PRIORITY     (tskIDLE_PRIORITY + 1)
+#endif
+
+#define NU_ASSET_REQ_INVALID        0
+
+typedef enum
+{
+    evNU_ASSET_PRIO_HIGH,       // On the visible screen
+    evNU_ASSET_PRIO_NORMAL,
+    evNU_ASSET_PRIO_LOW,        // Prefetch
+    evNU_ASSET_PRIO_CNT
+} E_NU_ASSET_PRIO;
+
+/*
+ * Completion in the LVGL thread. i32Result is 0 on success. The callback
+ * owns pvBuf from then on, also on failure where its content is undefined.
+ * Release it by NU_MEMTAG_FREE(lv_free, ...). A cancelled request frees
+ * the buffer itself.
+ */
+typedef void (*nu_asset_done_t)(int i32Result, void *pvBuf, uint32_t u32Size, void *pvUserData);
+
+/*
+ * Optional post-processing in the loader task after the read, e.g. to
+ * inflate or check a payload in place. It must not call LVGL.
+ */
+typedef int (*nu_asset_process_t)(void *pvBuf, uint32_t u32Size, void *pvUserData);
+
+typedef struct
+{
+    const char *szPath;         // FatFs path, e.g. "0:assets.pak"
+    uint32_t u32Offset;         // Payload offset in the file
+    uint32_t u32Size;           // Payload size, 0 for the whole file
+    void *pvBuf;                // u32Size bytes from NU_MEMTAG_MALLOC(lv_malloc, ...), or NULL to allocate
+    E_NU_ASSET_PRIO ePrio;
+    nu_asset_process_t pfnProcess;
+    nu_asset_done_t pfnDone;
+    void *pvUserData;
+} S_NU_ASSET_REQ;
+
+int nu_asset_loader_init(void);
+
+/* Returns a request ID, or NU_ASSET_REQ_INVALID if the queue is full or the file is missing.
+   The callback does not run for an invalid ID, a given pvBuf is still owned by the caller. */
+uint32_t nu_asset_loader_request(const S_NU_ASSET_REQ *psReq);
+
+/* The callback will not run. Returns 0 if the request was still pending. */
+int nu_asset_loader_cancel(uint32_t u32ReqId);
+
+/* Requests not finished yet. */
+uint32_t nu_asset_loader_pending(void);
+
+/* Run callbacks of finished requests, on NU_LV_WAKEUP_ASSET. */
+void nu_asset_loader_dispatch(void);
+
+#endif /* __NU_ASSET_LOADER_H__ */
@@ -0,0 +1,287 @@
+/**************************************************************************//**
+ * @file     nu_asset_pack.c
+ * @brief    Indexed asset pack reader
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ * @copyright (C) 2024 Nuvoton Technology Corp. All rights reserved.
+ *****************************************************************************/
+
+#include <string.h>
+#include "nu_asset_pack.h"
+#include "nu_memtag.h"
+
+#define FNV1A_OFFSET_BASIS      0x811C9DC5UL
+#define FNV1A_PRIME             0x01000193UL
+
+/* Reflected CRC-32 (0xEDB88320), one nibble per step. Same as zlib/binascii. */
+static const uint32_t s_au32Crc32Nibble[16] =
+{
+    0x00000000, 0x1DB71064, 0x3B6E20C8, 0x26D930AC, 0x76DC4190, 0x6B6B51F4, 0x4DB26158, 0x5005713C,
+    0xEDB88320, 0xF00F9344, 0xD6D6A3E8, 0xCB61B38C, 0x9B64C2B0, 0x86D3D2D4, 0xA00AE278, 0xBDBDF21C
+};
+
+uint32_t nu_asset_crc32(uint32_t u32Crc, const void *pvBuf, uint32_t u32Len)
+{
+    const uint8_t *pu8Buf = (const uint8_t *)pvBuf;
+
+    u32Crc = ~u32Crc;
+    while (u32Len--)
+    {
+        u32Crc ^= *pu8Buf++;
+        u32Crc = (u32Crc >> 4) ^ s_au32Crc32Nibble[u32Crc & 0xF];
+        u32Crc = (u32Crc >> 4) ^ s_au32Crc32Nibble[u32Crc & 0xF];
+    }
+
+    return ~u32Crc;
+}
+
+uint32_t nu_asset_id(const char *szName)
+{
+    uint32_t u32Hash = FNV1A_OFFSET_BASIS;
+
+    while (*szName)
+    {
+        u32Hash ^= (uint8_t)*szName++;
+        u32Hash *= FNV1A_PRIME;
+    }
+
+    return u32Hash;
+}
+
+static int nu_asset_file_read(void *pvUserData, uint32_t u32Offset, void *pvBuf, uint32_t u32Len)
+{
+    lv_fs_file_t *psFile = (lv_fs_file_t *)pvUserData;
+    uint32_t u32Read = 0;
+
+    if (lv_fs_seek(psFile, u32Offset, LV_FS_SEEK_SET) != LV_FS_RES_OK)
+        return -1;
+
+    if ((lv_fs_read(psFile, pvBuf, u32Len, &u32Read) != LV_FS_RES_OK) || (u32Read != u32Len))
+        return -1;
+
+    return 0;
+}
+
+static int nu_asset_mapped_read(void *pvUserData, uint32_t u32Offset, void *pvBuf, uint32_t u32Len)
+{
+    memcpy(pvBuf, (const uint8_t *)pvUserData + u32Offset, u32Len);
+
+    return 0;
+}
+
+static int nu_asset_pack_index_load(S_NU_ASSET_PACK *psPack)
+{
+    S_NU_ASSET_PACK_HEADER *psHeader = &psPack->sHeader;
+    uint32_t u32IndexSize;
+
+    if (psPack->pfnRead(psPack->pvUserData, 0, psHeader, sizeof(S_NU_ASSET_PACK_HEADER)) != 0)
+        goto exit_nu_asset_pack_index_load;
+
+    if ((psHeader->u32Magic != NU_ASSET_PACK_MAGIC) ||
+            (psHeader->u16Version != NU_ASSET_PACK_VERSION) ||
+            (psHeader->u16Count == 0))
+        goto exit_nu_asset_pack_index_load;
+
+    u32IndexSize = psHeader->u16Count * sizeof(S_NU_ASSET_ENTRY);
+
+    if (psPack->pu8Mapped)
+    {
+        /* The index is used in place as well. */
+        psPack->psIndex = (S_NU_ASSET_ENTRY *)(psPack->pu8Mapped + sizeof(S_NU_ASSET_PACK_HEADER));
+    }
+    else
+    {
+        psPack->psIndex = NU_MEMTAG_MALLOC(lv_malloc, evNU_MEMTAG_IMAGE, u32IndexSize);
+        if (!psPack->psIndex)
+            goto exit_nu_asset_pack_index_load;
+
+        if (psPack->pfnRead(psPack->pvUserData, sizeof(S_NU_ASSET_PACK_HEADER), psPack->psIndex, u32IndexSize) != 0)
+            goto exit_nu_asset_pack_index_load;
+    }
+
+    if (nu_asset_crc32(0, psPack->psIndex, u32IndexSize) != psHeader->u32IndexCrc)
+    {
+        LV_LOG_WARN("Asset pack index CRC mismatch");
+        goto exit_nu_asset_pack_index_load;
+    }
+
+    return 0;
+
+exit_nu_asset_pack_index_load:
+
+    if (!psPack->pu8Mapped && psPack->psIndex)
+        NU_MEMTAG_FREE(lv_free, psPack->psIndex);
+    psPack->psIndex = NULL;
+
+    return -1;
+}
+
+/**
+ * Open a pack stored as a file, e.g. "0:assets.pak" on the FatFs drive.
+ */
+int nu_asset_pack_open(S_NU_ASSET_PACK *psPack, const char *szPath)
+{
+    LV_ASSERT_NULL(psPack);
+
+    lv_memzero(psPack, sizeof(S_NU_ASSET_PACK));
+
+    if (lv_fs_open(&psPack->sFile, szPath, LV_FS_MODE_RD) != LV_FS_RES_OK)
+        return -1;
+
+    psPack->bIsFile    = true;
+    psPack->pfnRead    = nu_asset_file_read;
+    psPack->pvUserData = &psPack->sFile;
+
+    if (nu_asset_pack_index_load(psPack) != 0)
+    {
+        lv_fs_close(&psPack->sFile);
+        psPack->bIsFile = false;
+        return -1;
+    }
+
+    return 0;
+}
+
+/**
+ * Open a pack written raw to a flash partition, read through pfnRead.
+ */
+int nu_asset_pack_open_raw(S_NU_ASSET_PACK *psPack, nu_asset_read_t pfnRead, void *pvUserData)
+{
+    LV_ASSERT_NULL(psPack);
+    LV_ASSERT_NULL(pfnRead);
+
+    lv_memzero(psPack, sizeof(S_NU_ASSET_PACK));
+
+    psPack->pfnRead    = pfnRead;
+    psPack->pvUserData = pvUserData;
+
+    return nu_asset_pack_index_load(psPack);
+}
+
+/**
+ * Open a pack in a memory-mapped window, payloads are returned in place.
+ */
+int nu_asset_pack_open_mapped(S_NU_ASSET_PACK *psPack, const void *pvBase)
+{
+    LV_ASSERT_NULL(psPack);
+    LV_ASSERT_NULL(pvBase);
+
+    lv_memzero(psPack, sizeof(S_NU_ASSET_PACK));
+
+    psPack->pu8Mapped  = (const uint8_t *)pvBase;
+    psPack->pfnRead    = nu_asset_mapped_read;
+    psPack->pvUserData = (void *)pvBase;
+
+    return nu_asset_pack_index_load(psPack);
+}
+
+void nu_asset_pack_close(S_NU_ASSET_PACK *psPack)
+{
+    if (!psPack->pu8Mapped && psPack->psIndex)
+        NU_MEMTAG_FREE(lv_free, psPack->psIndex);
+
+    if (psPack->bIsFile)
+        lv_fs_close(&psPack->sFile);
+
+    lv_memzero(psPack, sizeof(S_NU_ASSET_PACK));
+}
+
+/**
+ * Close the file of a pack from nu_asset_pack_open() and keep its index,
+ * for a caller that only looks entries up and reads payloads itself.
+ * nu_asset_pack_load() fails from then on, nu_asset_pack_close() frees the index.
+ */
+void nu_asset_pack_release_file(S_NU_ASSET_PACK *psPack)
+{
+    if (!psPack->bIsFile)
+        return;
+
+    lv_fs_close(&psPack->sFile);
+
+    psPack->bIsFile    = false;
+    psPack->pfnRead    = NULL;
+    psPack->pvUserData = NULL;
+}
+
+const S_NU_ASSET_ENTRY *nu_asset_pack_find(const S_NU_ASSET_PACK *psPack, uint32_t u32Id)
+{
+    int32_t i32Low = 0;
+    int32_t i32High = (int32_t)psPack->sHeader.u16Count - 1;
+
+    if (!psPack->psIndex)
+        return NULL;
+
+    while (i32Low <= i32High)
+    {
+        int32_t i32Mid = (i32Low + i32High) / 2;
+        uint32_t u32MidId = psPack->psIndex[i32Mid].u32Id;
+
+        if (u32MidId == u32Id)
+            return &psPack->psIndex[i32Mid];
+        else if (u32MidId < u32Id)
+            i32Low = i32Mid + 1;
+        else
+            i32High = i32Mid - 1;
+    }
+
+    return NULL;
+}
+
+/**
+ * Get the payload of an entry. A mapped pack returns a pointer into the
+ * window; otherwise the payload is read with one seek into an lv_malloc()
+ * buffer and checked against its CRC. Release it by nu_asset_pack_unload().
+ * A stream payload stays compressed, nu_image_decoder inflates it per band.
+ */
+const void *nu_asset_pack_load(S_NU_ASSET_PACK *psPack, const S_NU_ASSET_ENTRY *psEntry)
+{
+    uint8_t *pu8Buf;
+
+    if (!psEntry || (psEntry->u8Codec >= evNU_ASSET_CODEC_CNT))
+        return NULL;
+
+    if (psPack->pu8Mapped)
+        return psPack->pu8Mapped + psEntry->u32Offset;
+
+    if (!psPack->pfnRead)
+        return NULL;
+
+    pu8Buf = NU_MEMTAG_MALLOC(lv_malloc, evNU_MEMTAG_IMAGE, psEntry->u32Size);
+    if (!pu8Buf)
+        return NULL;
+
+    if ((psPack->pfnRead(psPack->pvUserData, psEntry->u32Offset, pu8Buf, psEntry->u32Size) != 0) ||
+            (nu_asset_crc32(0, pu8Buf, psEntry->u32Size) != psEntry->u32Crc))
+    {
+        LV_LOG_WARN("Asset %08x load failed", psEntry->u32Id);
+        NU_MEMTAG_FREE(lv_free, pu8Buf);
+        return NULL;
+    }
+
+    return pu8Buf;
+}
+
+void nu_asset_pack_unload(S_NU_ASSET_PACK *psPack, const void *pvData)
+{
+    if (pvData && !psPack->pu8Mapped)
+        NU_MEMTAG_FREE(lv_free, (void *)pvData);
+}
+
+int nu_asset_pack_image_dsc_init(S_NU_ASSET_PACK *psPack, uint32_t u32Id, lv_image_dsc_t *psImgDsc)
+{
+    const S_NU_ASSET_ENTRY *psEntry = nu_asset_pack_find(psPack, u32Id);
+    const void *pvData;
+
+    if (!psEntry || (psEntry->sImgHeader.magic != LV_IMAGE_HEADER_MAGIC))
+        return -1;
+
+    if ((pvData = nu_asset_pack_load(psPack, psEntry)) == NULL)
+        return -1;
+
+    lv_memzero(psImgDsc, sizeof(lv_image_dsc_t));
+    psImgDsc->header    = psEntry->sImgHeader;
+    psImgDsc->data_size = psEntry->u32Size;
+    psImgDsc->data      = pvData;
+
+    return 0;
+}
@@ -0,0 +1,82 @@
+/**************************************************************************//**
+ * @file     nu_asset_pack.h
+ * @brief    Indexed asset pack reader
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ * @copyright (C) 2024 Nuvoton Technology Corp. All rights reserved.
+ *****************************************************************************/
+#ifndef __NU_ASSET_PACK_H__
+#define __NU_ASSET_PACK_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "lvgl.h"
+
+/*
+ * Pack layout, little-endian, built by tools/nu_asset_pack.py:
+ *
+ *   S_NU_ASSET_PACK_HEADER
+ *   S_NU_ASSET_ENTRY[u16Count]     sorted by u32Id
+ *   payloads                       each at a multiple of u32Align
+ *
+ * u32Id is the FNV-1a hash of the asset name, see nu_asset_id().
+ */
+#define NU_ASSET_PACK_MAGIC         0x5041554EUL    /* "NUAP" */
+#define NU_ASSET_PACK_VERSION       1
+
+typedef enum
+{
+    evNU_ASSET_CODEC_STORED,
+    evNU_ASSET_CODEC_STREAM,    // Band stream of nu_image_decoder, LZ4 or RLE
+    evNU_ASSET_CODEC_CNT
+} E_NU_ASSET_CODEC;
+
+typedef struct
+{
+    uint32_t u32Magic;
+    uint16_t u16Version;
+    uint16_t u16Count;
+    uint32_t u32Align;
+    uint32_t u32IndexCrc;       // CRC-32 of the entry table
+} S_NU_ASSET_PACK_HEADER;
+
+typedef struct
+{
+    uint32_t u32Id;
+    lv_image_header_t sImgHeader;   // magic is 0 for non-image assets
+    uint32_t u32Offset;         // From the start of the pack
+    uint32_t u32Size;           // Stored payload size in byte
+    uint32_t u32Crc;            // CRC-32 of the stored payload
+    uint8_t  u8Codec;           // E_NU_ASSET_CODEC
+    uint8_t  au8Reserved[3];
+} S_NU_ASSET_ENTRY;
+
+/* Read u32Len bytes at u32Offset of the pack, return 0 on success. */
+typedef int (*nu_asset_read_t)(void *pvUserData, uint32_t u32Offset, void *pvBuf, uint32_t u32Len);
+
+typedef struct
+{
+    S_NU_ASSET_PACK_HEADER sHeader;
+    S_NU_ASSET_ENTRY *psIndex;
+    const uint8_t *pu8Mapped;   // Pack base in a memory-mapped window
+    nu_asset_read_t pfnRead;
+    void *pvUserData;
+    lv_fs_file_t sFile;
+    bool bIsFile;
+} S_NU_ASSET_PACK;
+
+uint32_t nu_asset_id(const char *szName);
+uint32_t nu_asset_crc32(uint32_t u32Crc, const void *pvBuf, uint32_t u32Len);
+
+int nu_asset_pack_open(S_NU_ASSET_PACK *psPack, const char *szPath);
+int nu_asset_pack_open_raw(S_NU_ASSET_PACK *psPack, nu_asset_read_t pfnRead, void *pvUserData);
+int nu_asset_pack_open_mapped(S_NU_ASSET_PACK *psPack, const void *pvBase);
+void nu_asset_pack_close(S_NU_ASSET_PACK *psPack);
+void nu_asset_pack_release_file(S_NU_ASSET_PACK *psPack);
+
+const S_NU_ASSET_ENTRY *nu_asset_pack_find(const S_NU_ASSET_PACK *psPack, uint32_t u32Id);
+const void *nu_asset_pack_load(S_NU_ASSET_PACK *psPack, const S_NU_ASSET_ENTRY *psEntry);
+void nu_asset_pack_unload(S_NU_ASSET_PACK *psPack, const void *pvData);
+int nu_asset_pack_image_dsc_init(S_NU_ASSET_PACK *psPack, uint32_t u32Id, lv_image_dsc_t *psImgDsc);
+
+#endif /* __NU_ASSET_PACK_H__ */
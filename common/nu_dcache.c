@@ -0,0 +1,135 @@
+/**************************************************************************//**
+ * @file     nu_dcache.c
+ * @brief    Data cache maintenance of pixel buffers by rectangle
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ * @copyright (C) 2024 Nuvoton Technology Corp. All rights reserved.
+ *****************************************************************************/
+
+#include "nu_dcache.h"
+#include "lv_glue.h"
+
+#if defined(__aarch64__)
+    #define NU_DCACHE_CLEAN(a, s)           dcache_clean_by_mva((void const *)(a), (s))
+    #define NU_DCACHE_CLEAN_INV(a, s)       dcache_clean_invalidate_by_mva((void const *)(a), (s))
+#elif defined(__ARM_ARCH_5TEJ__) || defined(__ARM_ARCH_5TE__) || defined(__TARGET_ARCH_5TEJ)
+    #define NU_DCACHE_CLEAN(a, s)           sysCleanDcache((UINT32)(a), (UINT32)(s))
+    #define NU_DCACHE_CLEAN_INV(a, s)       sysCleanInvalidatedDcache((UINT32)(a), (UINT32)(s))
+    #define NU_DCACHE_WHOLE()               sysFlushCache(D_CACHE)
+#elif defined(__DCACHE_PRESENT) && (__DCACHE_PRESENT == 1U)
+    #define NU_DCACHE_CLEAN(a, s)           SCB_CleanDCache_by_Addr((void *)(a), (int32_t)(s))
+    #define NU_DCACHE_CLEAN_INV(a, s)       SCB_CleanInvalidateDCache_by_Addr((void *)(a), (int32_t)(s))
+    #define NU_DCACHE_WHOLE()               SCB_CleanInvalidateDCache()
+#else
+    #define NU_DCACHE_CLEAN(a, s)           (void)0
+    #define NU_DCACHE_CLEAN_INV(a, s)       (void)0
+#endif
+
+static void nu_dcache_op(E_NU_DCACHE_OP eOp, uintptr_t uAddr, uint32_t u32Size)
+{
+    if (eOp == evNU_DCACHE_CLEAN)
+        NU_DCACHE_CLEAN(uAddr, u32Size);
+    else
+        NU_DCACHE_CLEAN_INV(uAddr, u32Size);
+}
+
+static int nu_dcache_whole(uint32_t u32Size)
+{
+#if defined(NU_DCACHE_WHOLE) && (CONFIG_NU_DCACHE_WHOLE_SIZE > 0)
+    if (u32Size >= CONFIG_NU_DCACHE_WHOLE_SIZE)
+    {
+        /* Clean and invalidate serve both operations. */
+        NU_DCACHE_WHOLE();
+        return 1;
+    }
+#endif
+
+    return 0;
+}
+
+void nu_dcache_range(E_NU_DCACHE_OP eOp, const void *pvAddr, uint32_t u32Size)
+{
+    if (u32Size == 0)
+        return;
+
+    if (!nu_dcache_whole(u32Size))
+        nu_dcache_op(eOp, (uintptr_t)pvAddr, u32Size);
+}
+
+void nu_dcache_rect(E_NU_DCACHE_OP eOp, const void *pvAddr, uint32_t u32Width, uint32_t u32Lines, uint32_t u32Stride)
+{
+    uintptr_t uAddr = (uintptr_t)pvAddr;
+    uint32_t i;
+
+    if ((u32Width == 0) || (u32Lines == 0))
+        return;
+
+    /* Contiguous rows or short gaps, one range over all of them. */
+    if ((u32Lines == 1) || (u32Stride <= u32Width) || ((u32Stride - u32Width) <= CONFIG_NU_DCACHE_GAP_MAX))
+    {
+        nu_dcache_range(eOp, pvAddr, ((u32Lines - 1) * u32Stride) + u32Width);
+        return;
+    }
+
+    if (nu_dcache_whole(u32Width * u32Lines))
+        return;
+
+    for (i = 0; i < u32Lines; i++)
+    {
+        nu_dcache_op(eOp, uAddr, u32Width);
+        uAddr += u32Stride;
+    }
+}
+
+void nu_dcache_dirty_init(S_NU_DCACHE_DIRTY *psDirty, void *pvBase, int32_t i32Width, int32_t i32Height, uint32_t u32BytePerPixel)
+{
+    psDirty->pu8Base = (uint8_t *)pvBase;
+    psDirty->u32Stride = (uint32_t)i32Width * u32BytePerPixel;
+    psDirty->u32BytePerPixel = u32BytePerPixel;
+    psDirty->i32Width = i32Width;
+    psDirty->i32Height = i32Height;
+
+    /* Nothing marked. */
+    psDirty->i32X1 = i32Width;
+    psDirty->i32Y1 = i32Height;
+    psDirty->i32X2 = -1;
+    psDirty->i32Y2 = -1;
+}
+
+void nu_dcache_dirty_mark(S_NU_DCACHE_DIRTY *psDirty, int32_t x1, int32_t y1, int32_t x2, int32_t y2)
+{
+    if (x1 < 0) x1 = 0;
+    if (y1 < 0) y1 = 0;
+    if (x2 >= psDirty->i32Width) x2 = psDirty->i32Width - 1;
+    if (y2 >= psDirty->i32Height) y2 = psDirty->i32Height - 1;
+
+    if ((x1 > x2) || (y1 > y2))
+        return;
+
+    if (x1 < psDirty->i32X1) psDirty->i32X1 = x1;
+    if (y1 < psDirty->i32Y1) psDirty->i32Y1 = y1;
+    if (x2 > psDirty->i32X2) psDirty->i32X2 = x2;
+    if (y2 > psDirty->i32Y2) psDirty->i32Y2 = y2;
+}
+
+void nu_dcache_dirty_mark_all(S_NU_DCACHE_DIRTY *psDirty)
+{
+    nu_dcache_dirty_mark(psDirty, 0, 0, psDirty->i32Width - 1, psDirty->i32Height - 1);
+}
+
+void nu_dcache_dirty_flush(S_NU_DCACHE_DIRTY *psDirty, E_NU_DCACHE_OP eOp)
+{
+    if ((psDirty->i32X1 > psDirty->i32X2) || (psDirty->i32Y1 > psDirty->i32Y2))
+        return;
+
+    nu_dcache_rect(eOp,
+                   psDirty->pu8Base + ((uint32_t)psDirty->i32Y1 * psDirty->u32Stride) + ((uint32_t)psDirty->i32X1 * psDirty->u32BytePerPixel),
+                   (uint32_t)(psDirty->i32X2 - psDirty->i32X1 + 1) * psDirty->u32BytePerPixel,
+                   (uint32_t)(psDirty->i32Y2 - psDirty->i32Y1 + 1),
+                   psDirty->u32Stride);
+
+    psDirty->i32X1 = psDirty->i32Width;
+    psDirty->i32Y1 = psDirty->i32Height;
+    psDirty->i32X2 = -1;
+    psDirty->i32Y2 = -1;
+}
@@ -0,0 +1,75 @@
+/**************************************************************************//**
+ * @file     nu_dcache.h
+ * @brief    Data cache maintenance of pixel buffers by rectangle
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ * @copyright (C) 2024 Nuvoton Technology Corp. All rights reserved.
+ *****************************************************************************/
+#ifndef __NU_DCACHE_H__
+#define __NU_DCACHE_H__
+
+#include <stdint.h>
+
+/*
+ * A rectangle of a pixel buffer is one line range per row. The rows are
+ * maintained as one range from the first to the last byte when the gap
+ * between them, the stride less the width, is CONFIG_NU_DCACHE_GAP_MAX bytes
+ * or less. Walking the cache lines of a short gap is cheaper than another
+ * call that starts and ends in a partial cache line.
+ *
+ * From CONFIG_NU_DCACHE_WHOLE_SIZE bytes on, the whole data cache is cleaned
+ * and invalidated instead, which takes as long as a range of about the cache
+ * size. The default is twice the 16 KB data cache of the ARM926 and should be
+ * measured on a board with a smaller one. The A35 is left on ranges, as
+ * maintenance by set/way is not broadcast to the other core.
+ *
+ * S_NU_DCACHE_DIRTY collects updated rectangles of a frame buffer, so that
+ * only the lines inside their bounding box are cleaned.
+ */
+
+typedef enum
+{
+    evNU_DCACHE_CLEAN,              // Write back, before a DMA or the display reads
+    evNU_DCACHE_CLEAN_INVALIDATE,   // Write back and drop, before a DMA writes
+    evNU_DCACHE_CNT
+} E_NU_DCACHE_OP;
+
+#if !defined(CONFIG_NU_DCACHE_GAP_MAX)
+    #define CONFIG_NU_DCACHE_GAP_MAX        256
+#endif
+
+/* 0 to keep on ranges of any size. */
+#if !defined(CONFIG_NU_DCACHE_WHOLE_SIZE)
+    #if defined(__ARM_ARCH_5TEJ__) || defined(__ARM_ARCH_5TE__) || defined(__TARGET_ARCH_5TEJ)
+        #define CONFIG_NU_DCACHE_WHOLE_SIZE     (32 * 1024)
+    #else
+        #define CONFIG_NU_DCACHE_WHOLE_SIZE     0
+    #endif
+#endif
+
+typedef struct
+{
+    uint8_t *pu8Base;               // First pixel of the buffer
+    uint32_t u32Stride;             // Bytes per line
+    uint32_t u32BytePerPixel;
+    int32_t i32Width;               // Size in pixels, marked areas are clipped to it
+    int32_t i32Height;
+    int32_t i32X1;                  // Bounding box of marked areas, empty if X1 > X2
+    int32_t i32Y1;
+    int32_t i32X2;
+    int32_t i32Y2;
+} S_NU_DCACHE_DIRTY;
+
+void nu_dcache_range(E_NU_DCACHE_OP eOp, const void *pvAddr, uint32_t u32Size);
+
+/* pvAddr is the first byte of the first row, u32Width the bytes of a row. */
+void nu_dcache_rect(E_NU_DCACHE_OP eOp, const void *pvAddr, uint32_t u32Width, uint32_t u32Lines, uint32_t u32Stride);
+
+void nu_dcache_dirty_init(S_NU_DCACHE_DIRTY *psDirty, void *pvBase, int32_t i32Width, int32_t i32Height, uint32_t u32BytePerPixel);
+void nu_dcache_dirty_mark(S_NU_DCACHE_DIRTY *psDirty, int32_t x1, int32_t y1, int32_t x2, int32_t y2);
+void nu_dcache_dirty_mark_all(S_NU_DCACHE_DIRTY *psDirty);
+
+/* Maintain the marked lines and clear the marks. */
+void nu_dcache_dirty_flush(S_NU_DCACHE_DIRTY *psDirty, E_NU_DCACHE_OP eOp);
+
+#endif /* __NU_DCACHE_H__ */
@@ -0,0 +1,773 @@
+/**************************************************************************//**
+ * @file     nu_font_stream.c
+ * @brief    LVGL binary fonts streamed from storage with a glyph cache
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ * @copyright (C) 2024 Nuvoton Technology Corp. All rights reserved.
+ *****************************************************************************/
+
+#include <string.h>
+#include "nu_font_stream.h"
+#include "nu_memtag.h"
+
+#define NU_FONT_HASH_SIZE           64      // Power of 2
+
+/* Character map formats of lv_font_conv, same as lv_font_fmt_txt_cmap_type_t. */
+#define NU_FONT_CMAP_FORMAT0_FULL   0
+#define NU_FONT_CMAP_SPARSE_FULL    1
+#define NU_FONT_CMAP_FORMAT0_TINY   2
+#define NU_FONT_CMAP_SPARSE_TINY    3
+
+#define NU_FONT_MALLOC(size)        NU_MEMTAG_MALLOC(lv_malloc, evNU_MEMTAG_FONT, (size))
+#define NU_FONT_FREE(ptr)           NU_MEMTAG_FREE(lv_free, (ptr))
+
+/* Body of the "head" table, little-endian. */
+typedef struct
+{
+    uint32_t u32Version;
+    uint16_t u16TableCount;
+    uint16_t u16FontSize;
+    uint16_t u16Ascent;
+    int16_t  i16Descent;
+    uint16_t u16TypoAscent;
+    int16_t  i16TypoDescent;
+    uint16_t u16TypoLineGap;
+    int16_t  i16MinY;
+    int16_t  i16MaxY;
+    uint16_t u16DefaultAdvW;
+    uint16_t u16KerningScale;
+    uint8_t  u8LocaFormat;      // 0: 16-bit offsets, 1: 32-bit offsets
+    uint8_t  u8GlyphIdFormat;
+    uint8_t  u8AdvWFormat;      // 0: integer, 1: FP12.4
+    uint8_t  u8Bpp;
+    uint8_t  u8XyBits;
+    uint8_t  u8WhBits;
+    uint8_t  u8AdvWBits;        // 0: all glyphs use u16DefaultAdvW
+    uint8_t  u8Compression;     // 0: none
+    uint8_t  u8SubpxMode;
+    uint8_t  u8Padding;
+    int16_t  i16UnderlinePos;
+    uint16_t u16UnderlineThickness;
+} S_NU_FONT_HEAD;
+
+/* Subtable header of the "cmap" table. */
+typedef struct
+{
+    uint32_t u32DataOffset;     // From the start of the "cmap" table
+    uint32_t u32RangeStart;
+    uint16_t u16RangeLength;
+    uint16_t u16GlyphIdStart;
+    uint16_t u16EntryCount;
+    uint8_t  u8Format;
+    uint8_t  u8Padding;
+} S_NU_FONT_CMAP_BIN;
+
+typedef struct
+{
+    S_NU_FONT_CMAP_BIN sBin;
+    uint16_t *pu16Unicode;      // Sparse formats, sorted offsets from u32RangeStart
+    void *pvGlyphOfs;           // Full formats, uint8_t for format 0, uint16_t for sparse
+} S_NU_FONT_CMAP;
+
+typedef struct
+{
+    lv_font_t sFont;
+    nu_asset_read_t pfnRead;
+    void *pvUserData;
+    uint32_t u32Base;           // Font offset in the source
+    lv_fs_file_t sFile;
+    bool bIsFile;
+
+    S_NU_FONT_HEAD sHead;
+    uint32_t u32CmapCount;
+    S_NU_FONT_CMAP *psCmap;
+    uint32_t u32LocaCount;
+    void *pvLoca;               // Glyph offsets in "glyf", uint16_t or uint32_t
+    uint32_t u32GlyfStart;
+    uint32_t u32GlyfLength;
+} S_NU_FONT_STREAM;
+
+typedef struct S_NU_FONT_GLYPH
+{
+    struct S_NU_FONT_GLYPH *psHashNext;
+    struct S_NU_FONT_GLYPH *psPrev;     // LRU list, head is the most recent
+    struct S_NU_FONT_GLYPH *psNext;
+    const S_NU_FONT_STREAM *psStream;
+    uint32_t u32Letter;
+    uint32_t u32Bytes;          // Accounted in cache
+    uint16_t u16AdvW;           // FP12.4
+    uint16_t u16BoxW;
+    uint16_t u16BoxH;
+    int16_t  i16OfsX;
+    int16_t  i16OfsY;
+    uint16_t u16BmpBit;         // First bitmap bit in au8Record
+    uint8_t  au8Record[];       // Glyph record as stored, packed bitmap included
+} S_NU_FONT_GLYPH;
+
+typedef struct
+{
+    S_NU_FONT_GLYPH *apsHash[NU_FONT_HASH_SIZE];
+    S_NU_FONT_GLYPH *psHead;
+    S_NU_FONT_GLYPH *psTail;
+    S_NU_FONT_CACHE_STAT sStat;
+    lv_mutex_t sLock;
+    bool bInit;
+} S_NU_FONT_CACHE;
+
+static S_NU_FONT_CACHE s_sFontCache;
+
+static uint32_t nu_font_hash(const S_NU_FONT_STREAM *psStream, uint32_t u32Letter)
+{
+    return (((uint32_t)(uintptr_t)psStream >> 4) ^ u32Letter ^ (u32Letter >> 6)) & (NU_FONT_HASH_SIZE - 1);
+}
+
+/* MSB-first bit field at *pu32Pos of a glyph record. */
+static uint32_t nu_font_bits(const uint8_t *pu8Rec, uint32_t *pu32Pos, uint32_t u32Bits)
+{
+    uint32_t u32Val = 0;
+
+    while (u32Bits--)
+    {
+        uint32_t u32Pos = (*pu32Pos)++;
+
+        u32Val = (u32Val << 1) | ((pu8Rec[u32Pos >> 3] >> (7 - (u32Pos & 7))) & 1);
+    }
+
+    return u32Val;
+}
+
+static int32_t nu_font_bits_signed(const uint8_t *pu8Rec, uint32_t *pu32Pos, uint32_t u32Bits)
+{
+    uint32_t u32Val = nu_font_bits(pu8Rec, pu32Pos, u32Bits);
+
+    if (u32Bits && (u32Val & (1UL << (u32Bits - 1))))
+        u32Val |= ~0UL << u32Bits;
+
+    return (int32_t)u32Val;
+}
+
+static int nu_font_file_read(void *pvUserData, uint32_t u32Offset, void *pvBuf, uint32_t u32Len)
+{
+    lv_fs_file_t *psFile = (lv_fs_file_t *)pvUserData;
+    uint32_t u32Read = 0;
+
+    if (lv_fs_seek(psFile, u32Offset, LV_FS_SEEK_SET) != LV_FS_RES_OK)
+        return -1;
+
+    if ((lv_fs_read(psFile, pvBuf, u32Len, &u32Read) != LV_FS_RES_OK) || (u32Read != u32Len))
+        return -1;
+
+    return 0;
+}
+
+static int nu_font_read(const S_NU_FONT_STREAM *psStream, uint32_t u32Offset, void *pvBuf, uint32_t u32Len)
+{
+    return psStream->pfnRead(psStream->pvUserData, psStream->u32Base + u32Offset, pvBuf, u32Len);
+}
+
+/* Length of the table at u32Offset including its 8-byte label, 0 if it is not szLabel. */
+static uint32_t nu_font_table(const S_NU_FONT_STREAM *psStream, uint32_t u32Offset, const char *szLabel)
+{
+    uint32_t au32Label[2];
+
+    if (nu_font_read(psStream, u32Offset, au32Label, sizeof(au32Label)) != 0)
+        return 0;
+
+    if ((memcmp(&au32Label[1], szLabel, 4) != 0) || (au32Label[0] < sizeof(au32Label)))
+        return 0;
+
+    return au32Label[0];
+}
+
+/* Glyph ID of a letter, 0 if the font does not have it. */
+static uint32_t nu_font_glyph_id(const S_NU_FONT_STREAM *psStream, uint32_t u32Letter)
+{
+    uint32_t i;
+
+    for (i = 0; i < psStream->u32CmapCount; i++)
+    {
+        const S_NU_FONT_CMAP *psCmap = &psStream->psCmap[i];
+        uint32_t u32Rcp = u32Letter - psCmap->sBin.u32RangeStart;
+        int32_t i32Low, i32High;
+
+        if ((u32Letter < psCmap->sBin.u32RangeStart) || (u32Rcp >= psCmap->sBin.u16RangeLength))
+            continue;
+
+        switch (psCmap->sBin.u8Format)
+        {
+        case NU_FONT_CMAP_FORMAT0_TINY:
+            return psCmap->sBin.u16GlyphIdStart + u32Rcp;
+
+        case NU_FONT_CMAP_FORMAT0_FULL:
+            return psCmap->sBin.u16GlyphIdStart + ((const uint8_t *)psCmap->pvGlyphOfs)[u32Rcp];
+
+        default:
+            /* Sparse formats: binary search in the unicode list. */
+            i32Low = 0;
+            i32High = (int32_t)psCmap->sBin.u16EntryCount - 1;
+            while (i32Low <= i32High)
+            {
+                int32_t i32Mid = (i32Low + i32High) / 2;
+
+                if (psCmap->pu16Unicode[i32Mid] == u32Rcp)
+                {
+                    if (psCmap->sBin.u8Format == NU_FONT_CMAP_SPARSE_TINY)
+                        return psCmap->sBin.u16GlyphIdStart + i32Mid;
+
+                    return psCmap->sBin.u16GlyphIdStart + ((const uint16_t *)psCmap->pvGlyphOfs)[i32Mid];
+                }
+                else if (psCmap->pu16Unicode[i32Mid] < u32Rcp)
+                    i32Low = i32Mid + 1;
+                else
+                    i32High = i32Mid - 1;
+            }
+            break;
+        }
+    }
+
+    return 0;
+}
+
+static uint32_t nu_font_loca(const S_NU_FONT_STREAM *psStream, uint32_t u32Gid)
+{
+    if (u32Gid >= psStream->u32LocaCount)
+        return psStream->u32GlyfLength;
+
+    if (psStream->sHead.u8LocaFormat)
+        return ((const uint32_t *)psStream->pvLoca)[u32Gid];
+
+    return ((const uint16_t *)psStream->pvLoca)[u32Gid];
+}
+
+static void nu_font_lru_unlink(S_NU_FONT_GLYPH *psGlyph)
+{
+    if (psGlyph->psPrev)
+        psGlyph->psPrev->psNext = psGlyph->psNext;
+    else
+        s_sFontCache.psHead = psGlyph->psNext;
+
+    if (psGlyph->psNext)
+        psGlyph->psNext->psPrev = psGlyph->psPrev;
+    else
+        s_sFontCache.psTail = psGlyph->psPrev;
+}
+
+static void nu_font_lru_push(S_NU_FONT_GLYPH *psGlyph)
+{
+    psGlyph->psPrev = NULL;
+    psGlyph->psNext = s_sFontCache.psHead;
+
+    if (s_sFontCache.psHead)
+        s_sFontCache.psHead->psPrev = psGlyph;
+    else
+        s_sFontCache.psTail = psGlyph;
+
+    s_sFontCache.psHead = psGlyph;
+}
+
+static void nu_font_glyph_drop(S_NU_FONT_GLYPH *psGlyph)
+{
+    S_NU_FONT_GLYPH **ppsLink = &s_sFontCache.apsHash[nu_font_hash(psGlyph->psStream, psGlyph->u32Letter)];
+
+    while (*ppsLink != psGlyph)
+        ppsLink = &(*ppsLink)->psHashNext;
+    *ppsLink = psGlyph->psHashNext;
+
+    nu_font_lru_unlink(psGlyph);
+
+    s_sFontCache.sStat.u32Used -= psGlyph->u32Bytes;
+    s_sFontCache.sStat.u32Glyphs--;
+
+    NU_FONT_FREE(psGlyph);
+}
+
+/* Cached glyph, made the most recent. */
+static S_NU_FONT_GLYPH *nu_font_glyph_find(const S_NU_FONT_STREAM *psStream, uint32_t u32Letter)
+{
+    S_NU_FONT_GLYPH *psGlyph = s_sFontCache.apsHash[nu_font_hash(psStream, u32Letter)];
+
+    while (psGlyph && ((psGlyph->psStream != psStream) || (psGlyph->u32Letter != u32Letter)))
+        psGlyph = psGlyph->psHashNext;
+
+    if (psGlyph && (psGlyph != s_sFontCache.psHead))
+    {
+        nu_font_lru_unlink(psGlyph);
+        nu_font_lru_push(psGlyph);
+    }
+
+    return psGlyph;
+}
+
+static S_NU_FONT_GLYPH *nu_font_glyph_load(const S_NU_FONT_STREAM *psStream, uint32_t u32Letter, uint32_t u32Gid)
+{
+    const S_NU_FONT_HEAD *psHead = &psStream->sHead;
+    S_NU_FONT_GLYPH *psGlyph;
+    uint32_t u32Start = nu_font_loca(psStream, u32Gid);
+    uint32_t u32End = nu_font_loca(psStream, u32Gid + 1);
+    uint32_t u32Len, u32Bytes, u32Pos = 0;
+    S_NU_FONT_GLYPH **ppsBucket;
+
+    if ((u32End <= u32Start) || (u32End > psStream->u32GlyfLength) || ((u32End - u32Start) > 0xFFFF))
+        return NULL;
+
+    u32Len = u32End - u32Start;
+    u32Bytes = sizeof(S_NU_FONT_GLYPH) + u32Len;
+
+    /* Make room, one glyph bigger than the whole cache is still served alone. */
+    while (s_sFontCache.psTail && ((s_sFontCache.sStat.u32Used + u32Bytes) > CONFIG_NU_FONT_CACHE_SIZE))
+    {
+        nu_font_glyph_drop(s_sFontCache.psTail);
+        s_sFontCache.sStat.u32Evictions++;
+    }
+
+    psGlyph = NU_FONT_MALLOC(u32Bytes);
+    if (!psGlyph)
+        return NULL;
+
+    if (nu_font_read(psStream, psStream->u32GlyfStart + u32Start, psGlyph->au8Record, u32Len) != 0)
+        goto exit_nu_font_glyph_load;
+
+    if (psHead->u8AdvWBits)
+        psGlyph->u16AdvW = nu_font_bits(psGlyph->au8Record, &u32Pos, psHead->u8AdvWBits);
+    else
+        psGlyph->u16AdvW = psHead->u16DefaultAdvW;
+
+    if (psHead->u8AdvWFormat == 0)
+        psGlyph->u16AdvW <<= 4;
+
+    psGlyph->i16OfsX = nu_font_bits_signed(psGlyph->au8Record, &u32Pos, psHead->u8XyBits);
+    psGlyph->i16OfsY = nu_font_bits_signed(psGlyph->au8Record, &u32Pos, psHead->u8XyBits);
+    psGlyph->u16BoxW = nu_font_bits(psGlyph->au8Record, &u32Pos, psHead->u8WhBits);
+    psGlyph->u16BoxH = nu_font_bits(psGlyph->au8Record, &u32Pos, psHead->u8WhBits);
+    psGlyph->u16BmpBit = u32Pos;
+
+    /* A truncated record would make the bitmap expansion read beyond it. */
+    if ((u32Pos + (uint32_t)psGlyph->u16BoxW * psGlyph->u16BoxH * psHead->u8Bpp) > (u32Len * 8))
+        goto exit_nu_font_glyph_load;
+
+    psGlyph->psStream = psStream;
+    psGlyph->u32Letter = u32Letter;
+    psGlyph->u32Bytes = u32Bytes;
+
+    ppsBucket = &s_sFontCache.apsHash[nu_font_hash(psStream, u32Letter)];
+    psGlyph->psHashNext = *ppsBucket;
+    *ppsBucket = psGlyph;
+    nu_font_lru_push(psGlyph);
+
+    s_sFontCache.sStat.u32Used += u32Bytes;
+    s_sFontCache.sStat.u32Glyphs++;
+
+    return psGlyph;
+
+exit_nu_font_glyph_load:
+
+    LV_LOG_WARN("Glyph U+%04X load failed", (unsigned int)u32Letter);
+    NU_FONT_FREE(psGlyph);
+
+    return NULL;
+}
+
+static S_NU_FONT_GLYPH *nu_font_glyph_get(const S_NU_FONT_STREAM *psStream, uint32_t u32Letter)
+{
+    S_NU_FONT_GLYPH *psGlyph = nu_font_glyph_find(psStream, u32Letter);
+    uint32_t u32Gid;
+
+    if (psGlyph)
+    {
+        s_sFontCache.sStat.u32Hits++;
+        return psGlyph;
+    }
+
+    s_sFontCache.sStat.u32Misses++;
+
+    u32Gid = nu_font_glyph_id(psStream, u32Letter);
+    if (u32Gid == 0)
+        return NULL;
+
+    return nu_font_glyph_load(psStream, u32Letter, u32Gid);
+}
+
+static bool nu_font_get_glyph_dsc(const lv_font_t *font, lv_font_glyph_dsc_t *dsc_out, uint32_t letter, uint32_t letter_next)
+{
+    const S_NU_FONT_STREAM *psStream = (const S_NU_FONT_STREAM *)font->dsc;
+    S_NU_FONT_GLYPH *psGlyph;
+    bool bFound = false;
+
+    LV_UNUSED(letter_next);
+
+    lv_mutex_lock(&s_sFontCache.sLock);
+
+    psGlyph = nu_font_glyph_get(psStream, letter);
+    if (psGlyph)
+    {
+        dsc_out->adv_w = (psGlyph->u16AdvW + (1 << 3)) >> 4;
+        dsc_out->box_w = psGlyph->u16BoxW;
+        dsc_out->box_h = psGlyph->u16BoxH;
+        dsc_out->ofs_x = psGlyph->i16OfsX;
+        dsc_out->ofs_y = psGlyph->i16OfsY;
+        dsc_out->bpp = psStream->sHead.u8Bpp;
+        dsc_out->is_placeholder = false;
+        dsc_out->resolved_font = font;
+        bFound = true;
+    }
+
+    lv_mutex_unlock(&s_sFontCache.sLock);
+
+    return bFound;
+}
+
+/* Expand the packed bitmap to A8 in the draw buffer, as lv_font_fmt_txt does. */
+static const void *nu_font_get_glyph_bitmap(lv_font_glyph_dsc_t *g_dsc, uint32_t letter, lv_draw_buf_t *draw_buf)
+{
+    const S_NU_FONT_STREAM *psStream = (const S_NU_FONT_STREAM *)g_dsc->resolved_font->dsc;
+    const uint32_t u32Bpp = psStream->sHead.u8Bpp;
+    const uint32_t u32Mask = (1UL << u32Bpp) - 1;
+    const void *pvRet = NULL;
+    S_NU_FONT_GLYPH *psGlyph;
+    uint32_t x, y;
+
+    lv_mutex_lock(&s_sFontCache.sLock);
+
+    psGlyph = nu_font_glyph_get(psStream, letter);
+    if (psGlyph)
+    {
+        const uint8_t *pu8Rec = psGlyph->au8Record;
+        uint8_t *pu8Out = draw_buf->data;
+        uint32_t u32Pos = psGlyph->u16BmpBit;
+
+        for (y = 0; y < psGlyph->u16BoxH; y++)
+        {
+            for (x = 0; x < psGlyph->u16BoxW; x++, u32Pos += u32Bpp)
+            {
+                uint32_t u32Shift = u32Pos & 7;
+                uint32_t u32Val;
+
+                /* A pixel straddles two bytes only on odd bit offsets of the bitmap. */
+                if ((u32Shift + u32Bpp) <= 8)
+                    u32Val = pu8Rec[u32Pos >> 3] >> (8 - u32Shift - u32Bpp);
+                else
+                    u32Val = ((pu8Rec[u32Pos >> 3] << 8) | pu8Rec[(u32Pos >> 3) + 1]) >> (16 - u32Shift - u32Bpp);
+
+                pu8Out[x] = (uint8_t)(((u32Val & u32Mask) * 255) / u32Mask);
+            }
+
+            pu8Out += draw_buf->header.stride;
+        }
+
+        pvRet = draw_buf->data;
+    }
+
+    lv_mutex_unlock(&s_sFontCache.sLock);
+
+    return pvRet;
+}
+
+static int nu_font_stream_load(S_NU_FONT_STREAM *psStream)
+{
+    S_NU_FONT_HEAD *psHead = &psStream->sHead;
+    uint32_t u32CmapStart, u32LocaStart, u32LocaLen, u32Len, i;
+
+    u32Len = nu_font_table(psStream, 0, "head");
+    if ((u32Len < (8 + sizeof(S_NU_FONT_HEAD))) || (nu_font_read(psStream, 8, psHead, sizeof(S_NU_FONT_HEAD)) != 0))
+        return -1;
+
+    if (psHead->u8Compression != 0)
+    {
+        LV_LOG_ERROR("Compressed font is not supported, build it with --no-compress");
+        return -1;
+    }
+
+    if ((psHead->u8Bpp != 1) && (psHead->u8Bpp != 2) && (psHead->u8Bpp != 4) && (psHead->u8Bpp != 8))
+    {
+        LV_LOG_ERROR("%d bpp font is not supported, build it with --bpp 1, 2, 4 or 8", psHead->u8Bpp);
+        return -1;
+    }
+
+    /* Character map, resident. */
+    u32CmapStart = u32Len;
+    if ((u32Len = nu_font_table(psStream, u32CmapStart, "cmap")) == 0)
+        return -1;
+
+    if (nu_font_read(psStream, u32CmapStart + 8, &psStream->u32CmapCount, sizeof(uint32_t)) != 0)
+        return -1;
+
+    psStream->psCmap = NU_FONT_MALLOC(psStream->u32CmapCount * sizeof(S_NU_FONT_CMAP));
+    if (!psStream->psCmap)
+        return -1;
+
+    lv_memzero(psStream->psCmap, psStream->u32CmapCount * sizeof(S_NU_FONT_CMAP));
+
+    for (i = 0; i < psStream->u32CmapCount; i++)
+    {
+        S_NU_FONT_CMAP *psCmap = &psStream->psCmap[i];
+        uint32_t u32Data, u32Count;
+
+        if (nu_font_read(psStream, u32CmapStart + 12 + i * sizeof(S_NU_FONT_CMAP_BIN), &psCmap->sBin, sizeof(S_NU_FONT_CMAP_BIN)) != 0)
+            return -1;
+
+        u32Data = u32CmapStart + psCmap->sBin.u32DataOffset;
+        u32Count = psCmap->sBin.u16EntryCount;
+
+        switch (psCmap->sBin.u8Format)
+        {
+        case NU_FONT_CMAP_FORMAT0_TINY:
+            break;
+
+        case NU_FONT_CMAP_FORMAT0_FULL:
+            if (((psCmap->pvGlyphOfs = NU_FONT_MALLOC(u32Count)) == NULL) ||
+                    (nu_font_read(psStream, u32Data, psCmap->pvGlyphOfs, u32Count) != 0))
+                return -1;
+            break;
+
+        case NU_FONT_CMAP_SPARSE_FULL:
+        case NU_FONT_CMAP_SPARSE_TINY:
+            if (((psCmap->pu16Unicode = NU_FONT_MALLOC(u32Count * 2)) == NULL) ||
+                    (nu_font_read(psStream, u32Data, psCmap->pu16Unicode, u32Count * 2) != 0))
+                return -1;
+
+            if (psCmap->sBin.u8Format == NU_FONT_CMAP_SPARSE_TINY)
+                break;
+
+            if (((psCmap->pvGlyphOfs = NU_FONT_MALLOC(u32Count * 2)) == NULL) ||
+                    (nu_font_read(psStream, u32Data + u32Count * 2, psCmap->pvGlyphOfs, u32Count * 2) != 0))
+                return -1;
+            break;
+
+        default:
+            return -1;
+        }
+    }
+
+    /* Glyph locations, resident. */
+    u32LocaStart = u32CmapStart + u32Len;
+    if ((u32LocaLen = nu_font_table(psStream, u32LocaStart, "loca")) == 0)
+        return -1;
+
+    if (nu_font_read(psStream, u32LocaStart + 8, &psStream->u32LocaCount, sizeof(uint32_t)) != 0)
+        return -1;
+
+    u32Len = psStream->u32LocaCount * (psHead->u8LocaFormat ? 4 : 2);
+    if (((psStream->pvLoca = NU_FONT_MALLOC(u32Len)) == NULL) ||
+            (nu_font_read(psStream, u32LocaStart + 12, psStream->pvLoca, u32Len) != 0))
+        return -1;
+
+    /* Glyph records, streamed. Offsets in "loca" count from the table start. */
+    psStream->u32GlyfStart = u32LocaStart + u32LocaLen;
+    if ((psStream->u32GlyfLength = nu_font_table(psStream, psStream->u32GlyfStart, "glyf")) == 0)
+        return -1;
+
+    /* Pairs would be dropped silently and the text spaced unlike the C font. */
+    if (nu_font_table(psStream, psStream->u32GlyfStart + psStream->u32GlyfLength, "kern") != 0)
+    {
+        LV_LOG_ERROR("Font with kerning is not supported, build it with --no-kerning");
+        return -1;
+    }
+
+    return 0;
+}
+
+static void nu_font_stream_free(S_NU_FONT_STREAM *psStream)
+{
+    uint32_t i;
+
+    if (psStream->psCmap)
+    {
+        for (i = 0; i < psStream->u32CmapCount; i++)
+        {
+            NU_FONT_FREE(psStream->psCmap[i].pu16Unicode);
+            NU_FONT_FREE(psStream->psCmap[i].pvGlyphOfs);
+        }
+        NU_FONT_FREE(psStream->psCmap);
+    }
+
+    NU_FONT_FREE(psStream->pvLoca);
+
+    if (psStream->bIsFile)
+        lv_fs_close(&psStream->sFile);
+
+    NU_FONT_FREE(psStream);
+}
+
+static lv_font_t *nu_font_stream_open(S_NU_FONT_STREAM *psStream)
+{
+    lv_font_t *psFont = &psStream->sFont;
+
+    if (!s_sFontCache.bInit)
+    {
+        lv_mutex_init(&s_sFontCache.sLock);
+        s_sFontCache.bInit = true;
+    }
+
+    if (nu_font_stream_load(psStream) != 0)
+    {
+        nu_font_stream_free(psStream);
+        return NULL;
+    }
+
+    psFont->get_glyph_dsc = nu_font_get_glyph_dsc;
+    psFont->get_glyph_bitmap = nu_font_get_glyph_bitmap;
+    psFont->line_height = psStream->sHead.i16MaxY - psStream->sHead.i16MinY;
+    psFont->base_line = -psStream->sHead.i16MinY;
+    psFont->subpx = LV_FONT_SUBPX_NONE;
+    psFont->underline_position = (int8_t)psStream->sHead.i16UnderlinePos;
+    psFont->underline_thickness = (int8_t)psStream->sHead.u16UnderlineThickness;
+    psFont->dsc = psStream;
+
+    return psFont;
+}
+
+static S_NU_FONT_STREAM *nu_font_stream_alloc(void)
+{
+    S_NU_FONT_STREAM *psStream = NU_FONT_MALLOC(sizeof(S_NU_FONT_STREAM));
+
+    if (psStream)
+        lv_memzero(psStream, sizeof(S_NU_FONT_STREAM));
+
+    return psStream;
+}
+
+/**
+ * Open a font file, e.g. "0:cjk24.fnt". The file stays open until
+ * nu_font_stream_delete().
+ */
+lv_font_t *nu_font_stream_create(const char *szPath)
+{
+    S_NU_FONT_STREAM *psStream = nu_font_stream_alloc();
+
+    if (!psStream)
+        return NULL;
+
+    if (lv_fs_open(&psStream->sFile, szPath, LV_FS_MODE_RD) != LV_FS_RES_OK)
+    {
+        NU_FONT_FREE(psStream);
+        return NULL;
+    }
+
+    psStream->bIsFile    = true;
+    psStream->pfnRead    = nu_font_file_read;
+    psStream->pvUserData = &psStream->sFile;
+
+    return nu_font_stream_open(psStream);
+}
+
+/**
+ * Open a font stored in an asset pack, read through the pack. The pack
+ * must stay open while the font is in use.
+ */
+lv_font_t *nu_font_stream_create_packed(S_NU_ASSET_PACK *psPack, uint32_t u32Id)
+{
+    const S_NU_ASSET_ENTRY *psEntry = nu_asset_pack_find(psPack, u32Id);
+
+    if (!psEntry || (psEntry->u8Codec != evNU_ASSET_CODEC_STORED))
+        return NULL;
+
+    return nu_font_stream_create_raw(psPack->pfnRead, psPack->pvUserData, psEntry->u32Offset);
+}
+
+/**
+ * Open a font at u32Base of any source, e.g. a raw flash partition.
+ */
+lv_font_t *nu_font_stream_create_raw(nu_asset_read_t pfnRead, void *pvUserData, uint32_t u32Base)
+{
+    S_NU_FONT_STREAM *psStream;
+
+    LV_ASSERT_NULL(pfnRead);
+
+    if ((psStream = nu_font_stream_alloc()) == NULL)
+        return NULL;
+
+    psStream->pfnRead    = pfnRead;
+    psStream->pvUserData = pvUserData;
+    psStream->u32Base    = u32Base;
+
+    return nu_font_stream_open(psStream);
+}
+
+void nu_font_stream_delete(lv_font_t *psFont)
+{
+    S_NU_FONT_STREAM *psStream = (S_NU_FONT_STREAM *)psFont->dsc;
+    S_NU_FONT_GLYPH *psGlyph, *psNext;
+
+    lv_mutex_lock(&s_sFontCache.sLock);
+
+    for (psGlyph = s_sFontCache.psHead; psGlyph; psGlyph = psNext)
+    {
+        psNext = psGlyph->psNext;
+        if (psGlyph->psStream == psStream)
+            nu_font_glyph_drop(psGlyph);
+    }
+
+    lv_mutex_unlock(&s_sFontCache.sLock);
+
+    nu_font_stream_free(psStream);
+}
+
+void nu_font_stream_prefetch(const lv_font_t *psFont, const char *szText)
+{
+    const S_NU_FONT_STREAM *psStream = (const S_NU_FONT_STREAM *)psFont->dsc;
+    struct
+    {
+        uint32_t u32Letter;
+        uint32_t u32Gid;
+        uint32_t u32Offset;
+    } asPending[CONFIG_NU_FONT_PREFETCH_MAX];
+    uint32_t u32Count = 0, u32Idx = 0, u32Letter, i;
+
+    /* Other fonts have their own providers. */
+    if (psFont->get_glyph_dsc != nu_font_get_glyph_dsc)
+        return;
+
+    lv_mutex_lock(&s_sFontCache.sLock);
+
+    while ((u32Count < CONFIG_NU_FONT_PREFETCH_MAX) && ((u32Letter = lv_text_encoded_next(szText, &u32Idx)) != 0))
+    {
+        uint32_t u32Gid, u32Offset;
+
+        /* A hit is made recent, so this batch does not evict it. */
+        if (nu_font_glyph_find(psStream, u32Letter))
+            continue;
+
+        if ((u32Gid = nu_font_glyph_id(psStream, u32Letter)) == 0)
+            continue;
+
+        for (i = 0; i < u32Count; i++)
+        {
+            if (asPending[i].u32Gid == u32Gid)
+                break;
+        }
+
+        if (i < u32Count)
+            continue;
+
+        /* Insert by offset, then the reads go forward through the file. */
+        u32Offset = nu_font_loca(psStream, u32Gid);
+        for (i = u32Count; (i > 0) && (asPending[i - 1].u32Offset > u32Offset); i--)
+            asPending[i] = asPending[i - 1];
+
+        asPending[i].u32Letter = u32Letter;
+        asPending[i].u32Gid = u32Gid;
+        asPending[i].u32Offset = u32Offset;
+        u32Count++;
+    }
+
+    for (i = 0; i < u32Count; i++)
+    {
+        s_sFontCache.sStat.u32Misses++;
+        nu_font_glyph_load(psStream, asPending[i].u32Letter, asPending[i].u32Gid);
+    }
+
+    lv_mutex_unlock(&s_sFontCache.sLock);
+}
+
+void nu_font_stream_cache_stat(S_NU_FONT_CACHE_STAT *psStat)
+{
+    if (!s_sFontCache.bInit)
+    {
+        lv_memzero(psStat, sizeof(S_NU_FONT_CACHE_STAT));
+        return;
+    }
+
+    lv_mutex_lock(&s_sFontCache.sLock);
+    *psStat = s_sFontCache.sStat;
+    lv_mutex_unlock(&s_sFontCache.sLock);
+}
@@ -0,0 +1,63 @@
+/**************************************************************************//**
+ * @file     nu_font_stream.h
+ * @brief    LVGL binary fonts streamed from storage with a glyph cache
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ * @copyright (C) 2024 Nuvoton Technology Corp. All rights reserved.
+ *****************************************************************************/
+#ifndef __NU_FONT_STREAM_H__
+#define __NU_FONT_STREAM_H__
+
+#include <stdint.h>
+#include "lvgl.h"
+#include "nu_asset_pack.h"
+
+/*
+ * Fonts in the LVGL binary format, built by
+ *
+ *   lv_font_conv --format bin --no-compress --no-kerning --bpp 4 --size 24 --font x.ttf -r 0x20-0x7F -o x24.fnt
+ *
+ * stay on storage. Only the header, character map and glyph location table
+ * are kept in RAM per font. Glyph records are read on demand into an LRU
+ * cache shared by all fonts, bounded by CONFIG_NU_FONT_CACHE_SIZE bytes.
+ * Bitmaps are kept packed in the cache and expanded to A8 at draw time.
+ *
+ * A font can be a file on any lv_fs drive, or an entry of an asset pack.
+ * The cache is guarded by an lv_mutex for draw threads.
+ *
+ * A font with a "kern" table or compressed bitmaps is refused, the create
+ * calls return NULL and log an error naming the lv_font_conv option that
+ * was missing, --no-kerning or --no-compress. So is a bpp other than
+ * 1, 2, 4 or 8.
+ */
+
+/* Bytes of glyph records in cache, headers included. */
+#if !defined(CONFIG_NU_FONT_CACHE_SIZE)
+    #define CONFIG_NU_FONT_CACHE_SIZE       (16 * 1024)
+#endif
+
+/* Glyphs fetched per nu_font_stream_prefetch() call. */
+#if !defined(CONFIG_NU_FONT_PREFETCH_MAX)
+    #define CONFIG_NU_FONT_PREFETCH_MAX     32
+#endif
+
+typedef struct
+{
+    uint32_t u32Hits;
+    uint32_t u32Misses;
+    uint32_t u32Evictions;
+    uint32_t u32Used;           // Bytes in cache
+    uint32_t u32Glyphs;         // Glyphs in cache
+} S_NU_FONT_CACHE_STAT;
+
+lv_font_t *nu_font_stream_create(const char *szPath);
+lv_font_t *nu_font_stream_create_packed(S_NU_ASSET_PACK *psPack, uint32_t u32Id);
+lv_font_t *nu_font_stream_create_raw(nu_asset_read_t pfnRead, void *pvUserData, uint32_t u32Base);
+void nu_font_stream_delete(lv_font_t *psFont);
+
+/* Load the glyphs of a text before it is laid out, in order of storage offset. */
+void nu_font_stream_prefetch(const lv_font_t *psFont, const char *szText);
+
+void nu_font_stream_cache_stat(S_NU_FONT_CACHE_STAT *psStat);
+
+#endif /* __NU_FONT_STREAM_H__ */
@@ -0,0 +1,549 @@
+/**************************************************************************//**
+ * @file     nu_ftl.c
+ * @brief    Log-structured flash translation layer for NOR flash
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ * @copyright (C) 2024 Nuvoton Technology Corp. All rights reserved.
+ *****************************************************************************/
+#include <stddef.h>
+#include <string.h>
+
+#include "nu_ftl.h"
+
+/* Override both for builds without FreeRTOS, e.g. a host test with a simulated NOR. */
+#if !defined(NU_FTL_MALLOC)
+    #include "FreeRTOS.h"
+    #include "nu_memtag.h"
+    #define NU_FTL_MALLOC(size)     NU_MEMTAG_MALLOC(pvPortMalloc, evNU_MEMTAG_FATFS, size)
+    #define NU_FTL_FREE(ptr)        NU_MEMTAG_FREE(vPortFree, ptr)
+#endif
+
+#define NU_FTL_MAGIC        0x4C54464E  /* "NFTL" */
+#define NU_FTL_ERASED       0xFFFFFFFF
+#define NU_FTL_COMMITTED    0x00000000
+#define NU_FTL_NONE         0xFFFF
+
+typedef enum
+{
+    evNU_FTL_BLK_FREE,      // Erased and formatted, sequence not set
+    evNU_FTL_BLK_SPARE,     // Found free at mount, checked blank before use
+    evNU_FTL_BLK_DATA,      // Opened, slots in use
+    evNU_FTL_BLK_DIRTY      // Needs erase before use
+} E_NU_FTL_BLK;
+
+typedef struct
+{
+    uint32_t u32Lba;        // Programmed before data
+    uint32_t u32Commit;     // Programmed to NU_FTL_COMMITTED after data
+} S_NU_FTL_SLOT;
+
+typedef struct
+{
+    uint32_t u32Magic;
+    uint32_t u32EraseCnt;
+    uint32_t u32Check;      // ~(u32Magic ^ u32EraseCnt)
+    uint32_t u32Seq;        // Programmed when the block is opened
+    uint32_t u32SeqCheck;   // ~u32Seq, tells an interrupted open
+    S_NU_FTL_SLOT asSlot[NU_FTL_SLOTS_MAX];
+} S_NU_FTL_HDR;
+
+#define NU_FTL_HDR_FORMAT_SIZE  (3 * sizeof(uint32_t))
+#define NU_FTL_HDR_SIZE(slots)  (5 * sizeof(uint32_t) + (slots) * sizeof(S_NU_FTL_SLOT))
+
+static uint32_t ftl_block_addr(S_NU_FTL *psFtl, uint32_t u32Blk)
+{
+    return u32Blk * psFtl->sFlash.u32BlockSize;
+}
+
+static uint32_t ftl_data_addr(S_NU_FTL *psFtl, uint32_t u32Phys)
+{
+    return ftl_block_addr(psFtl, u32Phys / psFtl->u32Slots) + (u32Phys % psFtl->u32Slots + 1) * NU_FTL_SECTOR_SIZE;
+}
+
+static int ftl_header_read(S_NU_FTL *psFtl, uint32_t u32Blk, S_NU_FTL_HDR *psHdr)
+{
+    if (psFtl->sFlash.pfnRead(psFtl->sFlash.pvUserData, ftl_block_addr(psFtl, u32Blk), psHdr, NU_FTL_HDR_SIZE(psFtl->u32Slots)) != 0)
+        return -1;
+
+    return ((psHdr->u32Magic == NU_FTL_MAGIC) && (psHdr->u32Check == ~(psHdr->u32Magic ^ psHdr->u32EraseCnt))) ? 0 : -1;
+}
+
+/* Check a block is erased from u32Offset, a word-aligned offset. Scratch may hold data under relocation. */
+static int ftl_is_blank(S_NU_FTL *psFtl, uint32_t u32Blk, uint32_t u32Offset)
+{
+    uint32_t au32Word[32];
+    uint32_t u32Addr = ftl_block_addr(psFtl, u32Blk) + u32Offset;
+    uint32_t u32End = ftl_block_addr(psFtl, u32Blk) + psFtl->sFlash.u32BlockSize;
+    uint32_t u32Len, i;
+
+    for (; u32Addr < u32End; u32Addr += u32Len)
+    {
+        u32Len = u32End - u32Addr;
+        if (u32Len > sizeof(au32Word))
+            u32Len = sizeof(au32Word);
+
+        if (psFtl->sFlash.pfnRead(psFtl->sFlash.pvUserData, u32Addr, au32Word, u32Len) != 0)
+            return 0;
+
+        for (i = 0; i < u32Len / sizeof(uint32_t); i++)
+        {
+            if (au32Word[i] != NU_FTL_ERASED)
+                return 0;
+        }
+    }
+
+    return 1;
+}
+
+/* Erase a dirty block and write a fresh header, keeping its erase count. */
+static int ftl_block_prepare(S_NU_FTL *psFtl, uint32_t u32Blk)
+{
+    S_NU_FTL_HDR sHdr;
+    uint32_t u32EraseCnt;
+    int bErase = 1;
+
+    if (ftl_header_read(psFtl, u32Blk, &sHdr) == 0)
+    {
+        u32EraseCnt = sHdr.u32EraseCnt + 1;
+    }
+    else if (ftl_is_blank(psFtl, u32Blk, 0))
+    {
+        /* New chip, nothing to erase. */
+        u32EraseCnt = 0;
+        bErase = 0;
+    }
+    else
+    {
+        /* Header lost by an interrupted erase, carry on from the worst known. */
+        u32EraseCnt = psFtl->sStat.u32MaxEraseCnt + 1;
+    }
+
+    if (bErase)
+    {
+        if (psFtl->sFlash.pfnErase(psFtl->sFlash.pvUserData, ftl_block_addr(psFtl, u32Blk)) != 0)
+            return -1;
+
+        psFtl->sStat.u32Erases++;
+    }
+
+    sHdr.u32Magic = NU_FTL_MAGIC;
+    sHdr.u32EraseCnt = u32EraseCnt;
+    sHdr.u32Check = ~(NU_FTL_MAGIC ^ u32EraseCnt);
+
+    if (psFtl->sFlash.pfnProg(psFtl->sFlash.pvUserData, ftl_block_addr(psFtl, u32Blk), &sHdr, NU_FTL_HDR_FORMAT_SIZE) != 0)
+        return -1;
+
+    if (u32EraseCnt > psFtl->sStat.u32MaxEraseCnt)
+        psFtl->sStat.u32MaxEraseCnt = u32EraseCnt;
+
+    psFtl->pu8State[u32Blk] = evNU_FTL_BLK_FREE;
+    psFtl->u32DirtyBlocks--;
+
+    return 0;
+}
+
+/* Take the next free block round-robin, preferring ones that need no erase. */
+static int ftl_block_open(S_NU_FTL *psFtl)
+{
+    uint32_t u32BlockCount = psFtl->sFlash.u32BlockCount;
+    uint32_t u32Dirty = NU_FTL_ERASED;
+    uint32_t u32Blk = NU_FTL_ERASED;
+    uint32_t au32Seq[2], i;
+
+    for (i = 0; i < u32BlockCount; i++)
+    {
+        uint32_t u32Idx = (psFtl->u32Cursor + i) % u32BlockCount;
+
+        if ((psFtl->pu8State[u32Idx] == evNU_FTL_BLK_FREE) || (psFtl->pu8State[u32Idx] == evNU_FTL_BLK_SPARE))
+        {
+            u32Blk = u32Idx;
+            break;
+        }
+        else if ((psFtl->pu8State[u32Idx] == evNU_FTL_BLK_DIRTY) && (u32Dirty == NU_FTL_ERASED))
+        {
+            u32Dirty = u32Idx;
+        }
+    }
+
+    /* An interrupted erase can leave the old header behind on a block with data. */
+    if ((u32Blk != NU_FTL_ERASED) && (psFtl->pu8State[u32Blk] == evNU_FTL_BLK_SPARE))
+    {
+        if (ftl_is_blank(psFtl, u32Blk, offsetof(S_NU_FTL_HDR, u32Seq)))
+        {
+            psFtl->pu8State[u32Blk] = evNU_FTL_BLK_FREE;
+        }
+        else
+        {
+            psFtl->pu8State[u32Blk] = evNU_FTL_BLK_DIRTY;
+            psFtl->u32DirtyBlocks++;
+            u32Dirty = u32Blk;
+            u32Blk = NU_FTL_ERASED;
+        }
+    }
+
+    if (u32Blk == NU_FTL_ERASED)
+    {
+        if ((u32Dirty == NU_FTL_ERASED) || (ftl_block_prepare(psFtl, u32Dirty) != 0))
+            return -1;
+
+        u32Blk = u32Dirty;
+    }
+
+    au32Seq[0] = psFtl->u32Seq + 1;
+    au32Seq[1] = ~au32Seq[0];
+    if (psFtl->sFlash.pfnProg(psFtl->sFlash.pvUserData, ftl_block_addr(psFtl, u32Blk) + offsetof(S_NU_FTL_HDR, u32Seq), au32Seq, sizeof(au32Seq)) != 0)
+    {
+        /* Half-programmed sequence, erase it later. */
+        psFtl->pu8State[u32Blk] = evNU_FTL_BLK_DIRTY;
+        psFtl->u32DirtyBlocks++;
+        return -1;
+    }
+
+    psFtl->u32Seq = au32Seq[0];
+    psFtl->pu8State[u32Blk] = evNU_FTL_BLK_DATA;
+    psFtl->pu8Valid[u32Blk] = 0;
+    psFtl->u32FreeBlocks--;
+    psFtl->u32Active = u32Blk;
+    psFtl->u32ActiveSlot = 0;
+    psFtl->u32Cursor = (u32Blk + 1) % u32BlockCount;
+
+    return 0;
+}
+
+static int ftl_gc_collect(S_NU_FTL *psFtl);
+
+static int ftl_slot_write(S_NU_FTL *psFtl, uint32_t u32Lba, const void *pvBuf)
+{
+    uint32_t u32SlotAddr, u32Phys, u32Old, u32Commit = NU_FTL_COMMITTED;
+
+    for (;;)
+    {
+        int bFull = (psFtl->u32Active == NU_FTL_ERASED) || (psFtl->u32ActiveSlot >= psFtl->u32Slots);
+
+        /* Under the reserve only after power loss in the middle of a collection. */
+        if (!psFtl->bInGc && ((psFtl->u32FreeBlocks < CONFIG_NU_FTL_GC_MIN_FREE) ||
+                              (bFull && (psFtl->u32FreeBlocks <= CONFIG_NU_FTL_GC_MIN_FREE))))
+        {
+            if (ftl_gc_collect(psFtl) != 0)
+                return -1;
+        }
+        else if (bFull)
+        {
+            if (ftl_block_open(psFtl) != 0)
+                return -1;
+        }
+        else
+        {
+            break;
+        }
+    }
+
+    u32Phys = psFtl->u32Active * psFtl->u32Slots + psFtl->u32ActiveSlot;
+    u32SlotAddr = ftl_block_addr(psFtl, psFtl->u32Active) + offsetof(S_NU_FTL_HDR, asSlot) + psFtl->u32ActiveSlot * sizeof(S_NU_FTL_SLOT);
+
+    /* The slot is used from here on, whatever happens next. */
+    psFtl->u32ActiveSlot++;
+
+    if ((psFtl->sFlash.pfnProg(psFtl->sFlash.pvUserData, u32SlotAddr + offsetof(S_NU_FTL_SLOT, u32Lba), &u32Lba, sizeof(u32Lba)) != 0) ||
+            (psFtl->sFlash.pfnProg(psFtl->sFlash.pvUserData, ftl_data_addr(psFtl, u32Phys), pvBuf, NU_FTL_SECTOR_SIZE) != 0) ||
+            (psFtl->sFlash.pfnProg(psFtl->sFlash.pvUserData, u32SlotAddr + offsetof(S_NU_FTL_SLOT, u32Commit), &u32Commit, sizeof(u32Commit)) != 0))
+    {
+        return -1;
+    }
+
+    u32Old = psFtl->pu16Map[u32Lba];
+    if (u32Old != NU_FTL_NONE)
+        psFtl->pu8Valid[u32Old / psFtl->u32Slots]--;
+
+    psFtl->pu16Map[u32Lba] = (uint16_t)u32Phys;
+    psFtl->pu8Valid[psFtl->u32Active]++;
+
+    return 0;
+}
+
+/* Move valid slots out of the emptiest block and mark it dirty. */
+static int ftl_gc_collect(S_NU_FTL *psFtl)
+{
+    S_NU_FTL_HDR sHdr;
+    uint32_t u32Victim = NU_FTL_ERASED;
+    uint32_t u32MinValid = psFtl->u32Slots;
+    uint32_t i, u32Phys;
+    int ret = -1;
+
+    for (i = 0; i < psFtl->sFlash.u32BlockCount; i++)
+    {
+        uint32_t u32Idx = (psFtl->u32Cursor + i) % psFtl->sFlash.u32BlockCount;
+
+        if ((psFtl->pu8State[u32Idx] == evNU_FTL_BLK_DATA) && (u32Idx != psFtl->u32Active) &&
+                (psFtl->pu8Valid[u32Idx] < u32MinValid))
+        {
+            u32Victim = u32Idx;
+            u32MinValid = psFtl->pu8Valid[u32Idx];
+
+            if (u32MinValid == 0)
+                break;
+        }
+    }
+
+    /* Every block is full of live sectors, no reserve left. */
+    if (u32Victim == NU_FTL_ERASED)
+        return -1;
+
+    psFtl->bInGc = 1;
+
+    if (u32MinValid > 0)
+    {
+        if (psFtl->sFlash.pfnRead(psFtl->sFlash.pvUserData, ftl_block_addr(psFtl, u32Victim), &sHdr, NU_FTL_HDR_SIZE(psFtl->u32Slots)) != 0)
+            goto exit_ftl_gc_collect;
+
+        for (i = 0; i < psFtl->u32Slots; i++)
+        {
+            uint32_t u32Lba = sHdr.asSlot[i].u32Lba;
+
+            u32Phys = u32Victim * psFtl->u32Slots + i;
+
+            if ((u32Lba >= psFtl->u32SectorCount) || (psFtl->pu16Map[u32Lba] != u32Phys))
+                continue;
+
+            if ((psFtl->sFlash.pfnRead(psFtl->sFlash.pvUserData, ftl_data_addr(psFtl, u32Phys), psFtl->pu8Scratch, NU_FTL_SECTOR_SIZE) != 0) ||
+                    (ftl_slot_write(psFtl, u32Lba, psFtl->pu8Scratch) != 0))
+            {
+                goto exit_ftl_gc_collect;
+            }
+
+            psFtl->sStat.u32GcCopies++;
+        }
+    }
+
+    /* Old copies stay on flash until the erase, the newer sequence wins at mount. */
+    psFtl->pu8State[u32Victim] = evNU_FTL_BLK_DIRTY;
+    psFtl->u32DirtyBlocks++;
+    psFtl->u32FreeBlocks++;
+
+    ret = 0;
+
+exit_ftl_gc_collect:
+
+    psFtl->bInGc = 0;
+
+    return ret;
+}
+
+void nu_ftl_unmount(S_NU_FTL *psFtl)
+{
+    if (psFtl->pu16Map)
+        NU_FTL_FREE(psFtl->pu16Map);
+
+    if (psFtl->pu8Valid)
+        NU_FTL_FREE(psFtl->pu8Valid);
+
+    if (psFtl->pu8State)
+        NU_FTL_FREE(psFtl->pu8State);
+
+    if (psFtl->pu8Scratch)
+        NU_FTL_FREE(psFtl->pu8Scratch);
+
+    memset(psFtl, 0, sizeof(S_NU_FTL));
+}
+
+int nu_ftl_mount(S_NU_FTL *psFtl, const S_NU_FTL_FLASH *psFlash)
+{
+    S_NU_FTL_HDR sHdr;
+    uint32_t *pu32Seq = NULL;
+    uint32_t u32Blk, i;
+    int ret = -1;
+
+    memset(psFtl, 0, sizeof(S_NU_FTL));
+
+    psFtl->sFlash = *psFlash;
+    psFtl->u32Slots = psFlash->u32BlockSize / NU_FTL_SECTOR_SIZE - 1;
+    psFtl->u32Active = NU_FTL_ERASED;
+
+    if ((psFtl->u32Slots == 0) || (psFtl->u32Slots > NU_FTL_SLOTS_MAX) ||
+            (psFlash->u32BlockCount <= CONFIG_NU_FTL_RESERVED_BLOCKS) ||
+            (psFlash->u32BlockCount * psFtl->u32Slots >= NU_FTL_NONE))
+    {
+        return -1;
+    }
+
+    psFtl->u32SectorCount = (psFlash->u32BlockCount - CONFIG_NU_FTL_RESERVED_BLOCKS) * psFtl->u32Slots;
+
+    psFtl->pu16Map = NU_FTL_MALLOC(psFtl->u32SectorCount * sizeof(uint16_t));
+    psFtl->pu8Valid = NU_FTL_MALLOC(psFlash->u32BlockCount);
+    psFtl->pu8State = NU_FTL_MALLOC(psFlash->u32BlockCount);
+    psFtl->pu8Scratch = NU_FTL_MALLOC(NU_FTL_SECTOR_SIZE);
+    pu32Seq = NU_FTL_MALLOC(psFlash->u32BlockCount * sizeof(uint32_t));
+
+    if (!psFtl->pu16Map || !psFtl->pu8Valid || !psFtl->pu8State || !psFtl->pu8Scratch || !pu32Seq)
+        goto exit_nu_ftl_mount;
+
+    memset(psFtl->pu16Map, 0xFF, psFtl->u32SectorCount * sizeof(uint16_t));
+    memset(psFtl->pu8Valid, 0, psFlash->u32BlockCount);
+
+    /* Rebuild the map from headers. Order of blocks does not matter, newer copies replace older ones. */
+    for (u32Blk = 0; u32Blk < psFlash->u32BlockCount; u32Blk++)
+    {
+        pu32Seq[u32Blk] = NU_FTL_ERASED;
+
+        if (ftl_header_read(psFtl, u32Blk, &sHdr) != 0)
+        {
+            psFtl->pu8State[u32Blk] = evNU_FTL_BLK_DIRTY;
+            psFtl->u32DirtyBlocks++;
+            psFtl->u32FreeBlocks++;
+            continue;
+        }
+
+        if (sHdr.u32EraseCnt > psFtl->sStat.u32MaxEraseCnt)
+            psFtl->sStat.u32MaxEraseCnt = sHdr.u32EraseCnt;
+
+        if ((sHdr.u32Seq == NU_FTL_ERASED) && (sHdr.u32SeqCheck == NU_FTL_ERASED))
+        {
+            psFtl->pu8State[u32Blk] = evNU_FTL_BLK_SPARE;
+            psFtl->u32FreeBlocks++;
+            continue;
+        }
+
+        /* Power went off while opening it, no slot was written yet. */
+        if (sHdr.u32SeqCheck != ~sHdr.u32Seq)
+        {
+            psFtl->pu8State[u32Blk] = evNU_FTL_BLK_DIRTY;
+            psFtl->u32DirtyBlocks++;
+            psFtl->u32FreeBlocks++;
+            continue;
+        }
+
+        psFtl->pu8State[u32Blk] = evNU_FTL_BLK_DATA;
+        pu32Seq[u32Blk] = sHdr.u32Seq;
+
+        for (i = 0; i < psFtl->u32Slots; i++)
+        {
+            uint32_t u32Lba = sHdr.asSlot[i].u32Lba;
+            uint32_t u32Phys = u32Blk * psFtl->u32Slots + i;
+            uint32_t u32Old;
+
+            /* Torn slots were never committed. */
+            if ((sHdr.asSlot[i].u32Commit != NU_FTL_COMMITTED) || (u32Lba >= psFtl->u32SectorCount))
+                continue;
+
+            u32Old = psFtl->pu16Map[u32Lba];
+            if (u32Old != NU_FTL_NONE)
+            {
+                uint32_t u32OldBlk = u32Old / psFtl->u32Slots;
+
+                if ((pu32Seq[u32OldBlk] > sHdr.u32Seq) ||
+                        ((u32OldBlk == u32Blk) && (u32Old > u32Phys)))
+                    continue;
+
+                psFtl->pu8Valid[u32OldBlk]--;
+            }
+
+            psFtl->pu16Map[u32Lba] = (uint16_t)u32Phys;
+            psFtl->pu8Valid[u32Blk]++;
+        }
+
+        /* Keep filling the newest block after its last used slot. */
+        if ((psFtl->u32Active == NU_FTL_ERASED) || (sHdr.u32Seq > psFtl->u32Seq))
+        {
+            psFtl->u32Active = u32Blk;
+            psFtl->u32Seq = sHdr.u32Seq;
+
+            for (i = psFtl->u32Slots; i > 0; i--)
+            {
+                if (sHdr.asSlot[i - 1].u32Lba != NU_FTL_ERASED)
+                    break;
+            }
+            psFtl->u32ActiveSlot = i;
+        }
+    }
+
+    /* Collected before power went off, or opened without a slot written. */
+    for (u32Blk = 0; u32Blk < psFlash->u32BlockCount; u32Blk++)
+    {
+        if ((psFtl->pu8State[u32Blk] == evNU_FTL_BLK_DATA) && (psFtl->pu8Valid[u32Blk] == 0) && (u32Blk != psFtl->u32Active))
+        {
+            psFtl->pu8State[u32Blk] = evNU_FTL_BLK_DIRTY;
+            psFtl->u32DirtyBlocks++;
+            psFtl->u32FreeBlocks++;
+        }
+    }
+
+    if (psFtl->u32Active != NU_FTL_ERASED)
+        psFtl->u32Cursor = (psFtl->u32Active + 1) % psFlash->u32BlockCount;
+
+    ret = 0;
+
+exit_nu_ftl_mount:
+
+    if (pu32Seq)
+        NU_FTL_FREE(pu32Seq);
+
+    if (ret != 0)
+        nu_ftl_unmount(psFtl);
+
+    return ret;
+}
+
+int nu_ftl_read(S_NU_FTL *psFtl, uint32_t u32Sector, void *pvBuf, uint32_t u32Count)
+{
+    uint8_t *pu8Buf = (uint8_t *)pvBuf;
+
+    if ((u32Sector + u32Count > psFtl->u32SectorCount) || (u32Sector + u32Count < u32Sector))
+        return -1;
+
+    for (; u32Count > 0; u32Count--, u32Sector++, pu8Buf += NU_FTL_SECTOR_SIZE)
+    {
+        uint32_t u32Phys = psFtl->pu16Map[u32Sector];
+
+        /* Never written, looks like erased flash. */
+        if (u32Phys == NU_FTL_NONE)
+        {
+            memset(pu8Buf, 0xFF, NU_FTL_SECTOR_SIZE);
+        }
+        else if (psFtl->sFlash.pfnRead(psFtl->sFlash.pvUserData, ftl_data_addr(psFtl, u32Phys), pu8Buf, NU_FTL_SECTOR_SIZE) != 0)
+        {
+            return -1;
+        }
+    }
+
+    return 0;
+}
+
+int nu_ftl_write(S_NU_FTL *psFtl, uint32_t u32Sector, const void *pvBuf, uint32_t u32Count)
+{
+    const uint8_t *pu8Buf = (const uint8_t *)pvBuf;
+
+    if ((u32Sector + u32Count > psFtl->u32SectorCount) || (u32Sector + u32Count < u32Sector))
+        return -1;
+
+    for (; u32Count > 0; u32Count--, u32Sector++, pu8Buf += NU_FTL_SECTOR_SIZE)
+    {
+        if (ftl_slot_write(psFtl, u32Sector, pu8Buf) != 0)
+            return -1;
+
+        psFtl->sStat.u32HostWrites++;
+    }
+
+    return 0;
+}
+
+int nu_ftl_gc_step(S_NU_FTL *psFtl, uint32_t u32FreeTarget)
+{
+    uint32_t i;
+
+    if (psFtl->u32DirtyBlocks > 0)
+    {
+        for (i = 0; i < psFtl->sFlash.u32BlockCount; i++)
+        {
+            if (psFtl->pu8State[i] == evNU_FTL_BLK_DIRTY)
+                return (ftl_block_prepare(psFtl, i) == 0) ? 1 : -1;
+        }
+    }
+
+    if (psFtl->u32FreeBlocks < u32FreeTarget)
+    {
+        /* Nothing to collect is not an error here. */
+        return (ftl_gc_collect(psFtl) == 0) ? 1 : 0;
+    }
+
+    return 0;
+}
@@ -0,0 +1,91 @@
+/**************************************************************************//**
+ * @file     nu_ftl.h
+ * @brief    Log-structured flash translation layer for NOR flash
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ * @copyright (C) 2024 Nuvoton Technology Corp. All rights reserved.
+ *****************************************************************************/
+#ifndef __NU_FTL_H__
+#define __NU_FTL_H__
+
+#include <stdint.h>
+
+/*
+ * 512-byte logical sectors on top of NOR erase blocks. A block holds a
+ * header in its first sector and data slots in the others. Sectors are
+ * written out of place into the open block, the mapping table lives in RAM
+ * and is rebuilt from block headers at mount. Garbage collection moves
+ * valid slots out of the emptiest block and erases it.
+ *
+ * Each header word is programmed once after erase, so it only clears bits
+ * of NOR. A slot counts after its commit word is cleared, which makes an
+ * interrupted write invisible. The newest copy of a sector is the one with
+ * the highest block sequence, then the highest slot.
+ *
+ * The module is plain C without RTOS calls, the caller serializes access.
+ */
+
+#define NU_FTL_SECTOR_SIZE          512
+#define NU_FTL_SLOTS_MAX            15      // Erase block up to 8 KB
+
+/* Blocks kept out of logical capacity, for garbage collection headroom. At least CONFIG_NU_FTL_GC_MIN_FREE + 2. */
+#if !defined(CONFIG_NU_FTL_RESERVED_BLOCKS)
+    #define CONFIG_NU_FTL_RESERVED_BLOCKS   4
+#endif
+
+/* Foreground garbage collection starts when free blocks drop to this number.
+   One block is for relocation, the other covers power loss in the middle of it. */
+#if !defined(CONFIG_NU_FTL_GC_MIN_FREE)
+    #define CONFIG_NU_FTL_GC_MIN_FREE       2
+#endif
+
+typedef struct
+{
+    int (*pfnRead)(void *pvUserData, uint32_t u32Addr, void *pvBuf, uint32_t u32Len);
+    int (*pfnProg)(void *pvUserData, uint32_t u32Addr, const void *pvBuf, uint32_t u32Len);
+    int (*pfnErase)(void *pvUserData, uint32_t u32Addr);    // Erase the block at u32Addr
+    void *pvUserData;
+    uint32_t u32BlockSize;      // Erase block size in bytes
+    uint32_t u32BlockCount;
+} S_NU_FTL_FLASH;
+
+typedef struct
+{
+    uint32_t u32HostWrites;     // Sectors written by caller
+    uint32_t u32GcCopies;       // Sectors moved by garbage collection
+    uint32_t u32Erases;
+    uint32_t u32MaxEraseCnt;    // Highest erase count seen
+} S_NU_FTL_STAT;
+
+typedef struct
+{
+    S_NU_FTL_FLASH sFlash;
+    uint32_t u32Slots;          // Data slots per block
+    uint32_t u32SectorCount;    // Logical capacity in sectors
+
+    uint16_t *pu16Map;          // Logical sector to physical slot
+    uint8_t *pu8Valid;          // Valid slots per block
+    uint8_t *pu8State;          // Block state
+    uint8_t *pu8Scratch;        // One sector for relocation
+
+    uint32_t u32FreeBlocks;     // Free and dirty blocks
+    uint32_t u32DirtyBlocks;    // Need erase before use
+    uint32_t u32Active;         // Open block, or NU_FTL_NONE
+    uint32_t u32ActiveSlot;     // Next slot of open block
+    uint32_t u32Seq;            // Sequence of open block
+    uint32_t u32Cursor;         // Round-robin start of block allocation
+    int bInGc;
+
+    S_NU_FTL_STAT sStat;
+} S_NU_FTL;
+
+int nu_ftl_mount(S_NU_FTL *psFtl, const S_NU_FTL_FLASH *psFlash);
+void nu_ftl_unmount(S_NU_FTL *psFtl);
+int nu_ftl_read(S_NU_FTL *psFtl, uint32_t u32Sector, void *pvBuf, uint32_t u32Count);
+int nu_ftl_write(S_NU_FTL *psFtl, uint32_t u32Sector, const void *pvBuf, uint32_t u32Count);
+
+/* One unit of background work: erase a dirty block, or collect one block
+   while free blocks are under u32FreeTarget. Returns 1 if work was done. */
+int nu_ftl_gc_step(S_NU_FTL *psFtl, uint32_t u32FreeTarget);
+
+#endif /* __NU_FTL_H__ */
@@ -0,0 +1,867 @@
+/**************************************************************************//**
+ * @file     nu_heap.c
+ * @brief    Multi-region TLSF heap with placement hints
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ * @copyright (C) 2024 Nuvoton Technology Corp. All rights reserved.
+ *****************************************************************************/
+#include <string.h>
+#include "nu_heap.h"
+#include "nu_bitutil.h"
+#include "FreeRTOS.h"
+#include "task.h"
+#include "lvgl.h"
+
+/*
+ * Block layout, all sizes are payload sizes in multiple of NU_HEAP_ALIGN:
+ *
+ *   +------------+---------+--------------------------------+
+ *   | psPrevPhys | u32Size | payload (free-list links)      | next block ...
+ *   +------------+---------+--------------------------------+
+ *
+ * psPrevPhys is valid only when the physical previous block is free.
+ * Bit 0 of u32Size marks this block free, bit 1 marks previous block free.
+ * Each region ends with a zero-size used sentinel block.
+ */
+#define NU_HEAP_ALIGN_LOG2      3
+#define NU_HEAP_ALIGN           (1UL << NU_HEAP_ALIGN_LOG2)
+
+#define SL_INDEX_COUNT_LOG2     4
+#define SL_INDEX_COUNT          (1UL << SL_INDEX_COUNT_LOG2)
+#define FL_INDEX_SHIFT          (SL_INDEX_COUNT_LOG2 + NU_HEAP_ALIGN_LOG2)
+#define FL_INDEX_MAX            26
+#define FL_INDEX_COUNT          (FL_INDEX_MAX - FL_INDEX_SHIFT + 1)
+#define SMALL_BLOCK_SIZE        (1UL << FL_INDEX_SHIFT)
+
+#define BLOCK_FREE_BIT          (1UL << 0)
+#define BLOCK_PREV_FREE_BIT     (1UL << 1)
+
+typedef struct S_NU_HEAP_BLOCK
+{
+    struct S_NU_HEAP_BLOCK *psPrevPhys;
+    uint32_t u32Size;
+    struct S_NU_HEAP_BLOCK *psNextFree;
+    struct S_NU_HEAP_BLOCK *psPrevFree;
+} S_NU_HEAP_BLOCK;
+
+#define BLOCK_HEADER_SIZE       (sizeof(S_NU_HEAP_BLOCK *) + sizeof(uint32_t))
+#define BLOCK_SIZE_MIN          (sizeof(S_NU_HEAP_BLOCK) - BLOCK_HEADER_SIZE)
+#define BLOCK_SIZE_MAX          (1UL << FL_INDEX_MAX)
+
+typedef struct
+{
+    S_NU_HEAP_BLOCK  sNull;     // Terminator of all free lists
+    uint32_t         u32FlBitmap;
+    uint32_t         au32SlBitmap[FL_INDEX_COUNT];
+    S_NU_HEAP_BLOCK *apsBlocks[FL_INDEX_COUNT][SL_INDEX_COUNT];
+} S_NU_HEAP_CONTROL;
+
+typedef struct
+{
+    uint8_t           *pu8Start;
+    uint8_t           *pu8End;
+    uint32_t           u32Caps;
+    uint32_t           u32TotalSize;
+    uint32_t           u32FreeSize;
+    uint32_t           u32MinEverFree;
+    S_NU_HEAP_CONTROL *psControl;
+} S_NU_HEAP_REGION;
+
+static S_NU_HEAP_REGION s_asHeapRegion[CONFIG_NU_HEAP_MAX_REGIONS];
+static uint32_t s_u32HeapRegionNum = 0;
+
+#define NU_HEAP_LOCK()      vTaskSuspendAll()
+#define NU_HEAP_UNLOCK()    (void)xTaskResumeAll()
+
+#define ALIGN_UP(x, a)      (((x) + ((a) - 1)) & ~((a) - 1))
+
+__STATIC_INLINE int nu_fls(uint32_t x)
+{
+    return 31 - nu_clz(x);
+}
+
+__STATIC_INLINE uint32_t block_size(const S_NU_HEAP_BLOCK *psBlock)
+{
+    return psBlock->u32Size & ~(BLOCK_FREE_BIT | BLOCK_PREV_FREE_BIT);
+}
+
+__STATIC_INLINE void block_set_size(S_NU_HEAP_BLOCK *psBlock, uint32_t u32Size)
+{
+    psBlock->u32Size = u32Size | (psBlock->u32Size & (BLOCK_FREE_BIT | BLOCK_PREV_FREE_BIT));
+}
+
+__STATIC_INLINE int block_is_free(const S_NU_HEAP_BLOCK *psBlock)
+{
+    return (psBlock->u32Size & BLOCK_FREE_BIT) != 0;
+}
+
+__STATIC_INLINE int block_is_prev_free(const S_NU_HEAP_BLOCK *psBlock)
+{
+    return (psBlock->u32Size & BLOCK_PREV_FREE_BIT) != 0;
+}
+
+__STATIC_INLINE void *block_to_ptr(const S_NU_HEAP_BLOCK *psBlock)
+{
+    return (void *)((uint8_t *)psBlock + BLOCK_HEADER_SIZE);
+}
+
+__STATIC_INLINE S_NU_HEAP_BLOCK *block_from_ptr(const void *pvPtr)
+{
+    return (S_NU_HEAP_BLOCK *)((uint8_t *)pvPtr - BLOCK_HEADER_SIZE);
+}
+
+__STATIC_INLINE S_NU_HEAP_BLOCK *block_next(const S_NU_HEAP_BLOCK *psBlock)
+{
+    return (S_NU_HEAP_BLOCK *)((uint8_t *)block_to_ptr(psBlock) + block_size(psBlock));
+}
+
+/* Link to next physical block and tell it about our free state. */
+static S_NU_HEAP_BLOCK *block_link_next(S_NU_HEAP_BLOCK *psBlock)
+{
+    S_NU_HEAP_BLOCK *psNext = block_next(psBlock);
+    psNext->psPrevPhys = psBlock;
+    return psNext;
+}
+
+static void block_mark_as_free(S_NU_HEAP_BLOCK *psBlock)
+{
+    S_NU_HEAP_BLOCK *psNext = block_link_next(psBlock);
+    psNext->u32Size |= BLOCK_PREV_FREE_BIT;
+    psBlock->u32Size |= BLOCK_FREE_BIT;
+}
+
+static void block_mark_as_used(S_NU_HEAP_BLOCK *psBlock)
+{
+    S_NU_HEAP_BLOCK *psNext = block_next(psBlock);
+    psNext->u32Size &= ~BLOCK_PREV_FREE_BIT;
+    psBlock->u32Size &= ~BLOCK_FREE_BIT;
+}
+
+static void mapping_insert(uint32_t u32Size, int *pi32Fl, int *pi32Sl)
+{
+    if (u32Size < SMALL_BLOCK_SIZE)
+    {
+        *pi32Fl = 0;
+        *pi32Sl = u32Size / (SMALL_BLOCK_SIZE / SL_INDEX_COUNT);
+    }
+    else
+    {
+        int fl = nu_fls(u32Size);
+
+        *pi32Sl = (int)(u32Size >> (fl - SL_INDEX_COUNT_LOG2)) ^ SL_INDEX_COUNT;
+        *pi32Fl = fl - (FL_INDEX_SHIFT - 1);
+    }
+}
+
+/* Round up to next list so that any block found there is big enough. */
+static void mapping_search(uint32_t u32Size, int *pi32Fl, int *pi32Sl)
+{
+    if (u32Size >= SMALL_BLOCK_SIZE)
+        u32Size += (1UL << (nu_fls(u32Size) - SL_INDEX_COUNT_LOG2)) - 1;
+
+    mapping_insert(u32Size, pi32Fl, pi32Sl);
+}
+
+static S_NU_HEAP_BLOCK *search_suitable_block(S_NU_HEAP_CONTROL *psControl, int *pi32Fl, int *pi32Sl)
+{
+    int fl = *pi32Fl;
+    int sl = *pi32Sl;
+    uint32_t u32SlMap;
+
+    if (fl >= FL_INDEX_COUNT)
+        return NULL;
+
+    u32SlMap = psControl->au32SlBitmap[fl] & (~0UL << sl);
+    if (!u32SlMap)
+    {
+        uint32_t u32FlMap = (fl + 1 < 32) ? psControl->u32FlBitmap & (~0UL << (fl + 1)) : 0;
+
+        if (!u32FlMap)
+            return NULL;
+
+        fl = nu_ctz(u32FlMap);
+        u32SlMap = psControl->au32SlBitmap[fl];
+    }
+    sl = nu_ctz(u32SlMap);
+
+    *pi32Fl = fl;
+    *pi32Sl = sl;
+
+    return psControl->apsBlocks[fl][sl];
+}
+
+static void remove_free_block(S_NU_HEAP_CONTROL *psControl, S_NU_HEAP_BLOCK *psBlock, int fl, int sl)
+{
+    S_NU_HEAP_BLOCK *psPrev = psBlock->psPrevFree;
+    S_NU_HEAP_BLOCK *psNext = psBlock->psNextFree;
+
+    psNext->psPrevFree = psPrev;
+    psPrev->psNextFree = psNext;
+
+    if (psControl->apsBlocks[fl][sl] == psBlock)
+    {
+        psControl->apsBlocks[fl][sl] = psNext;
+
+        if (psNext == &psControl->sNull)
+        {
+            psControl->au32SlBitmap[fl] &= ~(1UL << sl);
+
+            if (!psControl->au32SlBitmap[fl])
+                psControl->u32FlBitmap &= ~(1UL << fl);
+        }
+    }
+}
+
+static void insert_free_block(S_NU_HEAP_CONTROL *psControl, S_NU_HEAP_BLOCK *psBlock, int fl, int sl)
+{
+    S_NU_HEAP_BLOCK *psCurrent = psControl->apsBlocks[fl][sl];
+
+    psBlock->psNextFree = psCurrent;
+    psBlock->psPrevFree = &psControl->sNull;
+    psCurrent->psPrevFree = psBlock;
+
+    psControl->apsBlocks[fl][sl] = psBlock;
+    psControl->u32FlBitmap |= (1UL << fl);
+    psControl->au32SlBitmap[fl] |= (1UL << sl);
+}
+
+static void block_remove(S_NU_HEAP_CONTROL *psControl, S_NU_HEAP_BLOCK *psBlock)
+{
+    int fl, sl;
+    mapping_insert(block_size(psBlock), &fl, &sl);
+    remove_free_block(psControl, psBlock, fl, sl);
+}
+
+static void block_insert(S_NU_HEAP_CONTROL *psControl, S_NU_HEAP_BLOCK *psBlock)
+{
+    int fl, sl;
+    mapping_insert(block_size(psBlock), &fl, &sl);
+    insert_free_block(psControl, psBlock, fl, sl);
+}
+
+static int block_can_split(const S_NU_HEAP_BLOCK *psBlock, uint32_t u32Size)
+{
+    return block_size(psBlock) >= sizeof(S_NU_HEAP_BLOCK) + u32Size;
+}
+
+/* Split psBlock at u32Size, return the free remainder. */
+static S_NU_HEAP_BLOCK *block_split(S_NU_HEAP_BLOCK *psBlock, uint32_t u32Size)
+{
+    S_NU_HEAP_BLOCK *psRemain = (S_NU_HEAP_BLOCK *)((uint8_t *)block_to_ptr(psBlock) + u32Size);
+    uint32_t u32RemainSize = block_size(psBlock) - (u32Size + BLOCK_HEADER_SIZE);
+
+    psRemain->u32Size = u32RemainSize;
+    block_set_size(psBlock, u32Size);
+    block_mark_as_free(psRemain);
+
+    return psRemain;
+}
+
+/* psBlock follows psPrev physically, merge them into psPrev. */
+static S_NU_HEAP_BLOCK *block_absorb(S_NU_HEAP_BLOCK *psPrev, S_NU_HEAP_BLOCK *psBlock)
+{
+    block_set_size(psPrev, block_size(psPrev) + block_size(psBlock) + BLOCK_HEADER_SIZE);
+    block_link_next(psPrev);
+    return psPrev;
+}
+
+static S_NU_HEAP_BLOCK *block_merge_prev(S_NU_HEAP_CONTROL *psControl, S_NU_HEAP_BLOCK *psBlock)
+{
+    if (block_is_prev_free(psBlock))
+    {
+        S_NU_HEAP_BLOCK *psPrev = psBlock->psPrevPhys;
+        block_remove(psControl, psPrev);
+        psBlock = block_absorb(psPrev, psBlock);
+    }
+
+    return psBlock;
+}
+
+static S_NU_HEAP_BLOCK *block_merge_next(S_NU_HEAP_CONTROL *psControl, S_NU_HEAP_BLOCK *psBlock)
+{
+    S_NU_HEAP_BLOCK *psNext = block_next(psBlock);
+
+    if (block_is_free(psNext))
+    {
+        block_remove(psControl, psNext);
+        psBlock = block_absorb(psBlock, psNext);
+    }
+
+    return psBlock;
+}
+
+static void block_trim_free(S_NU_HEAP_CONTROL *psControl, S_NU_HEAP_BLOCK *psBlock, uint32_t u32Size)
+{
+    if (block_can_split(psBlock, u32Size))
+    {
+        S_NU_HEAP_BLOCK *psRemain = block_split(psBlock, u32Size);
+        block_link_next(psBlock);
+        psRemain->u32Size |= BLOCK_PREV_FREE_BIT;
+        block_insert(psControl, psRemain);
+    }
+}
+
+static void block_trim_used(S_NU_HEAP_CONTROL *psControl, S_NU_HEAP_BLOCK *psBlock, uint32_t u32Size)
+{
+    if (block_can_split(psBlock, u32Size))
+    {
+        S_NU_HEAP_BLOCK *psRemain = block_split(psBlock, u32Size);
+        psRemain->u32Size &= ~BLOCK_PREV_FREE_BIT;
+        psRemain = block_merge_next(psControl, psRemain);
+        block_insert(psControl, psRemain);
+    }
+}
+
+/* Give u32Gap leading bytes of a free block back, return the aligned remainder. */
+static S_NU_HEAP_BLOCK *block_trim_free_leading(S_NU_HEAP_CONTROL *psControl, S_NU_HEAP_BLOCK *psBlock, uint32_t u32Gap)
+{
+    S_NU_HEAP_BLOCK *psRemain = psBlock;
+
+    if (block_can_split(psBlock, u32Gap - BLOCK_HEADER_SIZE))
+    {
+        psRemain = block_split(psBlock, u32Gap - BLOCK_HEADER_SIZE);
+        psRemain->u32Size |= BLOCK_PREV_FREE_BIT;
+        block_link_next(psBlock);
+        block_insert(psControl, psBlock);
+    }
+
+    return psRemain;
+}
+
+static uint32_t adjust_request_size(uint32_t u32Size, uint32_t u32Align)
+{
+    uint32_t u32Adjust;
+
+    if (!u32Size || u32Size >= BLOCK_SIZE_MAX)
+        return 0;
+
+    u32Adjust = ALIGN_UP(u32Size, u32Align);
+
+    return (u32Adjust < BLOCK_SIZE_MIN) ? BLOCK_SIZE_MIN : u32Adjust;
+}
+
+static void *region_malloc(S_NU_HEAP_REGION *psRegion, uint32_t u32Size, uint32_t u32Align)
+{
+    S_NU_HEAP_CONTROL *psControl = psRegion->psControl;
+    S_NU_HEAP_BLOCK *psBlock;
+    uint32_t u32SearchSize = u32Size;
+    int fl, sl;
+
+    /* Room for the aligned start plus a leading free block to give back. */
+    if (u32Align > NU_HEAP_ALIGN)
+        u32SearchSize = u32Size + u32Align + sizeof(S_NU_HEAP_BLOCK);
+
+    if (u32SearchSize > psRegion->u32FreeSize)
+        return NULL;
+
+    mapping_search(u32SearchSize, &fl, &sl);
+    psBlock = search_suitable_block(psControl, &fl, &sl);
+    if (psBlock == NULL || psBlock == &psControl->sNull)
+        return NULL;
+
+    remove_free_block(psControl, psBlock, fl, sl);
+
+    if (u32Align > NU_HEAP_ALIGN)
+    {
+        uintptr_t uPtr = (uintptr_t)block_to_ptr(psBlock);
+        uintptr_t uAligned = ALIGN_UP(uPtr, u32Align);
+        uint32_t u32Gap = uAligned - uPtr;
+
+        /* A leading gap has to hold a whole free block. */
+        if (u32Gap && u32Gap < sizeof(S_NU_HEAP_BLOCK))
+        {
+            uAligned = ALIGN_UP(uPtr + sizeof(S_NU_HEAP_BLOCK), u32Align);
+            u32Gap = uAligned - uPtr;
+        }
+
+        if (u32Gap)
+            psBlock = block_trim_free_leading(psControl, psBlock, u32Gap);
+    }
+
+    block_trim_free(psControl, psBlock, u32Size);
+    block_mark_as_used(psBlock);
+
+    psRegion->u32FreeSize -= block_size(psBlock) + BLOCK_HEADER_SIZE;
+    if (psRegion->u32FreeSize < psRegion->u32MinEverFree)
+        psRegion->u32MinEverFree = psRegion->u32FreeSize;
+
+    return block_to_ptr(psBlock);
+}
+
+static void region_free(S_NU_HEAP_REGION *psRegion, void *pvPtr)
+{
+    S_NU_HEAP_CONTROL *psControl = psRegion->psControl;
+    S_NU_HEAP_BLOCK *psBlock = block_from_ptr(pvPtr);
+
+    psRegion->u32FreeSize += block_size(psBlock) + BLOCK_HEADER_SIZE;
+
+    block_mark_as_free(psBlock);
+    psBlock = block_merge_prev(psControl, psBlock);
+    psBlock = block_merge_next(psControl, psBlock);
+    block_insert(psControl, psBlock);
+}
+
+static S_NU_HEAP_REGION *region_find(const void *pvPtr)
+{
+    uint32_t i;
+
+    for (i = 0; i < s_u32HeapRegionNum; i++)
+    {
+        S_NU_HEAP_REGION *psRegion = &s_asHeapRegion[i];
+
+        if (((uint8_t *)pvPtr >= psRegion->pu8Start) && ((uint8_t *)pvPtr < psRegion->pu8End))
+            return psRegion;
+    }
+
+    return NULL;
+}
+
+int nu_heap_add_region(void *pvStart, uint32_t u32Size, uint32_t u32Caps)
+{
+    S_NU_HEAP_REGION *psRegion;
+    S_NU_HEAP_CONTROL *psControl;
+    S_NU_HEAP_BLOCK *psBlock, *psSentinel;
+    uintptr_t uStart, uEnd;
+    uint32_t u32PoolSize;
+    int i, j;
+
+    uStart = ALIGN_UP((uintptr_t)pvStart, NU_HEAP_ALIGN);
+    uEnd = ((uintptr_t)pvStart + u32Size) & ~(NU_HEAP_ALIGN - 1);
+
+    if ((s_u32HeapRegionNum >= CONFIG_NU_HEAP_MAX_REGIONS) ||
+            (uEnd <= uStart) ||
+            ((uEnd - uStart) < (ALIGN_UP(sizeof(S_NU_HEAP_CONTROL), NU_HEAP_ALIGN) + sizeof(S_NU_HEAP_BLOCK) + BLOCK_HEADER_SIZE)))
+    {
+        return -1;
+    }
+
+    /* Control structure sits at region head. */
+    psControl = (S_NU_HEAP_CONTROL *)uStart;
+    psControl->sNull.psNextFree = &psControl->sNull;
+    psControl->sNull.psPrevFree = &psControl->sNull;
+    psControl->u32FlBitmap = 0;
+    for (i = 0; i < FL_INDEX_COUNT; i++)
+    {
+        psControl->au32SlBitmap[i] = 0;
+        for (j = 0; j < SL_INDEX_COUNT; j++)
+            psControl->apsBlocks[i][j] = &psControl->sNull;
+    }
+
+    /* One free block spans the pool, a zero-size used sentinel terminates it. */
+    psBlock = (S_NU_HEAP_BLOCK *)(uStart + ALIGN_UP(sizeof(S_NU_HEAP_CONTROL), NU_HEAP_ALIGN));
+    u32PoolSize = (uEnd - (uintptr_t)psBlock) - 2 * BLOCK_HEADER_SIZE;
+    if (u32PoolSize >= BLOCK_SIZE_MAX)
+        u32PoolSize = BLOCK_SIZE_MAX - NU_HEAP_ALIGN;
+
+    psBlock->psPrevPhys = NULL;
+    psBlock->u32Size = u32PoolSize;
+    psBlock->u32Size |= BLOCK_FREE_BIT;
+
+    psSentinel = block_link_next(psBlock);
+    psSentinel->u32Size = 0 | BLOCK_PREV_FREE_BIT;
+
+    NU_HEAP_LOCK();
+
+    block_insert(psControl, psBlock);
+
+    psRegion = &s_asHeapRegion[s_u32HeapRegionNum];
+    psRegion->pu8Start = (uint8_t *)psBlock;
+    psRegion->pu8End = (uint8_t *)psSentinel;
+    psRegion->u32Caps = u32Caps;
+    psRegion->u32TotalSize = u32PoolSize + BLOCK_HEADER_SIZE;
+    psRegion->u32FreeSize = psRegion->u32TotalSize;
+    psRegion->u32MinEverFree = psRegion->u32TotalSize;
+    psRegion->psControl = psControl;
+    s_u32HeapRegionNum++;
+
+    NU_HEAP_UNLOCK();
+
+    return 0;
+}
+
+void *nu_heap_malloc_align(uint32_t u32Size, uint32_t u32Align, uint32_t u32Hints)
+{
+    uint32_t u32Need = u32Hints & NU_MEM_DMA;
+    uint32_t u32Prefer = u32Hints & (NU_MEM_FAST | NU_MEM_BULK);
+    void *pvPtr = NULL;
+    uint32_t u32Adjust;
+    int pass;
+
+    if (u32Hints & NU_MEM_CACHELINE)
+    {
+        if (u32Align < CONFIG_NU_HEAP_CACHE_LINE)
+            u32Align = CONFIG_NU_HEAP_CACHE_LINE;
+        u32Size = ALIGN_UP(u32Size, CONFIG_NU_HEAP_CACHE_LINE);
+    }
+
+    if (u32Align < NU_HEAP_ALIGN)
+        u32Align = NU_HEAP_ALIGN;
+
+    /* Power of 2 only */
+    if (u32Align & (u32Align - 1))
+        return NULL;
+
+    u32Adjust = adjust_request_size(u32Size, NU_HEAP_ALIGN);
+    if (!u32Adjust)
+        return NULL;
+
+    NU_HEAP_LOCK();
+
+    /* First pass: preferred regions only. Second pass: any region meets requirements. */
+    for (pass = (u32Prefer ? 0 : 1); (pass < 2) && (pvPtr == NULL); pass++)
+    {
+        uint32_t i;
+
+        for (i = 0; (i < s_u32HeapRegionNum) && (pvPtr == NULL); i++)
+        {
+            S_NU_HEAP_REGION *psRegion = &s_asHeapRegion[i];
+
+            if ((psRegion->u32Caps & u32Need) != u32Need)
+                continue;
+
+            if ((pass == 0) && !(psRegion->u32Caps & u32Prefer))
+                continue;
+
+            pvPtr = region_malloc(psRegion, u32Adjust, u32Align);
+        }
+    }
+
+    NU_HEAP_UNLOCK();
+
+    return pvPtr;
+}
+
+void *nu_heap_malloc(uint32_t u32Size, uint32_t u32Hints)
+{
+    return nu_heap_malloc_align(u32Size, NU_HEAP_ALIGN, u32Hints);
+}
+
+void nu_heap_free(void *pvPtr)
+{
+    S_NU_HEAP_REGION *psRegion;
+
+    if (pvPtr == NULL)
+        return;
+
+    NU_HEAP_LOCK();
+
+    psRegion = region_find(pvPtr);
+    if (psRegion != NULL)
+        region_free(psRegion, pvPtr);
+
+    NU_HEAP_UNLOCK();
+}
+
+void *nu_heap_realloc(void *pvPtr, uint32_t u32Size, uint32_t u32Hints)
+{
+    S_NU_HEAP_REGION *psRegion;
+    S_NU_HEAP_BLOCK *psBlock;
+    uint32_t u32Adjust, u32Current;
+    void *pvNew;
+
+    if (pvPtr == NULL)
+        return nu_heap_malloc(u32Size, u32Hints);
+
+    if (u32Size == 0)
+    {
+        nu_heap_free(pvPtr);
+        return NULL;
+    }
+
+    u32Adjust = adjust_request_size(u32Size, NU_HEAP_ALIGN);
+    if (!u32Adjust)
+        return NULL;
+
+    NU_HEAP_LOCK();
+
+    psRegion = region_find(pvPtr);
+    if (psRegion == NULL)
+    {
+        NU_HEAP_UNLOCK();
+        return NULL;
+    }
+
+    psBlock = block_from_ptr(pvPtr);
+    u32Current = block_size(psBlock);
+
+    /* Grow into free next block, or shrink, in place. */
+    if (u32Adjust > u32Current)
+    {
+        S_NU_HEAP_BLOCK *psNext = block_next(psBlock);
+
+        if (!block_is_free(psNext) ||
+                (u32Adjust > u32Current + block_size(psNext) + BLOCK_HEADER_SIZE))
+        {
+            NU_HEAP_UNLOCK();
+            goto exit_nu_heap_realloc;
+        }
+
+        psRegion->u32FreeSize -= block_size(psNext) + BLOCK_HEADER_SIZE;
+        block_merge_next(psRegion->psControl, psBlock);
+        block_mark_as_used(psBlock);
+        u32Current = block_size(psBlock);
+    }
+
+    block_trim_used(psRegion->psControl, psBlock, u32Adjust);
+    psRegion->u32FreeSize += u32Current - block_size(psBlock);
+    if (psRegion->u32FreeSize < psRegion->u32MinEverFree)
+        psRegion->u32MinEverFree = psRegion->u32FreeSize;
+
+    NU_HEAP_UNLOCK();
+
+    return pvPtr;
+
+exit_nu_heap_realloc:
+
+    pvNew = nu_heap_malloc(u32Size, u32Hints);
+    if (pvNew != NULL)
+    {
+        memcpy(pvNew, pvPtr, u32Current);
+        nu_heap_free(pvPtr);
+    }
+
+    return pvNew;
+}
+
+uint32_t nu_heap_region_caps(const void *pvPtr)
+{
+    S_NU_HEAP_REGION *psRegion = region_find(pvPtr);
+
+    return (psRegion != NULL) ? psRegion->u32Caps : 0;
+}
+
+void nu_heap_stat(uint32_t u32Caps, S_NU_HEAP_STAT *psStat)
+{
+    uint32_t i;
+
+    memset(psStat, 0, sizeof(S_NU_HEAP_STAT));
+
+    NU_HEAP_LOCK();
+
+    for (i = 0; i < s_u32HeapRegionNum; i++)
+    {
+        S_NU_HEAP_REGION *psRegion = &s_asHeapRegion[i];
+        S_NU_HEAP_BLOCK *psBlock = (S_NU_HEAP_BLOCK *)psRegion->pu8Start;
+
+        if ((psRegion->u32Caps & u32Caps) != u32Caps)
+            continue;
+
+        psStat->u32TotalSize += psRegion->u32TotalSize;
+        psStat->u32FreeSize += psRegion->u32FreeSize;
+        psStat->u32MinEverFree += psRegion->u32MinEverFree;
+
+        while ((uint8_t *)psBlock < psRegion->pu8End)
+        {
+            if (block_is_free(psBlock))
+            {
+                psStat->u32FreeCnt++;
+                if (block_size(psBlock) > psStat->u32BiggestFree)
+                    psStat->u32BiggestFree = block_size(psBlock);
+            }
+            else
+            {
+                psStat->u32UsedCnt++;
+            }
+
+            psBlock = block_next(psBlock);
+        }
+    }
+
+    NU_HEAP_UNLOCK();
+}
+
+/* Walk all blocks, return 0 if physical chain, flags and free accounting agree. */
+int nu_heap_check(void)
+{
+    int ret = 0;
+    uint32_t i;
+
+    NU_HEAP_LOCK();
+
+    for (i = 0; (i < s_u32HeapRegionNum) && (ret == 0); i++)
+    {
+        S_NU_HEAP_REGION *psRegion = &s_asHeapRegion[i];
+        S_NU_HEAP_BLOCK *psBlock = (S_NU_HEAP_BLOCK *)psRegion->pu8Start;
+        int prev_free = 0;
+        uint32_t u32Free = 0;
+
+        while ((uint8_t *)psBlock < psRegion->pu8End)
+        {
+            S_NU_HEAP_BLOCK *psNext = block_next(psBlock);
+
+            if ((psNext > (S_NU_HEAP_BLOCK *)psRegion->pu8End) ||
+                    (block_is_prev_free(psBlock) != prev_free) ||
+                    (prev_free && block_is_free(psBlock)) ||
+                    (block_is_free(psBlock) && psNext->psPrevPhys != psBlock))
+            {
+                ret = -1;
+                break;
+            }
+
+            prev_free = block_is_free(psBlock);
+            if (prev_free)
+                u32Free += block_size(psBlock) + BLOCK_HEADER_SIZE;
+
+            psBlock = psNext;
+        }
+
+        if ((ret == 0) &&
+                (((uint8_t *)psBlock != psRegion->pu8End) || (block_is_prev_free(psBlock) != prev_free) || (u32Free != psRegion->u32FreeSize)))
+        {
+            ret = -1;
+        }
+    }
+
+    NU_HEAP_UNLOCK();
+
+    return ret;
+}
+
+/*
+ * FreeRTOS heap, replaces heap_x.c. Kernel objects and stacks are small and
+ * touched often, keep them in internal SRAM when there is room.
+ */
+void *pvPortMalloc(size_t xWantedSize)
+{
+    void *pvReturn = nu_heap_malloc(xWantedSize, NU_MEM_FAST);
+
+    traceMALLOC(pvReturn, xWantedSize);
+
+#if (configUSE_MALLOC_FAILED_HOOK == 1)
+    if (pvReturn == NULL)
+    {
+        extern void vApplicationMallocFailedHook(void);
+        vApplicationMallocFailedHook();
+    }
+#endif
+
+    return pvReturn;
+}
+
+void vPortFree(void *pv)
+{
+    traceFREE(pv, 0);
+    nu_heap_free(pv);
+}
+
+void *pvPortCalloc(size_t xNum, size_t xSize)
+{
+    void *pv = NULL;
+
+    if ((xSize == 0) || (xNum <= (0xFFFFFFFFUL / xSize)))
+    {
+        pv = pvPortMalloc(xNum * xSize);
+        if (pv != NULL)
+            memset(pv, 0, xNum * xSize);
+    }
+
+    return pv;
+}
+
+size_t xPortGetFreeHeapSize(void)
+{
+    uint32_t i, u32Free = 0;
+
+    for (i = 0; i < s_u32HeapRegionNum; i++)
+        u32Free += s_asHeapRegion[i].u32FreeSize;
+
+    return u32Free;
+}
+
+size_t xPortGetMinimumEverFreeHeapSize(void)
+{
+    uint32_t i, u32Free = 0;
+
+    for (i = 0; i < s_u32HeapRegionNum; i++)
+        u32Free += s_asHeapRegion[i].u32MinEverFree;
+
+    return u32Free;
+}
+
+void vPortInitialiseBlocks(void)
+{
+    /* Regions are set up by nu_heap_add_region(). */
+}
+
+void vPortGetHeapStats(HeapStats_t *pxHeapStats)
+{
+    S_NU_HEAP_STAT sStat;
+
+    nu_heap_stat(0, &sStat);
+
+    memset(pxHeapStats, 0, sizeof(HeapStats_t));
+    pxHeapStats->xAvailableHeapSpaceInBytes = sStat.u32FreeSize;
+    pxHeapStats->xSizeOfLargestFreeBlockInBytes = sStat.u32BiggestFree;
+    pxHeapStats->xNumberOfFreeBlocks = sStat.u32FreeCnt;
+    pxHeapStats->xMinimumEverFreeBytesRemaining = sStat.u32MinEverFree;
+}
+
+#if (LV_USE_STDLIB_MALLOC == LV_STDLIB_CUSTOM)
+
+/*
+ * lv_malloc() backend. Widgets, styles and timers stay in internal SRAM,
+ * draw and layer buffers from CONFIG_NU_HEAP_LV_BULK_THRESHOLD bytes go to
+ * external RAM when a NU_MEM_BULK region was added.
+ */
+static uint32_t lv_heap_hints(size_t size)
+{
+    return (size >= CONFIG_NU_HEAP_LV_BULK_THRESHOLD) ? (NU_MEM_BULK | NU_MEM_CACHELINE) : NU_MEM_FAST;
+}
+
+void lv_mem_init(void)
+{
+    /* Regions are set up by nu_heap_add_region() before lv_init(). */
+}
+
+void lv_mem_deinit(void)
+{
+}
+
+lv_mem_pool_t lv_mem_add_pool(void *mem, size_t bytes)
+{
+    return (nu_heap_add_region(mem, bytes, NU_MEM_BULK) == 0) ? (lv_mem_pool_t)mem : NULL;
+}
+
+void lv_mem_remove_pool(lv_mem_pool_t pool)
+{
+    LV_UNUSED(pool);
+    LV_LOG_WARN("Region removal is not supported.");
+}
+
+void *lv_malloc_core(size_t size)
+{
+    return nu_heap_malloc(size, lv_heap_hints(size));
+}
+
+void *lv_realloc_core(void *p, size_t new_size)
+{
+    return nu_heap_realloc(p, new_size, lv_heap_hints(new_size));
+}
+
+void lv_free_core(void *p)
+{
+    nu_heap_free(p);
+}
+
+void lv_mem_monitor_core(lv_mem_monitor_t *mon_p)
+{
+    S_NU_HEAP_STAT sStat;
+
+    nu_heap_stat(0, &sStat);
+
+    mon_p->total_size = sStat.u32TotalSize;
+    mon_p->free_size = sStat.u32FreeSize;
+    mon_p->free_biggest_size = sStat.u32BiggestFree;
+    mon_p->free_cnt = sStat.u32FreeCnt;
+    mon_p->used_cnt = sStat.u32UsedCnt;
+    mon_p->max_used = sStat.u32TotalSize - sStat.u32MinEverFree;
+    mon_p->used_pct = sStat.u32TotalSize ? (100 - (100U * sStat.u32FreeSize) / sStat.u32TotalSize) : 0;
+    mon_p->frag_pct = sStat.u32FreeSize ? (100 - (100U * sStat.u32BiggestFree) / sStat.u32FreeSize) : 0;
+}
+
+lv_result_t lv_mem_test_core(void)
+{
+    return (nu_heap_check() == 0) ? LV_RESULT_OK : LV_RESULT_INVALID;
+}
+
+#endif /* LV_USE_STDLIB_MALLOC == LV_STDLIB_CUSTOM */
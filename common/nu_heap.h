@@ -0,0 +1,67 @@
+/**************************************************************************//**
+ * @file     nu_heap.h
+ * @brief    Multi-region TLSF heap with placement hints
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ * @copyright (C) 2024 Nuvoton Technology Corp. All rights reserved.
+ *****************************************************************************/
+#ifndef __NU_HEAP_H__
+#define __NU_HEAP_H__
+
+#include <stdint.h>
+
+/*
+ * One O(1) two-level segregated fit allocator per region. A region is any
+ * RAM window, e.g. internal SRAM, HyperRAM or DDR, tagged with the
+ * capabilities below. Allocation walks regions in adding order and takes
+ * the first one that satisfies the hints.
+ *
+ * Adding nu_heap.c to a project also provides pvPortMalloc() and friends,
+ * remove heap_x.c of FreeRTOS from that project. With
+ * LV_USE_STDLIB_MALLOC set to LV_STDLIB_CUSTOM in lv_conf.h, lv_malloc()
+ * is served here too.
+ */
+
+/* Region capabilities, also used as placement hints. */
+#define NU_MEM_FAST             (1 << 0)    // Internal SRAM, prefer it for small and hot objects.
+#define NU_MEM_DMA              (1 << 1)    // Reachable by PDMA/GDMA, a hard requirement as hint.
+#define NU_MEM_BULK             (1 << 2)    // Large external RAM, prefer it for frame, draw and layer buffers.
+
+/* Hint only. Align start and round size up to cache line, no line is shared with other blocks. */
+#define NU_MEM_CACHELINE        (1 << 8)
+
+#if !defined(CONFIG_NU_HEAP_MAX_REGIONS)
+    #define CONFIG_NU_HEAP_MAX_REGIONS      4
+#endif
+
+#if !defined(CONFIG_NU_HEAP_CACHE_LINE)
+    #define CONFIG_NU_HEAP_CACHE_LINE       32
+#endif
+
+/* lv_malloc() requests from this size go to NU_MEM_BULK regions first. */
+#if !defined(CONFIG_NU_HEAP_LV_BULK_THRESHOLD)
+    #define CONFIG_NU_HEAP_LV_BULK_THRESHOLD    (4*1024)
+#endif
+
+typedef struct
+{
+    uint32_t u32TotalSize;      // Usable bytes of matched regions
+    uint32_t u32FreeSize;
+    uint32_t u32MinEverFree;    // Low-water mark of u32FreeSize
+    uint32_t u32BiggestFree;
+    uint32_t u32UsedCnt;
+    uint32_t u32FreeCnt;
+} S_NU_HEAP_STAT;
+
+int nu_heap_add_region(void *pvStart, uint32_t u32Size, uint32_t u32Caps);
+
+void *nu_heap_malloc(uint32_t u32Size, uint32_t u32Hints);
+void *nu_heap_malloc_align(uint32_t u32Size, uint32_t u32Align, uint32_t u32Hints);
+void *nu_heap_realloc(void *pvPtr, uint32_t u32Size, uint32_t u32Hints);
+void nu_heap_free(void *pvPtr);
+
+uint32_t nu_heap_region_caps(const void *pvPtr);
+void nu_heap_stat(uint32_t u32Caps, S_NU_HEAP_STAT *psStat);
+int nu_heap_check(void);
+
+#endif /* __NU_HEAP_H__ */
@@ -0,0 +1,472 @@
+/**************************************************************************//**
+ * @file     nu_image_decoder.c
+ * @brief    LVGL decoder for band-compressed (LZ4/RLE) images
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ * @copyright (C) 2024 Nuvoton Technology Corp. All rights reserved.
+ *****************************************************************************/
+
+#include <stdio.h>
+#include <string.h>
+#include "nu_bitutil.h"
+#include "nu_image_decoder.h"
+#include "nu_memtag.h"
+
+#define NU_IMAGE_FILE_EXT           "nz"
+#define NU_IMAGE_BENCH_CHUNK        4096
+
+typedef struct
+{
+    S_NU_IMAGE_STREAM_HEADER sStream;
+    uint32_t *pu32BandOffset;       // u16BandCount + 1 entries
+    const uint8_t *pu8Mem;          // Band data of an in-memory stream
+    lv_fs_file_t sFile;
+    uint32_t u32FileDataPos;        // File offset of band data
+    bool bIsFile;
+    uint8_t *pu8InBuf;              // One compressed band, file source only
+    lv_draw_buf_t *psBand;          // One decoded band
+    uint32_t u32Stride;
+    uint32_t u32PxSize;
+} S_NU_IMAGE_CTX;
+
+/*
+ * LZ4 block format: [token][literal length+][literals][offset16][match length+].
+ * Returns the decoded size, or -1 on a malformed or oversized block.
+ */
+static int32_t nu_lz4_decode(const uint8_t *pu8Src, uint32_t u32SrcLen, uint8_t *pu8Dst, uint32_t u32DstCap)
+{
+    const uint8_t *ip = pu8Src;
+    const uint8_t *iend = pu8Src + u32SrcLen;
+    uint8_t *op = pu8Dst;
+    uint8_t *oend = pu8Dst + u32DstCap;
+
+    while (ip < iend)
+    {
+        uint32_t u32Token = *ip++;
+        uint32_t u32Len = u32Token >> 4;
+        uint32_t u32Offset;
+        const uint8_t *match;
+
+        if (u32Len == 15)
+        {
+            uint8_t b;
+            do
+            {
+                if (ip >= iend)
+                    return -1;
+                b = *ip++;
+                u32Len += b;
+            }
+            while (b == 255);
+        }
+
+        if ((u32Len > (uint32_t)(iend - ip)) || (u32Len > (uint32_t)(oend - op)))
+            return -1;
+
+        memcpy(op, ip, u32Len);
+        ip += u32Len;
+        op += u32Len;
+
+        /* The last sequence has literals only. */
+        if (ip >= iend)
+            break;
+
+        if ((iend - ip) < 2)
+            return -1;
+
+        u32Offset = ip[0] | (ip[1] << 8);
+        ip += 2;
+        if ((u32Offset == 0) || (u32Offset > (uint32_t)(op - pu8Dst)))
+            return -1;
+
+        u32Len = u32Token & 0xF;
+        if (u32Len == 15)
+        {
+            uint8_t b;
+            do
+            {
+                if (ip >= iend)
+                    return -1;
+                b = *ip++;
+                u32Len += b;
+            }
+            while (b == 255);
+        }
+        u32Len += 4;
+
+        if (u32Len > (uint32_t)(oend - op))
+            return -1;
+
+        /* Byte copy, the match may overlap the output. */
+        match = op - u32Offset;
+        while (u32Len--)
+            *op++ = *match++;
+    }
+
+    return (int32_t)(op - pu8Dst);
+}
+
+/*
+ * Pixel-wise RLE: control byte c, then
+ *   c & 0x80: one pixel repeated (c & 0x7F) + 1 times,
+ *   else    : (c + 1) literal pixels.
+ * A unit is one pixel (2 bytes for RGB565), so runs of flat color cost 3 bytes.
+ */
+static int32_t nu_rle_decode(const uint8_t *pu8Src, uint32_t u32SrcLen, uint8_t *pu8Dst, uint32_t u32DstCap, uint32_t u32PxSize)
+{
+    const uint8_t *ip = pu8Src;
+    const uint8_t *iend = pu8Src + u32SrcLen;
+    uint8_t *op = pu8Dst;
+    uint8_t *oend = pu8Dst + u32DstCap;
+
+    while (ip < iend)
+    {
+        uint32_t u32Ctrl = *ip++;
+        uint32_t u32Count = (u32Ctrl & 0x7F) + 1;
+        uint32_t u32Bytes = u32Count * u32PxSize;
+
+        if (u32Bytes > (uint32_t)(oend - op))
+            return -1;
+
+        if (u32Ctrl & 0x80)
+        {
+            if ((uint32_t)(iend - ip) < u32PxSize)
+                return -1;
+
+            if (u32PxSize == 2)
+            {
+                uint16_t u16Px = ip[0] | (ip[1] << 8);
+                while (u32Count--)
+                {
+                    *op++ = (uint8_t)u16Px;
+                    *op++ = (uint8_t)(u16Px >> 8);
+                }
+            }
+            else
+            {
+                while (u32Count--)
+                {
+                    memcpy(op, ip, u32PxSize);
+                    op += u32PxSize;
+                }
+            }
+            ip += u32PxSize;
+        }
+        else
+        {
+            if ((uint32_t)(iend - ip) < u32Bytes)
+                return -1;
+
+            memcpy(op, ip, u32Bytes);
+            ip += u32Bytes;
+            op += u32Bytes;
+        }
+    }
+
+    return (int32_t)(op - pu8Dst);
+}
+
+static lv_result_t nu_image_stream_check(const S_NU_IMAGE_STREAM_HEADER *psStream, const lv_image_header_t *psHeader)
+{
+    if ((psStream->u32Magic != NU_IMAGE_STREAM_MAGIC) ||
+            (psStream->u8Codec == 0) || (psStream->u8Codec >= evNU_IMAGE_CODEC_CNT) ||
+            (psStream->u16BandRows == 0) ||
+            (psStream->u16BandCount != ((psHeader->h + psStream->u16BandRows - 1) / psStream->u16BandRows)))
+        return LV_RESULT_INVALID;
+
+    /* Sub-byte and planar formats are not split into bands. */
+    if ((lv_color_format_get_size(psHeader->cf) == 0) ||
+            (psHeader->cf == LV_COLOR_FORMAT_RGB565A8))
+        return LV_RESULT_INVALID;
+
+    return LV_RESULT_OK;
+}
+
+static lv_result_t nu_image_decoder_info(lv_image_decoder_t *decoder, const void *src, lv_image_header_t *header)
+{
+    lv_image_src_t src_type = lv_image_src_get_type(src);
+
+    LV_UNUSED(decoder);
+
+    if (src_type == LV_IMAGE_SRC_VARIABLE)
+    {
+        const lv_image_dsc_t *img_dsc = (const lv_image_dsc_t *)src;
+
+        if (!(img_dsc->header.flags & NU_IMAGE_FLAGS_STREAM) ||
+                (img_dsc->data_size < sizeof(S_NU_IMAGE_STREAM_HEADER)) ||
+                (nu_get32_le(img_dsc->data) != NU_IMAGE_STREAM_MAGIC))
+            return LV_RESULT_INVALID;
+
+        *header = img_dsc->header;
+    }
+    else if (src_type == LV_IMAGE_SRC_FILE)
+    {
+        lv_fs_file_t f;
+        uint32_t u32Read = 0;
+        lv_result_t res = LV_RESULT_INVALID;
+
+        if (lv_strcmp(lv_fs_get_ext(src), NU_IMAGE_FILE_EXT) != 0)
+            return LV_RESULT_INVALID;
+
+        if (lv_fs_open(&f, src, LV_FS_MODE_RD) != LV_FS_RES_OK)
+            return LV_RESULT_INVALID;
+
+        if ((lv_fs_read(&f, header, sizeof(lv_image_header_t), &u32Read) == LV_FS_RES_OK) &&
+                (u32Read == sizeof(lv_image_header_t)) &&
+                (header->magic == LV_IMAGE_HEADER_MAGIC) &&
+                (header->flags & NU_IMAGE_FLAGS_STREAM))
+            res = LV_RESULT_OK;
+
+        lv_fs_close(&f);
+
+        if (res != LV_RESULT_OK)
+            return res;
+    }
+    else
+    {
+        return LV_RESULT_INVALID;
+    }
+
+    if (header->stride == 0)
+        header->stride = lv_draw_buf_width_to_stride(header->w, header->cf);
+
+    return LV_RESULT_OK;
+}
+
+static void nu_image_decoder_close(lv_image_decoder_t *decoder, lv_image_decoder_dsc_t *dsc)
+{
+    S_NU_IMAGE_CTX *psCtx = (S_NU_IMAGE_CTX *)dsc->user_data;
+
+    LV_UNUSED(decoder);
+
+    if (!psCtx)
+        return;
+
+    if (psCtx->psBand)
+        lv_draw_buf_destroy(psCtx->psBand);
+
+    if (psCtx->pu8InBuf)
+        NU_MEMTAG_FREE(lv_free, psCtx->pu8InBuf);
+
+    if (psCtx->pu32BandOffset)
+        NU_MEMTAG_FREE(lv_free, psCtx->pu32BandOffset);
+
+    if (psCtx->bIsFile)
+        lv_fs_close(&psCtx->sFile);
+
+    lv_free(psCtx);
+
+    dsc->user_data = NULL;
+    dsc->decoded = NULL;
+}
+
+static lv_result_t nu_image_decoder_open(lv_image_decoder_t *decoder, lv_image_decoder_dsc_t *dsc)
+{
+    S_NU_IMAGE_CTX *psCtx;
+    uint32_t u32TableSize;
+
+    psCtx = lv_malloc_zeroed(sizeof(S_NU_IMAGE_CTX));
+    if (!psCtx)
+        return LV_RESULT_INVALID;
+
+    dsc->user_data = psCtx;
+
+    if (dsc->src_type == LV_IMAGE_SRC_FILE)
+    {
+        uint32_t u32Read = 0;
+
+        if (lv_fs_open(&psCtx->sFile, dsc->src, LV_FS_MODE_RD) != LV_FS_RES_OK)
+            goto exit_nu_image_decoder_open;
+
+        psCtx->bIsFile = true;
+
+        if ((lv_fs_seek(&psCtx->sFile, sizeof(lv_image_header_t), LV_FS_SEEK_SET) != LV_FS_RES_OK) ||
+                (lv_fs_read(&psCtx->sFile, &psCtx->sStream, sizeof(S_NU_IMAGE_STREAM_HEADER), &u32Read) != LV_FS_RES_OK) ||
+                (u32Read != sizeof(S_NU_IMAGE_STREAM_HEADER)) ||
+                (nu_image_stream_check(&psCtx->sStream, &dsc->header) != LV_RESULT_OK))
+            goto exit_nu_image_decoder_open;
+
+        u32TableSize = (psCtx->sStream.u16BandCount + 1) * sizeof(uint32_t);
+        psCtx->pu32BandOffset = NU_MEMTAG_MALLOC(lv_malloc, evNU_MEMTAG_IMAGE, u32TableSize);
+        psCtx->pu8InBuf = NU_MEMTAG_MALLOC(lv_malloc, evNU_MEMTAG_IMAGE, psCtx->sStream.u32MaxBandSize);
+        if (!psCtx->pu32BandOffset || !psCtx->pu8InBuf)
+            goto exit_nu_image_decoder_open;
+
+        if ((lv_fs_read(&psCtx->sFile, psCtx->pu32BandOffset, u32TableSize, &u32Read) != LV_FS_RES_OK) ||
+                (u32Read != u32TableSize))
+            goto exit_nu_image_decoder_open;
+
+        psCtx->u32FileDataPos = sizeof(lv_image_header_t) + sizeof(S_NU_IMAGE_STREAM_HEADER) + u32TableSize;
+    }
+    else
+    {
+        const lv_image_dsc_t *img_dsc = (const lv_image_dsc_t *)dsc->src;
+
+        memcpy(&psCtx->sStream, img_dsc->data, sizeof(S_NU_IMAGE_STREAM_HEADER));
+        if (nu_image_stream_check(&psCtx->sStream, &dsc->header) != LV_RESULT_OK)
+            goto exit_nu_image_decoder_open;
+
+        u32TableSize = (psCtx->sStream.u16BandCount + 1) * sizeof(uint32_t);
+        if (img_dsc->data_size < (sizeof(S_NU_IMAGE_STREAM_HEADER) + u32TableSize))
+            goto exit_nu_image_decoder_open;
+
+        psCtx->pu32BandOffset = NU_MEMTAG_MALLOC(lv_malloc, evNU_MEMTAG_IMAGE, u32TableSize);
+        if (!psCtx->pu32BandOffset)
+            goto exit_nu_image_decoder_open;
+
+        memcpy(psCtx->pu32BandOffset, img_dsc->data + sizeof(S_NU_IMAGE_STREAM_HEADER), u32TableSize);
+        psCtx->pu8Mem = img_dsc->data + sizeof(S_NU_IMAGE_STREAM_HEADER) + u32TableSize;
+
+        if (psCtx->pu32BandOffset[psCtx->sStream.u16BandCount] > (img_dsc->data_size - sizeof(S_NU_IMAGE_STREAM_HEADER) - u32TableSize))
+            goto exit_nu_image_decoder_open;
+    }
+
+    psCtx->u32PxSize = lv_color_format_get_size(dsc->header.cf);
+    psCtx->u32Stride = dsc->header.stride ? dsc->header.stride : lv_draw_buf_width_to_stride(dsc->header.w, dsc->header.cf);
+
+    psCtx->psBand = lv_draw_buf_create(dsc->header.w, psCtx->sStream.u16BandRows, dsc->header.cf, psCtx->u32Stride);
+    if (!psCtx->psBand)
+        goto exit_nu_image_decoder_open;
+
+    /* No full decoded image, draw units pull bands through get_area_cb. */
+    dsc->decoded = NULL;
+
+    return LV_RESULT_OK;
+
+exit_nu_image_decoder_open:
+
+    nu_image_decoder_close(decoder, dsc);
+
+    return LV_RESULT_INVALID;
+}
+
+static lv_result_t nu_image_band_decode(S_NU_IMAGE_CTX *psCtx, const lv_image_header_t *psHeader, uint32_t u32Band)
+{
+    uint32_t u32Start = psCtx->pu32BandOffset[u32Band];
+    uint32_t u32Len = psCtx->pu32BandOffset[u32Band + 1] - u32Start;
+    uint32_t u32Rows = LV_MIN(psCtx->sStream.u16BandRows, psHeader->h - (u32Band * psCtx->sStream.u16BandRows));
+    uint32_t u32RawLen = psCtx->u32Stride * u32Rows;
+    const uint8_t *pu8Src;
+    int32_t i32Out;
+
+    if (psCtx->bIsFile)
+    {
+        uint32_t u32Read = 0;
+
+        if ((u32Len > psCtx->sStream.u32MaxBandSize) ||
+                (lv_fs_seek(&psCtx->sFile, psCtx->u32FileDataPos + u32Start, LV_FS_SEEK_SET) != LV_FS_RES_OK) ||
+                (lv_fs_read(&psCtx->sFile, psCtx->pu8InBuf, u32Len, &u32Read) != LV_FS_RES_OK) ||
+                (u32Read != u32Len))
+            return LV_RESULT_INVALID;
+
+        pu8Src = psCtx->pu8InBuf;
+    }
+    else
+    {
+        pu8Src = psCtx->pu8Mem + u32Start;
+    }
+
+    if (psCtx->sStream.u8Codec == evNU_IMAGE_CODEC_LZ4)
+        i32Out = nu_lz4_decode(pu8Src, u32Len, psCtx->psBand->data, u32RawLen);
+    else
+        i32Out = nu_rle_decode(pu8Src, u32Len, psCtx->psBand->data, u32RawLen, psCtx->u32PxSize);
+
+    if (i32Out != (int32_t)u32RawLen)
+    {
+        LV_LOG_WARN("Band %d decode failed", u32Band);
+        return LV_RESULT_INVALID;
+    }
+
+    psCtx->psBand->header.h = u32Rows;
+
+    return LV_RESULT_OK;
+}
+
+static lv_result_t nu_image_decoder_get_area(lv_image_decoder_t *decoder, lv_image_decoder_dsc_t *dsc,
+        const lv_area_t *full_area, lv_area_t *decoded_area)
+{
+    S_NU_IMAGE_CTX *psCtx = (S_NU_IMAGE_CTX *)dsc->user_data;
+    int32_t i32Y;
+    uint32_t u32Band;
+
+    LV_UNUSED(decoder);
+
+    if (!psCtx)
+        return LV_RESULT_INVALID;
+
+    /* First call starts at the band holding the first row to draw. */
+    i32Y = (decoded_area->y1 == LV_COORD_MIN) ? LV_MAX(full_area->y1, 0) : (decoded_area->y2 + 1);
+    if ((i32Y > full_area->y2) || (i32Y >= dsc->header.h))
+        return LV_RESULT_INVALID;
+
+    u32Band = i32Y / psCtx->sStream.u16BandRows;
+    if (nu_image_band_decode(psCtx, &dsc->header, u32Band) != LV_RESULT_OK)
+        return LV_RESULT_INVALID;
+
+    decoded_area->x1 = 0;
+    decoded_area->x2 = dsc->header.w - 1;
+    decoded_area->y1 = u32Band * psCtx->sStream.u16BandRows;
+    decoded_area->y2 = decoded_area->y1 + psCtx->psBand->header.h - 1;
+
+    dsc->decoded = psCtx->psBand;
+
+    return LV_RESULT_OK;
+}
+
+void nu_image_decoder_init(void)
+{
+    lv_image_decoder_t *psDecoder = lv_image_decoder_create();
+
+    LV_ASSERT_MALLOC(psDecoder);
+
+    lv_image_decoder_set_info_cb(psDecoder, nu_image_decoder_info);
+    lv_image_decoder_set_open_cb(psDecoder, nu_image_decoder_open);
+    lv_image_decoder_set_get_area_cb(psDecoder, nu_image_decoder_get_area);
+    lv_image_decoder_set_close_cb(psDecoder, nu_image_decoder_close);
+}
+
+/**
+ * Compare reading a raw image file against reading and inflating its
+ * compressed copy band by band, which is what a draw of the whole image costs.
+ */
+void nu_image_decoder_benchmark(const char *szRawPath, const char *szStreamPath)
+{
+    lv_fs_file_t sFile;
+    lv_image_decoder_dsc_t sDsc;
+    lv_area_t sFullArea, sDecodedArea;
+    uint8_t *pu8Buf;
+    uint32_t u32Read, u32RawBytes = 0, u32Bands = 0;
+    uint32_t u32Start, u32RawMs, u32StreamMs;
+
+    pu8Buf = lv_malloc(NU_IMAGE_BENCH_CHUNK);
+    if (!pu8Buf)
+        return;
+
+    u32Start = lv_tick_get();
+    if (lv_fs_open(&sFile, szRawPath, LV_FS_MODE_RD) == LV_FS_RES_OK)
+    {
+        while ((lv_fs_read(&sFile, pu8Buf, NU_IMAGE_BENCH_CHUNK, &u32Read) == LV_FS_RES_OK) && u32Read)
+            u32RawBytes += u32Read;
+
+        lv_fs_close(&sFile);
+    }
+    u32RawMs = lv_tick_elaps(u32Start);
+
+    lv_free(pu8Buf);
+
+    u32Start = lv_tick_get();
+    if (lv_image_decoder_open(&sDsc, szStreamPath, NULL) == LV_RESULT_OK)
+    {
+        lv_area_set(&sFullArea, 0, 0, sDsc.header.w - 1, sDsc.header.h - 1);
+        sDecodedArea.y1 = LV_COORD_MIN;
+
+        while (lv_image_decoder_get_area(&sDsc, &sFullArea, &sDecodedArea) == LV_RESULT_OK)
+            u32Bands++;
+
+        lv_image_decoder_close(&sDsc);
+    }
+    u32StreamMs = lv_tick_elaps(u32Start);
+
+    printf("[%s] %s: %d bytes read in %d ms\n", __func__, szRawPath, u32RawBytes, u32RawMs);
+    printf("[%s] %s: %d bands read and decoded in %d ms\n", __func__, szStreamPath, u32Bands, u32StreamMs);
+}
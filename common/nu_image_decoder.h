@@ -0,0 +1,54 @@
+/**************************************************************************//**
+ * @file     nu_image_decoder.h
+ * @brief    LVGL decoder for band-compressed (LZ4/RLE) images
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ * @copyright (C) 2024 Nuvoton Technology Corp. All rights reserved.
+ *****************************************************************************/
+#ifndef __NU_IMAGE_DECODER_H__
+#define __NU_IMAGE_DECODER_H__
+
+#include <stdint.h>
+#include "lvgl.h"
+
+/*
+ * A compressed image is an lv_image_header_t with LV_IMAGE_FLAGS_USER1 set,
+ * followed by a stream built by tools/nu_image_compress.py:
+ *
+ *   S_NU_IMAGE_STREAM_HEADER
+ *   uint32_t au32BandOffset[u16BandCount + 1]    from the end of this table
+ *   band data                                    each band decodes alone
+ *
+ * Every band holds u16BandRows full-width rows (fewer in the last one). The
+ * decoder inflates one band at a time into a band-sized draw buffer through
+ * get_area_cb, so neither the compressed nor the raw image is ever resident.
+ *
+ * Sources: a file ("0:bg.nz"), or an lv_image_dsc_t whose header has
+ * LV_IMAGE_FLAGS_USER1 and whose data points at the stream (RAM, internal
+ * flash or a memory-mapped window).
+ */
+#define NU_IMAGE_STREAM_MAGIC       0x535A554EUL    /* "NUZS" */
+#define NU_IMAGE_FLAGS_STREAM       LV_IMAGE_FLAGS_USER1
+
+typedef enum
+{
+    evNU_IMAGE_CODEC_LZ4 = 1,   // LZ4 block format
+    evNU_IMAGE_CODEC_RLE,       // Pixel-wise RLE, unit is one pixel
+    evNU_IMAGE_CODEC_CNT
+} E_NU_IMAGE_CODEC;
+
+typedef struct
+{
+    uint32_t u32Magic;
+    uint8_t  u8Codec;           // E_NU_IMAGE_CODEC
+    uint8_t  u8Reserved;
+    uint16_t u16BandRows;
+    uint16_t u16BandCount;
+    uint16_t u16Reserved;
+    uint32_t u32MaxBandSize;    // Largest compressed band in byte
+} S_NU_IMAGE_STREAM_HEADER;
+
+void nu_image_decoder_init(void);
+void nu_image_decoder_benchmark(const char *szRawPath, const char *szStreamPath);
+
+#endif /* __NU_IMAGE_DECODER_H__ */
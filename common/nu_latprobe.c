@@ -0,0 +1,353 @@
+/**************************************************************************//**
+ * @file     nu_latprobe.c
+ * @brief    Touch-to-photon latency probe
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ * @copyright (C) 2024 Nuvoton Technology Corp. All rights reserved.
+ *****************************************************************************/
+
+#include "nu_latprobe.h"
+
+#if defined(CONFIG_NU_LATPROBE)
+
+#include <stdio.h>
+#include "lv_glue.h"
+#include "FreeRTOS.h"
+#include "task.h"
+#include "timers.h"
+
+/* Cycle counter of DWT where the core has one, else the RTOS tick. */
+#if defined(__CORTEX_M) && ((__CORTEX_M == 3U) || (__CORTEX_M == 4U) || (__CORTEX_M == 7U) || (__CORTEX_M == 33U) || (__CORTEX_M == 55U))
+    #define NU_LATPROBE_USE_CYCCNT
+#endif
+
+typedef enum
+{
+    evLATPROBE_IDLE,
+    evLATPROBE_PRESSED,         // Waiting for a flush overlapping the object
+    evLATPROBE_FLUSHING,
+} E_LATPROBE_STATE;
+
+typedef struct
+{
+    uint32_t u32Irq;
+    uint32_t u32Read;
+    uint32_t u32Flush;
+    lv_area_t sArea;            // Object under the finger
+} S_LATPROBE_SAMPLE;
+
+/* Written by the touch ISR, armed again by a released read. */
+static volatile bool s_bIrqArmed = true;
+static volatile bool s_bIrqValid = false;
+static volatile uint32_t s_u32IrqStamp;
+
+static E_LATPROBE_STATE s_eState = evLATPROBE_IDLE;
+static S_LATPROBE_SAMPLE s_sSample;
+static lv_indev_state_t s_eLastState = LV_INDEV_STATE_RELEASED;
+
+static uint32_t s_au32Hist[CONFIG_NU_LATPROBE_BUCKET_NUM];
+static uint32_t s_u32Samples;
+static uint32_t s_u32Dropped;
+static uint32_t s_u32MinUs;
+static uint32_t s_u32MaxUs;
+static uint64_t s_u64SumUs;
+static uint64_t s_u64SumIrqReadUs;
+static uint64_t s_u64SumReadFlushUs;
+static uint64_t s_u64SumFlushUs;
+
+#if defined(CONFIG_NU_LATPROBE_SYNTH)
+static volatile bool s_bSynthDown = false;
+static const lv_point_t *s_psSynthPoints = NULL;
+static uint32_t s_u32SynthCount = 0;
+static uint32_t s_u32SynthIdx = 0;
+#endif
+
+static void nu_latprobe_timebase_init(void)
+{
+#if defined(NU_LATPROBE_USE_CYCCNT)
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+    DWT->CYCCNT = 0;
+    DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+#endif
+}
+
+/* Raw stamp, wraps. Differences are converted by nu_latprobe_us(). */
+static inline uint32_t nu_latprobe_now(void)
+{
+#if defined(NU_LATPROBE_USE_CYCCNT)
+    return DWT->CYCCNT;
+#else
+    return (uint32_t)xTaskGetTickCountFromISR();
+#endif
+}
+
+static uint32_t nu_latprobe_us(uint32_t u32From, uint32_t u32To)
+{
+#if defined(NU_LATPROBE_USE_CYCCNT)
+    return (u32To - u32From) / (SystemCoreClock / 1000000UL);
+#else
+    return (u32To - u32From) * portTICK_PERIOD_MS * 1000UL;
+#endif
+}
+
+void nu_latprobe_irq(void)
+{
+    if (s_bIrqArmed)
+    {
+        s_u32IrqStamp = nu_latprobe_now();
+        s_bIrqValid = true;
+        s_bIrqArmed = false;
+    }
+}
+
+static void nu_latprobe_record(uint32_t u32End)
+{
+    uint32_t u32Total = nu_latprobe_us(s_sSample.u32Irq, u32End);
+    uint32_t u32Bucket = u32Total / CONFIG_NU_LATPROBE_BUCKET_US;
+
+    if (u32Bucket >= CONFIG_NU_LATPROBE_BUCKET_NUM)
+        u32Bucket = CONFIG_NU_LATPROBE_BUCKET_NUM - 1;
+
+    s_au32Hist[u32Bucket]++;
+
+    if ((s_u32Samples == 0) || (u32Total < s_u32MinUs))
+        s_u32MinUs = u32Total;
+    if (u32Total > s_u32MaxUs)
+        s_u32MaxUs = u32Total;
+
+    s_u64SumUs += u32Total;
+    s_u64SumIrqReadUs += nu_latprobe_us(s_sSample.u32Irq, s_sSample.u32Read);
+    s_u64SumReadFlushUs += nu_latprobe_us(s_sSample.u32Read, s_sSample.u32Flush);
+    s_u64SumFlushUs += nu_latprobe_us(s_sSample.u32Flush, u32End);
+    s_u32Samples++;
+}
+
+static void nu_latprobe_press(const lv_point_t *psPoint)
+{
+    lv_obj_t *obj;
+    uint32_t u32Now = nu_latprobe_now();
+
+    /* Last one had no visible reaction yet. */
+    if (s_eState != evLATPROBE_IDLE)
+        s_u32Dropped++;
+
+    s_sSample.u32Irq = s_bIrqValid ? s_u32IrqStamp : u32Now;
+    s_sSample.u32Read = u32Now;
+    s_bIrqValid = false;
+
+    obj = lv_indev_search_obj(lv_screen_active(), (lv_point_t *)psPoint);
+    if (obj != NULL)
+    {
+        lv_obj_get_coords(obj, &s_sSample.sArea);
+    }
+    else
+    {
+        s_sSample.sArea.x1 = psPoint->x;
+        s_sSample.sArea.y1 = psPoint->y;
+        s_sSample.sArea.x2 = psPoint->x;
+        s_sSample.sArea.y2 = psPoint->y;
+    }
+
+    s_eState = evLATPROBE_PRESSED;
+}
+
+void nu_latprobe_read(lv_indev_data_t *psData)
+{
+#if defined(CONFIG_NU_LATPROBE_SYNTH)
+    lv_point_t sCenter;
+
+    if (s_u32SynthCount > 0)
+    {
+        psData->point = s_psSynthPoints[s_u32SynthIdx % s_u32SynthCount];
+    }
+    else
+    {
+        sCenter.x = lv_display_get_horizontal_resolution(NULL) / 2;
+        sCenter.y = lv_display_get_vertical_resolution(NULL) / 2;
+        psData->point = sCenter;
+    }
+    psData->state = s_bSynthDown ? LV_INDEV_STATE_PRESSED : LV_INDEV_STATE_RELEASED;
+#endif
+
+    if ((s_eState == evLATPROBE_PRESSED) &&
+            (nu_latprobe_us(s_sSample.u32Read, nu_latprobe_now()) > (CONFIG_NU_LATPROBE_TIMEOUT_MS * 1000UL)))
+    {
+        s_u32Dropped++;
+        s_eState = evLATPROBE_IDLE;
+    }
+
+    if ((psData->state == LV_INDEV_STATE_PRESSED) && (s_eLastState == LV_INDEV_STATE_RELEASED))
+    {
+        nu_latprobe_press(&psData->point);
+    }
+    else if (psData->state == LV_INDEV_STATE_RELEASED)
+    {
+        /* Next IRQ is a landing. */
+        s_bIrqValid = false;
+        s_bIrqArmed = true;
+    }
+
+    s_eLastState = psData->state;
+}
+
+void nu_latprobe_flush_begin(const lv_area_t *psArea)
+{
+    if ((s_eState == evLATPROBE_PRESSED) && lv_area_is_on(psArea, &s_sSample.sArea))
+    {
+        s_sSample.u32Flush = nu_latprobe_now();
+        s_eState = evLATPROBE_FLUSHING;
+    }
+}
+
+void nu_latprobe_flush_end(void)
+{
+    if (s_eState == evLATPROBE_FLUSHING)
+    {
+        /* Photons are out when the transfer is done. */
+        nu_latprobe_record(nu_latprobe_now());
+
+        s_eState = evLATPROBE_IDLE;
+    }
+}
+
+static uint32_t nu_latprobe_percentile(uint32_t u32Percent)
+{
+    uint32_t i, u32Sum = 0;
+    uint32_t u32Rank = ((s_u32Samples * u32Percent) + 99) / 100;
+
+    for (i = 0; i < CONFIG_NU_LATPROBE_BUCKET_NUM; i++)
+    {
+        u32Sum += s_au32Hist[i];
+        if (u32Sum >= u32Rank)
+            break;
+    }
+
+    /* The last bucket is open, report the max. */
+    if (i >= (CONFIG_NU_LATPROBE_BUCKET_NUM - 1))
+        return s_u32MaxUs;
+
+    return (i + 1) * CONFIG_NU_LATPROBE_BUCKET_US;
+}
+
+void nu_latprobe_stat(S_NU_LATPROBE_STAT *psStat)
+{
+    LV_ASSERT(psStat != NULL);
+
+    lv_memzero(psStat, sizeof(S_NU_LATPROBE_STAT));
+
+    psStat->u32Dropped = s_u32Dropped;
+    if (s_u32Samples == 0)
+        return;
+
+    psStat->u32Samples = s_u32Samples;
+    psStat->u32MinUs = s_u32MinUs;
+    psStat->u32MaxUs = s_u32MaxUs;
+    psStat->u32AvgUs = (uint32_t)(s_u64SumUs / s_u32Samples);
+    psStat->u32P50Us = nu_latprobe_percentile(50);
+    psStat->u32P99Us = nu_latprobe_percentile(99);
+    psStat->u32AvgIrqReadUs = (uint32_t)(s_u64SumIrqReadUs / s_u32Samples);
+    psStat->u32AvgReadFlushUs = (uint32_t)(s_u64SumReadFlushUs / s_u32Samples);
+    psStat->u32AvgFlushUs = (uint32_t)(s_u64SumFlushUs / s_u32Samples);
+}
+
+void nu_latprobe_reset(void)
+{
+    lv_memzero(s_au32Hist, sizeof(s_au32Hist));
+    s_u32Samples = 0;
+    s_u32Dropped = 0;
+    s_u32MinUs = 0;
+    s_u32MaxUs = 0;
+    s_u64SumUs = 0;
+    s_u64SumIrqReadUs = 0;
+    s_u64SumReadFlushUs = 0;
+    s_u64SumFlushUs = 0;
+    s_eState = evLATPROBE_IDLE;
+}
+
+/* Lines are parsed by tools/nu_latency_report.py, keep the format. */
+void nu_latprobe_dump(void)
+{
+    S_NU_LATPROBE_STAT sStat;
+    uint32_t i;
+
+    nu_latprobe_stat(&sStat);
+
+    printf("[latprobe] samples %u, dropped %u\n", sStat.u32Samples, sStat.u32Dropped);
+    printf("[latprobe] total us: min %u, avg %u, p50 %u, p99 %u, max %u\n",
+           sStat.u32MinUs, sStat.u32AvgUs, sStat.u32P50Us, sStat.u32P99Us, sStat.u32MaxUs);
+    printf("[latprobe] stage avg us: irq-read %u, read-flush %u, flush %u\n",
+           sStat.u32AvgIrqReadUs, sStat.u32AvgReadFlushUs, sStat.u32AvgFlushUs);
+
+    for (i = 0; i < CONFIG_NU_LATPROBE_BUCKET_NUM; i++)
+    {
+        if (s_au32Hist[i])
+            printf("[latprobe] hist %u %u\n", i * CONFIG_NU_LATPROBE_BUCKET_US, s_au32Hist[i]);
+    }
+}
+
+#if defined(CONFIG_NU_LATPROBE_SYNTH)
+void nu_latprobe_synth_points(const lv_point_t *psPoints, uint32_t u32Count)
+{
+    s_psSynthPoints = psPoints;
+    s_u32SynthCount = u32Count;
+    s_u32SynthIdx = 0;
+}
+
+/* Runs in timer task, acts as the touch ISR. */
+static void nu_latprobe_synth_cb(TimerHandle_t xTimer)
+{
+    if (!s_bSynthDown)
+    {
+        nu_latprobe_irq();
+        s_bSynthDown = true;
+        xTimerChangePeriod(xTimer, pdMS_TO_TICKS(CONFIG_NU_LATPROBE_SYNTH_HOLD_MS), 0);
+    }
+    else
+    {
+        s_bSynthDown = false;
+        s_u32SynthIdx++;
+        xTimerChangePeriod(xTimer, pdMS_TO_TICKS(CONFIG_NU_LATPROBE_SYNTH_PERIOD_MS - CONFIG_NU_LATPROBE_SYNTH_HOLD_MS), 0);
+    }
+
+    nu_lv_task_wakeup(NU_LV_WAKEUP_INPUT);
+}
+#else
+void nu_latprobe_synth_points(const lv_point_t *psPoints, uint32_t u32Count)
+{
+    LV_UNUSED(psPoints);
+    LV_UNUSED(u32Count);
+}
+#endif
+
+#if (CONFIG_NU_LATPROBE_DUMP_PERIOD > 0)
+static void nu_latprobe_dump_timer_cb(lv_timer_t *timer)
+{
+    LV_UNUSED(timer);
+
+    nu_latprobe_dump();
+}
+#endif
+
+void nu_latprobe_init(void)
+{
+    nu_latprobe_timebase_init();
+    nu_latprobe_reset();
+
+#if defined(CONFIG_NU_LATPROBE_SYNTH)
+    {
+        TimerHandle_t xTimer;
+
+        LV_ASSERT(CONFIG_NU_LATPROBE_SYNTH_PERIOD_MS > CONFIG_NU_LATPROBE_SYNTH_HOLD_MS);
+
+        xTimer = xTimerCreate("latprobe", pdMS_TO_TICKS(CONFIG_NU_LATPROBE_SYNTH_PERIOD_MS), pdFALSE, NULL, nu_latprobe_synth_cb);
+        LV_ASSERT(xTimer != NULL);
+        LV_ASSERT(xTimerStart(xTimer, 0) == pdPASS);
+    }
+#endif
+
+#if (CONFIG_NU_LATPROBE_DUMP_PERIOD > 0)
+    lv_timer_create(nu_latprobe_dump_timer_cb, CONFIG_NU_LATPROBE_DUMP_PERIOD, NULL);
+#endif
+}
+
+#endif /* CONFIG_NU_LATPROBE */
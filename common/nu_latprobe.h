@@ -0,0 +1,108 @@
+/**************************************************************************//**
+ * @file     nu_latprobe.h
+ * @brief    Touch-to-photon latency probe
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ * @copyright (C) 2024 Nuvoton Technology Corp. All rights reserved.
+ *****************************************************************************/
+#ifndef __NU_LATPROBE_H__
+#define __NU_LATPROBE_H__
+
+#include <stdint.h>
+#include "lvgl.h"
+
+/*
+ * A sample starts at the touch IRQ of a finger landing. The press read by
+ * LVGL gives the sample the object under the finger, and the sample ends when
+ * the first flush overlapping that object is sent to the panel. Stages:
+ *
+ *   irq -> read     controller read and LVGL task wakeup
+ *   read -> flush   LVGL event processing and rendering
+ *   flush           transfer of the overlapping area
+ *
+ * Samples without a visible reaction in CONFIG_NU_LATPROBE_TIMEOUT_MS are
+ * dropped. Without a touch IRQ pin the sample starts at the read.
+ *
+ * With CONFIG_NU_LATPROBE_SYNTH, a timer injects presses in place of the
+ * panel, so runs are repeatable across firmware builds. Compare the dump of
+ * two runs by tools/nu_latency_report.py.
+ *
+ * Define CONFIG_NU_LATPROBE in project settings to enable it. Otherwise the
+ * hooks below are nothing and nu_latprobe.c builds empty.
+ */
+
+/* Histogram bucket width in us, the last bucket counts all above. */
+#if !defined(CONFIG_NU_LATPROBE_BUCKET_US)
+    #define CONFIG_NU_LATPROBE_BUCKET_US        1000
+#endif
+
+#if !defined(CONFIG_NU_LATPROBE_BUCKET_NUM)
+    #define CONFIG_NU_LATPROBE_BUCKET_NUM       64
+#endif
+
+#if !defined(CONFIG_NU_LATPROBE_TIMEOUT_MS)
+    #define CONFIG_NU_LATPROBE_TIMEOUT_MS       500
+#endif
+
+/* Dump by a LVGL timer of this period in ms, 0 to dump on demand only. */
+#if !defined(CONFIG_NU_LATPROBE_DUMP_PERIOD)
+    #define CONFIG_NU_LATPROBE_DUMP_PERIOD      0
+#endif
+
+/* Synthetic press of HOLD ms every PERIOD ms. */
+#if !defined(CONFIG_NU_LATPROBE_SYNTH_PERIOD_MS)
+    #define CONFIG_NU_LATPROBE_SYNTH_PERIOD_MS  500
+#endif
+
+#if !defined(CONFIG_NU_LATPROBE_SYNTH_HOLD_MS)
+    #define CONFIG_NU_LATPROBE_SYNTH_HOLD_MS    100
+#endif
+
+typedef struct
+{
+    uint32_t u32Samples;
+    uint32_t u32Dropped;        // No overlapping flush in time, or overrun by next press
+    uint32_t u32MinUs;
+    uint32_t u32MaxUs;
+    uint32_t u32AvgUs;
+    uint32_t u32P50Us;          // Upper bound of the bucket
+    uint32_t u32P99Us;          // Upper bound of the bucket
+    uint32_t u32AvgIrqReadUs;
+    uint32_t u32AvgReadFlushUs;
+    uint32_t u32AvgFlushUs;
+} S_NU_LATPROBE_STAT;
+
+#if defined(CONFIG_NU_LATPROBE)
+
+void nu_latprobe_init(void);
+
+/* Touch GPIO ISR. */
+void nu_latprobe_irq(void);
+
+/* Input read callback, after the device is read. It replaces the data with CONFIG_NU_LATPROBE_SYNTH. */
+void nu_latprobe_read(lv_indev_data_t *psData);
+
+/* Flush callback, around sending an area to the panel. */
+void nu_latprobe_flush_begin(const lv_area_t *psArea);
+void nu_latprobe_flush_end(void);
+
+/* Points pressed by turns with CONFIG_NU_LATPROBE_SYNTH, the center of screen by default. */
+void nu_latprobe_synth_points(const lv_point_t *psPoints, uint32_t u32Count);
+
+void nu_latprobe_stat(S_NU_LATPROBE_STAT *psStat);
+void nu_latprobe_reset(void);
+void nu_latprobe_dump(void);
+
+#else
+
+#define nu_latprobe_init()
+#define nu_latprobe_irq()
+#define nu_latprobe_read(data)
+#define nu_latprobe_flush_begin(area)
+#define nu_latprobe_flush_end()
+#define nu_latprobe_synth_points(points, count)
+#define nu_latprobe_dump()
+
+#endif
+
+#endif /* __NU_LATPROBE_H__ */
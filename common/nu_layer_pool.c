@@ -0,0 +1,237 @@
+/**************************************************************************//**
+ * @file     nu_layer_pool.c
+ * @brief    Fixed-size pool of LVGL layer and draw buffers
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ * @copyright (C) 2024 Nuvoton Technology Corp. All rights reserved.
+ *****************************************************************************/
+
+#include "lvgl.h"
+#include "nu_layer_pool.h"
+
+#if defined(CONFIG_NU_LAYER_POOL)
+
+#include <stdio.h>
+#include "nu_section.h"
+#include "FreeRTOS.h"
+#include "task.h"
+
+#define NU_LAYER_POOL_SLOT(size)    (((size) + CONFIG_NU_DMA_ALIGN - 1) & ~(CONFIG_NU_DMA_ALIGN - 1))
+
+/* Keep an array for a removed class, as C has no empty arrays. */
+#define NU_LAYER_POOL_BYTES(size, num)  (((num) > 0) ? (NU_LAYER_POOL_SLOT(size) * (num)) : CONFIG_NU_DMA_ALIGN)
+
+#if (CONFIG_NU_LAYER_POOL_SMALL_NUM > 32) || (CONFIG_NU_LAYER_POOL_MEDIUM_NUM > 32) || (CONFIG_NU_LAYER_POOL_LARGE_NUM > 32)
+    #error "Up to 32 slots per class."
+#endif
+
+typedef struct
+{
+    uint8_t *pu8Base;
+    uint32_t u32UsedMask;       // Bit n set if slot n is taken
+    S_NU_LAYER_POOL_STAT sStat;
+} S_NU_LAYER_POOL_CLASS;
+
+NU_DMA_DATA static uint8_t s_au8PoolSmall[NU_LAYER_POOL_BYTES(CONFIG_NU_LAYER_POOL_SMALL_SIZE, CONFIG_NU_LAYER_POOL_SMALL_NUM)];
+NU_DMA_DATA static uint8_t s_au8PoolMedium[NU_LAYER_POOL_BYTES(CONFIG_NU_LAYER_POOL_MEDIUM_SIZE, CONFIG_NU_LAYER_POOL_MEDIUM_NUM)];
+NU_DMA_DATA static uint8_t s_au8PoolLarge[NU_LAYER_POOL_BYTES(CONFIG_NU_LAYER_POOL_LARGE_SIZE, CONFIG_NU_LAYER_POOL_LARGE_NUM)];
+
+static S_NU_LAYER_POOL_CLASS s_asPoolClass[evNU_LAYER_POOL_CNT] =
+{
+    { s_au8PoolSmall,  0, { NU_LAYER_POOL_SLOT(CONFIG_NU_LAYER_POOL_SMALL_SIZE),  CONFIG_NU_LAYER_POOL_SMALL_NUM,  0, 0, 0 } },
+    { s_au8PoolMedium, 0, { NU_LAYER_POOL_SLOT(CONFIG_NU_LAYER_POOL_MEDIUM_SIZE), CONFIG_NU_LAYER_POOL_MEDIUM_NUM, 0, 0, 0 } },
+    { s_au8PoolLarge,  0, { NU_LAYER_POOL_SLOT(CONFIG_NU_LAYER_POOL_LARGE_SIZE),  CONFIG_NU_LAYER_POOL_LARGE_NUM,  0, 0, 0 } },
+};
+
+static const char *const s_apcPoolClassName[evNU_LAYER_POOL_CNT] =
+{
+    "small",
+    "medium",
+    "large",
+};
+
+static S_NU_LAYER_POOL_MISS s_sPoolMiss;
+
+static lv_draw_buf_malloc_cb s_pfnDrawBufMalloc = NULL;
+static lv_draw_buf_free_cb s_pfnDrawBufFree = NULL;
+
+static void *nu_layer_pool_take(uint32_t u32Size)
+{
+    S_NU_LAYER_POOL_CLASS *psClass;
+    void *pvBuf = NULL;
+    int bFits = 0;
+    uint32_t i, u32Slot;
+
+    taskENTER_CRITICAL();
+
+    /* Smallest class first, then a larger one if it is full. */
+    for (i = 0; i < evNU_LAYER_POOL_CNT; i++)
+    {
+        psClass = &s_asPoolClass[i];
+
+        if ((psClass->sStat.u32SlotNum == 0) || (u32Size > psClass->sStat.u32SlotSize))
+            continue;
+
+        bFits = 1;
+
+        for (u32Slot = 0; u32Slot < psClass->sStat.u32SlotNum; u32Slot++)
+        {
+            if (!(psClass->u32UsedMask & (1UL << u32Slot)))
+                break;
+        }
+
+        if (u32Slot == psClass->sStat.u32SlotNum)
+            continue;
+
+        psClass->u32UsedMask |= (1UL << u32Slot);
+        psClass->sStat.u32Hit++;
+        psClass->sStat.u32Used++;
+        if (psClass->sStat.u32Used > psClass->sStat.u32Peak)
+            psClass->sStat.u32Peak = psClass->sStat.u32Used;
+
+        pvBuf = psClass->pu8Base + (u32Slot * psClass->sStat.u32SlotSize);
+        goto exit_nu_layer_pool_take;
+    }
+
+    if (bFits)
+    {
+        s_sPoolMiss.u32MissFull++;
+    }
+    else
+    {
+        s_sPoolMiss.u32MissSize++;
+        if (u32Size > s_sPoolMiss.u32MaxMissSize)
+            s_sPoolMiss.u32MaxMissSize = u32Size;
+    }
+
+exit_nu_layer_pool_take:
+
+    taskEXIT_CRITICAL();
+
+    return pvBuf;
+}
+
+/* Return 0 if the buffer is not of the pool. */
+static int nu_layer_pool_give(void *pvBuf)
+{
+    S_NU_LAYER_POOL_CLASS *psClass;
+    uintptr_t uOffset;
+    uint32_t i, u32Slot;
+
+    for (i = 0; i < evNU_LAYER_POOL_CNT; i++)
+    {
+        psClass = &s_asPoolClass[i];
+
+        uOffset = (uintptr_t)pvBuf - (uintptr_t)psClass->pu8Base;
+        if (((uintptr_t)pvBuf < (uintptr_t)psClass->pu8Base) ||
+                (uOffset >= (psClass->sStat.u32SlotSize * psClass->sStat.u32SlotNum)))
+            continue;
+
+        u32Slot = uOffset / psClass->sStat.u32SlotSize;
+
+        taskENTER_CRITICAL();
+
+        /* Freed twice. */
+        LV_ASSERT(psClass->u32UsedMask & (1UL << u32Slot));
+
+        psClass->u32UsedMask &= ~(1UL << u32Slot);
+        psClass->sStat.u32Used--;
+
+        taskEXIT_CRITICAL();
+
+        return 1;
+    }
+
+    return 0;
+}
+
+static void *nu_layer_pool_draw_buf_malloc(size_t size, lv_color_format_t color_format)
+{
+    void *pvBuf;
+
+    /* Like the LVGL allocator, leave room for align_pointer_cb, a wrapper may shift the pointer. */
+    pvBuf = nu_layer_pool_take((uint32_t)size + LV_DRAW_BUF_ALIGN - 1);
+    if (pvBuf == NULL)
+        pvBuf = s_pfnDrawBufMalloc(size, color_format);
+
+    return pvBuf;
+}
+
+static void nu_layer_pool_draw_buf_free(void *buf)
+{
+    if ((buf != NULL) && !nu_layer_pool_give(buf))
+        s_pfnDrawBufFree(buf);
+}
+
+void nu_layer_pool_stat(E_NU_LAYER_POOL_CLASS eClass, S_NU_LAYER_POOL_STAT *psStat)
+{
+    LV_ASSERT((uint32_t)eClass < evNU_LAYER_POOL_CNT);
+
+    taskENTER_CRITICAL();
+    *psStat = s_asPoolClass[eClass].sStat;
+    taskEXIT_CRITICAL();
+}
+
+void nu_layer_pool_miss(S_NU_LAYER_POOL_MISS *psMiss)
+{
+    taskENTER_CRITICAL();
+    *psMiss = s_sPoolMiss;
+    taskEXIT_CRITICAL();
+}
+
+void nu_layer_pool_dump(void)
+{
+    S_NU_LAYER_POOL_STAT sStat;
+    S_NU_LAYER_POOL_MISS sMiss;
+    int i;
+
+    printf("[layerpool] %-6s %8s %5s %5s %5s %10s\n", "class", "slot", "num", "used", "peak", "hit");
+
+    for (i = 0; i < evNU_LAYER_POOL_CNT; i++)
+    {
+        nu_layer_pool_stat((E_NU_LAYER_POOL_CLASS)i, &sStat);
+
+        printf("[layerpool] %-6s %8u %5u %5u %5u %10u\n",
+               s_apcPoolClassName[i],
+               (unsigned int)sStat.u32SlotSize,
+               (unsigned int)sStat.u32SlotNum,
+               (unsigned int)sStat.u32Used,
+               (unsigned int)sStat.u32Peak,
+               (unsigned int)sStat.u32Hit);
+    }
+
+    nu_layer_pool_miss(&sMiss);
+    printf("[layerpool] miss: too large %u, full %u, largest missed %u bytes\n",
+           (unsigned int)sMiss.u32MissSize,
+           (unsigned int)sMiss.u32MissFull,
+           (unsigned int)sMiss.u32MaxMissSize);
+}
+
+#if (CONFIG_NU_LAYER_POOL_DUMP_PERIOD > 0)
+static void nu_layer_pool_dump_timer_cb(lv_timer_t *timer)
+{
+    LV_UNUSED(timer);
+
+    nu_layer_pool_dump();
+}
+#endif
+
+void nu_layer_pool_lv_init(void)
+{
+    lv_draw_buf_handlers_t *handlers = lv_draw_buf_get_handlers();
+
+    if (s_pfnDrawBufMalloc == NULL)
+    {
+        s_pfnDrawBufMalloc = handlers->buf_malloc_cb;
+        s_pfnDrawBufFree = handlers->buf_free_cb;
+
+        handlers->buf_malloc_cb = nu_layer_pool_draw_buf_malloc;
+        handlers->buf_free_cb = nu_layer_pool_draw_buf_free;
+    }
+
+#if (CONFIG_NU_LAYER_POOL_DUMP_PERIOD > 0)
+    lv_timer_create(nu_layer_pool_dump_timer_cb, CONFIG_NU_LAYER_POOL_DUMP_PERIOD, NULL);
+#endif
+}
+
+#endif /* CONFIG_NU_LAYER_POOL */
@@ -0,0 +1,95 @@
+/**************************************************************************//**
+ * @file     nu_layer_pool.h
+ * @brief    Fixed-size pool of LVGL layer and draw buffers
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ * @copyright (C) 2024 Nuvoton Technology Corp. All rights reserved.
+ *****************************************************************************/
+#ifndef __NU_LAYER_POOL_H__
+#define __NU_LAYER_POOL_H__
+
+#include <stdint.h>
+
+/*
+ * Draw buffers of layers, i.e. opacity, transform and blend mode, come and
+ * go every frame. The pool serves them from three classes of fixed slots,
+ * taking the smallest class that fits and a larger one when it is full.
+ * Larger requests, or all fitting slots taken, fall back to the previous
+ * buf_malloc_cb of LVGL and count as a miss.
+ *
+ * Slots are NU_DMA_DATA, in the internal SRAM reached by GDMA on the
+ * Cortex-M boards instead of HyperRAM, each starting on a cache line.
+ *
+ * Define CONFIG_NU_LAYER_POOL in lv_conf.h or project settings to enable
+ * it. Otherwise the calls below are nothing and nu_layer_pool.c builds
+ * empty.
+ */
+
+typedef enum
+{
+    evNU_LAYER_POOL_SMALL,
+    evNU_LAYER_POOL_MEDIUM,
+    evNU_LAYER_POOL_LARGE,
+    evNU_LAYER_POOL_CNT
+} E_NU_LAYER_POOL_CLASS;
+
+/* Bytes of a slot and slots of each class, 0 slots removes a class. */
+#if !defined(CONFIG_NU_LAYER_POOL_SMALL_SIZE)
+    #define CONFIG_NU_LAYER_POOL_SMALL_SIZE     (16 * 1024)
+#endif
+#if !defined(CONFIG_NU_LAYER_POOL_SMALL_NUM)
+    #define CONFIG_NU_LAYER_POOL_SMALL_NUM      4
+#endif
+
+#if !defined(CONFIG_NU_LAYER_POOL_MEDIUM_SIZE)
+    #define CONFIG_NU_LAYER_POOL_MEDIUM_SIZE    (64 * 1024)
+#endif
+#if !defined(CONFIG_NU_LAYER_POOL_MEDIUM_NUM)
+    #define CONFIG_NU_LAYER_POOL_MEDIUM_NUM     2
+#endif
+
+#if !defined(CONFIG_NU_LAYER_POOL_LARGE_SIZE)
+    #define CONFIG_NU_LAYER_POOL_LARGE_SIZE     (256 * 1024)
+#endif
+#if !defined(CONFIG_NU_LAYER_POOL_LARGE_NUM)
+    #define CONFIG_NU_LAYER_POOL_LARGE_NUM      1
+#endif
+
+/* Dump the stats by a LVGL timer of this period in ms, 0 to dump on demand only. */
+#if !defined(CONFIG_NU_LAYER_POOL_DUMP_PERIOD)
+    #define CONFIG_NU_LAYER_POOL_DUMP_PERIOD    0
+#endif
+
+typedef struct
+{
+    uint32_t u32SlotSize;
+    uint32_t u32SlotNum;
+    uint32_t u32Used;           // Slots in use
+    uint32_t u32Peak;           // High-water mark of u32Used
+    uint32_t u32Hit;            // Allocations served
+} S_NU_LAYER_POOL_STAT;
+
+typedef struct
+{
+    uint32_t u32MissSize;       // Larger than any slot
+    uint32_t u32MissFull;       // All fitting slots in use
+    uint32_t u32MaxMissSize;    // Largest request missed, to size the classes
+} S_NU_LAYER_POOL_MISS;
+
+#if defined(CONFIG_NU_LAYER_POOL)
+
+/* Call it after lv_init() and initialization of draw units, before nu_memtag_lv_init(). */
+void nu_layer_pool_lv_init(void);
+
+void nu_layer_pool_stat(E_NU_LAYER_POOL_CLASS eClass, S_NU_LAYER_POOL_STAT *psStat);
+void nu_layer_pool_miss(S_NU_LAYER_POOL_MISS *psMiss);
+void nu_layer_pool_dump(void);
+
+#else
+
+#define nu_layer_pool_lv_init()
+#define nu_layer_pool_dump()
+
+#endif
+
+#endif /* __NU_LAYER_POOL_H__ */
@@ -0,0 +1,186 @@
+/**************************************************************************//**
+ * @file     nu_memtag.c
+ * @brief    Tagged heap accounting
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ * @copyright (C) 2024 Nuvoton Technology Corp. All rights reserved.
+ *****************************************************************************/
+
+#include "nu_memtag.h"
+
+#if defined(CONFIG_NU_MEMTAG)
+
+#include <stdio.h>
+#include "lvgl.h"
+#include "FreeRTOS.h"
+#include "task.h"
+
+#define NU_MEMTAG_MAGIC     0x4D54  /* "MT" */
+
+typedef struct
+{
+    uint16_t u16Magic;
+    uint16_t u16Tag;
+    uint32_t u32Size;
+} S_NU_MEMTAG_HDR;
+
+static S_NU_MEMTAG_STAT s_asMemTagStat[evNU_MEMTAG_CNT];
+
+static const char *const s_apcMemTagName[evNU_MEMTAG_CNT] =
+{
+    "misc",
+    "drawbuf",
+    "pdma",
+    "fatfs",
+    "usb",
+    "image",
+    "font",
+};
+
+static lv_draw_buf_malloc_cb s_pfnDrawBufMalloc = NULL;
+static lv_draw_buf_free_cb s_pfnDrawBufFree = NULL;
+
+void *nu_memtag_track(void *pvRaw, E_NU_MEMTAG eTag, uint32_t u32Size)
+{
+    S_NU_MEMTAG_HDR *psHdr = (S_NU_MEMTAG_HDR *)pvRaw;
+    S_NU_MEMTAG_STAT *psStat;
+
+    if (psHdr == NULL)
+        return NULL;
+
+    if ((uint32_t)eTag >= evNU_MEMTAG_CNT)
+        eTag = evNU_MEMTAG_MISC;
+
+    psHdr->u16Magic = NU_MEMTAG_MAGIC;
+    psHdr->u16Tag = (uint16_t)eTag;
+    psHdr->u32Size = u32Size;
+
+    psStat = &s_asMemTagStat[eTag];
+
+    taskENTER_CRITICAL();
+    psStat->u32Current += u32Size;
+    psStat->u32Blocks++;
+    if (psStat->u32Current > psStat->u32Peak)
+        psStat->u32Peak = psStat->u32Current;
+    taskEXIT_CRITICAL();
+
+    return (void *)((uintptr_t)pvRaw + NU_MEMTAG_HDR_SIZE);
+}
+
+void *nu_memtag_untrack(void *pvPtr)
+{
+    S_NU_MEMTAG_HDR *psHdr;
+    S_NU_MEMTAG_STAT *psStat;
+
+    if (pvPtr == NULL)
+        return NULL;
+
+    psHdr = (S_NU_MEMTAG_HDR *)((uintptr_t)pvPtr - NU_MEMTAG_HDR_SIZE);
+
+    /* Freed twice, or never tracked. */
+    LV_ASSERT(psHdr->u16Magic == NU_MEMTAG_MAGIC);
+    LV_ASSERT(psHdr->u16Tag < evNU_MEMTAG_CNT);
+
+    psStat = &s_asMemTagStat[psHdr->u16Tag];
+
+    taskENTER_CRITICAL();
+    psStat->u32Current -= psHdr->u32Size;
+    psStat->u32Blocks--;
+    taskEXIT_CRITICAL();
+
+    psHdr->u16Magic = 0;
+
+    return (void *)psHdr;
+}
+
+void nu_memtag_stat(E_NU_MEMTAG eTag, S_NU_MEMTAG_STAT *psStat)
+{
+    LV_ASSERT((uint32_t)eTag < evNU_MEMTAG_CNT);
+
+    taskENTER_CRITICAL();
+    *psStat = s_asMemTagStat[eTag];
+    taskEXIT_CRITICAL();
+}
+
+void nu_memtag_dump(void)
+{
+    S_NU_MEMTAG_STAT sStat;
+    HeapStats_t sHeapStats;
+    int i;
+
+    printf("[memtag] %-8s %10s %10s %8s\n", "tag", "current", "peak", "blocks");
+
+    for (i = 0; i < evNU_MEMTAG_CNT; i++)
+    {
+        nu_memtag_stat((E_NU_MEMTAG)i, &sStat);
+
+        printf("[memtag] %-8s %10u %10u %8u\n",
+               s_apcMemTagName[i],
+               (unsigned int)sStat.u32Current,
+               (unsigned int)sStat.u32Peak,
+               (unsigned int)sStat.u32Blocks);
+    }
+
+    /* Totals and fragmentation of the allocators under the tags. */
+    vPortGetHeapStats(&sHeapStats);
+    printf("[memtag] rtos: free %u, min-ever free %u, biggest free %u, free blocks %u\n",
+           (unsigned int)sHeapStats.xAvailableHeapSpaceInBytes,
+           (unsigned int)sHeapStats.xMinimumEverFreeBytesRemaining,
+           (unsigned int)sHeapStats.xSizeOfLargestFreeBlockInBytes,
+           (unsigned int)sHeapStats.xNumberOfFreeBlocks);
+
+#if (LV_USE_STDLIB_MALLOC != LV_STDLIB_CLIB)
+    {
+        lv_mem_monitor_t sMon;
+
+        lv_mem_monitor(&sMon);
+        printf("[memtag] lvgl: total %u, free %u, max used %u, biggest free %u, frag %u%%\n",
+               (unsigned int)sMon.total_size,
+               (unsigned int)sMon.free_size,
+               (unsigned int)sMon.max_used,
+               (unsigned int)sMon.free_biggest_size,
+               (unsigned int)sMon.frag_pct);
+    }
+#endif
+}
+
+static void *nu_memtag_draw_buf_malloc(size_t size, lv_color_format_t color_format)
+{
+    /* Alignment is applied by align_pointer_cb on the returned pointer, so shifting it is fine. */
+    return nu_memtag_track(s_pfnDrawBufMalloc(size + NU_MEMTAG_HDR_SIZE, color_format), evNU_MEMTAG_DRAWBUF, size);
+}
+
+static void nu_memtag_draw_buf_free(void *buf)
+{
+    s_pfnDrawBufFree(nu_memtag_untrack(buf));
+}
+
+#if (CONFIG_NU_MEMTAG_DUMP_PERIOD > 0)
+static void nu_memtag_dump_timer_cb(lv_timer_t *timer)
+{
+    LV_UNUSED(timer);
+
+    nu_memtag_dump();
+}
+#endif
+
+/* Call it after lv_init() and initialization of draw units. */
+void nu_memtag_lv_init(void)
+{
+    lv_draw_buf_handlers_t *handlers = lv_draw_buf_get_handlers();
+
+    if (s_pfnDrawBufMalloc == NULL)
+    {
+        s_pfnDrawBufMalloc = handlers->buf_malloc_cb;
+        s_pfnDrawBufFree = handlers->buf_free_cb;
+
+        handlers->buf_malloc_cb = nu_memtag_draw_buf_malloc;
+        handlers->buf_free_cb = nu_memtag_draw_buf_free;
+    }
+
+#if (CONFIG_NU_MEMTAG_DUMP_PERIOD > 0)
+    lv_timer_create(nu_memtag_dump_timer_cb, CONFIG_NU_MEMTAG_DUMP_PERIOD, NULL);
+#endif
+}
+
+#endif /* CONFIG_NU_MEMTAG */
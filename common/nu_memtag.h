@@ -0,0 +1,69 @@
+/**************************************************************************//**
+ * @file     nu_memtag.h
+ * @brief    Tagged heap accounting
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ * @copyright (C) 2024 Nuvoton Technology Corp. All rights reserved.
+ *****************************************************************************/
+#ifndef __NU_MEMTAG_H__
+#define __NU_MEMTAG_H__
+
+#include <stdint.h>
+
+/*
+ * Current and peak bytes per call site group, on top of any allocator.
+ * A tracked block carries a header of NU_MEMTAG_HDR_SIZE bytes in front.
+ *
+ * Define CONFIG_NU_MEMTAG in project settings to enable it. Otherwise
+ * the macros below fall back to plain allocator calls and nothing of
+ * nu_memtag.c is built.
+ */
+typedef enum
+{
+    evNU_MEMTAG_MISC,
+    evNU_MEMTAG_DRAWBUF,    // LVGL draw and layer buffers
+    evNU_MEMTAG_PDMA,       // PDMA scatter-gather descriptors
+    evNU_MEMTAG_FATFS,      // FatFs and storage buffers
+    evNU_MEMTAG_USB,        // CherryUSB buffers
+    evNU_MEMTAG_IMAGE,      // Image decoder and asset pack buffers
+    evNU_MEMTAG_FONT,       // Font and glyph buffers
+    evNU_MEMTAG_CNT
+} E_NU_MEMTAG;
+
+typedef struct
+{
+    uint32_t u32Current;    // Bytes in use, header excluded
+    uint32_t u32Peak;       // High-water mark of u32Current
+    uint32_t u32Blocks;     // Blocks in use
+} S_NU_MEMTAG_STAT;
+
+/* Dump all tags by a LVGL timer of this period in ms, 0 to dump on demand only. */
+#if !defined(CONFIG_NU_MEMTAG_DUMP_PERIOD)
+    #define CONFIG_NU_MEMTAG_DUMP_PERIOD    0
+#endif
+
+#define NU_MEMTAG_HDR_SIZE      8
+
+#if defined(CONFIG_NU_MEMTAG)
+
+void *nu_memtag_track(void *pvRaw, E_NU_MEMTAG eTag, uint32_t u32Size);
+void *nu_memtag_untrack(void *pvPtr);
+void nu_memtag_stat(E_NU_MEMTAG eTag, S_NU_MEMTAG_STAT *psStat);
+void nu_memtag_dump(void);
+void nu_memtag_lv_init(void);
+
+/* e.g. NU_MEMTAG_MALLOC(lv_malloc, evNU_MEMTAG_IMAGE, size), NU_MEMTAG_FREE(lv_free, ptr) */
+#define NU_MEMTAG_MALLOC(alloc, tag, size)  nu_memtag_track(alloc((size) + NU_MEMTAG_HDR_SIZE), (tag), (size))
+#define NU_MEMTAG_FREE(release, ptr)        release(nu_memtag_untrack(ptr))
+
+#else
+
+#define NU_MEMTAG_MALLOC(alloc, tag, size)  alloc(size)
+#define NU_MEMTAG_FREE(release, ptr)        release(ptr)
+
+#define nu_memtag_dump()
+#define nu_memtag_lv_init()
+
+#endif
+
+#endif /* __NU_MEMTAG_H__ */
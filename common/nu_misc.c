@@ -1,8 +1,9 @@
 #include <stdint.h>
 #include "nu_misc.h"
 #include "FreeRTOS.h"
+#include "nu_memtag.h"
 
-void *nvt_malloc_align(uint32_t size, uint32_t align)
+void *nvt_malloc_align_tag(uint32_t size, uint32_t align, uint32_t tag)
 {
     void *ptr;
     uint32_t align_size;
@@ -11,7 +12,7 @@ void *nvt_malloc_align(uint32_t size, uint32_t align)
 
     align_size = NVT_ALIGN(size, sizeof(void *)) + align;
 
-    if ((ptr=pvPortMalloc(align_size)) != NULL)
+    if ((ptr = NU_MEMTAG_MALLOC(pvPortMalloc, (E_NU_MEMTAG)tag, align_size)) != NULL)
     {
         void *align_ptr;
 
@@ -33,9 +34,14 @@ void *nvt_malloc_align(uint32_t size, uint32_t align)
     return ptr;
 }
 
+void *nvt_malloc_align(uint32_t size, uint32_t align)
+{
+    return nvt_malloc_align_tag(size, align, evNU_MEMTAG_MISC);
+}
+
 void nvt_free_align(void *ptr)
 {
     if (ptr == NULL) return;
 
-    vPortFree((void *) * ((uintptr_t *)((uintptr_t)ptr - sizeof(void *))));
+    NU_MEMTAG_FREE(vPortFree, (void *) * ((uintptr_t *)((uintptr_t)ptr - sizeof(void *))));
 }
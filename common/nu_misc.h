@@ -11,9 +11,29 @@ typedef enum
     evLCD_CTRL_PAN_DISPLAY,
     evLCD_CTRL_WAIT_VSYNC,
     evLCD_CTRL_RECT_UPDATE,
+    evLCD_CTRL_TILE_UPDATE,
+    evLCD_CTRL_TILE_WAIT,
     evLCD_CTRL_CNT
 } E_LCD_CTRL;
 
+typedef enum
+{
+    evTOUCH_CTRL_GET_POINTS,        // S_TOUCH_POINTS of the last read, the gesture is consumed
+    evTOUCH_CTRL_CNT
+} E_TOUCH_CTRL;
+
+typedef enum
+{
+    evTOUCH_GESTURE_NONE,
+    evTOUCH_GESTURE_MOVE_UP,
+    evTOUCH_GESTURE_MOVE_DOWN,
+    evTOUCH_GESTURE_MOVE_LEFT,
+    evTOUCH_GESTURE_MOVE_RIGHT,
+    evTOUCH_GESTURE_ZOOM_IN,
+    evTOUCH_GESTURE_ZOOM_OUT,
+    evTOUCH_GESTURE_CNT
+} E_TOUCH_GESTURE;
+
 typedef enum
 {
     evLCD_TYPE_SYNC,
@@ -52,11 +72,53 @@ typedef struct
     E_LCD_TYPE evLCDType;
 } S_LCD_INFO;
 
+/* Argument of evLCD_CTRL_TILE_UPDATE. */
+typedef struct
+{
+    const void *pvArea;     // lv_area_t of the tile on screen
+    void *pvPixels;         // Rendered pixels, packed in width of the area
+} S_LCD_TILE;
+
+#define TOUCH_POINT_MAX     5
+
+typedef struct
+{
+    int16_t i16Id;          // Contact ID by controller, kept while the finger is down
+    int16_t i16X;
+    int16_t i16Y;
+    int16_t i16W;           // Weight or area, 0 if not reported
+} S_TOUCH_POINT;
+
+/* Argument of evTOUCH_CTRL_GET_POINTS, contacts still down. */
+typedef struct
+{
+    uint32_t u32Count;
+    S_TOUCH_POINT asPoint[TOUCH_POINT_MAX];
+    E_TOUCH_GESTURE eGesture;   // Hardware gesture since last get, evTOUCH_GESTURE_NONE if none
+} S_TOUCH_POINTS;
+
 #define NVT_ALIGN(size, align)        (((size) + (align) - 1) & ~((align) - 1))
 #define NVT_ALIGN_DOWN(size, align)   ((size) & ~((align) - 1))
 #define CONFIG_TICK_PER_SECOND        1000
 
+/* Wakeup events of LVGL handler task, see components/task_lv.c. */
+#define NU_LV_WAKEUP_INPUT            (1 << 0)    // Input device has data, read it now.
+#define NU_LV_WAKEUP_REFRESH          (1 << 1)    // Invalidation from another task, run timers now.
+#define NU_LV_WAKEUP_ASSET            (1 << 2)    // Asset loader finished a request, see nu_asset_loader.h.
+
 void *nvt_malloc_align(uint32_t size, uint32_t align);
+void *nvt_malloc_align_tag(uint32_t size, uint32_t align, uint32_t tag);    // tag: E_NU_MEMTAG
 void nvt_free_align(void *ptr);
 
+/* Notification index of the wakeup events, index 0 is used by LVGL with LV_USE_FREERTOS_TASK_NOTIFY. */
+#define NU_LV_WAKEUP_NOTIFY_INDEX     1
+
+void nu_lv_task_wakeup(uint32_t u32Events);
+void nu_lv_task_wakeup_from_isr(uint32_t u32Events);
+
+/* Multi-touch of capacitive panels, see common/lv_port_indev.c. */
+int lv_port_indev_get_points(S_TOUCH_POINTS *psPoints);
+uint32_t lv_port_indev_get_zoom_event(void);
+void lv_port_indev_set_lookahead(uint32_t u32Ms);
+
 #endif //__NU_MISC_H__
@@ -0,0 +1,105 @@
+/**************************************************************************//**
+ * @file     nu_predict.c
+ * @brief    Pointer motion prediction by alpha-beta filter
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ * @copyright (C) 2024 Nuvoton Technology Corp. All rights reserved.
+ *****************************************************************************/
+
+#include "nu_predict.h"
+
+#define NU_PREDICT_Q        8
+
+void nu_predict_reset(S_NU_PREDICT *psPredict)
+{
+    psPredict->i32X = 0;
+    psPredict->i32Y = 0;
+    psPredict->i32Vx = 0;
+    psPredict->i32Vy = 0;
+    psPredict->u32LastMs = 0;
+    psPredict->u32Samples = 0;
+}
+
+void nu_predict_init(S_NU_PREDICT *psPredict, uint32_t u32LookaheadMs)
+{
+    nu_predict_reset(psPredict);
+    psPredict->u32LookaheadMs = u32LookaheadMs;
+}
+
+/* One axis of the filter. Returns false on a turn, the velocity is dropped then. */
+static bool nu_predict_axis(int32_t *pi32Pos, int32_t *pi32Vel, int32_t i32Meas, int32_t i32Dt)
+{
+    int32_t i32Move = i32Meas - *pi32Pos;
+    int32_t i32Pred, i32Res;
+
+    if (((i32Move ^ *pi32Vel) < 0) && (*pi32Vel != 0) &&
+            ((i32Move > (CONFIG_NU_PREDICT_TURN << NU_PREDICT_Q)) || (i32Move < -(CONFIG_NU_PREDICT_TURN << NU_PREDICT_Q))))
+    {
+        *pi32Pos = i32Meas;
+        *pi32Vel = 0;
+        return false;
+    }
+
+    i32Pred = *pi32Pos + (*pi32Vel * i32Dt);
+    i32Res = i32Meas - i32Pred;
+
+    *pi32Pos = i32Pred + ((CONFIG_NU_PREDICT_ALPHA * i32Res) / 256);
+    *pi32Vel = *pi32Vel + ((CONFIG_NU_PREDICT_BETA * i32Res) / 256) / i32Dt;
+
+    return true;
+}
+
+static int32_t nu_predict_extrapolate(int32_t i32Pos, int32_t i32Vel, uint32_t u32LookaheadMs)
+{
+    int32_t i32Shift = i32Vel * (int32_t)u32LookaheadMs;
+
+    if (i32Shift > (CONFIG_NU_PREDICT_MAX_SHIFT << NU_PREDICT_Q))
+        i32Shift = CONFIG_NU_PREDICT_MAX_SHIFT << NU_PREDICT_Q;
+    else if (i32Shift < -(CONFIG_NU_PREDICT_MAX_SHIFT << NU_PREDICT_Q))
+        i32Shift = -(CONFIG_NU_PREDICT_MAX_SHIFT << NU_PREDICT_Q);
+
+    /* Round to pixel. */
+    return (i32Pos + i32Shift + (1 << (NU_PREDICT_Q - 1))) >> NU_PREDICT_Q;
+}
+
+bool nu_predict_update(S_NU_PREDICT *psPredict, uint32_t u32Ms, int32_t *pi32X, int32_t *pi32Y)
+{
+    int32_t i32MeasX = *pi32X << NU_PREDICT_Q;
+    int32_t i32MeasY = *pi32Y << NU_PREDICT_Q;
+    int32_t i32Dt = (int32_t)(u32Ms - psPredict->u32LastMs);
+    bool bTrackX, bTrackY;
+
+    if (psPredict->u32Samples == 0)
+    {
+        psPredict->i32X = i32MeasX;
+        psPredict->i32Y = i32MeasY;
+        psPredict->i32Vx = 0;
+        psPredict->i32Vy = 0;
+        psPredict->u32LastMs = u32Ms;
+        psPredict->u32Samples = 1;
+        return false;
+    }
+
+    /* On the same timestamp, keep the filter and predict from it. */
+    if (i32Dt > 0)
+    {
+        bTrackX = nu_predict_axis(&psPredict->i32X, &psPredict->i32Vx, i32MeasX, i32Dt);
+        bTrackY = nu_predict_axis(&psPredict->i32Y, &psPredict->i32Vy, i32MeasY, i32Dt);
+
+        psPredict->u32LastMs = u32Ms;
+        psPredict->u32Samples++;
+
+        /* A turn: report as measured until velocity is built again. */
+        if (!bTrackX || !bTrackY)
+            return false;
+    }
+
+    /* Velocity needs two intervals at least. */
+    if ((psPredict->u32Samples < 3) || (psPredict->u32LookaheadMs == 0))
+        return false;
+
+    *pi32X = nu_predict_extrapolate(psPredict->i32X, psPredict->i32Vx, psPredict->u32LookaheadMs);
+    *pi32Y = nu_predict_extrapolate(psPredict->i32Y, psPredict->i32Vy, psPredict->u32LookaheadMs);
+
+    return true;
+}
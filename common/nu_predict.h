@@ -0,0 +1,64 @@
+/**************************************************************************//**
+ * @file     nu_predict.h
+ * @brief    Pointer motion prediction by alpha-beta filter
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ * @copyright (C) 2024 Nuvoton Technology Corp. All rights reserved.
+ *****************************************************************************/
+#ifndef __NU_PREDICT_H__
+#define __NU_PREDICT_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/*
+ * Position and velocity per axis are tracked by an alpha-beta filter from
+ * timestamped samples, and the position is extrapolated by the lookahead,
+ * the time from reading the pointer to pixels on the panel. Integer math
+ * only, in 1/256 pixel, so it is cheap on cores without FPU.
+ *
+ * Prediction is suppressed when an axis turns against its velocity, and
+ * the caller resets it on release. It has no LVGL dependency, so
+ * tools/nu_predict_replay.c replays recorded traces through it on host.
+ */
+
+/* Gains in 1/256. */
+#if !defined(CONFIG_NU_PREDICT_ALPHA)
+    #define CONFIG_NU_PREDICT_ALPHA         160
+#endif
+
+#if !defined(CONFIG_NU_PREDICT_BETA)
+    #define CONFIG_NU_PREDICT_BETA          80
+#endif
+
+/* Extrapolation is clipped to this distance in pixels. */
+#if !defined(CONFIG_NU_PREDICT_MAX_SHIFT)
+    #define CONFIG_NU_PREDICT_MAX_SHIFT     48
+#endif
+
+/* A move against the velocity longer than this in pixels is a turn. */
+#if !defined(CONFIG_NU_PREDICT_TURN)
+    #define CONFIG_NU_PREDICT_TURN          2
+#endif
+
+typedef struct
+{
+    int32_t i32X;               // Filtered position, 1/256 pixel
+    int32_t i32Y;
+    int32_t i32Vx;              // Velocity, 1/256 pixel per ms
+    int32_t i32Vy;
+    uint32_t u32LastMs;
+    uint32_t u32Samples;
+    uint32_t u32LookaheadMs;
+} S_NU_PREDICT;
+
+void nu_predict_init(S_NU_PREDICT *psPredict, uint32_t u32LookaheadMs);
+void nu_predict_reset(S_NU_PREDICT *psPredict);
+
+/*
+ * Feed a sample of a pressed pointer at u32Ms. The point is replaced by the
+ * predicted one. Returns true if it is extrapolated, false if passed as is.
+ */
+bool nu_predict_update(S_NU_PREDICT *psPredict, uint32_t u32Ms, int32_t *pi32X, int32_t *pi32Y);
+
+#endif /* __NU_PREDICT_H__ */
@@ -0,0 +1,69 @@
+/**************************************************************************//**
+ * @file     nu_section.h
+ * @brief    Placement of hot code and data by linker sections
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ * @copyright (C) 2024 Nuvoton Technology Corp. All rights reserved.
+ *****************************************************************************/
+#ifndef __NU_SECTION_H__
+#define __NU_SECTION_H__
+
+/*
+ * Put the macro in front of a definition:
+ *
+ *   NU_FAST_CODE   .nu_fast_code       Runs from ITCM, or SRAM without ITCM
+ *   NU_FAST_DATA   .nu_fast_data       Initialized data in DTCM, or SRAM
+ *   NU_DMA_DATA    .bss.nu_dma_data    Zero-initialized buffer reachable by
+ *                                      DMA, aligned to a cache line
+ *
+ *   NU_FAST_CODE static int nu_pdma_memfun(...)
+ *   NU_DMA_DATA static uint8_t s_au8TileBuf[...];
+ *
+ * The GCC and IAR linker files of the Cortex-M boards and the M55M1 scatter
+ * file locate both fast sections in RAM with a load image in flash, and the
+ * startup code copies them along with .data. The Keil projects without a
+ * scatter file keep them in flash. ARM9 and Cortex-A35 run from DDR through
+ * the caches, so only the alignment of NU_DMA_DATA is applied there.
+ *
+ * Fast code calls flash through linker veneers; keep it to inner loops.
+ * Define CONFIG_NU_FAST_SECTION as 0 to link everything as usual.
+ */
+
+#if !defined(CONFIG_NU_FAST_SECTION)
+    #if (defined(__ARM_ARCH_PROFILE) && (__ARM_ARCH_PROFILE == 'M')) || defined(__ARM_PROFILE_M__)
+        #define CONFIG_NU_FAST_SECTION      1
+    #else
+        #define CONFIG_NU_FAST_SECTION      0
+    #endif
+#endif
+
+/* Cache line of the largest data cache on the boards. */
+#if !defined(CONFIG_NU_DMA_ALIGN)
+    #if defined(__aarch64__)
+        #define CONFIG_NU_DMA_ALIGN         64
+    #else
+        #define CONFIG_NU_DMA_ALIGN         32
+    #endif
+#endif
+
+#if CONFIG_NU_FAST_SECTION
+    #if defined(__ICCARM__)
+        #define NU_FAST_CODE    _Pragma("location=\".nu_fast_code\"")
+        #define NU_FAST_DATA    _Pragma("location=\".nu_fast_data\"")
+        #define NU_DMA_DATA     _Pragma("location=\".bss.nu_dma_data\"") _Pragma("data_alignment=32")
+    #else
+        #define NU_FAST_CODE    __attribute__((section(".nu_fast_code"), noinline))
+        #define NU_FAST_DATA    __attribute__((section(".nu_fast_data")))
+        #define NU_DMA_DATA     __attribute__((section(".bss.nu_dma_data"), aligned(CONFIG_NU_DMA_ALIGN)))
+    #endif
+#else
+    #define NU_FAST_CODE
+    #define NU_FAST_DATA
+    #if defined(__ICCARM__)
+        #define NU_DMA_DATA     _Pragma("data_alignment=32")
+    #else
+        #define NU_DMA_DATA     __attribute__((aligned(CONFIG_NU_DMA_ALIGN)))
+    #endif
+#endif
+
+#endif /* __NU_SECTION_H__ */
@@ -0,0 +1,365 @@
+/**************************************************************************//**
+ * @file     nu_sysstat.c
+ * @brief    Per-task CPU load and ISR time accounting
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ * @copyright (C) 2024 Nuvoton Technology Corp. All rights reserved.
+ *****************************************************************************/
+
+#include "nu_sysstat.h"
+
+#if defined(CONFIG_NU_SYSSTAT)
+
+#include <stdio.h>
+#include <string.h>
+#include "lv_glue.h"
+#include "FreeRTOS.h"
+#include "task.h"
+
+#if (configGENERATE_RUN_TIME_STATS != 1) || (configUSE_TRACE_FACILITY != 1)
+    #error "CONFIG_NU_SYSSTAT needs configGENERATE_RUN_TIME_STATS and configUSE_TRACE_FACILITY in FreeRTOSConfig.h"
+#endif
+
+#if defined(__CORTEX_M) && ((__CORTEX_M == 3U) || (__CORTEX_M == 4U) || (__CORTEX_M == 7U) || (__CORTEX_M == 33U) || (__CORTEX_M == 55U))
+    #define NU_SYSSTAT_USE_CYCCNT
+#elif defined(__CORTEX_M)
+    #define NU_SYSSTAT_USE_SYSTICK
+#elif defined(__aarch64__)
+    #define NU_SYSSTAT_USE_CNTPCT
+#endif
+
+typedef struct
+{
+    uint32_t u32Start;
+    uint32_t u32Nested;         // Counts of ISRs nested in this one
+} S_SYSSTAT_FRAME;
+
+typedef struct
+{
+    uint32_t u32Count;
+    uint32_t u32Sum;
+    uint32_t u32Max;
+} S_SYSSTAT_ISR_ACC;
+
+typedef struct
+{
+    UBaseType_t uxTaskNumber;
+    uint32_t u32Counter;
+} S_SYSSTAT_TASK_PREV;
+
+typedef struct
+{
+    char acName[configMAX_TASK_NAME_LEN];
+    uint32_t u32Permille;
+} S_SYSSTAT_TASK_LOAD;
+
+/* Written by ISRs, taken by the LVGL task in a critical section. */
+static S_SYSSTAT_FRAME s_asFrame[CONFIG_NU_SYSSTAT_ISR_NEST];
+static volatile uint32_t s_u32Depth = 0;
+static S_SYSSTAT_ISR_ACC s_asIsrAcc[evNU_SYSSTAT_ISR_CNT];
+
+/* Result of the last period. */
+static S_NU_SYSSTAT_ISR s_asIsr[evNU_SYSSTAT_ISR_CNT];
+static S_SYSSTAT_TASK_LOAD s_asLoad[CONFIG_NU_SYSSTAT_TASK_MAX];
+static uint32_t s_u32Loads = 0;
+static uint32_t s_u32BusyPermille = 0;
+static uint32_t s_u32IsrPermille = 0;
+static uint32_t s_u32PeriodMs = 0;
+
+static TaskStatus_t s_asStatus[CONFIG_NU_SYSSTAT_TASK_MAX];
+static S_SYSSTAT_TASK_PREV s_asPrev[CONFIG_NU_SYSSTAT_TASK_MAX];
+static uint32_t s_u32Prevs = 0;
+static uint32_t s_u32LastSample = 0;
+
+#if CONFIG_NU_SYSSTAT_OVERLAY
+static lv_obj_t *s_psOverlay = NULL;
+#endif
+
+static const char *s_apcIsrName[evNU_SYSSTAT_ISR_CNT] =
+{
+    "pdma", "spi", "i2c", "touch", "draw"
+};
+
+void nu_sysstat_timer_init(void)
+{
+#if defined(NU_SYSSTAT_USE_CYCCNT)
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+    DWT->CYCCNT = 0;
+    DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+#endif
+}
+
+uint32_t nu_sysstat_timer_get(void)
+{
+#if defined(NU_SYSSTAT_USE_CYCCNT)
+    return DWT->CYCCNT;
+#elif defined(NU_SYSSTAT_USE_SYSTICK)
+    uint32_t u32Load = SysTick->LOAD + 1;
+    uint32_t u32Base, u32Ticks, u32Val;
+
+    /* Called in the context switch too, where a pending tick is not counted yet. */
+    do
+    {
+        u32Base = (uint32_t)xTaskGetTickCountFromISR();
+        u32Ticks = u32Base;
+        u32Val = SysTick->VAL;
+        if (SCB->ICSR & SCB_ICSR_PENDSTSET_Msk)
+        {
+            /* Reloaded already, read again past the reload. */
+            u32Ticks++;
+            u32Val = SysTick->VAL;
+        }
+    }
+    while (u32Base != (uint32_t)xTaskGetTickCountFromISR());
+
+    return (u32Ticks * u32Load) + (u32Load - 1 - u32Val);
+#elif defined(NU_SYSSTAT_USE_CNTPCT)
+    uint64_t u64Count;
+
+    __asm volatile("mrs %0, cntpct_el0" : "=r"(u64Count));
+
+    return (uint32_t)u64Count;
+#else
+    return (uint32_t)xTaskGetTickCountFromISR();
+#endif
+}
+
+/* Counts of nu_sysstat_timer_get() in 1 ms. */
+static uint32_t nu_sysstat_counts_per_ms(void)
+{
+#if defined(NU_SYSSTAT_USE_CYCCNT)
+    return SystemCoreClock / 1000UL;
+#elif defined(NU_SYSSTAT_USE_SYSTICK)
+    return (SysTick->LOAD + 1) * configTICK_RATE_HZ / 1000UL;
+#elif defined(NU_SYSSTAT_USE_CNTPCT)
+    uint64_t u64Freq;
+
+    __asm volatile("mrs %0, cntfrq_el0" : "=r"(u64Freq));
+
+    return (uint32_t)(u64Freq / 1000UL);
+#else
+    return 1;
+#endif
+}
+
+static uint32_t nu_sysstat_permille(uint32_t u32Part, uint32_t u32Whole)
+{
+    uint64_t u64Permille;
+
+    if (u32Whole == 0)
+        return 0;
+
+    u64Permille = ((uint64_t)u32Part * 1000UL) / u32Whole;
+
+    return (u64Permille > 1000) ? 1000 : (uint32_t)u64Permille;
+}
+
+void nu_sysstat_isr_enter(void)
+{
+    uint32_t u32Depth = s_u32Depth;
+
+    if (u32Depth < CONFIG_NU_SYSSTAT_ISR_NEST)
+    {
+        s_asFrame[u32Depth].u32Nested = 0;
+        s_asFrame[u32Depth].u32Start = nu_sysstat_timer_get();
+    }
+
+    /* A preempting ISR runs its own pair to the end before this one goes on. */
+    s_u32Depth = u32Depth + 1;
+}
+
+void nu_sysstat_isr_exit(E_NU_SYSSTAT_ISR eIsr)
+{
+    uint32_t u32Depth = s_u32Depth - 1;
+    uint32_t u32Elapsed, u32Self;
+
+    s_u32Depth = u32Depth;
+
+    if ((u32Depth >= CONFIG_NU_SYSSTAT_ISR_NEST) || (eIsr >= evNU_SYSSTAT_ISR_CNT))
+        return;
+
+    u32Elapsed = nu_sysstat_timer_get() - s_asFrame[u32Depth].u32Start;
+    u32Self = u32Elapsed - s_asFrame[u32Depth].u32Nested;
+
+    if (u32Depth > 0)
+        s_asFrame[u32Depth - 1].u32Nested += u32Elapsed;
+
+    s_asIsrAcc[eIsr].u32Count++;
+    s_asIsrAcc[eIsr].u32Sum += u32Self;
+    if (u32Self > s_asIsrAcc[eIsr].u32Max)
+        s_asIsrAcc[eIsr].u32Max = u32Self;
+}
+
+void nu_sysstat_isr_stat(E_NU_SYSSTAT_ISR eIsr, S_NU_SYSSTAT_ISR *psStat)
+{
+    LV_ASSERT((eIsr < evNU_SYSSTAT_ISR_CNT) && (psStat != NULL));
+
+    *psStat = s_asIsr[eIsr];
+}
+
+static uint32_t nu_sysstat_task_prev(UBaseType_t uxTaskNumber)
+{
+    uint32_t i;
+
+    for (i = 0; i < s_u32Prevs; i++)
+    {
+        if (s_asPrev[i].uxTaskNumber == uxTaskNumber)
+            return s_asPrev[i].u32Counter;
+    }
+
+    /* Created in this period. */
+    return 0;
+}
+
+static void nu_sysstat_sample(void)
+{
+    S_SYSSTAT_ISR_ACC asIsrAcc[evNU_SYSSTAT_ISR_CNT];
+    uint32_t u32Now, u32Elapsed, u32CountsPerMs, u32IsrSum = 0;
+    UBaseType_t uxTasks;
+    uint32_t i, j;
+
+    /* Take the counters of the period and restart them. */
+    taskENTER_CRITICAL();
+    u32Now = nu_sysstat_timer_get();
+    memcpy(asIsrAcc, s_asIsrAcc, sizeof(asIsrAcc));
+    memset(s_asIsrAcc, 0, sizeof(s_asIsrAcc));
+    taskEXIT_CRITICAL();
+
+    uxTasks = uxTaskGetSystemState(s_asStatus, CONFIG_NU_SYSSTAT_TASK_MAX, NULL);
+
+    u32Elapsed = u32Now - s_u32LastSample;
+    s_u32LastSample = u32Now;
+    u32CountsPerMs = nu_sysstat_counts_per_ms();
+    s_u32PeriodMs = u32Elapsed / u32CountsPerMs;
+
+    for (i = 0; i < evNU_SYSSTAT_ISR_CNT; i++)
+    {
+        s_asIsr[i].u32Count = asIsrAcc[i].u32Count;
+        s_asIsr[i].u32Permille = nu_sysstat_permille(asIsrAcc[i].u32Sum, u32Elapsed);
+        s_asIsr[i].u32MaxUs = (uint32_t)(((uint64_t)asIsrAcc[i].u32Max * 1000UL) / u32CountsPerMs);
+        u32IsrSum += asIsrAcc[i].u32Sum;
+    }
+    s_u32IsrPermille = nu_sysstat_permille(u32IsrSum, u32Elapsed);
+
+    /* More tasks than CONFIG_NU_SYSSTAT_TASK_MAX. */
+    if (uxTasks == 0)
+    {
+        s_u32Loads = 0;
+        s_u32Prevs = 0;
+        return;
+    }
+
+    s_u32BusyPermille = 1000;
+
+    for (i = 0; i < uxTasks; i++)
+    {
+        uint32_t u32Delta = s_asStatus[i].ulRunTimeCounter - nu_sysstat_task_prev(s_asStatus[i].xTaskNumber);
+        uint32_t u32Permille = nu_sysstat_permille(u32Delta, u32Elapsed);
+
+        if (strcmp(s_asStatus[i].pcTaskName, configIDLE_TASK_NAME) == 0)
+            s_u32BusyPermille = 1000 - u32Permille;
+
+        /* Insert by load, the busiest first. */
+        for (j = i; (j > 0) && (s_asLoad[j - 1].u32Permille < u32Permille); j--)
+            s_asLoad[j] = s_asLoad[j - 1];
+
+        strncpy(s_asLoad[j].acName, s_asStatus[i].pcTaskName, sizeof(s_asLoad[j].acName) - 1);
+        s_asLoad[j].acName[sizeof(s_asLoad[j].acName) - 1] = '\0';
+        s_asLoad[j].u32Permille = u32Permille;
+    }
+    s_u32Loads = uxTasks;
+
+    for (i = 0; i < uxTasks; i++)
+    {
+        s_asPrev[i].uxTaskNumber = s_asStatus[i].xTaskNumber;
+        s_asPrev[i].u32Counter = s_asStatus[i].ulRunTimeCounter;
+    }
+    s_u32Prevs = uxTasks;
+}
+
+void nu_sysstat_dump(void)
+{
+    uint32_t i;
+
+    printf("[sysstat] period %u ms, busy %u.%u%%, isr %u.%u%%\n", s_u32PeriodMs,
+           s_u32BusyPermille / 10, s_u32BusyPermille % 10, s_u32IsrPermille / 10, s_u32IsrPermille % 10);
+
+    if (s_u32Loads == 0)
+        printf("[sysstat] more tasks than CONFIG_NU_SYSSTAT_TASK_MAX %u\n", CONFIG_NU_SYSSTAT_TASK_MAX);
+
+    for (i = 0; i < s_u32Loads; i++)
+        printf("[sysstat] task %s %u.%u%%\n", s_asLoad[i].acName, s_asLoad[i].u32Permille / 10, s_asLoad[i].u32Permille % 10);
+
+    for (i = 0; i < evNU_SYSSTAT_ISR_CNT; i++)
+    {
+        if (s_asIsr[i].u32Count == 0)
+            continue;
+
+        printf("[sysstat] isr %s %u.%u%%, count %u, max %u us\n", s_apcIsrName[i],
+               s_asIsr[i].u32Permille / 10, s_asIsr[i].u32Permille % 10, s_asIsr[i].u32Count, s_asIsr[i].u32MaxUs);
+    }
+}
+
+#if CONFIG_NU_SYSSTAT_OVERLAY
+static void nu_sysstat_overlay_update(void)
+{
+    static char s_acText[(CONFIG_NU_SYSSTAT_OVERLAY_TASKS + evNU_SYSSTAT_ISR_CNT + 1) * 40];
+    uint32_t u32Len, i;
+
+    u32Len = lv_snprintf(s_acText, sizeof(s_acText), "busy %u.%u%%, isr %u.%u%%",
+                         s_u32BusyPermille / 10, s_u32BusyPermille % 10, s_u32IsrPermille / 10, s_u32IsrPermille % 10);
+
+    for (i = 0; (i < s_u32Loads) && (i < CONFIG_NU_SYSSTAT_OVERLAY_TASKS) && (u32Len < sizeof(s_acText)); i++)
+    {
+        u32Len += lv_snprintf(&s_acText[u32Len], sizeof(s_acText) - u32Len, "\n%s %u.%u%%",
+                              s_asLoad[i].acName, s_asLoad[i].u32Permille / 10, s_asLoad[i].u32Permille % 10);
+    }
+
+    for (i = 0; (i < evNU_SYSSTAT_ISR_CNT) && (u32Len < sizeof(s_acText)); i++)
+    {
+        if (s_asIsr[i].u32Count == 0)
+            continue;
+
+        u32Len += lv_snprintf(&s_acText[u32Len], sizeof(s_acText) - u32Len, "\n%s %u.%u%% max %uus", s_apcIsrName[i],
+                              s_asIsr[i].u32Permille / 10, s_asIsr[i].u32Permille % 10, s_asIsr[i].u32MaxUs);
+    }
+
+    lv_label_set_text_static(s_psOverlay, s_acText);
+}
+#endif
+
+static void nu_sysstat_timer_cb(lv_timer_t *timer)
+{
+    LV_UNUSED(timer);
+
+    nu_sysstat_sample();
+
+#if CONFIG_NU_SYSSTAT_OVERLAY
+    nu_sysstat_overlay_update();
+#endif
+
+#if CONFIG_NU_SYSSTAT_DUMP
+    nu_sysstat_dump();
+#endif
+}
+
+void nu_sysstat_lv_init(void)
+{
+#if CONFIG_NU_SYSSTAT_OVERLAY
+    /* The same look as the LVGL sysmon, on the other corner. */
+    s_psOverlay = lv_label_create(lv_layer_sys());
+    lv_obj_set_style_bg_opa(s_psOverlay, LV_OPA_50, 0);
+    lv_obj_set_style_bg_color(s_psOverlay, lv_color_black(), 0);
+    lv_obj_set_style_text_color(s_psOverlay, lv_color_white(), 0);
+    lv_obj_set_style_pad_all(s_psOverlay, 3, 0);
+    lv_obj_align(s_psOverlay, LV_ALIGN_BOTTOM_LEFT, 0, 0);
+    lv_label_set_text_static(s_psOverlay, "sysstat");
+#endif
+
+    /* Take the counters of tasks so far, the first period starts here. */
+    nu_sysstat_sample();
+
+    lv_timer_create(nu_sysstat_timer_cb, CONFIG_NU_SYSSTAT_PERIOD_MS, NULL);
+}
+
+#endif /* CONFIG_NU_SYSSTAT */
@@ -0,0 +1,105 @@
+/**************************************************************************//**
+ * @file     nu_sysstat.h
+ * @brief    Per-task CPU load and ISR time accounting
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ * @copyright (C) 2024 Nuvoton Technology Corp. All rights reserved.
+ *****************************************************************************/
+#ifndef __NU_SYSSTAT_H__
+#define __NU_SYSSTAT_H__
+
+#include <stdint.h>
+
+/*
+ * FreeRTOS run time stats are counted on a free-running 32-bit counter:
+ *
+ *   Cortex-M3/M4/M7/M33/M55    DWT cycle counter
+ *   Cortex-M0/M23              SysTick, interpolated between ticks
+ *   Cortex-A35                 Generic timer
+ *   ARM9                       RTOS tick, 1 ms resolution only
+ *
+ * Driver ISRs are wrapped by nu_sysstat_isr_enter()/nu_sysstat_isr_exit().
+ * The time of an ISR excludes ISRs nested in it, so PDMA time does not hold
+ * the SPI callbacks called from the PDMA ISR. FreeRTOS charges ISR time to
+ * the task it interrupted, so the task loads include it as well.
+ *
+ * Every CONFIG_NU_SYSSTAT_PERIOD_MS the load of the last period is taken by
+ * a LVGL timer. It is shown in an overlay on the system layer, next to the
+ * LVGL sysmon, and printed as "[sysstat] ..." lines by nu_sysstat_dump().
+ * The counter wraps in 2^32 counts, 20 s on a 200 MHz core, so the period
+ * must be shorter.
+ *
+ * Define CONFIG_NU_SYSSTAT in project settings to enable it. FreeRTOSConfig.h
+ * turns configGENERATE_RUN_TIME_STATS on by it. Otherwise the hooks below
+ * are nothing and nu_sysstat.c builds empty.
+ */
+
+typedef enum
+{
+    evNU_SYSSTAT_ISR_PDMA,      // PDMA channels, callbacks of other drivers excluded
+    evNU_SYSSTAT_ISR_SPI,       // SPI transfer callbacks
+    evNU_SYSSTAT_ISR_I2C,       // Touch controller I2C
+    evNU_SYSSTAT_ISR_TOUCH,     // Touch GPIO and ADC
+    evNU_SYSSTAT_ISR_DRAW,      // Draw unit engines
+    evNU_SYSSTAT_ISR_CNT
+} E_NU_SYSSTAT_ISR;
+
+#if !defined(CONFIG_NU_SYSSTAT_PERIOD_MS)
+    #define CONFIG_NU_SYSSTAT_PERIOD_MS     1000
+#endif
+
+/* Tasks at most, no task load is taken with more. */
+#if !defined(CONFIG_NU_SYSSTAT_TASK_MAX)
+    #define CONFIG_NU_SYSSTAT_TASK_MAX      16
+#endif
+
+/* Busiest tasks listed in the overlay. */
+#if !defined(CONFIG_NU_SYSSTAT_OVERLAY_TASKS)
+    #define CONFIG_NU_SYSSTAT_OVERLAY_TASKS 5
+#endif
+
+#if !defined(CONFIG_NU_SYSSTAT_OVERLAY)
+    #define CONFIG_NU_SYSSTAT_OVERLAY       1
+#endif
+
+/* Dump each period to the console as well. */
+#if !defined(CONFIG_NU_SYSSTAT_DUMP)
+    #define CONFIG_NU_SYSSTAT_DUMP          0
+#endif
+
+/* Deepest nesting of wrapped ISRs and callbacks. */
+#if !defined(CONFIG_NU_SYSSTAT_ISR_NEST)
+    #define CONFIG_NU_SYSSTAT_ISR_NEST      8
+#endif
+
+typedef struct
+{
+    uint32_t u32Count;          // Entries in the last period
+    uint32_t u32Permille;       // Share of the period
+    uint32_t u32MaxUs;          // Longest entry in the last period
+} S_NU_SYSSTAT_ISR;
+
+#if defined(CONFIG_NU_SYSSTAT)
+
+/* Run time counter of FreeRTOS. */
+void nu_sysstat_timer_init(void);
+uint32_t nu_sysstat_timer_get(void);
+
+/* Call around an ISR body, the time is charged to eIsr at exit. Pairs may nest. */
+void nu_sysstat_isr_enter(void);
+void nu_sysstat_isr_exit(E_NU_SYSSTAT_ISR eIsr);
+
+void nu_sysstat_lv_init(void);
+void nu_sysstat_isr_stat(E_NU_SYSSTAT_ISR eIsr, S_NU_SYSSTAT_ISR *psStat);
+void nu_sysstat_dump(void);
+
+#else
+
+#define nu_sysstat_isr_enter()
+#define nu_sysstat_isr_exit(isr)
+#define nu_sysstat_lv_init()
+#define nu_sysstat_dump()
+
+#endif
+
+#endif /* __NU_SYSSTAT_H__ */
@@ -94,12 +94,12 @@ void vApplicationIRQHandler(uint32_t ulICCIAR)
     value with 0x3FF. */
 
     IRQHandler_t handler;
-    IRQn_ID_t num = (int32_t)ulICCIAR;
+    IRQn_ID_t num = (int32_t)(ulICCIAR & 0x3FFUL);    /* SGIs carry the source CPU in bits 12:10. */
 
     /* Call the function installed in the array of installed handler
     functions. */
     handler = IRQ_GetHandler(num);
     if (handler != 0)
         (*handler)();
-    IRQ_EndOfInterrupt(num);
+    IRQ_EndOfInterrupt((IRQn_ID_t)ulICCIAR);
 }
@@ -0,0 +1,188 @@
+/*
+ * SPDX-License-Identifier: Apache-2.0
+ * Copyright (C) 2024 Nuvoton Technology Corp. All rights reserved.
+ *
+ * Stand-in of lvgl.h for the host tools, with the font, file system and
+ * memory calls the common modules use. Names and fields follow LVGL v9.1,
+ * files are read by stdio.
+ */
+#ifndef LVGL_H
+#define LVGL_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+
+#define LV_UNUSED(x)            ((void)(x))
+#define LV_ASSERT(expr)         assert(expr)
+#define LV_ASSERT_NULL(p)       assert((p) != NULL)
+
+#define LV_LOG_WARN(...)        (fprintf(stderr, "[Warn] " __VA_ARGS__), fprintf(stderr, "\n"))
+#define LV_LOG_ERROR(...)       (fprintf(stderr, "[Error] " __VA_ARGS__), fprintf(stderr, "\n"))
+
+#define lv_malloc(size)         malloc(size)
+#define lv_free(ptr)            free(ptr)
+#define lv_memzero(ptr, size)   memset((ptr), 0, (size))
+
+/* Draw threads are not run on host. */
+typedef int lv_mutex_t;
+#define lv_mutex_init(m)        (*(m) = 0)
+#define lv_mutex_lock(m)        ((void)(m))
+#define lv_mutex_unlock(m)      ((void)(m))
+
+typedef struct
+{
+    uint32_t magic: 8;
+    uint32_t cf: 8;
+    uint32_t flags: 16;
+    uint32_t w: 16;
+    uint32_t h: 16;
+    uint32_t stride: 16;
+    uint32_t reserved_2: 16;
+} lv_image_header_t;
+
+typedef struct
+{
+    lv_image_header_t header;
+    uint32_t data_size;
+    const uint8_t *data;
+} lv_image_dsc_t;
+
+typedef struct
+{
+    lv_image_header_t header;
+    uint32_t data_size;
+    uint8_t *data;
+    void *unaligned_data;
+} lv_draw_buf_t;
+
+/* File system, "X:" drive letters are dropped. */
+typedef enum
+{
+    LV_FS_RES_OK = 0,
+    LV_FS_RES_HW_ERR,
+    LV_FS_RES_NOT_EX,
+    LV_FS_RES_UNKNOWN,
+} lv_fs_res_t;
+
+typedef enum
+{
+    LV_FS_MODE_WR = 0x01,
+    LV_FS_MODE_RD = 0x02,
+} lv_fs_mode_t;
+
+typedef enum
+{
+    LV_FS_SEEK_SET = 0x00,
+    LV_FS_SEEK_CUR = 0x01,
+    LV_FS_SEEK_END = 0x02,
+} lv_fs_whence_t;
+
+typedef struct
+{
+    FILE *fp;
+} lv_fs_file_t;
+
+static inline lv_fs_res_t lv_fs_open(lv_fs_file_t *file_p, const char *path, lv_fs_mode_t mode)
+{
+    LV_UNUSED(mode);
+
+    if ((path[0] != '\0') && (path[1] == ':'))
+        path += 2;
+
+    file_p->fp = fopen(path, "rb");
+
+    return file_p->fp ? LV_FS_RES_OK : LV_FS_RES_NOT_EX;
+}
+
+static inline lv_fs_res_t lv_fs_close(lv_fs_file_t *file_p)
+{
+    fclose(file_p->fp);
+    file_p->fp = NULL;
+
+    return LV_FS_RES_OK;
+}
+
+static inline lv_fs_res_t lv_fs_seek(lv_fs_file_t *file_p, uint32_t pos, lv_fs_whence_t whence)
+{
+    return (fseek(file_p->fp, (long)pos, (int)whence) == 0) ? LV_FS_RES_OK : LV_FS_RES_HW_ERR;
+}
+
+static inline lv_fs_res_t lv_fs_read(lv_fs_file_t *file_p, void *buf, uint32_t btr, uint32_t *br)
+{
+    *br = (uint32_t)fread(buf, 1, btr, file_p->fp);
+
+    return ferror(file_p->fp) ? LV_FS_RES_HW_ERR : LV_FS_RES_OK;
+}
+
+/* Fonts */
+typedef enum
+{
+    LV_FONT_SUBPX_NONE,
+    LV_FONT_SUBPX_HOR,
+    LV_FONT_SUBPX_VER,
+    LV_FONT_SUBPX_BOTH,
+} lv_font_subpx_t;
+
+struct _lv_font_t;
+
+typedef struct
+{
+    const struct _lv_font_t *resolved_font;
+    uint16_t adv_w;
+    uint16_t box_w;
+    uint16_t box_h;
+    int16_t ofs_x;
+    int16_t ofs_y;
+    uint8_t bpp: 4;
+    uint8_t is_placeholder: 1;
+} lv_font_glyph_dsc_t;
+
+typedef struct _lv_font_t
+{
+    bool (*get_glyph_dsc)(const struct _lv_font_t *, lv_font_glyph_dsc_t *, uint32_t letter, uint32_t letter_next);
+    const void *(*get_glyph_bitmap)(lv_font_glyph_dsc_t *, uint32_t, lv_draw_buf_t *);
+    void (*release_glyph)(const struct _lv_font_t *, lv_font_glyph_dsc_t *);
+    int32_t line_height;
+    int32_t base_line;
+    uint8_t subpx: 2;
+    int8_t underline_position;
+    int8_t underline_thickness;
+    const void *dsc;
+    const struct _lv_font_t *fallback;
+    void *user_data;
+} lv_font_t;
+
+/* UTF-8 only, as LV_TXT_ENC_UTF8. */
+static inline uint32_t lv_text_encoded_next(const char *txt, uint32_t *i)
+{
+    const uint8_t *s = (const uint8_t *)txt;
+    uint32_t c = s[*i];
+    uint32_t n, k;
+
+    if (c < 0x80)
+    {
+        if (c)
+            (*i)++;
+        return c;
+    }
+
+    n = (c >= 0xF0) ? 3 : (c >= 0xE0) ? 2 : 1;
+    c &= 0x3F >> n;
+    (*i)++;
+
+    for (k = 0; k < n; k++)
+    {
+        if ((s[*i] & 0xC0) != 0x80)
+            return 0;
+        c = (c << 6) | (s[(*i)++] & 0x3F);
+    }
+
+    return c;
+}
+
+#endif /* LVGL_H */
@@ -0,0 +1,74 @@
+/*
+ * SPDX-License-Identifier: Apache-2.0
+ * Copyright (C) 2024 Nuvoton Technology Corp. All rights reserved.
+ *
+ * Stand-in of the SFUD headers for the host tools, with the types and
+ * commands the port layer uses. Names follow thirdparty/SFUD/sfud/inc.
+ */
+#ifndef _SFUD_H_
+#define _SFUD_H_
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#define SFUD_CMD_WRITE_ENABLE               0x06
+#define SFUD_CMD_WRITE_STATUS_REGISTER      0x01
+#define SFUD_CMD_READ_STATUS_REGISTER       0x05
+#define SFUD_CMD_READ_DATA                  0x03
+#define SFUD_STATUS_REGISTER_BUSY           (1 << 0)
+
+typedef enum
+{
+    SFUD_SUCCESS = 0,
+    SFUD_ERR_NOT_FOUND = 1,
+    SFUD_ERR_WRITE = 2,
+    SFUD_ERR_READ = 3,
+    SFUD_ERR_TIMEOUT = 4,
+    SFUD_ERR_ADDR_OUT_OF_BOUND = 5,
+} sfud_err;
+
+typedef struct
+{
+    uint8_t instruction;
+    uint8_t instruction_lines;
+    uint8_t address_size;
+    uint8_t address_lines;
+    uint8_t alternate_bytes_lines;
+    uint8_t dummy_cycles;
+    uint8_t data_lines;
+} sfud_qspi_read_cmd_format;
+
+typedef struct __sfud_spi
+{
+    char *name;
+    sfud_err(*wr)(const struct __sfud_spi *spi, const uint8_t *write_buf, size_t write_size, uint8_t *read_buf, size_t read_size);
+    sfud_err(*qspi_read)(const struct __sfud_spi *spi, uint32_t addr, sfud_qspi_read_cmd_format *qspi_read_cmd_format,
+                         uint8_t *read_buf, size_t read_size);
+    void (*lock)(const struct __sfud_spi *spi);
+    void (*unlock)(const struct __sfud_spi *spi);
+    void *user_data;
+} sfud_spi, *sfud_spi_t;
+
+typedef struct
+{
+    char *name;
+    size_t index;
+    sfud_spi spi;
+    bool init_ok;
+    bool addr_in_4_byte;
+    struct
+    {
+        void (*delay)(void);
+        size_t times;
+    } retry;
+    void *user_data;
+    sfud_qspi_read_cmd_format read_cmd_format;
+} sfud_flash, *sfud_flash_t;
+
+const sfud_flash *sfud_get_device(size_t index);
+sfud_err sfud_read(const sfud_flash *flash, uint32_t addr, size_t size, uint8_t *data);
+sfud_err sfud_erase(const sfud_flash *flash, uint32_t addr, size_t size);
+sfud_err sfud_write(const sfud_flash *flash, uint32_t addr, size_t size, const uint8_t *data);
+
+#endif /* _SFUD_H_ */
@@ -0,0 +1,212 @@
+/*
+ * SPDX-License-Identifier: Apache-2.0
+ * Copyright (C) 2024 Nuvoton Technology Corp. All rights reserved.
+ *
+ * Run the draw job protocol of common/nu_amp_draw.c with two threads on host:
+ * the main thread produces jobs as the draw unit on core 0 does, a worker
+ * thread consumes them as core 1 does and returns completions. The main
+ * thread draws into its own buffer meanwhile, as the software draw unit.
+ * Both buffers are compared against the same jobs run on one thread.
+ *
+ *   cc -O2 -pthread -I../common -o nu_amp_draw_test nu_amp_draw_test.c ../common/nu_amp_draw.c
+ *   ./nu_amp_draw_test [-n jobs] [-d max_in_flight]
+ *
+ * Exit code is 0 if all completions came back in order and the pixels match.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include <sched.h>
+#include "nu_amp_draw.h"
+
+#define BUF_W       97
+#define BUF_H       61
+#define BUF_STRIDE  (BUF_W * 4 + 12)
+
+static S_NU_AMP_QUEUE s_sReqQueue __attribute__((aligned(CONFIG_NU_AMP_CACHE_LINE)));
+static S_NU_AMP_QUEUE s_sDoneQueue __attribute__((aligned(CONFIG_NU_AMP_CACHE_LINE)));
+static volatile int s_i32Stop;
+
+static uint8_t s_au8Remote[BUF_H * BUF_STRIDE], s_au8RemoteRef[BUF_H * BUF_STRIDE];
+static uint8_t s_au8Local[BUF_H * BUF_STRIDE], s_au8LocalRef[BUF_H * BUF_STRIDE];
+static uint8_t s_au8Src[BUF_H * BUF_STRIDE];
+
+/* The core 1 side: pop, draw, complete. sched_yield() stands for WFE. */
+static void *worker(void *pvArg)
+{
+    S_NU_AMP_DRAW_JOB sJob;
+
+    (void)pvArg;
+
+    while (!__atomic_load_n(&s_i32Stop, __ATOMIC_ACQUIRE))
+    {
+        if (!nu_amp_queue_pop(&s_sReqQueue, &sJob))
+        {
+            sched_yield();
+            continue;
+        }
+
+        nu_amp_draw_run(&sJob);
+
+        while (!nu_amp_queue_push(&s_sDoneQueue, &sJob))
+            sched_yield();
+    }
+
+    return NULL;
+}
+
+static void job_random(S_NU_AMP_DRAW_JOB *psJob, uint8_t *pu8Buf, uintptr_t uSeq)
+{
+    uint32_t u32X = rand() % BUF_W, u32Y = rand() % BUF_H;
+    uint32_t u32SrcX = rand() % BUF_W, u32SrcY = rand() % BUF_H;
+    static const uint8_t au8Opa[] = { 0, 1, 64, 128, 200, 252, 253, 255 };
+
+    memset(psJob, 0, sizeof(S_NU_AMP_DRAW_JOB));
+    psJob->u32Op = rand() % 3;
+    psJob->u32Width = 1 + rand() % (BUF_W - (u32X > u32SrcX ? u32X : u32SrcX));
+    psJob->u32Height = 1 + rand() % (BUF_H - (u32Y > u32SrcY ? u32Y : u32SrcY));
+    psJob->pu8Dst = pu8Buf + u32Y * BUF_STRIDE + u32X * 4;
+    psJob->u32DstStride = BUF_STRIDE;
+    psJob->pu8Src = s_au8Src + u32SrcY * BUF_STRIDE + u32SrcX * 4;
+    psJob->u32SrcStride = BUF_STRIDE;
+    psJob->u32Color = (uint32_t)rand() & 0xFFFFFF;
+    psJob->u8Opa = au8Opa[rand() % sizeof(au8Opa)];
+    psJob->pvUserData = (void *)uSeq;
+}
+
+/* Re-address a job to the reference buffer. */
+static void job_rebase(S_NU_AMP_DRAW_JOB *psJob, const uint8_t *pu8From, uint8_t *pu8To)
+{
+    psJob->pu8Dst = pu8To + (psJob->pu8Dst - pu8From);
+}
+
+static int mix_check(void)
+{
+    uint32_t u32Dst = 0xFF000000UL, u32Src = 0x80FFFFFFUL;
+    S_NU_AMP_DRAW_JOB sJob = { eNU_AMP_DRAW_BLEND_ARGB, 1, 1, (uint8_t *)&u32Dst, 4, (const uint8_t *)&u32Src, 4, 0, 255, NULL };
+
+    /* White at alpha 128 over black. */
+    nu_amp_draw_run(&sJob);
+    if (u32Dst != 0xFF808080UL)
+    {
+        printf("blend 0x%08x, expected 0xff808080\n", u32Dst);
+        return -1;
+    }
+
+    return 0;
+}
+
+static void usage(const char *pcName)
+{
+    fprintf(stderr, "usage: %s [-n jobs] [-d max_in_flight]\n", pcName);
+    exit(2);
+}
+
+int main(int argc, char *argv[])
+{
+    pthread_t hWorker;
+    uint32_t u32Jobs = 20000, u32Depth = CONFIG_NU_AMP_QUEUE_DEPTH;
+    uintptr_t uSent = 0, uDone = 0;
+    uint32_t i, u32Local = 0;
+    int i32Ret = 0;
+
+    for (i = 1; i < (uint32_t)argc; i++)
+    {
+        if (!strcmp(argv[i], "-n") && (i + 1) < (uint32_t)argc)
+            u32Jobs = (uint32_t)atoi(argv[++i]);
+        else if (!strcmp(argv[i], "-d") && (i + 1) < (uint32_t)argc)
+            u32Depth = (uint32_t)atoi(argv[++i]);
+        else
+            usage(argv[0]);
+    }
+
+    if ((u32Depth == 0) || (u32Depth > CONFIG_NU_AMP_QUEUE_DEPTH))
+        usage(argv[0]);
+
+    if (mix_check() < 0)
+        return 1;
+
+    srand(1);
+    for (i = 0; i < sizeof(s_au8Src); i++)
+        s_au8Src[i] = (uint8_t)rand();
+    for (i = 0; i < sizeof(s_au8Remote); i++)
+        s_au8Remote[i] = s_au8RemoteRef[i] = s_au8Local[i] = s_au8LocalRef[i] = (uint8_t)rand();
+
+    nu_amp_queue_init(&s_sReqQueue);
+    nu_amp_queue_init(&s_sDoneQueue);
+
+    if (pthread_create(&hWorker, NULL, worker, NULL) != 0)
+    {
+        perror("pthread_create");
+        return 2;
+    }
+
+    while (uDone < u32Jobs)
+    {
+        S_NU_AMP_DRAW_JOB sJob;
+
+        /* Queue for the worker in order, the reference runs them in the same order. */
+        if ((uSent < u32Jobs) && ((uSent - uDone) < u32Depth))
+        {
+            job_random(&sJob, s_au8Remote, uSent);
+
+            if (!nu_amp_queue_push(&s_sReqQueue, &sJob))
+            {
+                printf("request queue full with %u in flight\n", (unsigned)(uSent - uDone));
+                i32Ret = 1;
+                break;
+            }
+
+            job_rebase(&sJob, s_au8Remote, s_au8RemoteRef);
+            nu_amp_draw_run(&sJob);
+            uSent++;
+
+            /* Draw locally while the worker is busy. */
+            job_random(&sJob, s_au8Local, 0);
+            nu_amp_draw_run(&sJob);
+            job_rebase(&sJob, s_au8Local, s_au8LocalRef);
+            nu_amp_draw_run(&sJob);
+            u32Local++;
+        }
+        else
+        {
+            sched_yield();
+        }
+
+        while (nu_amp_queue_pop(&s_sDoneQueue, &sJob))
+        {
+            if ((uintptr_t)sJob.pvUserData != uDone)
+            {
+                printf("completion %u, expected %u\n", (unsigned)(uintptr_t)sJob.pvUserData, (unsigned)uDone);
+                i32Ret = 1;
+                goto exit_main;
+            }
+            uDone++;
+        }
+    }
+
+exit_main:
+
+    __atomic_store_n(&s_i32Stop, 1, __ATOMIC_RELEASE);
+    pthread_join(hWorker, NULL);
+
+    if (i32Ret == 0)
+    {
+        if (memcmp(s_au8Remote, s_au8RemoteRef, sizeof(s_au8Remote)) != 0)
+        {
+            printf("worker pixels differ from reference\n");
+            i32Ret = 1;
+        }
+
+        if (memcmp(s_au8Local, s_au8LocalRef, sizeof(s_au8Local)) != 0)
+        {
+            printf("local pixels differ from reference\n");
+            i32Ret = 1;
+        }
+    }
+
+    printf("%u jobs on worker, %u local, max %u in flight: %s\n", (unsigned)uDone, u32Local, u32Depth, i32Ret ? "FAIL" : "PASS");
+
+    return i32Ret;
+}
@@ -0,0 +1,183 @@
+#!/usr/bin/env python3
+#
+# SPDX-License-Identifier: Apache-2.0
+# Copyright (C) 2024 Nuvoton Technology Corp. All rights reserved.
+#
+# Build an indexed asset pack for common/nu_asset_pack.c.
+#
+#   python3 nu_asset_pack.py -o assets.pak -m assets.json [--header assets_id.h]
+#   python3 nu_asset_pack.py -o assets.pak img_a.bin img_b.bin
+#
+# Manifest (JSON), one object per asset:
+#   [ { "name": "1.bin", "file": "assets_ext_storage/1.bin",
+#       "w": 114, "h": 108, "cf": "RGB565A8" }, ... ]
+#
+# "w", "h" and "cf" are optional; without them the asset is stored as plain
+# data. "codec": "lz4" or "rle" stores an image as a band stream for
+# common/nu_image_decoder.c, see nu_image_compress.py. A positional LVGL v9 binary image keeps its lv_image_header_t in the
+# index and only its pixel data is stored. An asset is found at run time by
+# nu_asset_id(name), the FNV-1a hash of its name.
+
+import argparse
+import binascii
+import json
+import os
+import struct
+import sys
+
+from nu_image_compress import compress_image
+
+PACK_MAGIC = 0x5041554E     # "NUAP"
+PACK_VERSION = 1
+PACK_HEADER = struct.Struct('<IHHII')
+PACK_ENTRY = struct.Struct('<I12sIIIB3x')
+
+LV_IMAGE_HEADER_MAGIC = 0x19
+LV_IMAGE_HEADER = struct.Struct('<BBHHHHH')
+
+CODEC_STORED = 0
+CODEC_STREAM = 1
+
+# name: (LV_COLOR_FORMAT_xxx, bits per pixel of the first plane)
+COLOR_FORMATS = {
+    'L8':       (0x06, 8),
+    'I1':       (0x07, 1),
+    'I2':       (0x08, 2),
+    'I4':       (0x09, 4),
+    'I8':       (0x0A, 8),
+    'A1':       (0x0B, 1),
+    'A2':       (0x0C, 2),
+    'A4':       (0x0D, 4),
+    'A8':       (0x0E, 8),
+    'RGB888':   (0x0F, 24),
+    'ARGB8888': (0x10, 32),
+    'XRGB8888': (0x11, 32),
+    'RGB565':   (0x12, 16),
+    'ARGB8565': (0x13, 24),
+    'RGB565A8': (0x14, 16),
+}
+
+
+def fnv1a(name):
+    h = 0x811C9DC5
+    for b in name.encode('utf-8'):
+        h = ((h ^ b) * 0x01000193) & 0xFFFFFFFF
+    return h
+
+
+def align_up(v, a):
+    return (v + a - 1) // a * a
+
+
+def image_header(w, h, cf, stride=None):
+    if cf not in COLOR_FORMATS:
+        raise ValueError('unknown color format %s' % cf)
+    cf_id, bpp = COLOR_FORMATS[cf]
+    if stride is None:
+        stride = (w * bpp + 7) // 8
+    return LV_IMAGE_HEADER.pack(LV_IMAGE_HEADER_MAGIC, cf_id, 0, w, h, stride, 0)
+
+
+def load_manifest(path):
+    base = os.path.dirname(os.path.abspath(path))
+    assets = []
+    with open(path, 'r') as f:
+        for item in json.load(f):
+            with open(os.path.join(base, item['file']), 'rb') as a:
+                data = a.read()
+            name = item.get('name', os.path.basename(item['file']))
+            if 'codec' in item:
+                hdr, data = compress_image(data, item['codec'], item.get('band_rows', 0),
+                                           item.get('w'), item.get('h'), item.get('cf'))
+                assets.append((name, hdr, data, CODEC_STREAM))
+                continue
+            hdr = bytes(LV_IMAGE_HEADER.size)
+            if 'cf' in item:
+                hdr = image_header(item['w'], item['h'], item['cf'], item.get('stride'))
+            assets.append((name, hdr, data, CODEC_STORED))
+    return assets
+
+
+def load_binary(path):
+    with open(path, 'rb') as f:
+        data = f.read()
+    hdr = bytes(LV_IMAGE_HEADER.size)
+    if len(data) > LV_IMAGE_HEADER.size and data[0] == LV_IMAGE_HEADER_MAGIC:
+        hdr, data = data[:LV_IMAGE_HEADER.size], data[LV_IMAGE_HEADER.size:]
+    return (os.path.basename(path), hdr, data, CODEC_STORED)
+
+
+def build(assets, align):
+    ids = {}
+    for name, _, _, _ in assets:
+        i = fnv1a(name)
+        if i in ids:
+            raise ValueError('asset id collision: %s and %s' % (ids[i], name))
+        ids[i] = name
+
+    assets = sorted(assets, key=lambda a: fnv1a(a[0]))
+    offset = align_up(PACK_HEADER.size + PACK_ENTRY.size * len(assets), align)
+
+    index = b''
+    payload = b''
+    for name, hdr, data, codec in assets:
+        pad = offset - (PACK_HEADER.size + PACK_ENTRY.size * len(assets)) - len(payload)
+        payload += b'\xff' * pad
+        index += PACK_ENTRY.pack(fnv1a(name), hdr, offset, len(data),
+                                 binascii.crc32(data) & 0xFFFFFFFF, codec)
+        payload += data
+        offset = align_up(offset + len(data), align)
+
+    header = PACK_HEADER.pack(PACK_MAGIC, PACK_VERSION, len(assets), align,
+                              binascii.crc32(index) & 0xFFFFFFFF)
+    return header + index + payload, assets
+
+
+def write_id_header(path, assets):
+    guard = '__' + os.path.basename(path).upper().replace('.', '_') + '__'
+    with open(path, 'w', newline='\n') as f:
+        f.write('/* Generated by tools/nu_asset_pack.py, do not edit. */\n')
+        f.write('#ifndef %s\n#define %s\n\n' % (guard, guard))
+        for name, _, _, _ in assets:
+            macro = ''.join(c if c.isalnum() else '_' for c in name).upper()
+            f.write('#define ASSET_ID_%-32s 0x%08XUL    /* %s */\n' % (macro, fnv1a(name), name))
+        f.write('\n#endif /* %s */\n' % guard)
+
+
+def main():
+    parser = argparse.ArgumentParser(description='Build an indexed asset pack.')
+    parser.add_argument('-o', '--output', required=True, help='output pack file')
+    parser.add_argument('-m', '--manifest', help='JSON manifest of assets')
+    parser.add_argument('-a', '--align', type=int, default=64,
+                        help='payload alignment in byte, power of 2 (default: 64)')
+    parser.add_argument('--header', help='also write a C header of asset IDs')
+    parser.add_argument('files', nargs='*', help='LVGL binary images or plain files')
+    args = parser.parse_args()
+
+    if args.align < 4 or (args.align & (args.align - 1)):
+        parser.error('alignment must be a power of 2 and at least 4')
+
+    assets = load_manifest(args.manifest) if args.manifest else []
+    assets += [load_binary(p) for p in args.files]
+    if not assets:
+        parser.error('no assets given')
+
+    try:
+        pack, assets = build(assets, args.align)
+    except ValueError as e:
+        print(e, file=sys.stderr)
+        sys.exit(1)
+
+    with open(args.output, 'wb') as f:
+        f.write(pack)
+
+    if args.header:
+        write_id_header(args.header, assets)
+
+    for name, hdr, data, codec in assets:
+        print('%08X %8d  %s' % (fnv1a(name), len(data), name))
+    print('%s: %d assets, %d bytes' % (args.output, len(assets), len(pack)))
+
+
+if __name__ == '__main__':
+    main()
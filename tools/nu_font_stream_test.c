@@ -0,0 +1,546 @@
+/*
+ * SPDX-License-Identifier: Apache-2.0
+ * Copyright (C) 2024 Nuvoton Technology Corp. All rights reserved.
+ *
+ * Round trip of an lv_font_conv binary font through common/nu_font_stream.c
+ * on host, host_data/lato16.fnt by default. Build another font as the
+ * boards do:
+ *
+ *   lv_font_conv --format bin --no-compress --no-kerning --bpp 4 --size 16 \
+ *                --font Montserrat-Medium.ttf -r 0x20-0x7F -o montserrat16.fnt
+ *   cc -O2 -I../common -Ihost_inc -o nu_font_stream_test nu_font_stream_test.c
+ *   ./nu_font_stream_test [montserrat16.fnt]
+ *
+ * The whole file is decoded here in one pass, as lv_binfont_loader does, and
+ * every letter of every character map is compared with what the stream gives,
+ * descriptor and A8 bitmap, through a cache small enough to evict. Letters
+ * outside the maps must be missing. The font is opened as a file and from
+ * an offset of a raw source, and a copy with the compression byte set and
+ * one with a "kern" table appended must both be refused.
+ *
+ * Exit code is 0 if all of it matched.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* A few glyphs of 16 px at 4 bpp, so that every pass evicts. */
+#define CONFIG_NU_FONT_CACHE_SIZE       1024
+#define CONFIG_NU_FONT_PREFETCH_MAX     8
+
+/* Build the module in here, with the heap and stdio of host. */
+#include "nu_font_stream.c"
+
+/* Not used, fonts are opened raw here. */
+const S_NU_ASSET_ENTRY *nu_asset_pack_find(const S_NU_ASSET_PACK *psPack, uint32_t u32Id)
+{
+    return NULL;
+}
+
+#define RAW_BASE            0x123       // Odd, like an entry of a pack with no alignment
+
+typedef struct
+{
+    uint32_t u32Letter;
+    uint32_t u32Gid;
+} S_REF_LETTER;
+
+/* The font decoded in one pass. */
+typedef struct
+{
+    const uint8_t *pu8Font;
+    uint32_t u32Size;
+    S_NU_FONT_HEAD sHead;
+    uint32_t u32LocaCount;
+    uint32_t u32LocaStart;      // First offset in "loca"
+    uint32_t u32GlyfStart;
+    S_REF_LETTER *psLetter;
+    uint32_t u32Letters;
+} S_REF_FONT;
+
+typedef struct
+{
+    const uint8_t *pu8Src;
+    uint32_t u32Size;
+    uint32_t u32Reads;
+} S_RAW_SRC;
+
+static uint32_t s_u32Fails;
+
+static uint32_t get16(const uint8_t *p)
+{
+    return p[0] | ((uint32_t)p[1] << 8);
+}
+
+static uint32_t get32(const uint8_t *p)
+{
+    return p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+static uint32_t ref_bits(const uint8_t *p, uint32_t *pu32Pos, uint32_t u32Bits)
+{
+    uint32_t u32Val = 0, i;
+
+    for (i = 0; i < u32Bits; i++, (*pu32Pos)++)
+        u32Val = (u32Val << 1) | ((p[*pu32Pos / 8] >> (7 - (*pu32Pos % 8))) & 1);
+
+    return u32Val;
+}
+
+static int32_t ref_sbits(const uint8_t *p, uint32_t *pu32Pos, uint32_t u32Bits)
+{
+    uint32_t u32Val = ref_bits(p, pu32Pos, u32Bits);
+
+    if (u32Bits && (u32Val >> (u32Bits - 1)))
+        return (int32_t)u32Val - (int32_t)(1UL << u32Bits);
+
+    return (int32_t)u32Val;
+}
+
+/* Offset of the table labelled szLabel at u32Pos, 0 if it is something else. */
+static uint32_t ref_table(const S_REF_FONT *psRef, uint32_t u32Pos, const char *szLabel)
+{
+    if ((u32Pos + 8 > psRef->u32Size) || memcmp(&psRef->pu8Font[u32Pos + 4], szLabel, 4))
+        return 0;
+
+    return get32(&psRef->pu8Font[u32Pos]);
+}
+
+static void ref_add(S_REF_FONT *psRef, uint32_t u32Letter, uint32_t u32Gid)
+{
+    psRef->psLetter = realloc(psRef->psLetter, (psRef->u32Letters + 1) * sizeof(S_REF_LETTER));
+    psRef->psLetter[psRef->u32Letters].u32Letter = u32Letter;
+    psRef->psLetter[psRef->u32Letters].u32Gid = u32Gid;
+    psRef->u32Letters++;
+}
+
+static int ref_load(S_REF_FONT *psRef)
+{
+    const uint8_t *p = psRef->pu8Font;
+    const uint8_t *h;
+    uint32_t u32Pos, u32Len, u32Cmap, u32Count, i, j;
+
+    if ((u32Len = ref_table(psRef, 0, "head")) < 8 + 40)
+        return -1;
+
+    /* Field by field, not by the struct of the module. */
+    h = &p[8];
+    psRef->sHead.u16TableCount  = get16(&h[4]);
+    psRef->sHead.u16FontSize    = get16(&h[6]);
+    psRef->sHead.i16MinY        = (int16_t)get16(&h[18]);
+    psRef->sHead.i16MaxY        = (int16_t)get16(&h[20]);
+    psRef->sHead.u16DefaultAdvW = get16(&h[22]);
+    psRef->sHead.u8LocaFormat   = h[26];
+    psRef->sHead.u8AdvWFormat   = h[28];
+    psRef->sHead.u8Bpp          = h[29];
+    psRef->sHead.u8XyBits       = h[30];
+    psRef->sHead.u8WhBits       = h[31];
+    psRef->sHead.u8AdvWBits     = h[32];
+    psRef->sHead.u8Compression  = h[33];
+
+    u32Cmap = u32Len;
+    if ((u32Len = ref_table(psRef, u32Cmap, "cmap")) == 0)
+        return -1;
+
+    u32Count = get32(&p[u32Cmap + 8]);
+    for (i = 0; i < u32Count; i++)
+    {
+        const uint8_t *s = &p[u32Cmap + 12 + i * 16];
+        const uint8_t *d = &p[u32Cmap + get32(&s[0])];
+        uint32_t u32Start = get32(&s[4]);
+        uint32_t u32Range = get16(&s[8]);
+        uint32_t u32GidStart = get16(&s[10]);
+        uint32_t u32Entries = get16(&s[12]);
+
+        switch (s[14])
+        {
+        case NU_FONT_CMAP_FORMAT0_TINY:
+            for (j = 0; j < u32Range; j++)
+                ref_add(psRef, u32Start + j, u32GidStart + j);
+            break;
+
+        case NU_FONT_CMAP_FORMAT0_FULL:
+            for (j = 0; j < u32Entries; j++)
+                ref_add(psRef, u32Start + j, u32GidStart + d[j]);
+            break;
+
+        case NU_FONT_CMAP_SPARSE_TINY:
+            for (j = 0; j < u32Entries; j++)
+                ref_add(psRef, u32Start + get16(&d[j * 2]), u32GidStart + j);
+            break;
+
+        case NU_FONT_CMAP_SPARSE_FULL:
+            for (j = 0; j < u32Entries; j++)
+                ref_add(psRef, u32Start + get16(&d[j * 2]), u32GidStart + get16(&d[(u32Entries + j) * 2]));
+            break;
+
+        default:
+            fprintf(stderr, "cmap format %u\n", s[14]);
+            return -1;
+        }
+    }
+
+    u32Pos = u32Cmap + u32Len;
+    if ((u32Len = ref_table(psRef, u32Pos, "loca")) == 0)
+        return -1;
+
+    psRef->u32LocaCount = get32(&p[u32Pos + 8]);
+    psRef->u32LocaStart = u32Pos + 12;
+
+    psRef->u32GlyfStart = u32Pos + u32Len;
+    if (ref_table(psRef, psRef->u32GlyfStart, "glyf") == 0)
+        return -1;
+
+    return 0;
+}
+
+static uint32_t ref_loca(const S_REF_FONT *psRef, uint32_t u32Gid)
+{
+    const uint8_t *p = &psRef->pu8Font[psRef->u32LocaStart];
+
+    return psRef->sHead.u8LocaFormat ? get32(&p[u32Gid * 4]) : get16(&p[u32Gid * 2]);
+}
+
+/* Descriptor and A8 bitmap of a glyph, as lv_font_fmt_txt gives them. */
+static void ref_glyph(const S_REF_FONT *psRef, uint32_t u32Gid, lv_font_glyph_dsc_t *psDsc, uint8_t *pu8A8, uint32_t u32Stride)
+{
+    static const uint8_t au8Opa2[4] = { 0, 85, 170, 255 };
+    static const uint8_t au8Opa4[16] = { 0, 17, 34, 51, 68, 85, 102, 119, 136, 153, 170, 187, 204, 221, 238, 255 };
+    const S_NU_FONT_HEAD *psHead = &psRef->sHead;
+    const uint8_t *g = &psRef->pu8Font[psRef->u32GlyfStart + ref_loca(psRef, u32Gid)];
+    uint32_t u32Pos = 0, u32AdvW, x, y;
+
+    u32AdvW = psHead->u8AdvWBits ? ref_bits(g, &u32Pos, psHead->u8AdvWBits) : psHead->u16DefaultAdvW;
+    if (psHead->u8AdvWFormat == 0)
+        u32AdvW *= 16;
+
+    memset(psDsc, 0, sizeof(*psDsc));
+    psDsc->adv_w = (u32AdvW + 8) / 16;
+    psDsc->ofs_x = ref_sbits(g, &u32Pos, psHead->u8XyBits);
+    psDsc->ofs_y = ref_sbits(g, &u32Pos, psHead->u8XyBits);
+    psDsc->box_w = ref_bits(g, &u32Pos, psHead->u8WhBits);
+    psDsc->box_h = ref_bits(g, &u32Pos, psHead->u8WhBits);
+    psDsc->bpp = psHead->u8Bpp;
+
+    if ((psDsc->box_w > u32Stride) || (psDsc->box_h > 256))
+        return;
+
+    for (y = 0; y < psDsc->box_h; y++)
+    {
+        for (x = 0; x < psDsc->box_w; x++)
+        {
+            uint32_t v = ref_bits(g, &u32Pos, psHead->u8Bpp);
+
+            switch (psHead->u8Bpp)
+            {
+            case 1:
+                pu8A8[y * u32Stride + x] = v ? 255 : 0;
+                break;
+            case 2:
+                pu8A8[y * u32Stride + x] = au8Opa2[v];
+                break;
+            case 4:
+                pu8A8[y * u32Stride + x] = au8Opa4[v];
+                break;
+            default:
+                pu8A8[y * u32Stride + x] = v;
+                break;
+            }
+        }
+    }
+}
+
+static int raw_read(void *pvUserData, uint32_t u32Offset, void *pvBuf, uint32_t u32Len)
+{
+    S_RAW_SRC *psSrc = (S_RAW_SRC *)pvUserData;
+
+    psSrc->u32Reads++;
+
+    if ((u32Offset > psSrc->u32Size) || (u32Len > psSrc->u32Size - u32Offset))
+        return -1;
+
+    memcpy(pvBuf, &psSrc->pu8Src[u32Offset], u32Len);
+
+    return 0;
+}
+
+static void fail(const char *szWhat, uint32_t u32Letter)
+{
+    fprintf(stderr, "U+%04X: %s\n", (unsigned int)u32Letter, szWhat);
+    s_u32Fails++;
+}
+
+static void check_letter(const lv_font_t *psFont, const S_REF_FONT *psRef, const S_REF_LETTER *psLetter)
+{
+    static uint8_t au8Ref[256 * 256], au8Got[256 * 256];
+    lv_font_glyph_dsc_t sRef, sGot;
+    lv_draw_buf_t sDrawBuf;
+    uint32_t u32Stride = 256, y;
+
+    ref_glyph(psRef, psLetter->u32Gid, &sRef, au8Ref, u32Stride);
+
+    if ((sRef.box_w > u32Stride) || (sRef.box_h > 256))
+    {
+        fail("glyph larger than the test buffer", psLetter->u32Letter);
+        return;
+    }
+
+    memset(&sGot, 0, sizeof(sGot));
+    if (!psFont->get_glyph_dsc(psFont, &sGot, psLetter->u32Letter, 0))
+    {
+        fail("missing", psLetter->u32Letter);
+        return;
+    }
+
+    if ((sGot.adv_w != sRef.adv_w) || (sGot.box_w != sRef.box_w) || (sGot.box_h != sRef.box_h) ||
+            (sGot.ofs_x != sRef.ofs_x) || (sGot.ofs_y != sRef.ofs_y) || (sGot.bpp != sRef.bpp) ||
+            (sGot.resolved_font != psFont) || sGot.is_placeholder)
+    {
+        fprintf(stderr, "adv %u/%u box %ux%u/%ux%u ofs %d,%d/%d,%d\n",
+                sGot.adv_w, sRef.adv_w, sGot.box_w, sGot.box_h, sRef.box_w, sRef.box_h,
+                sGot.ofs_x, sGot.ofs_y, sRef.ofs_x, sRef.ofs_y);
+        fail("descriptor differs", psLetter->u32Letter);
+        return;
+    }
+
+    memset(&sDrawBuf, 0, sizeof(sDrawBuf));
+    memset(au8Got, 0xA5, sizeof(au8Got));
+    sDrawBuf.data = au8Got;
+    sDrawBuf.header.stride = u32Stride;
+
+    if (psFont->get_glyph_bitmap(&sGot, psLetter->u32Letter, &sDrawBuf) != au8Got)
+    {
+        fail("no bitmap", psLetter->u32Letter);
+        return;
+    }
+
+    for (y = 0; y < sRef.box_h; y++)
+    {
+        if (memcmp(&au8Got[y * u32Stride], &au8Ref[y * u32Stride], sRef.box_w))
+        {
+            fail("bitmap differs", psLetter->u32Letter);
+            return;
+        }
+    }
+}
+
+static int ref_has(const S_REF_FONT *psRef, uint32_t u32Letter)
+{
+    uint32_t i;
+
+    for (i = 0; i < psRef->u32Letters; i++)
+        if (psRef->psLetter[i].u32Letter == u32Letter)
+            return 1;
+
+    return 0;
+}
+
+static void check_font(const char *szHow, const lv_font_t *psFont, const S_REF_FONT *psRef)
+{
+    S_NU_FONT_CACHE_STAT sStat;
+    lv_font_glyph_dsc_t sDsc;
+    char acText[CONFIG_NU_FONT_PREFETCH_MAX * 4 + 1];
+    uint32_t u32Fails = s_u32Fails, u32Len, i, j, u32Letter;
+    int i32Pass;
+
+    if (!psFont)
+    {
+        printf("%s: not opened\n", szHow);
+        s_u32Fails++;
+        return;
+    }
+
+    if ((psFont->line_height != psRef->sHead.i16MaxY - psRef->sHead.i16MinY) ||
+            (psFont->base_line != -psRef->sHead.i16MinY))
+        fail("line height or base line differs", 0);
+
+    /* Forward, backward, then by prefetched runs of text. */
+    for (i32Pass = 0; i32Pass < 3; i32Pass++)
+    {
+        for (i = 0; i < psRef->u32Letters; i++)
+        {
+            const S_REF_LETTER *psLetter = &psRef->psLetter[(i32Pass == 1) ? (psRef->u32Letters - 1 - i) : i];
+
+            if ((i32Pass == 2) && ((i % CONFIG_NU_FONT_PREFETCH_MAX) == 0))
+            {
+                for (j = 0, u32Len = 0; (j < CONFIG_NU_FONT_PREFETCH_MAX) && (i + j < psRef->u32Letters); j++)
+                {
+                    u32Letter = psRef->psLetter[i + j].u32Letter;
+                    if (u32Letter < 0x80)
+                        acText[u32Len++] = (char)u32Letter;
+                    else if (u32Letter < 0x800)
+                    {
+                        acText[u32Len++] = (char)(0xC0 | (u32Letter >> 6));
+                        acText[u32Len++] = (char)(0x80 | (u32Letter & 0x3F));
+                    }
+                    else if (u32Letter < 0x10000)
+                    {
+                        acText[u32Len++] = (char)(0xE0 | (u32Letter >> 12));
+                        acText[u32Len++] = (char)(0x80 | ((u32Letter >> 6) & 0x3F));
+                        acText[u32Len++] = (char)(0x80 | (u32Letter & 0x3F));
+                    }
+                }
+                acText[u32Len] = '\0';
+
+                /* Letter 0 is the end of the text. */
+                if (psRef->psLetter[i].u32Letter != 0)
+                    nu_font_stream_prefetch(psFont, acText);
+            }
+
+            check_letter(psFont, psRef, psLetter);
+        }
+    }
+
+    /* Letters the maps do not have. */
+    for (u32Letter = 1; u32Letter < 0x3000; u32Letter++)
+    {
+        if (!ref_has(psRef, u32Letter) && psFont->get_glyph_dsc(psFont, &sDsc, u32Letter, 0))
+            fail("present, not in the font", u32Letter);
+    }
+
+    nu_font_stream_cache_stat(&sStat);
+
+    /* One glyph larger than the cache is the only overrun allowed. */
+    if ((sStat.u32Used > CONFIG_NU_FONT_CACHE_SIZE) && (sStat.u32Glyphs > 1))
+        fail("cache over its size", 0);
+
+    printf("%s: %u letters, %u hits, %u misses, %u evictions, %u glyphs %u bytes cached, %s\n",
+           szHow, (unsigned int)psRef->u32Letters, (unsigned int)sStat.u32Hits, (unsigned int)sStat.u32Misses,
+           (unsigned int)sStat.u32Evictions, (unsigned int)sStat.u32Glyphs, (unsigned int)sStat.u32Used,
+           (s_u32Fails == u32Fails) ? "ok" : "differs");
+}
+
+static int read_file(const char *szPath, uint8_t **ppu8Buf, uint32_t *pu32Size)
+{
+    FILE *fp = fopen(szPath, "rb");
+    long lSize;
+
+    if (!fp)
+        return -1;
+
+    fseek(fp, 0, SEEK_END);
+    lSize = ftell(fp);
+    fseek(fp, 0, SEEK_SET);
+
+    /* Room for a "kern" table appended by the test, and the raw base. */
+    *ppu8Buf = calloc(1, RAW_BASE + lSize + 64);
+    *pu32Size = (uint32_t)lSize;
+
+    if (fread(*ppu8Buf + RAW_BASE, 1, lSize, fp) != (size_t)lSize)
+    {
+        fclose(fp);
+        return -1;
+    }
+
+    fclose(fp);
+
+    return 0;
+}
+
+int main(int argc, char *argv[])
+{
+    S_REF_FONT sRef;
+    S_RAW_SRC sSrc;
+    lv_font_t *psFont;
+    uint8_t *pu8Buf = NULL;
+    uint8_t *pu8Font;
+    uint32_t u32Size, u32GlyfLen;
+    const char *szPath = (argc > 1) ? argv[1] : "host_data/lato16.fnt";
+
+    if (argc > 2)
+    {
+        fprintf(stderr, "usage: %s [font.fnt]\n", argv[0]);
+        return 2;
+    }
+
+    if (read_file(szPath, &pu8Buf, &u32Size) != 0)
+    {
+        fprintf(stderr, "cannot read %s\n", szPath);
+        return 2;
+    }
+
+    pu8Font = pu8Buf + RAW_BASE;
+
+    memset(&sRef, 0, sizeof(sRef));
+    sRef.pu8Font = pu8Font;
+    sRef.u32Size = u32Size;
+    if (ref_load(&sRef) != 0)
+    {
+        fprintf(stderr, "%s is not an lv_font_conv binary font\n", szPath);
+        return 2;
+    }
+
+    /* The module refuses these, see nu_font_stream.h. */
+    if (sRef.sHead.u8Compression || ref_table(&sRef, sRef.u32GlyfStart + get32(&pu8Font[sRef.u32GlyfStart]), "kern"))
+    {
+        fprintf(stderr, "%s has compressed bitmaps or kerning, build it with --no-compress --no-kerning\n", szPath);
+        return 2;
+    }
+
+    printf("%s: %u px, %u bpp, %u glyphs, %u letters, %u tables\n", szPath,
+           sRef.sHead.u16FontSize, sRef.sHead.u8Bpp, (unsigned int)sRef.u32LocaCount,
+           (unsigned int)sRef.u32Letters, sRef.sHead.u16TableCount);
+
+    /* As a file on an lv_fs drive. */
+    psFont = nu_font_stream_create(szPath);
+    check_font("file", psFont, &sRef);
+    if (psFont)
+        nu_font_stream_delete(psFont);
+
+    /* At an offset of a raw source, reads must not stray out of the font. */
+    sSrc.pu8Src = pu8Buf;
+    sSrc.u32Size = RAW_BASE + u32Size;
+    sSrc.u32Reads = 0;
+    psFont = nu_font_stream_create_raw(raw_read, &sSrc, RAW_BASE);
+    check_font("raw", psFont, &sRef);
+    if (psFont)
+        nu_font_stream_delete(psFont);
+
+    /* Cache is empty once the fonts are gone. */
+    {
+        S_NU_FONT_CACHE_STAT sStat;
+
+        nu_font_stream_cache_stat(&sStat);
+        if (sStat.u32Glyphs || sStat.u32Used)
+            fail("glyphs left in cache after delete", 0);
+    }
+
+    /* Compressed bitmaps, lv_font_conv without --no-compress. */
+    pu8Font[8 + 33] = 1;
+    psFont = nu_font_stream_create_raw(raw_read, &sSrc, RAW_BASE);
+    printf("compressed: %s\n", psFont ? "accepted" : "refused");
+    if (psFont)
+    {
+        fail("compressed font accepted", 0);
+        nu_font_stream_delete(psFont);
+    }
+    pu8Font[8 + 33] = sRef.sHead.u8Compression;
+
+    /* Kerning, lv_font_conv without --no-kerning writes "kern" after "glyf". */
+    u32GlyfLen = get32(&pu8Font[sRef.u32GlyfStart]);
+    if (sRef.u32GlyfStart + u32GlyfLen + 8 <= u32Size + 64)
+    {
+        memcpy(&pu8Font[sRef.u32GlyfStart + u32GlyfLen], "\x10\x00\x00\x00kern\x00\x00\x00\x00\x00\x00\x00\x00", 16);
+        sSrc.u32Size = RAW_BASE + sRef.u32GlyfStart + u32GlyfLen + 16;
+        psFont = nu_font_stream_create_raw(raw_read, &sSrc, RAW_BASE);
+        printf("kerning: %s\n", psFont ? "accepted" : "refused");
+        if (psFont)
+        {
+            fail("font with kerning accepted", 0);
+            nu_font_stream_delete(psFont);
+        }
+    }
+
+    free(sRef.psLetter);
+    free(pu8Buf);
+
+    if (s_u32Fails)
+    {
+        printf("%u mismatches\nFAIL\n", (unsigned int)s_u32Fails);
+        return 1;
+    }
+
+    printf("PASS\n");
+
+    return 0;
+}
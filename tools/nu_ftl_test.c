@@ -0,0 +1,348 @@
+/*
+ * SPDX-License-Identifier: Apache-2.0
+ * Copyright (C) 2024 Nuvoton Technology Corp. All rights reserved.
+ *
+ * Run common/nu_ftl.c on host against a simulated NOR flash, cutting the
+ * power in the middle of programs and erases, and check the logical sectors
+ * after each remount.
+ *
+ *   cc -O2 -I../common -o nu_ftl_test nu_ftl_test.c
+ *   ./nu_ftl_test [-n power_cuts] [-s seed]
+ *
+ * The NOR only clears bits on program, and a byte is programmed once between
+ * erases. A cut program leaves a prefix of the bytes, and some bits of the
+ * next one, programmed. A cut erase leaves random cells, or a run of them,
+ * erased.
+ * After the cut, every sector must read back what was last written to it,
+ * except the one in flight, which may read the old or the new data.
+ *
+ * Exit code is 0 if the NOR rules were kept and no sector was lost.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* Build the module in here, with the heap of host. */
+#define NU_FTL_MALLOC(size)     malloc(size)
+#define NU_FTL_FREE(ptr)        free(ptr)
+#include "nu_ftl.c"
+
+#define NOR_BLOCK_SIZE      4096
+#define NOR_BLOCK_COUNT     24
+#define NOR_SIZE            (NOR_BLOCK_SIZE * NOR_BLOCK_COUNT)
+
+#define LBA_MAX             ((NOR_BLOCK_COUNT - CONFIG_NU_FTL_RESERVED_BLOCKS) * (NOR_BLOCK_SIZE / NU_FTL_SECTOR_SIZE - 1))
+
+typedef struct
+{
+    uint8_t au8Mem[NOR_SIZE];
+    int32_t i32OpsToCut;        // Programs and erases until the power cut, -1 for none
+    int bDead;                  // Power is off, every access fails
+    uint32_t u32Violations;
+    uint32_t u32Progs;
+    uint32_t u32Erases;
+} S_NOR;
+
+static S_NOR s_sNor;
+static uint8_t s_au8Ref[LBA_MAX][NU_FTL_SECTOR_SIZE];
+static uint32_t s_u32Rand = 1;
+
+static uint32_t rand_next(void)
+{
+    /* xorshift32, the same sequence on any host. */
+    s_u32Rand ^= s_u32Rand << 13;
+    s_u32Rand ^= s_u32Rand >> 17;
+    s_u32Rand ^= s_u32Rand << 5;
+
+    return s_u32Rand;
+}
+
+static int nor_cut(S_NOR *psNor)
+{
+    if (psNor->i32OpsToCut < 0)
+        return 0;
+
+    if (psNor->i32OpsToCut-- > 0)
+        return 0;
+
+    psNor->bDead = 1;
+    return 1;
+}
+
+static int nor_read(void *pvUserData, uint32_t u32Addr, void *pvBuf, uint32_t u32Len)
+{
+    S_NOR *psNor = (S_NOR *)pvUserData;
+
+    if (psNor->bDead || (u32Addr + u32Len > NOR_SIZE))
+        return -1;
+
+    memcpy(pvBuf, &psNor->au8Mem[u32Addr], u32Len);
+
+    return 0;
+}
+
+static int nor_prog(void *pvUserData, uint32_t u32Addr, const void *pvBuf, uint32_t u32Len)
+{
+    S_NOR *psNor = (S_NOR *)pvUserData;
+    const uint8_t *pu8Src = (const uint8_t *)pvBuf;
+    uint32_t u32Done = u32Len, i;
+
+    if (psNor->bDead || (u32Addr + u32Len > NOR_SIZE))
+        return -1;
+
+    if (nor_cut(psNor))
+        u32Done = rand_next() % u32Len;
+
+    for (i = 0; i < u32Len; i++)
+    {
+        uint8_t *pu8Dst = &psNor->au8Mem[u32Addr + i];
+
+        if ((pu8Src[i] != 0xFF) && (*pu8Dst != 0xFF))
+        {
+            fprintf(stderr, "program over programmed byte at 0x%05x: %02x over %02x\n", (unsigned int)(u32Addr + i), pu8Src[i], *pu8Dst);
+            psNor->u32Violations++;
+        }
+
+        if (i < u32Done)
+            *pu8Dst &= pu8Src[i];
+        else if (i == u32Done)
+            *pu8Dst &= pu8Src[i] | (uint8_t)rand_next();   // Some bits of the byte under way
+    }
+
+    psNor->u32Progs++;
+
+    return psNor->bDead ? -1 : 0;
+}
+
+static int nor_erase(void *pvUserData, uint32_t u32Addr)
+{
+    S_NOR *psNor = (S_NOR *)pvUserData;
+    uint32_t i;
+
+    if (psNor->bDead || (u32Addr % NOR_BLOCK_SIZE) || (u32Addr >= NOR_SIZE))
+        return -1;
+
+    if (nor_cut(psNor))
+    {
+        uint32_t u32Start = (rand_next() & 1) ? (rand_next() % 16) * 4 : rand_next() % NOR_BLOCK_SIZE;  // Half from a header word
+        uint32_t u32End = u32Start + rand_next() % (NOR_BLOCK_SIZE - u32Start + 1);
+        int bRun = rand_next() & 1;
+
+        /* Cells go up in no particular order, or one run of them, which may spare the header. */
+        for (i = 0; i < NOR_BLOCK_SIZE; i++)
+        {
+            if (bRun ? ((i >= u32Start) && (i < u32End)) : (rand_next() & 1))
+                psNor->au8Mem[u32Addr + i] = 0xFF;
+        }
+
+        return -1;
+    }
+
+    memset(&psNor->au8Mem[u32Addr], 0xFF, NOR_BLOCK_SIZE);
+    psNor->u32Erases++;
+
+    return 0;
+}
+
+static void sector_fill(uint8_t *pu8Buf, uint32_t u32Lba, uint32_t u32Gen)
+{
+    uint32_t i;
+
+    for (i = 0; i < NU_FTL_SECTOR_SIZE; i++)
+        pu8Buf[i] = (uint8_t)((u32Lba * 131) ^ (u32Gen * 7) ^ (i * 13) ^ (i >> 8));
+
+    memcpy(pu8Buf, &u32Lba, sizeof(u32Lba));
+    memcpy(pu8Buf + sizeof(u32Lba), &u32Gen, sizeof(u32Gen));
+}
+
+static int ftl_mount(S_NU_FTL *psFtl)
+{
+    S_NU_FTL_FLASH sFlash;
+
+    sFlash.pfnRead = nor_read;
+    sFlash.pfnProg = nor_prog;
+    sFlash.pfnErase = nor_erase;
+    sFlash.pvUserData = &s_sNor;
+    sFlash.u32BlockSize = NOR_BLOCK_SIZE;
+    sFlash.u32BlockCount = NOR_BLOCK_COUNT;
+
+    if (nu_ftl_mount(psFtl, &sFlash) != 0)
+    {
+        fprintf(stderr, "mount failed\n");
+        return -1;
+    }
+
+    if (psFtl->u32SectorCount != LBA_MAX)
+    {
+        fprintf(stderr, "%u sectors, %u expected\n", (unsigned int)psFtl->u32SectorCount, (unsigned int)LBA_MAX);
+        return -1;
+    }
+
+    return 0;
+}
+
+/* Compare every sector with the reference, the one in flight may hold pu8New instead. */
+static int ftl_check(S_NU_FTL *psFtl, int32_t i32InFlight, const uint8_t *pu8New)
+{
+    uint8_t au8Buf[NU_FTL_SECTOR_SIZE];
+    uint32_t u32Lba;
+    int ret = 0;
+
+    for (u32Lba = 0; u32Lba < LBA_MAX; u32Lba++)
+    {
+        if (nu_ftl_read(psFtl, u32Lba, au8Buf, 1) != 0)
+        {
+            fprintf(stderr, "read of sector %u failed\n", (unsigned int)u32Lba);
+            return -1;
+        }
+
+        if (!memcmp(au8Buf, s_au8Ref[u32Lba], NU_FTL_SECTOR_SIZE))
+            continue;
+
+        if (((int32_t)u32Lba == i32InFlight) && !memcmp(au8Buf, pu8New, NU_FTL_SECTOR_SIZE))
+        {
+            /* The write made it before the cut. */
+            memcpy(s_au8Ref[u32Lba], pu8New, NU_FTL_SECTOR_SIZE);
+            continue;
+        }
+
+        fprintf(stderr, "sector %u lost%s\n", (unsigned int)u32Lba, ((int32_t)u32Lba == i32InFlight) ? " (in flight)" : "");
+        ret = -1;
+    }
+
+    return ret;
+}
+
+/* Hot sectors, as FAT and directory ones, get most of the writes. */
+static uint32_t lba_pick(void)
+{
+    if ((rand_next() % 4) != 0)
+        return rand_next() % 8;
+
+    return rand_next() % LBA_MAX;
+}
+
+static void usage(const char *pcName)
+{
+    fprintf(stderr, "usage: %s [-n power_cuts] [-s seed]\n", pcName);
+    exit(2);
+}
+
+int main(int argc, char *argv[])
+{
+    static S_NU_FTL sFtl;
+    uint8_t au8New[NU_FTL_SECTOR_SIZE];
+    uint32_t u32Cuts = 5000, u32Gen = 0, u32Cut, u32Lba;
+    uint32_t u32MaxEraseCnt = 0;
+    int32_t i32InFlight;
+    int i;
+
+    for (i = 1; i < argc; i++)
+    {
+        if (!strcmp(argv[i], "-n") && (i + 1) < argc)
+            u32Cuts = (uint32_t)atoi(argv[++i]);
+        else if (!strcmp(argv[i], "-s") && (i + 1) < argc)
+            s_u32Rand = (uint32_t)strtoul(argv[++i], NULL, 0);
+        else
+            usage(argv[0]);
+    }
+
+    /* xorshift stays at 0 once there. */
+    if (s_u32Rand == 0)
+        s_u32Rand = 1;
+
+    /* A new chip, with the reference all erased as never written sectors read. */
+    memset(s_sNor.au8Mem, 0xFF, sizeof(s_sNor.au8Mem));
+    memset(s_au8Ref, 0xFF, sizeof(s_au8Ref));
+    s_sNor.i32OpsToCut = -1;
+
+    for (u32Cut = 0; u32Cut <= u32Cuts; u32Cut++)
+    {
+        if (ftl_mount(&sFtl) != 0)
+            goto exit_main;
+
+        if (ftl_check(&sFtl, -1, NULL) != 0)
+            goto exit_main;
+
+        /* The last round runs without a cut, then everything is checked once more. */
+        s_sNor.i32OpsToCut = (u32Cut < u32Cuts) ? (int32_t)(rand_next() % 600) : -1;
+        i32InFlight = -1;
+
+        for (i = 0; i < 3000; i++)
+        {
+            /* Now and then, the background collector of the board. */
+            if ((rand_next() % 16) == 0)
+            {
+                if ((nu_ftl_gc_step(&sFtl, CONFIG_NU_FTL_GC_MIN_FREE + 2) < 0) && !s_sNor.bDead)
+                {
+                    fprintf(stderr, "collection failed\n");
+                    goto exit_main;
+                }
+            }
+            else
+            {
+                u32Lba = lba_pick();
+                sector_fill(au8New, u32Lba, ++u32Gen);
+
+                if (nu_ftl_write(&sFtl, u32Lba, au8New, 1) == 0)
+                {
+                    memcpy(s_au8Ref[u32Lba], au8New, NU_FTL_SECTOR_SIZE);
+                }
+                else if (!s_sNor.bDead)
+                {
+                    fprintf(stderr, "write of sector %u failed with power on\n", (unsigned int)u32Lba);
+                    goto exit_main;
+                }
+                else
+                {
+                    i32InFlight = (int32_t)u32Lba;
+                }
+            }
+
+            if (s_sNor.bDead)
+                break;
+        }
+
+        if (sFtl.sStat.u32MaxEraseCnt > u32MaxEraseCnt)
+            u32MaxEraseCnt = sFtl.sStat.u32MaxEraseCnt;
+
+        nu_ftl_unmount(&sFtl);
+
+        /* Power back, remount and look. */
+        s_sNor.bDead = 0;
+        s_sNor.i32OpsToCut = -1;
+
+        if (ftl_mount(&sFtl) != 0)
+            goto exit_main;
+
+        if (ftl_check(&sFtl, i32InFlight, au8New) != 0)
+        {
+            fprintf(stderr, "after power cut %u\n", (unsigned int)u32Cut);
+            goto exit_main;
+        }
+
+        nu_ftl_unmount(&sFtl);
+    }
+
+exit_main:
+
+    nu_ftl_unmount(&sFtl);
+
+    printf("%u power cuts, %u writes, %u programs, %u erases, highest erase count %u\n",
+           (unsigned int)u32Cuts, (unsigned int)u32Gen,
+           (unsigned int)s_sNor.u32Progs, (unsigned int)s_sNor.u32Erases,
+           (unsigned int)u32MaxEraseCnt);
+
+    if (s_sNor.u32Violations)
+        printf("%u programs broke the NOR rules\n", (unsigned int)s_sNor.u32Violations);
+
+    if ((u32Cut <= u32Cuts) || s_sNor.u32Violations)
+    {
+        printf("FAIL\n");
+        return 1;
+    }
+
+    printf("PASS\n");
+
+    return 0;
+}
@@ -0,0 +1,81 @@
+#!/usr/bin/env python3
+#
+# SPDX-License-Identifier: Apache-2.0
+# Copyright (C) 2024 Nuvoton Technology Corp. All rights reserved.
+#
+# Build and run the host tests of tools/ with their fixtures in host_data/.
+#
+#   python3 nu_host_test.py [-t name] [--cc cc]
+#
+# Each test is built by the cc line of its header comment and must exit 0.
+# nu_predict_replay replays host_data/indev_800x480.log with a 20 ms
+# lookahead, and fails if the predicted RMS error is over PREDICT_MAX_RMS,
+# which is under the RMS error of the raw points, so the filter constants
+# of common/nu_predict.c must keep beating no prediction.
+#
+# Exit code is the number of failed tests.
+
+import argparse
+import os
+import subprocess
+import sys
+import tempfile
+
+TOOLS_DIR = os.path.dirname(os.path.abspath(__file__))
+
+# Raw 14.62 px, predicted 13.07 px at the time of writing.
+PREDICT_LOOKAHEAD_MS = 20
+PREDICT_MAX_RMS = 14.0
+
+# name: (sources, cc flags, arguments)
+HOST_TESTS = {
+    'nu_amp_draw_test':     (['nu_amp_draw_test.c', '../common/nu_amp_draw.c'],
+                             ['-pthread', '-I../common'], []),
+    'nu_font_stream_test':  (['nu_font_stream_test.c'],
+                             ['-I../common', '-Ihost_inc'], ['host_data/lato16.fnt']),
+    'nu_ftl_test':          (['nu_ftl_test.c'],
+                             ['-I../common'], []),
+    'nu_sfud_port_test':    (['nu_sfud_port_test.c'],
+                             ['-I../common', '-I../board/numaker-hmi-m2354', '-Ihost_inc'], []),
+    'nu_predict_replay':    (['nu_predict_replay.c', '../common/nu_predict.c', '-lm'],
+                             ['-I../common'],
+                             ['-l', str(PREDICT_LOOKAHEAD_MS), '-m', str(PREDICT_MAX_RMS),
+                              'host_data/indev_800x480.log']),
+}
+
+
+def run_test(cc, name, out_dir):
+    sources, flags, args = HOST_TESTS[name]
+    exe = os.path.join(out_dir, name)
+
+    build = subprocess.run([cc, '-O2'] + flags + ['-o', exe] + sources, cwd=TOOLS_DIR)
+    if build.returncode != 0:
+        print('%s: build failed' % name)
+        return False
+
+    result = subprocess.run([exe] + args, cwd=TOOLS_DIR)
+    print('%s: %s' % (name, 'PASS' if result.returncode == 0 else 'FAIL (exit %d)' % result.returncode))
+    return result.returncode == 0
+
+
+def main():
+    parser = argparse.ArgumentParser(description='Build and run the host tests.')
+    parser.add_argument('-t', '--test', action='append', choices=sorted(HOST_TESTS),
+                        help='run only this test, may be repeated')
+    parser.add_argument('--cc', default=os.environ.get('CC', 'cc'), help='host C compiler (default: $CC or cc)')
+    args = parser.parse_args()
+
+    failed = []
+    with tempfile.TemporaryDirectory() as out_dir:
+        for name in args.test or HOST_TESTS:
+            sys.stdout.flush()
+            if not run_test(args.cc, name, out_dir):
+                failed.append(name)
+
+    print('%d of %d host tests failed%s' % (len(failed), len(args.test or HOST_TESTS),
+                                           (': ' + ', '.join(failed)) if failed else ''))
+    sys.exit(len(failed))
+
+
+if __name__ == '__main__':
+    main()
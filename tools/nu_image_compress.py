@@ -0,0 +1,193 @@
+#!/usr/bin/env python3
+#
+# SPDX-License-Identifier: Apache-2.0
+# Copyright (C) 2024 Nuvoton Technology Corp. All rights reserved.
+#
+# Compress an image into band streams for common/nu_image_decoder.c.
+#
+#   python3 nu_image_compress.py -c lz4 bg.bin -o bg.nz
+#   python3 nu_image_compress.py -c rle --w 320 --h 240 --cf RGB565 bg.raw -o bg.nz
+#
+# The input is an LVGL v9 binary image, or raw pixels with --w/--h/--cf. The
+# output is the lv_image_header_t with LV_IMAGE_FLAGS_USER1 set, followed by
+# the stream. Every band of rows is compressed on its own, so the target can
+# inflate one band at a time into a small buffer.
+
+import argparse
+import struct
+import sys
+
+LV_IMAGE_HEADER_MAGIC = 0x19
+LV_IMAGE_HEADER = struct.Struct('<BBHHHHH')
+LV_IMAGE_FLAGS_USER1 = 0x0100
+
+STREAM_MAGIC = 0x535A554E   # "NUZS"
+STREAM_HEADER = struct.Struct('<IBxHHxxI')
+
+CODECS = {'lz4': 1, 'rle': 2}
+
+# name: (LV_COLOR_FORMAT_xxx, byte per pixel)
+COLOR_FORMATS = {
+    'L8':       (0x06, 1),
+    'I8':       (0x0A, 1),
+    'A8':       (0x0E, 1),
+    'RGB888':   (0x0F, 3),
+    'ARGB8888': (0x10, 4),
+    'XRGB8888': (0x11, 4),
+    'RGB565':   (0x12, 2),
+    'ARGB8565': (0x13, 3),
+}
+
+LZ4_MIN_MATCH = 4
+LZ4_LAST_LITERALS = 5
+LZ4_MFLIMIT = 12
+LZ4_MAX_OFFSET = 65535
+
+
+def _lz4_length(out, n):
+    while n >= 255:
+        out.append(255)
+        n -= 255
+    out.append(n)
+
+
+def _lz4_sequence(out, literals, offset, match_len):
+    lit = len(literals)
+    token = (min(lit, 15) << 4)
+    if offset:
+        token |= min(match_len - LZ4_MIN_MATCH, 15)
+    out.append(token)
+    if lit >= 15:
+        _lz4_length(out, lit - 15)
+    out += literals
+    if offset:
+        out += struct.pack('<H', offset)
+        if match_len - LZ4_MIN_MATCH >= 15:
+            _lz4_length(out, match_len - LZ4_MIN_MATCH - 15)
+
+
+def lz4_compress(src):
+    """Greedy LZ4 block compressor, output is valid LZ4 block format."""
+    n = len(src)
+    out = bytearray()
+    table = {}
+    anchor = 0
+    i = 0
+    while i < n - LZ4_MFLIMIT:
+        key = src[i:i + LZ4_MIN_MATCH]
+        cand = table.get(key)
+        table[key] = i
+        if cand is None or i - cand > LZ4_MAX_OFFSET:
+            i += 1
+            continue
+        m = LZ4_MIN_MATCH
+        while i + m < n - LZ4_LAST_LITERALS and src[cand + m] == src[i + m]:
+            m += 1
+        _lz4_sequence(out, src[anchor:i], i - cand, m)
+        i += m
+        anchor = i
+    _lz4_sequence(out, src[anchor:], 0, 0)
+    return bytes(out)
+
+
+def rle_compress(src, px):
+    """Pixel-wise RLE: 0x80|(n-1) + pixel for runs, (n-1) + pixels for literals."""
+    pixels = [src[i:i + px] for i in range(0, len(src), px)]
+    out = bytearray()
+    lit = []
+    i = 0
+    while i < len(pixels):
+        run = 1
+        while i + run < len(pixels) and run < 128 and pixels[i + run] == pixels[i]:
+            run += 1
+        if run >= 2:
+            while lit:
+                chunk, lit = lit[:128], lit[128:]
+                out.append(len(chunk) - 1)
+                out += b''.join(chunk)
+            out.append(0x80 | (run - 1))
+            out += pixels[i]
+            i += run
+        else:
+            lit.append(pixels[i])
+            i += 1
+    while lit:
+        chunk, lit = lit[:128], lit[128:]
+        out.append(len(chunk) - 1)
+        out += b''.join(chunk)
+    return bytes(out)
+
+
+def compress_stream(pixels, h, stride, px, codec, band_rows):
+    bands = []
+    for y in range(0, h, band_rows):
+        raw = pixels[y * stride:min(y + band_rows, h) * stride]
+        bands.append(lz4_compress(raw) if codec == 'lz4' else rle_compress(raw, px))
+
+    offsets = [0]
+    for b in bands:
+        offsets.append(offsets[-1] + len(b))
+
+    header = STREAM_HEADER.pack(STREAM_MAGIC, CODECS[codec], band_rows, len(bands),
+                                max(len(b) for b in bands))
+    return header + struct.pack('<%dI' % len(offsets), *offsets) + b''.join(bands)
+
+
+def parse_image(data, w=None, h=None, cf=None):
+    """Return (lv_image_header_t fields, pixel data)."""
+    if data[0] == LV_IMAGE_HEADER_MAGIC and w is None:
+        magic, cf_id, flags, w, h, stride, _ = LV_IMAGE_HEADER.unpack_from(data)
+        px = {v[0]: v[1] for v in COLOR_FORMATS.values()}.get(cf_id)
+        if px is None:
+            raise ValueError('color format 0x%02x is not supported' % cf_id)
+        return (cf_id, flags, w, h, stride or w * px, px), data[LV_IMAGE_HEADER.size:]
+    if w is None or h is None or cf not in COLOR_FORMATS:
+        raise ValueError('raw input needs --w, --h and --cf')
+    cf_id, px = COLOR_FORMATS[cf]
+    return (cf_id, 0, w, h, w * px, px), data
+
+
+def compress_image(data, codec, band_rows=0, w=None, h=None, cf=None):
+    """Return (lv_image_header_t bytes with USER1 set, stream)."""
+    (cf_id, flags, w, h, stride, px), pixels = parse_image(data, w, h, cf)
+    if len(pixels) < stride * h:
+        raise ValueError('image data is short: %d < %d' % (len(pixels), stride * h))
+    if band_rows <= 0:
+        band_rows = max(1, 4096 // stride)
+    stream = compress_stream(pixels, h, stride, px, codec, band_rows)
+    header = LV_IMAGE_HEADER.pack(LV_IMAGE_HEADER_MAGIC, cf_id, flags | LV_IMAGE_FLAGS_USER1,
+                                  w, h, stride, 0)
+    return header, stream
+
+
+def main():
+    parser = argparse.ArgumentParser(description='Compress an image into band streams.')
+    parser.add_argument('input', help='LVGL binary image, or raw pixels with --w/--h/--cf')
+    parser.add_argument('-o', '--output', required=True, help='output .nz file')
+    parser.add_argument('-c', '--codec', choices=sorted(CODECS), default='lz4')
+    parser.add_argument('-b', '--band-rows', type=int, default=0,
+                        help='rows per band (default: about 4 KB of pixels)')
+    parser.add_argument('--w', type=int, help='width of raw input')
+    parser.add_argument('--h', type=int, help='height of raw input')
+    parser.add_argument('--cf', choices=sorted(COLOR_FORMATS), help='color format of raw input')
+    args = parser.parse_args()
+
+    with open(args.input, 'rb') as f:
+        data = f.read()
+
+    try:
+        header, stream = compress_image(data, args.codec, args.band_rows, args.w, args.h, args.cf)
+    except ValueError as e:
+        print(e, file=sys.stderr)
+        sys.exit(1)
+
+    with open(args.output, 'wb') as f:
+        f.write(header + stream)
+
+    raw = LV_IMAGE_HEADER.unpack(header)
+    print('%s: %dx%d, %d -> %d bytes (%.1f%%)' % (args.output, raw[3], raw[4], raw[5] * raw[4],
+          len(header) + len(stream), 100.0 * (len(header) + len(stream)) / (raw[5] * raw[4])))
+
+
+if __name__ == '__main__':
+    main()
@@ -0,0 +1,109 @@
+#!/usr/bin/env python3
+#
+# SPDX-License-Identifier: Apache-2.0
+# Copyright (C) 2024 Nuvoton Technology Corp. All rights reserved.
+#
+# Summarize touch-to-photon latency from the console log of common/nu_latprobe.c,
+# and check it against a baseline.
+#
+#   python3 nu_latency_report.py uart.log --save base.json
+#   python3 nu_latency_report.py uart.log --baseline base.json --tolerance 10
+#
+# Build the firmware with CONFIG_NU_LATPROBE, CONFIG_NU_LATPROBE_SYNTH and
+# CONFIG_NU_LATPROBE_DUMP_PERIOD, and capture the console. The last dump in the
+# log is used. Exit code is 1 if avg or p99 grows beyond the tolerance.
+
+import argparse
+import json
+import re
+import sys
+
+RE_SAMPLES = re.compile(r'\[latprobe\] samples (\d+), dropped (\d+)')
+RE_TOTAL = re.compile(r'\[latprobe\] total us: min (\d+), avg (\d+), p50 (\d+), p99 (\d+), max (\d+)')
+RE_STAGE = re.compile(r'\[latprobe\] stage avg us: irq-read (\d+), read-flush (\d+), flush (\d+)')
+RE_HIST = re.compile(r'\[latprobe\] hist (\d+) (\d+)')
+
+CHECKED = ('avg', 'p99')
+
+
+def parse(lines):
+    dump = None
+    for line in lines:
+        m = RE_SAMPLES.search(line)
+        if m:
+            # A new dump starts.
+            dump = {'samples': int(m.group(1)), 'dropped': int(m.group(2)), 'hist': {}}
+            continue
+        if dump is None:
+            continue
+        m = RE_TOTAL.search(line)
+        if m:
+            dump.update(zip(('min', 'avg', 'p50', 'p99', 'max'), map(int, m.groups())))
+            continue
+        m = RE_STAGE.search(line)
+        if m:
+            dump.update(zip(('irq_read', 'read_flush', 'flush'), map(int, m.groups())))
+            continue
+        m = RE_HIST.search(line)
+        if m:
+            dump['hist'][int(m.group(1))] = int(m.group(2))
+    return dump
+
+
+def print_report(dump):
+    print('samples %d, dropped %d' % (dump['samples'], dump['dropped']))
+    if not dump['samples']:
+        return
+    print('total us: min %d, avg %d, p50 %d, p99 %d, max %d' %
+          (dump['min'], dump['avg'], dump['p50'], dump['p99'], dump['max']))
+    print('stage avg us: irq-read %d, read-flush %d, flush %d' %
+          (dump['irq_read'], dump['read_flush'], dump['flush']))
+    peak = max(dump['hist'].values())
+    for bucket in sorted(dump['hist']):
+        count = dump['hist'][bucket]
+        print('%8d us %6d %s' % (bucket, count, '#' * max(1, count * 50 // peak)))
+
+
+def compare(dump, base, tolerance):
+    failed = False
+    for key in CHECKED:
+        limit = base[key] * (100 + tolerance) / 100
+        state = 'ok'
+        if dump[key] > limit:
+            state = 'REGRESSION'
+            failed = True
+        print('%-4s %8d us, baseline %8d us, limit %8d us: %s' % (key, dump[key], base[key], limit, state))
+    return failed
+
+
+def main():
+    parser = argparse.ArgumentParser(description='Touch-to-photon latency report')
+    parser.add_argument('log', help='console log with [latprobe] lines')
+    parser.add_argument('--save', metavar='JSON', help='save the result as baseline')
+    parser.add_argument('--baseline', metavar='JSON', help='compare with a saved baseline')
+    parser.add_argument('--tolerance', type=float, default=10, help='allowed growth in percent (default 10)')
+    args = parser.parse_args()
+
+    with open(args.log, errors='replace') as f:
+        dump = parse(f)
+
+    if dump is None:
+        sys.exit('no [latprobe] dump in %s' % args.log)
+
+    print_report(dump)
+
+    if args.save:
+        with open(args.save, 'w') as f:
+            json.dump(dump, f, indent=2)
+
+    if args.baseline:
+        if not dump['samples']:
+            sys.exit('no samples to compare')
+        with open(args.baseline) as f:
+            base = json.load(f)
+        if compare(dump, base, args.tolerance):
+            sys.exit(1)
+
+
+if __name__ == '__main__':
+    main()
@@ -0,0 +1,249 @@
+/*
+ * SPDX-License-Identifier: Apache-2.0
+ * Copyright (C) 2024 Nuvoton Technology Corp. All rights reserved.
+ *
+ * Replay recorded pointer traces through common/nu_predict.c on host, and
+ * measure the error of the predicted point against where the pointer really
+ * was after the lookahead.
+ *
+ *   cc -O2 -I../common -o nu_predict_replay nu_predict_replay.c ../common/nu_predict.c -lm
+ *   ./nu_predict_replay -l 20 uart.log [more.log ...]
+ *   ./nu_predict_replay -s > synth.log
+ *
+ * Record a trace by building the firmware with CONFIG_NU_INDEV_PREDICT and
+ * CONFIG_NU_INDEV_PREDICT_TRACE, and capture the console while dragging.
+ * "[indev] ms x y state" lines are read, and "ms,x,y,state" lines as well.
+ * Set the filter by -DCONFIG_NU_PREDICT_ALPHA=... as for the firmware.
+ *
+ * nu_host_test.py runs "-l 20 -m <rms> host_data/indev_800x480.log", with
+ * the bound under the RMS error of the raw points.
+ *
+ * Exit code is 1 if -m is given and the predicted RMS error is larger.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include "nu_predict.h"
+
+typedef struct
+{
+    uint32_t u32Ms;
+    int32_t i32X;
+    int32_t i32Y;
+    int32_t i32Pressed;
+} S_SAMPLE;
+
+typedef struct
+{
+    uint32_t u32Count;
+    double dSum;
+    double dSqSum;
+    double dMax;
+} S_ERROR;
+
+static S_SAMPLE *s_psSamples;
+static uint32_t s_u32Samples, s_u32Capacity;
+
+static void sample_add(uint32_t u32Ms, int32_t i32X, int32_t i32Y, int32_t i32Pressed)
+{
+    if (s_u32Samples == s_u32Capacity)
+    {
+        s_u32Capacity = s_u32Capacity ? s_u32Capacity * 2 : 1024;
+        s_psSamples = realloc(s_psSamples, s_u32Capacity * sizeof(S_SAMPLE));
+        if (s_psSamples == NULL)
+        {
+            fprintf(stderr, "out of memory\n");
+            exit(2);
+        }
+    }
+
+    s_psSamples[s_u32Samples].u32Ms = u32Ms;
+    s_psSamples[s_u32Samples].i32X = i32X;
+    s_psSamples[s_u32Samples].i32Y = i32Y;
+    s_psSamples[s_u32Samples].i32Pressed = i32Pressed;
+    s_u32Samples++;
+}
+
+static int trace_load(const char *pcPath)
+{
+    char acLine[256];
+    FILE *fp = fopen(pcPath, "r");
+    unsigned int u32Ms;
+    int i32X, i32Y, i32Pressed;
+
+    if (fp == NULL)
+    {
+        perror(pcPath);
+        return -1;
+    }
+
+    while (fgets(acLine, sizeof(acLine), fp))
+    {
+        char *pcTag = strstr(acLine, "[indev] ");
+
+        if (pcTag && (sscanf(pcTag + 8, "%u %d %d %d", &u32Ms, &i32X, &i32Y, &i32Pressed) == 4))
+            sample_add(u32Ms, i32X, i32Y, i32Pressed);
+        else if (sscanf(acLine, "%u,%d,%d,%d", &u32Ms, &i32X, &i32Y, &i32Pressed) == 4)
+            sample_add(u32Ms, i32X, i32Y, i32Pressed);
+    }
+
+    /* A release between files, strokes do not continue across them. */
+    if (s_u32Samples && s_psSamples[s_u32Samples - 1].i32Pressed)
+        sample_add(s_psSamples[s_u32Samples - 1].u32Ms, s_psSamples[s_u32Samples - 1].i32X, s_psSamples[s_u32Samples - 1].i32Y, 0);
+
+    fclose(fp);
+
+    return 0;
+}
+
+/* Position at u32Ms interpolated in the stroke holding sample u32Idx, -1 past its end. */
+static int trace_position(uint32_t u32Idx, uint32_t u32Ms, double *pdX, double *pdY)
+{
+    uint32_t i;
+
+    for (i = u32Idx; (i + 1) < s_u32Samples && s_psSamples[i + 1].i32Pressed; i++)
+    {
+        const S_SAMPLE *psA = &s_psSamples[i];
+        const S_SAMPLE *psB = &s_psSamples[i + 1];
+
+        if (psB->u32Ms >= u32Ms)
+        {
+            double dT = (psB->u32Ms == psA->u32Ms) ? 1.0 : (double)(u32Ms - psA->u32Ms) / (psB->u32Ms - psA->u32Ms);
+
+            *pdX = psA->i32X + (psB->i32X - psA->i32X) * dT;
+            *pdY = psA->i32Y + (psB->i32Y - psA->i32Y) * dT;
+            return 0;
+        }
+    }
+
+    return -1;
+}
+
+static void error_add(S_ERROR *psError, double dX, double dY, double dRefX, double dRefY)
+{
+    double dErr = sqrt((dX - dRefX) * (dX - dRefX) + (dY - dRefY) * (dY - dRefY));
+
+    psError->u32Count++;
+    psError->dSum += dErr;
+    psError->dSqSum += dErr * dErr;
+    if (dErr > psError->dMax)
+        psError->dMax = dErr;
+}
+
+static double error_rms(const S_ERROR *psError)
+{
+    return psError->u32Count ? sqrt(psError->dSqSum / psError->u32Count) : 0;
+}
+
+static void error_print(const char *pcName, const S_ERROR *psError)
+{
+    printf("%-10s samples %6u, avg %6.2f px, rms %6.2f px, max %6.2f px\n", pcName, psError->u32Count,
+           psError->u32Count ? psError->dSum / psError->u32Count : 0, error_rms(psError), psError->dMax);
+}
+
+/* Drags with easing, a turn and a fling, with touch noise, sampled at 60 Hz. */
+static void trace_synth(void)
+{
+    uint32_t u32Ms = 0;
+    int i, j;
+
+    srand(1);
+
+    for (i = 0; i < 8; i++)
+    {
+        int32_t i32X0 = 40 + (i * 37) % 200, i32Y0 = 60 + (i * 53) % 150;
+        int32_t i32Dx = (i & 1) ? 300 : -250, i32Dy = (i & 2) ? 120 : -80;
+        int i32Steps = 20 + i * 4;
+
+        for (j = 0; j <= i32Steps; j++)
+        {
+            double dT = (double)j / i32Steps;
+            double dS = (i == 3) ? sin(dT * 3.14159 * 2) * 0.5 : dT * dT * (3 - 2 * dT);
+
+            printf("[indev] %u %d %d 1\n", u32Ms,
+                   (int)(i32X0 + i32Dx * dS + (rand() % 3) - 1),
+                   (int)(i32Y0 + i32Dy * dS + (rand() % 3) - 1));
+            u32Ms += 16 + (rand() % 3);
+        }
+
+        printf("[indev] %u 0 0 0\n", u32Ms);
+        u32Ms += 300;
+    }
+}
+
+static void usage(const char *pcName)
+{
+    fprintf(stderr, "usage: %s [-l lookahead_ms] [-m max_rms_px] trace.log ...\n", pcName);
+    fprintf(stderr, "       %s -s\n", pcName);
+    exit(2);
+}
+
+int main(int argc, char *argv[])
+{
+    S_NU_PREDICT sPredict;
+    S_ERROR sPredicted = { 0 }, sRaw = { 0 };
+    uint32_t u32LookaheadMs = 20;
+    double dMaxRms = -1;
+    int i;
+
+    for (i = 1; i < argc && argv[i][0] == '-'; i++)
+    {
+        if (!strcmp(argv[i], "-s"))
+        {
+            trace_synth();
+            return 0;
+        }
+        else if (!strcmp(argv[i], "-l") && (i + 1) < argc)
+            u32LookaheadMs = (uint32_t)atoi(argv[++i]);
+        else if (!strcmp(argv[i], "-m") && (i + 1) < argc)
+            dMaxRms = atof(argv[++i]);
+        else
+            usage(argv[0]);
+    }
+
+    if (i == argc)
+        usage(argv[0]);
+
+    for (; i < argc; i++)
+        if (trace_load(argv[i]) < 0)
+            return 2;
+
+    nu_predict_init(&sPredict, u32LookaheadMs);
+
+    for (i = 0; i < (int)s_u32Samples; i++)
+    {
+        const S_SAMPLE *psSample = &s_psSamples[i];
+        int32_t i32X = psSample->i32X, i32Y = psSample->i32Y;
+        double dRefX, dRefY;
+
+        /* The same as input_predict() of common/lv_port_indev.c. */
+        if (!psSample->i32Pressed)
+        {
+            nu_predict_reset(&sPredict);
+            continue;
+        }
+
+        nu_predict_update(&sPredict, psSample->u32Ms, &i32X, &i32Y);
+
+        if (trace_position(i, psSample->u32Ms + u32LookaheadMs, &dRefX, &dRefY) < 0)
+            continue;
+
+        error_add(&sPredicted, i32X, i32Y, dRefX, dRefY);
+        error_add(&sRaw, psSample->i32X, psSample->i32Y, dRefX, dRefY);
+    }
+
+    printf("lookahead %u ms, alpha %d/256, beta %d/256\n", u32LookaheadMs, CONFIG_NU_PREDICT_ALPHA, CONFIG_NU_PREDICT_BETA);
+    error_print("raw", &sRaw);
+    error_print("predicted", &sPredicted);
+
+    free(s_psSamples);
+
+    if ((dMaxRms >= 0) && (error_rms(&sPredicted) > dMaxRms))
+    {
+        printf("rms %.2f px over %.2f px\n", error_rms(&sPredicted), dMaxRms);
+        return 1;
+    }
+
+    return 0;
+}
@@ -0,0 +1,560 @@
+/*
+ * SPDX-License-Identifier: Apache-2.0
+ * Copyright (C) 2024 Nuvoton Technology Corp. All rights reserved.
+ *
+ * Run board/numaker-hmi-m2354/lv_port/sfud_port.c on host against a mock of
+ * the SPI driver and a serial flash, and check the bus phases of a read.
+ *
+ *   cc -O2 -I../common -I../board/numaker-hmi-m2354 -Ihost_inc -o nu_sfud_port_test nu_sfud_port_test.c
+ *   ./nu_sfud_port_test
+ *
+ * The flash picks the read command from a W25Q style SFDP table, by 1-2-2
+ * and 1-4-4 fast read, and reads by QSPI and by plain SPI sizes around
+ * CONFIG_SPI_USE_PDMA_MIN_THRESHOLD, with the scheduler started and not.
+ * Each read must send the instruction on its lines, the address big-endian
+ * and dummy_cycles * address_lines / 8 bytes of 0xFF on the address lines,
+ * then receive the data on the data lines, all under one SS low. Before the
+ * scheduler starts no phase may reach the PDMA threshold.
+ *
+ * Exit code is 0 if every read had the right phases and data.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "nu_bitutil.h"
+
+/* Keep the headers of the board out, the mocks below stand for them. */
+#define __LV_GLUE_H__
+#define __DRV_SPI_H__
+#define _SFUD_CFG_H_
+
+#define CONFIG_SPI_USE_PDMA
+#define CONFIG_SPI_USE_PDMA_MIN_THRESHOLD   (128)
+#define SFUD_USING_QSPI
+
+enum
+{
+    SFUD_W25_DEVICE_INDEX = 0,
+};
+
+/* SPI and QSPI controllers, only the line mode is kept. */
+typedef struct
+{
+    int bDual;
+    int bQuad;
+    int bOutput;
+} SPI_T;
+typedef SPI_T QSPI_T;
+
+static SPI_T s_asSpi[5];
+
+#define QSPI0       (&s_asSpi[0])
+#define SPI0        (&s_asSpi[1])
+#define SPI1        (&s_asSpi[2])
+#define SPI2        (&s_asSpi[3])
+#define SPI3        (&s_asSpi[4])
+
+#define PDMA_QSPI0_TX   1
+#define PDMA_QSPI0_RX   2
+#define PDMA_SPI0_TX    3
+#define PDMA_SPI0_RX    4
+#define PDMA_SPI1_TX    5
+#define PDMA_SPI1_RX    6
+#define PDMA_SPI2_TX    7
+#define PDMA_SPI2_RX    8
+#define PDMA_SPI3_TX    9
+#define PDMA_SPI3_RX    10
+
+#define SPI_MASTER      0
+#define SPI_MODE_0      0
+#define SPI_Open(spi, mode, type, width, clk)   ((void)(spi))
+#define SPI_DisableAutoSS(spi)                  ((void)(spi))
+#define SPI_SET_MSB_FIRST(spi)                  ((void)(spi))
+#define SPI_SET_SS_HIGH(spi)                    ((void)(spi))
+
+#define QSPI_ENABLE_DUAL_OUTPUT_MODE(q)     ((q)->bDual = 1, (q)->bOutput = 1)
+#define QSPI_ENABLE_DUAL_INPUT_MODE(q)      ((q)->bDual = 1, (q)->bOutput = 0)
+#define QSPI_ENABLE_QUAD_OUTPUT_MODE(q)     ((q)->bQuad = 1, (q)->bOutput = 1)
+#define QSPI_ENABLE_QUAD_INPUT_MODE(q)      ((q)->bQuad = 1, (q)->bOutput = 0)
+#define QSPI_DISABLE_DUAL_MODE(q)           ((q)->bDual = 0)
+#define QSPI_DISABLE_QUAD_MODE(q)           ((q)->bQuad = 0)
+
+#define __disable_irq()
+#define __enable_irq()
+
+/* FreeRTOS */
+typedef void *SemaphoreHandle_t;
+#define taskSCHEDULER_NOT_STARTED   1
+#define taskSCHEDULER_RUNNING       2
+
+static int s_i32SchedState = taskSCHEDULER_NOT_STARTED;
+static int s_i32SemDone;
+
+static int xTaskGetSchedulerState(void)
+{
+    return s_i32SchedState;
+}
+
+static SemaphoreHandle_t xSemaphoreCreateBinary(void)
+{
+    return &s_i32SemDone;
+}
+
+/* lv_port/drv_spi.h */
+struct nu_spi
+{
+    SPI_T *base;
+    int32_t  ss_pin;
+    uint32_t dummy;
+    int16_t pdma_perp_tx;
+    int8_t  pdma_chanid_tx;
+    int16_t pdma_perp_rx;
+    int8_t  pdma_chanid_rx;
+    volatile uint32_t m_psSemBus;
+    SemaphoreHandle_t m_psSemDone;
+};
+
+void nu_spi_ss_set(struct nu_spi *psNuSPI, int level);
+int nu_spi_xfer(struct nu_spi *psNuSPI, const void *tx, void *rx, int length);
+int nu_spi_send_then_recv(SPI_T *spi, const uint8_t *tx, int tx_len, uint8_t *rx, int rx_len, int dw);
+int nu_spi_send_then_recv_pdma(struct nu_spi *psNuSPI, const uint8_t *tx, int tx_len, uint8_t *rx, int rx_len);
+
+#include "../board/numaker-hmi-m2354/lv_port/sfud_port.c"
+
+#define FLASH_SIZE      (64 * 1024)
+#define SFDP_BFPT_PTR   0x30
+#define PHASE_MAX       64
+
+typedef struct
+{
+    int i32Lines;
+    int bOutput;
+    int bPdma;                  // At or over the threshold, the driver takes PDMA
+    int i32Len;
+    uint8_t au8Tx[16];          // Head of what was sent
+} S_PHASE;
+
+typedef struct
+{
+    int bSsLow;
+    int i32Phases;
+    S_PHASE asPhase[PHASE_MAX];
+    uint32_t u32Addr;           // Address of the data phases of the read under way
+    uint32_t u32Errors;
+} S_BUS;
+
+static S_BUS s_sBus;
+static uint8_t s_au8Flash[FLASH_SIZE];
+static uint8_t s_au8Sfdp[0x100];
+
+static void bus_error(const char *pcMsg)
+{
+    fprintf(stderr, "%s\n", pcMsg);
+    s_sBus.u32Errors++;
+}
+
+static int spi_lines(SPI_T *spi)
+{
+    if (spi->bDual && spi->bQuad)
+    {
+        bus_error("dual and quad mode both on");
+        return 0;
+    }
+
+    return spi->bQuad ? 4 : (spi->bDual ? 2 : 1);
+}
+
+void nu_spi_ss_set(struct nu_spi *psNuSPI, int level)
+{
+    if (level == !s_sBus.bSsLow)
+        bus_error(level ? "SS released twice" : "SS asserted twice");
+
+    s_sBus.bSsLow = !level;
+}
+
+int nu_spi_xfer(struct nu_spi *psNuSPI, const void *tx, void *rx, int length)
+{
+    S_PHASE *psPhase;
+
+    if (!s_sBus.bSsLow)
+        bus_error("transfer with SS high");
+
+    if (s_sBus.i32Phases == PHASE_MAX)
+    {
+        bus_error("too many phases");
+        return -1;
+    }
+
+    psPhase = &s_sBus.asPhase[s_sBus.i32Phases++];
+    psPhase->i32Lines = spi_lines(psNuSPI->base);
+    psPhase->bOutput = (psPhase->i32Lines == 1) || psNuSPI->base->bOutput;    // Single line is full duplex
+    psPhase->bPdma = (length >= CONFIG_SPI_USE_PDMA_MIN_THRESHOLD);
+    psPhase->i32Len = length;
+
+    if (tx)
+        memcpy(psPhase->au8Tx, tx, (length < (int)sizeof(psPhase->au8Tx)) ? length : (int)sizeof(psPhase->au8Tx));
+
+    /* Address and dummy phases are out before the first data phase. */
+    if (rx)
+    {
+        memcpy(rx, &s_au8Flash[s_sBus.u32Addr % FLASH_SIZE], length);
+        s_sBus.u32Addr += length;
+    }
+
+    return 0;
+}
+
+/* The commands of SFDP discovery, and the data of READ. */
+static void flash_command(const uint8_t *tx, int tx_len, uint8_t *rx, int rx_len)
+{
+    uint32_t u32Addr;
+
+    if (!tx || (tx_len < 1))
+        return;
+
+    switch (tx[0])
+    {
+    case SFUD_SFDP_CMD_READ:
+        if (tx_len != 5)
+            bus_error("SFDP read is not 5Ah, 3 address bytes and a dummy byte");
+        u32Addr = ((uint32_t)tx[1] << 16) | ((uint32_t)tx[2] << 8) | tx[3];
+        if (rx && (u32Addr + rx_len <= sizeof(s_au8Sfdp)))
+            memcpy(rx, &s_au8Sfdp[u32Addr], rx_len);
+        break;
+
+    case SFUD_CMD_READ_DATA:
+        u32Addr = ((uint32_t)tx[1] << 16) | ((uint32_t)tx[2] << 8) | tx[3];
+        if (rx)
+            memcpy(rx, &s_au8Flash[u32Addr % FLASH_SIZE], rx_len);
+        break;
+
+    default:
+        if (rx)
+            memset(rx, 0, rx_len);
+        break;
+    }
+}
+
+static int s_i32PolledCalls;
+static int s_i32PdmaCalls;
+
+int nu_spi_send_then_recv(SPI_T *spi, const uint8_t *tx, int tx_len, uint8_t *rx, int rx_len, int dw)
+{
+    s_i32PolledCalls++;
+
+    if (spi_lines(spi) != 1)
+        bus_error("single-line command in dual or quad mode");
+
+    flash_command(tx, tx_len, rx, rx_len);
+
+    return 0;
+}
+
+/* Same phases as lv_port/drv_spi.c. */
+int nu_spi_send_then_recv_pdma(struct nu_spi *psNuSPI, const uint8_t *tx, int tx_len, uint8_t *rx, int rx_len)
+{
+    uint8_t au8Rx[4096];
+
+    s_i32PdmaCalls++;
+
+    if (psNuSPI->m_psSemDone == NULL)
+        bus_error("PDMA transfer without a completion semaphore");
+
+    if (rx_len > (int)sizeof(au8Rx))
+    {
+        bus_error("read too long for the mock");
+        return -1;
+    }
+
+    nu_spi_ss_set(psNuSPI, 0);
+
+    if (tx && (tx_len > 0))
+        nu_spi_xfer(psNuSPI, tx, NULL, tx_len);
+
+    if (rx && (rx_len > 0))
+        nu_spi_xfer(psNuSPI, NULL, au8Rx, rx_len);
+
+    nu_spi_ss_set(psNuSPI, 1);
+
+    flash_command(tx, tx_len, rx, rx_len);
+
+    return 0;
+}
+
+const sfud_flash *sfud_get_device(size_t index)
+{
+    return NULL;
+}
+
+sfud_err sfud_read(const sfud_flash *flash, uint32_t addr, size_t size, uint8_t *data)
+{
+    return SFUD_ERR_NOT_FOUND;
+}
+
+sfud_err sfud_erase(const sfud_flash *flash, uint32_t addr, size_t size)
+{
+    return SFUD_ERR_NOT_FOUND;
+}
+
+sfud_err sfud_write(const sfud_flash *flash, uint32_t addr, size_t size, const uint8_t *data)
+{
+    return SFUD_ERR_NOT_FOUND;
+}
+
+static void put32_le(uint8_t *pu8Buf, uint32_t u32Val)
+{
+    pu8Buf[0] = (uint8_t)u32Val;
+    pu8Buf[1] = (uint8_t)(u32Val >> 8);
+    pu8Buf[2] = (uint8_t)(u32Val >> 16);
+    pu8Buf[3] = (uint8_t)(u32Val >> 24);
+}
+
+/* SFDP of a W25Q64, QE set in advance (QER 0) so no status writes are needed. */
+static void sfdp_init(void)
+{
+    memset(s_au8Sfdp, 0xFF, sizeof(s_au8Sfdp));
+
+    put32_le(&s_au8Sfdp[0], SFUD_SFDP_SIGNATURE);
+    s_au8Sfdp[4] = 0x06;                    // JESD216B
+    s_au8Sfdp[5] = 0x01;
+    s_au8Sfdp[6] = 0x00;                    // One parameter header
+    s_au8Sfdp[8] = 0x00;                    // BFPT
+    s_au8Sfdp[9] = 0x06;
+    s_au8Sfdp[10] = 0x01;
+    s_au8Sfdp[11] = 16;                     // DWORDs
+    s_au8Sfdp[12] = SFDP_BFPT_PTR;
+    s_au8Sfdp[13] = 0x00;
+    s_au8Sfdp[14] = 0x00;
+
+    put32_le(&s_au8Sfdp[SFDP_BFPT_PTR + 0], 0xFFF920E5);    // 1-1-2, 1-2-2, 1-4-4, 1-1-4
+    put32_le(&s_au8Sfdp[SFDP_BFPT_PTR + 4], 0x03FFFFFF);    // 64 Mbit
+    put32_le(&s_au8Sfdp[SFDP_BFPT_PTR + 8], 0x6B08EB44);    // 1-4-4 EBh 4+2, 1-1-4 6Bh 8
+    put32_le(&s_au8Sfdp[SFDP_BFPT_PTR + 12], 0xBB423B08);   // 1-1-2 3Bh 8, 1-2-2 BBh 2+2
+    put32_le(&s_au8Sfdp[SFDP_BFPT_PTR + 56], 0x00000000);   // DWORD15, QER 0
+}
+
+static int check_qspi_read(sfud_flash *psFlash, uint32_t u32Addr, int i32Size, int bSched)
+{
+    const sfud_qspi_read_cmd_format *psFmt = &psFlash->read_cmd_format;
+    static uint8_t au8Buf[8192];
+    int i32AddrBytes = psFmt->address_size / 8;
+    int i32DummyBytes = (psFmt->dummy_cycles * psFmt->address_lines) / 8;
+    int i32Got = 0, i;
+    uint32_t u32Errors = s_sBus.u32Errors;
+    char acMsg[128];
+
+    s_i32SchedState = bSched ? taskSCHEDULER_RUNNING : taskSCHEDULER_NOT_STARTED;
+    s_sBus.i32Phases = 0;
+    s_sBus.u32Addr = u32Addr;
+    memset(au8Buf, 0, sizeof(au8Buf));
+
+    if (psFlash->spi.qspi_read(&psFlash->spi, u32Addr, &psFlash->read_cmd_format, au8Buf, i32Size) != SFUD_SUCCESS)
+    {
+        bus_error("qspi_read failed");
+        goto exit_check_qspi_read;
+    }
+
+    if (s_sBus.bSsLow)
+        bus_error("SS left low");
+
+    if (spi_lines(QSPI0) != 1)
+        bus_error("lines not back to single");
+
+    if (s_sBus.i32Phases < 3)
+    {
+        bus_error("fewer than 3 phases");
+        goto exit_check_qspi_read;
+    }
+
+    /* Instruction */
+    if ((s_sBus.asPhase[0].i32Len != 1) || (s_sBus.asPhase[0].au8Tx[0] != psFmt->instruction) ||
+            (s_sBus.asPhase[0].i32Lines != psFmt->instruction_lines) || !s_sBus.asPhase[0].bOutput)
+        bus_error("instruction phase");
+
+    /* Address and dummy */
+    if ((s_sBus.asPhase[1].i32Len != i32AddrBytes + i32DummyBytes) ||
+            (s_sBus.asPhase[1].i32Lines != psFmt->address_lines) || !s_sBus.asPhase[1].bOutput)
+        bus_error("address phase");
+
+    for (i = 0; i < i32AddrBytes; i++)
+    {
+        if (s_sBus.asPhase[1].au8Tx[i] != (uint8_t)(u32Addr >> ((i32AddrBytes - 1 - i) * 8)))
+            bus_error("address not big-endian");
+    }
+
+    for (i = i32AddrBytes; i < i32AddrBytes + i32DummyBytes; i++)
+    {
+        if (s_sBus.asPhase[1].au8Tx[i] != 0xFF)
+            bus_error("dummy byte is not FFh");
+    }
+
+    /* Data */
+    for (i = 2; i < s_sBus.i32Phases; i++)
+    {
+        S_PHASE *psPhase = &s_sBus.asPhase[i];
+
+        if ((psPhase->i32Lines != psFmt->data_lines) || ((psPhase->i32Lines > 1) && psPhase->bOutput))
+            bus_error("data phase not on input data lines");
+
+        if (psPhase->bPdma && !bSched)
+            bus_error("PDMA data phase before the scheduler started");
+
+        i32Got += psPhase->i32Len;
+    }
+
+    if (bSched && (s_sBus.i32Phases != 3))
+        bus_error("data in more than one phase with the scheduler running");
+
+    if (bSched && (s_sBus.asPhase[2].bPdma != (i32Size >= CONFIG_SPI_USE_PDMA_MIN_THRESHOLD)))
+        bus_error("data phase not by PDMA at the threshold");
+
+    if ((i32Got != i32Size) || memcmp(au8Buf, &s_au8Flash[u32Addr % FLASH_SIZE], i32Size))
+        bus_error("data differs from the flash");
+
+exit_check_qspi_read:
+
+    if (s_sBus.u32Errors != u32Errors)
+    {
+        snprintf(acMsg, sizeof(acMsg), "  in %02Xh %d-%d-%d addr 0x%06x size %d, scheduler %s",
+                 psFmt->instruction, psFmt->instruction_lines, psFmt->address_lines, psFmt->data_lines,
+                 (unsigned int)u32Addr, i32Size, bSched ? "running" : "not started");
+        fprintf(stderr, "%s\n", acMsg);
+        return -1;
+    }
+
+    return 0;
+}
+
+static int check_spi_read(sfud_flash *psFlash, uint32_t u32Addr, int i32Size, int bSched)
+{
+    static uint8_t au8Buf[4096];
+    uint8_t au8Cmd[4] = { SFUD_CMD_READ_DATA, (uint8_t)(u32Addr >> 16), (uint8_t)(u32Addr >> 8), (uint8_t)u32Addr };
+    int i32Polled = s_i32PolledCalls, i32Pdma = s_i32PdmaCalls;
+    uint32_t u32Errors = s_sBus.u32Errors;
+
+    s_i32SchedState = bSched ? taskSCHEDULER_RUNNING : taskSCHEDULER_NOT_STARTED;
+    s_sBus.i32Phases = 0;
+    s_sBus.u32Addr = u32Addr;
+    memset(au8Buf, 0, sizeof(au8Buf));
+
+    if (psFlash->spi.wr(&psFlash->spi, au8Cmd, sizeof(au8Cmd), au8Buf, i32Size) != SFUD_SUCCESS)
+        bus_error("spi_write_read failed");
+
+    if (bSched && ((s_i32PdmaCalls != i32Pdma + 1) || (s_i32PolledCalls != i32Polled)))
+        bus_error("read not through the PDMA path with the scheduler running");
+
+    if (!bSched && ((s_i32PolledCalls != i32Polled + 1) || (s_i32PdmaCalls != i32Pdma)))
+        bus_error("read not polled before the scheduler started");
+
+    if (bSched && ((s_sBus.i32Phases != 2) || (s_sBus.asPhase[0].i32Len != sizeof(au8Cmd)) ||
+                   (s_sBus.asPhase[1].bPdma != (i32Size >= CONFIG_SPI_USE_PDMA_MIN_THRESHOLD))))
+        bus_error("PDMA path phases");
+
+    if (memcmp(au8Buf, &s_au8Flash[u32Addr], i32Size))
+        bus_error("data differs from the flash");
+
+    if (s_sBus.u32Errors != u32Errors)
+    {
+        fprintf(stderr, "  in 03h addr 0x%06x size %d, scheduler %s\n",
+                (unsigned int)u32Addr, i32Size, bSched ? "running" : "not started");
+        return -1;
+    }
+
+    return 0;
+}
+
+int main(int argc, char *argv[])
+{
+    static const int ai32Size[] =
+    {
+        1, 2,
+        CONFIG_SPI_USE_PDMA_MIN_THRESHOLD - 2,
+        CONFIG_SPI_USE_PDMA_MIN_THRESHOLD - 1,
+        CONFIG_SPI_USE_PDMA_MIN_THRESHOLD,
+        CONFIG_SPI_USE_PDMA_MIN_THRESHOLD + 1,
+        2 * CONFIG_SPI_USE_PDMA_MIN_THRESHOLD - 1,
+        2 * CONFIG_SPI_USE_PDMA_MIN_THRESHOLD,
+        4096,
+    };
+    static const uint8_t au8Width[] = { 1, 2, 4 };
+    static const uint8_t au8Ins[] = { SFUD_CMD_READ_DATA, 0xBB, 0xEB };
+    static const uint8_t au8Dummy[] = { 0, 4, 6 };
+    sfud_flash sFlash;
+    uint32_t u32Checks = 0, u32Fails = 0, u32Addr;
+    int i, j, bSched, b4Byte;
+
+    for (i = 0; i < FLASH_SIZE; i++)
+        s_au8Flash[i] = (uint8_t)((i * 7) ^ (i >> 8));
+
+    sfdp_init();
+
+    memset(&sFlash, 0, sizeof(sFlash));
+    sFlash.name = "W25Q64";
+    sFlash.spi.user_data = (void *)QSPI0;
+    sFlash.retry.times = 10;
+
+    if (sfud_spi_port_init(&sFlash) != SFUD_SUCCESS)
+    {
+        printf("sfud_spi_port_init failed\nFAIL\n");
+        return 1;
+    }
+
+    /* Plain SPI reads by spi_write_read. */
+    for (bSched = 0; bSched < 2; bSched++)
+    {
+        for (j = 0; j < (int)(sizeof(ai32Size) / sizeof(ai32Size[0])); j++)
+        {
+            u32Checks++;
+            if (check_spi_read(&sFlash, 0x1234, ai32Size[j], bSched) != 0)
+                u32Fails++;
+        }
+    }
+
+    /* Fast read commands from SFDP, by QSPI. SFDP is read before the scheduler starts. */
+    for (i = 0; i < (int)sizeof(au8Width); i++)
+    {
+        for (b4Byte = 0; b4Byte < 2; b4Byte++)
+        {
+            s_i32SchedState = taskSCHEDULER_NOT_STARTED;
+            sFlash.addr_in_4_byte = b4Byte;
+
+            u32Checks++;
+            if ((nu_sfud_qspi_fast_read_enable(&sFlash, au8Width[i]) != SFUD_SUCCESS) ||
+                    (sFlash.read_cmd_format.instruction != au8Ins[i]) ||
+                    (sFlash.read_cmd_format.dummy_cycles != au8Dummy[i]) ||
+                    (sFlash.read_cmd_format.address_size != (b4Byte ? 32 : 24)))
+            {
+                fprintf(stderr, "%d lines: got %02Xh with %d dummy cycles\n", au8Width[i],
+                        sFlash.read_cmd_format.instruction, sFlash.read_cmd_format.dummy_cycles);
+                u32Fails++;
+                continue;
+            }
+
+            for (bSched = 0; bSched < 2; bSched++)
+            {
+                for (j = 0; j < (int)(sizeof(ai32Size) / sizeof(ai32Size[0])); j++)
+                {
+                    /* Odd addresses, with every byte of it set. */
+                    u32Addr = (b4Byte ? 0x5AA20000 : 0x00A50000) + 0x3C5 + j;
+
+                    u32Checks++;
+                    if (check_qspi_read(&sFlash, u32Addr, ai32Size[j], bSched) != 0)
+                        u32Fails++;
+                }
+            }
+        }
+    }
+
+    printf("%u checks, %u failed, %u bus errors\n",
+           (unsigned int)u32Checks, (unsigned int)u32Fails, (unsigned int)s_sBus.u32Errors);
+
+    if (u32Fails || s_sBus.u32Errors)
+    {
+        printf("FAIL\n");
+        return 1;
+    }
+
+    printf("PASS\n");
+
+    return 0;
+}